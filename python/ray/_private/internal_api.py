@@ -145,6 +145,11 @@ def store_stats_summary(reply):
                 ),
             )
         )
+    if reply.store_stats.spill_compression_ratio > 1.05:
+        store_summary += "Spill compression: {} MiB on disk, ratio {}\n".format(
+            int(reply.store_stats.spilled_bytes_on_disk_total / (1024 * 1024)),
+            round(reply.store_stats.spill_compression_ratio, 2),
+        )
     if reply.store_stats.restore_time_total_s > 0:
         store_summary += (
             "Restored {} MiB, {} objects, avg read throughput {} MiB/s\n".format(
@@ -282,6 +282,18 @@ def main(results=None):
     results += timeit("n:n async-actor calls async", async_actor_multi, m * n)
     ray.shutdown()
 
+    # Same as "1:1 actor calls async", but the calls are coalesced into batched
+    # PushTasks RPCs.
+    ray.init(_system_config={"actor_task_batch_max_size": 64})
+
+    a = Actor.remote()
+
+    def actor_async_batched():
+        ray.get([a.small_value.remote() for _ in range(1000)])
+
+    results += timeit("1:1 actor calls async batched", actor_async_batched, 1000)
+    ray.shutdown()
+
     NUM_PGS = 100
     NUM_BUNDLES = 1
     ray.init(resources={"custom": 100})
@@ -48,6 +48,10 @@ _METRICS = [
     "ray_object_store_used_memory",
     "ray_object_store_num_local_objects",
     "ray_object_store_memory",
+    # "ray_object_store_slab_bytes",
+    # "ray_object_store_slab_fragmentation_ratio",
+    # "ray_task_lineage_bytes",
+    # "ray_core_worker_lease_reuses_total",
     "ray_object_manager_num_pull_requests",
     "ray_object_directory_subscriptions",
     "ray_object_directory_updates",
@@ -195,6 +195,63 @@ def test_pull_spilled_object(
         assert hash_value == hash_value1
 
 
+@pytest.mark.skipif(platform.system() == "Windows", reason="Failing on Windows.")
+@pytest.mark.parametrize("native_fs", [False, True])
+def test_pull_spilled_object_from_disk(
+    ray_start_cluster_enabled, fs_only_object_spilling_config, native_fs, shutdown_only
+):
+    """Objects spilled to the local filesystem are pushed to other nodes straight
+    from the spill file, without being restored on the node that spilled them."""
+    cluster = ray_start_cluster_enabled
+    object_spilling_config, _ = fs_only_object_spilling_config
+
+    # Head node.
+    cluster.add_node(
+        num_cpus=1,
+        resources={"custom": 0},
+        object_store_memory=75 * 1024 * 1024,
+        _system_config={
+            "max_io_workers": 2,
+            "min_spilling_size": 1 * 1024 * 1024,
+            "automatic_object_spilling_enabled": True,
+            "object_store_full_delay_ms": 100,
+            "object_spilling_config": object_spilling_config,
+            "object_spilling_native_fs": native_fs,
+        },
+    )
+    ray.init(cluster.address)
+
+    # add 1 worker node
+    cluster.add_node(
+        num_cpus=1, resources={"custom": 1}, object_store_memory=75 * 1024 * 1024
+    )
+    cluster.wait_for_nodes()
+
+    @ray.remote(num_cpus=1, resources={"custom": 1})
+    def create_objects():
+        results = []
+        for _ in range(8):
+            arr = np.random.rand(1024 * 1024)
+            results.append([ray.put(arr), zlib.crc32(arr.tobytes())])
+        # ensure the objects are spilled
+        for _ in range(4):
+            ray.get(ray.put(np.random.rand(5 * 1024 * 1024)))
+        return results
+
+    @ray.remote(num_cpus=1, resources={"custom": 0})
+    def get_object(arr):
+        return zlib.crc32(arr.tobytes())
+
+    results = ray.get(create_objects.remote())
+    _check_spilled(num_objects_spilled=1)
+    for value_ref, hash_value in results:
+        assert ray.get(get_object.remote(value_ref)) == hash_value
+
+    # Neither node restored the objects into plasma to transfer them.
+    s = ray._private.internal_api.memory_summary(stats_only=True)
+    assert "Restored" not in s, s
+
+
 # TODO(chenshen): fix error handling when spilled file
 # missing/corrupted
 @pytest.mark.skipif(True, reason="Currently hangs.")
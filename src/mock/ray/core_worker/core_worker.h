@@ -45,6 +45,18 @@ class MockCoreWorker : public CoreWorker {
                rpc::PushTaskReply *reply,
                rpc::SendReplyCallback send_reply_callback),
               (override));
+  MOCK_METHOD(void,
+              HandlePushTasks,
+              (rpc::PushTasksRequest request,
+               rpc::PushTasksReply *reply,
+               rpc::SendReplyCallback send_reply_callback),
+              (override));
+  MOCK_METHOD(void,
+              HandleReportActorTaskReply,
+              (rpc::ReportActorTaskReplyRequest request,
+               rpc::ReportActorTaskReplyReply *reply,
+               rpc::SendReplyCallback send_reply_callback),
+              (override));
   MOCK_METHOD(void,
               HandleDirectActorCallArgWaitComplete,
               (rpc::DirectActorCallArgWaitCompleteRequest request,
@@ -57,6 +69,12 @@ class MockCoreWorker : public CoreWorker {
                rpc::GetObjectStatusReply *reply,
                rpc::SendReplyCallback send_reply_callback),
               (override));
+  MOCK_METHOD(void,
+              HandleGetObjectStatuses,
+              (rpc::GetObjectStatusesRequest request,
+               rpc::GetObjectStatusesReply *reply,
+               rpc::SendReplyCallback send_reply_callback),
+              (override));
   MOCK_METHOD(void,
               HandleWaitForActorOutOfScope,
               (rpc::WaitForActorOutOfScopeRequest request,
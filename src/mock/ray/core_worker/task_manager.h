@@ -75,6 +75,10 @@ class MockTaskResubmissionInterface : public TaskResubmissionInterface {
               ResubmitTask,
               (const TaskID &task_id, std::vector<ObjectID> *task_deps),
               (override));
+  MOCK_METHOD(bool,
+              GetTaskDependencies,
+              (const TaskID &task_id, std::vector<ObjectID> *task_deps),
+              (const, override));
 };
 
 }  // namespace core
@@ -37,7 +37,7 @@ class MockCoreWorkerClientInterface : public ray::pubsub::MockSubscriberClientIn
               (override));
   MOCK_METHOD(void,
               PushNormalTask,
-              (std::unique_ptr<PushTaskRequest> request,
+              (const PushTaskRequest &request,
                const ClientCallback<PushTaskReply> &callback),
               (override));
   MOCK_METHOD(void,
@@ -50,6 +50,11 @@ class MockCoreWorkerClientInterface : public ray::pubsub::MockSubscriberClientIn
               (const GetObjectStatusRequest &request,
                const ClientCallback<GetObjectStatusReply> &callback),
               (override));
+  MOCK_METHOD(void,
+              GetObjectStatuses,
+              (const GetObjectStatusesRequest &request,
+               const ClientCallback<GetObjectStatusesReply> &callback),
+              (override));
   MOCK_METHOD(void,
               WaitForActorOutOfScope,
               (const WaitForActorOutOfScopeRequest &request,
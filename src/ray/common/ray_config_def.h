@@ -156,6 +156,20 @@ RAY_CONFIG(bool, lineage_pinning_enabled, true)
 /// cache.
 RAY_CONFIG(int64_t, reconstruct_objects_period_milliseconds, 100)
 
+/// Whether the objects that are flushed from the local cache together, e.g.
+/// all objects lost with a node, are recovered as one plan. Copies are pinned
+/// with one request per node, and the lineage of the objects is resubmitted
+/// once per task, in dependency order.
+RAY_CONFIG(bool, object_recovery_bulk_mode, false)
+
+/// The maximum number of tasks that one bulk recovery plan has resubmitted and
+/// that did not finish yet.
+RAY_CONFIG(int64_t, object_recovery_max_inflight_tasks, 1000)
+
+/// The maximum number of object location lookups that one bulk recovery plan
+/// has issued and that did not return yet.
+RAY_CONFIG(int64_t, object_recovery_max_inflight_lookups, 1000)
+
 /// Maximum amount of lineage to keep in bytes. This includes the specs of all
 /// tasks that have previously already finished but that may be retried again.
 /// If we reach this limit, 50% of the current lineage will be evicted and
@@ -164,12 +178,49 @@ RAY_CONFIG(int64_t, reconstruct_objects_period_milliseconds, 100)
 /// inlined args.
 RAY_CONFIG(int64_t, max_lineage_bytes, 1024 * 1024 * 1024)
 
+/// Maximum amount of lineage in bytes that an owner spills to local disk once
+/// it exceeds max_lineage_bytes. The oldest lineage is spilled first and is
+/// read back if it is needed to reconstruct an object. Lineage is only evicted
+/// once this limit is also reached. Set to 0 to disable spilling lineage.
+RAY_CONFIG(int64_t, max_lineage_spill_bytes, 0)
+
+/// The directory that owners spill lineage to. If empty, the session
+/// directory is used.
+RAY_CONFIG(std::string, lineage_spill_directory, "")
+
 /// Whether to re-populate plasma memory. This avoids memory allocation failures
 /// at runtime (SIGBUS errors creating new objects), however it will use more memory
 /// upfront and can slow down Ray startup.
 /// See also: https://github.com/ray-project/ray/issues/14182
 RAY_CONFIG(bool, preallocate_plasma_memory, false)
 
+/// Whether to back the plasma arena with 2MB huge pages, which reduces TLB misses
+/// when reading large objects. If the kernel has no free huge pages (see
+/// /proc/sys/vm/nr_hugepages), we fall back to regular pages with transparent
+/// huge pages requested. Only supported on Linux.
+RAY_CONFIG(bool, plasma_huge_page_arena, false)
+
+/// Comma separated list of NUMA nodes to allocate the plasma arena on, e.g. "0"
+/// or "0,1". The arena is bound to a single node, or interleaved across several.
+/// If empty, the default memory policy of the raylet is used. Only supported on
+/// Linux.
+RAY_CONFIG(std::string, plasma_numa_nodes, "")
+
+/// The policy used to choose which objects to evict from the plasma store when
+/// it is full. One of "lru", "slru" (segmented LRU, which protects objects that
+/// are used repeatedly from scans) or "gdsf" (GreedyDual-Size-Frequency, which
+/// prefers to keep small and frequently used objects).
+RAY_CONFIG(std::string, plasma_eviction_policy, "lru")
+
+/// Objects up to this size are allocated from per size class slabs of plasma
+/// memory instead of going through dlmalloc. This avoids fragmenting the
+/// arena when there are many small objects. Set to 0 to disable.
+RAY_CONFIG(int64_t, plasma_slab_max_object_size, 0)
+
+/// The size of each slab allocated by the plasma slab allocator. Must be at
+/// least plasma_slab_max_object_size.
+RAY_CONFIG(int64_t, plasma_slab_size, 1024 * 1024)
+
 // If true, we place a soft cap on the numer of scheduling classes, see
 // `worker_cap_initial_backoff_delay_ms`.
 RAY_CONFIG(bool, worker_cap_enabled, true)
@@ -192,17 +243,29 @@ RAY_CONFIG(int64_t, worker_cap_max_backoff_delay_ms, 1000 * 10)
 /// even balancing of load. Low values (min 0.0) encourage more load spreading.
 RAY_CONFIG(float, scheduler_spread_threshold, 0.5)
 
-/// Used by the default hybrid policy only. The scheduler will randomly pick
-/// one node from the top k in the cluster to improve load balancing. The
+/// The weight of task argument locality when the raylet picks a node for a task
+/// with the default scheduling strategy, between 0 and 1. A node is scored by
+/// (1 - weight) * its resource utilization score + weight * the fraction of the
+/// argument bytes that it would have to fetch. 0 disables locality aware scheduling.
+RAY_CONFIG(float, scheduler_locality_weight, 0)
+
+/// Used by the default hybrid and the locality aware policies only. The scheduler will
+/// randomly pick one node from the top k in the cluster to improve load balancing. The
 /// scheduler guarantees k is at least equal to this fraction * the number of
 /// nodes in the cluster.
 RAY_CONFIG(float, scheduler_top_k_fraction, 0.2);
 
-/// Used by the default hybrid policy only. The scheduler will randomly pick
-/// one node from the top k in the cluster to improve load balancing. The
+/// Used by the default hybrid and the locality aware policies only. The scheduler will
+/// randomly pick one node from the top k in the cluster to improve load balancing. The
 /// scheduler guarantees k is at least equal to scheduler_top_k_absolute.
 RAY_CONFIG(int32_t, scheduler_top_k_absolute, 1);
 
+/// Whether the cluster task manager places the pending tasks of a scheduling class
+/// in batches. When enabled, a node that is picked for a task is also given as many
+/// of the following tasks of the same class as fit in its available resources,
+/// instead of picking a node again for each of them.
+RAY_CONFIG(bool, scheduler_batch_placement_enabled, false)
+
 /// Whether to only report the usage of pinned copies of objects in the
 /// object_store_memory resource. This means nodes holding secondary copies only
 /// will become eligible for removal in the autoscaler.
@@ -237,6 +300,49 @@ RAY_CONFIG(uint64_t, actor_creation_min_retries, 3)
 /// It likely indicates a bug in the user code.
 RAY_CONFIG(uint64_t, actor_excess_queueing_warn_threshold, 5000)
 
+/// The stack size in bytes of the fiber that runs each call of an async actor,
+/// or 0 for the default size of boost fibers. Only the calls that are running,
+/// at most max_concurrency per concurrency group, hold a stack. A smaller stack
+/// lowers the memory used per in-flight call, but the task and the Python
+/// frames it calls into must fit in it.
+RAY_CONFIG(uint64_t, async_actor_fiber_stack_size, 0)
+
+/// The max number of actor tasks that are sent to an actor in one PushTasks RPC.
+/// Tasks that become ready to send within actor_task_batch_window_us of each
+/// other are coalesced. Tasks to actors that execute out of order are not
+/// batched. Only the requests are coalesced: the actor reports the reply to each
+/// task to the caller as soon as the task finishes. Set to 1 to send each task in
+/// its own PushTask RPC.
+RAY_CONFIG(uint64_t, actor_task_batch_max_size, 1)
+
+/// How long to wait for more actor tasks to fill a batch before sending it.
+RAY_CONFIG(uint64_t, actor_task_batch_window_us, 100)
+
+/// The reply to a task that was sent in a PushTasks RPC is reported to the caller
+/// in its own RPC, which is the only way for the caller to learn the result of the
+/// task. If the report fails, the actor retries it after this delay, which doubles
+/// on every retry up to actor_task_reply_report_max_retry_delay_ms. The actor
+/// retries until the report succeeds or the caller is known to be dead.
+RAY_CONFIG(int64_t, actor_task_reply_report_initial_retry_delay_ms, 100)
+
+/// The max delay between retries to report the reply to a task, see
+/// actor_task_reply_report_initial_retry_delay_ms.
+RAY_CONFIG(int64_t, actor_task_reply_report_max_retry_delay_ms, 5000)
+
+/// Whether the concurrency groups of a threaded actor share one work-stealing
+/// pool of threads instead of each group having its own thread pool. The
+/// max_concurrency of each group still bounds how many of its tasks run at a
+/// time.
+RAY_CONFIG(bool, actor_executor_work_stealing, false)
+
+/// The number of threads of the work-stealing pool of a threaded actor. If
+/// this is 0, the pool has as many threads as the max_concurrency of all of the
+/// actor's groups together, and it never has more. A smaller pool uses fewer
+/// threads, but a group may then run fewer tasks at a time while the other
+/// groups keep the threads busy. So it should not be set for actors whose tasks
+/// wait on each other.
+RAY_CONFIG(int64_t, actor_executor_work_stealing_num_threads, 0)
+
 /// When trying to resolve an object, the initial period that the raylet will
 /// wait before contacting the object's owner to check if the object is still
 /// available. This is a lower bound on the time to report the loss of an
@@ -248,6 +354,12 @@ RAY_CONFIG(int64_t, object_timeout_milliseconds, 100)
 /// for direct task submission until it must be returned to the raylet.
 RAY_CONFIG(int64_t, worker_lease_timeout_milliseconds, 500)
 
+/// Whether an idle leased worker can be reused for queued tasks of a different
+/// scheduling key that has the same resource shape and runtime env, instead of
+/// returning the worker to the raylet and requesting a new lease. The reused
+/// lease skips the raylet's locality and spillback decisions for the new key.
+RAY_CONFIG(bool, worker_lease_reuse_across_scheduling_keys, false)
+
 /// The interval at which the workers will check if their raylet has gone down.
 /// When this happens, they will kill themselves.
 RAY_CONFIG(uint64_t, raylet_death_check_interval_milliseconds, 1000)
@@ -274,6 +386,19 @@ RAY_CONFIG(bool, yield_plasma_lock_workaround, true)
 // See https://github.com/ray-project/ray/issues/16025 for more details.
 RAY_CONFIG(bool, inline_object_status_in_refs, true)
 
+/// The maximum number of objects that a borrower asks the same owner about in
+/// one GetObjectStatuses request. Requests for objects with the same owner are
+/// coalesced. If this is 0, one GetObjectStatus request is sent per object.
+RAY_CONFIG(int64_t, object_status_batch_max_size, 1000)
+
+/// Once the status of the first object in a GetObjectStatuses request is
+/// known, the owner waits this long for more of the objects to be created
+/// before it replies. This bounds the number of times that a borrower asks
+/// again for the rest of the objects while they are created one by one, but it
+/// delays the objects that are already created. If this is 0, the owner
+/// replies as soon as the status of any of the objects is known.
+RAY_CONFIG(int64_t, object_status_batch_wait_ms, 0)
+
 /// Number of times raylet client tries connecting to a raylet.
 RAY_CONFIG(int64_t, raylet_client_num_connect_attempts, 10)
 RAY_CONFIG(int64_t, raylet_client_connect_timeout_milliseconds, 1000)
@@ -331,6 +456,34 @@ RAY_CONFIG(int, object_manager_push_timeout_ms, 10000)
 /// NOTE(ekl): this has been raised to lower broadcast overheads.
 RAY_CONFIG(uint64_t, object_manager_default_chunk_size, 5 * 1024 * 1024)
 
+/// Min chunk size for multi-chunk transfers in the object manager. Objects are
+/// split into a few chunks between this and object_manager_default_chunk_size, so
+/// that small objects are still transferred over several connections in parallel,
+/// while large objects use fewer, larger chunks. Like the default chunk size, this
+/// must be the same on all nodes.
+RAY_CONFIG(uint64_t, object_manager_min_chunk_size, 1024 * 1024)
+
+/// Whether to limit the chunks in flight to each destination node by a window that
+/// grows and shrinks based on the latency of completed chunks, so that slow nodes
+/// don't take up the whole object_manager_max_bytes_in_flight budget.
+RAY_CONFIG(bool, object_manager_push_congestion_control, true)
+
+/// The max number of nodes that the object manager sends an object to at a time
+/// before forwarding further pull requests for it to those nodes, which relay the
+/// chunks onward as they receive them. This turns broadcasts of an object to many
+/// nodes into a relay tree. Pull requests are never forwarded if this is 0.
+RAY_CONFIG(int64_t, object_manager_broadcast_fanout, 0)
+
+/// Whether to push chunks of objects in plasma by referencing the plasma memory
+/// directly from the gRPC request, instead of copying each chunk into it. The
+/// object stays pinned until the chunk has been written to the wire.
+RAY_CONFIG(bool, object_manager_zero_copy_push, true)
+
+/// The number of bytes after each chunk of a spilled object that the OS is asked to
+/// read ahead when the object is pushed straight from its spill file. 0 disables
+/// read-ahead hints.
+RAY_CONFIG(uint64_t, object_manager_spilled_object_readahead_bytes, 16 * 1024 * 1024)
+
 /// The maximum number of outbound bytes to allow to be outstanding. This avoids
 /// excessive memory usage during object broadcast to many receivers.
 RAY_CONFIG(uint64_t,
@@ -580,6 +733,24 @@ RAY_CONFIG(float, object_spilling_threshold, 0.8)
 /// Maximum number of objects that can be fused into a single file.
 RAY_CONFIG(int64_t, max_fused_object_count, 2000)
 
+/// Whether the raylet should spill and restore objects itself when the external
+/// storage is the local filesystem, instead of sending them through Python IO
+/// workers. Other external storages always use IO workers.
+RAY_CONFIG(bool, object_spilling_native_fs, false)
+
+/// Whether objects spilled by the raylet are written with O_DIRECT, bypassing the
+/// page cache. Only used if object_spilling_native_fs is enabled.
+RAY_CONFIG(bool, object_spilling_direct_io, false)
+
+/// The codec that objects spilled by the raylet are compressed with, or empty to
+/// not compress them. Only "zlib" is supported. Objects that don't shrink are
+/// stored uncompressed. Only used if object_spilling_native_fs is enabled.
+RAY_CONFIG(std::string, object_spilling_compression, "")
+
+/// The number of bytes of each spilled object that are compressed together. Ranges
+/// of a compressed object are read by decompressing the blocks they overlap.
+RAY_CONFIG(uint64_t, object_spilling_compression_block_size, 1024 * 1024)
+
 /// Grace period until we throw the OOM error to the application in seconds.
 /// In unlimited allocation mode, this is the time delay prior to fallback allocating.
 RAY_CONFIG(int64_t, oom_grace_period_s, 2)
@@ -619,6 +790,16 @@ RAY_CONFIG(int64_t, timeout_ms_task_wait_for_death_info, 1000)
 /// report the loads to raylet.
 RAY_CONFIG(int64_t, core_worker_internal_heartbeat_ms, 1000)
 
+/// The number of independently locked shards of the core worker's in-memory object
+/// store. More shards reduce lock contention between threads of threaded actors and
+/// task completion callbacks.
+RAY_CONFIG(uint64_t, core_worker_memory_store_num_shards, 16)
+
+/// The number of independently locked shards for the local reference counts of objects
+/// that already have a local reference. Adding and removing more local references to
+/// such objects does not take the reference counter's main lock. Set to 0 to disable.
+RAY_CONFIG(uint64_t, reference_counter_num_local_ref_shards, 16)
+
 /// Maximum amount of memory that will be used by running tasks' args.
 RAY_CONFIG(float, max_task_args_memory_fraction, 0.7)
 
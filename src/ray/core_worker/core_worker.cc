@@ -21,6 +21,7 @@
 #include <google/protobuf/util/json_util.h>
 
 #include "boost/fiber/all.hpp"
+#include "ray/common/asio/asio_util.h"
 #include "ray/common/bundle_spec.h"
 #include "ray/common/ray_config.h"
 #include "ray/common/runtime_env_common.h"
@@ -32,6 +33,7 @@
 #include "ray/stats/metric_defs.h"
 #include "ray/stats/stats.h"
 #include "ray/util/event.h"
+#include "ray/util/filesystem.h"
 #include "ray/util/util.h"
 
 namespace ray {
@@ -334,6 +336,25 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
                                     double timestamp) {
     return PushError(job_id, type, error_message, timestamp);
   };
+  std::unique_ptr<LineageStore> lineage_store;
+  if (RayConfig::instance().max_lineage_spill_bytes() > 0) {
+    auto lineage_spill_directory = RayConfig::instance().lineage_spill_directory();
+    if (lineage_spill_directory.empty() && !options_.log_dir.empty()) {
+      // The log directory is in the session directory, so that the segments
+      // are cleaned up with the session even if this worker dies.
+      lineage_spill_directory =
+          std::filesystem::path(options_.log_dir).parent_path().string();
+    }
+    if (lineage_spill_directory.empty()) {
+      RAY_LOG(WARNING) << "Not spilling lineage because neither the lineage spill "
+                          "directory nor the log directory is set.";
+    } else {
+      lineage_store = std::make_unique<LineageStore>(
+          lineage_spill_directory,
+          worker_context_.GetWorkerID().Hex(),
+          RayConfig::instance().max_lineage_spill_bytes());
+    }
+  }
   task_manager_.reset(new TaskManager(
       memory_store_,
       reference_counter_,
@@ -364,7 +385,8 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
       },
       push_error_callback,
       RayConfig::instance().max_lineage_bytes(),
-      *task_event_buffer_.get()));
+      *task_event_buffer_.get(),
+      std::move(lineage_store)));
 
   // Create an entry for the driver task in the task table. This task is
   // added immediately with status RUNNING. This allows us to push errors
@@ -473,7 +495,8 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
                                             reference_counter_,
                                             std::move(report_locality_data_callback),
                                             core_worker_client_pool_,
-                                            rpc_address_));
+                                            rpc_address_,
+                                            io_service_));
 
   // Unfortunately the raylet client has to be constructed after the receivers.
   if (direct_task_receiver_ != nullptr) {
@@ -574,13 +597,11 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
           // will eventually be stored for the objects (either an
           // UnreconstructableError or a value reconstructed from lineage).
           memory_store_->Delete(lost_objects);
-          for (const auto &object_id : lost_objects) {
-            // NOTE(swang): There is a race condition where this can return false if
-            // the reference went out of scope since the call to the ref counter to get
-            // the lost objects. It's okay to not mark the object as failed or recover
-            // the object since there are no reference holders.
-            RAY_UNUSED(object_recovery_manager_->RecoverObject(object_id));
-          }
+          // NOTE(swang): There is a race condition where an object is not recovered if
+          // the reference went out of scope since the call to the ref counter to get
+          // the lost objects. It's okay to not mark the object as failed or recover
+          // the object since there are no reference holders.
+          object_recovery_manager_->RecoverObjects(lost_objects);
         }
       },
       100);
@@ -1931,8 +1952,8 @@ std::vector<rpc::ObjectReference> CoreWorker::SubmitTask(
     returned_refs = task_manager_->AddPendingTask(
         task_spec.CallerAddress(), task_spec, CurrentCallSite(), max_retries);
     io_service_.post(
-        [this, task_spec]() {
-          RAY_UNUSED(direct_task_submitter_->SubmitTask(task_spec));
+        [this, task_spec = std::move(task_spec)]() mutable {
+          RAY_UNUSED(direct_task_submitter_->SubmitTask(std::move(task_spec)));
         },
         "CoreWorker.SubmitTask");
   }
@@ -2968,6 +2989,72 @@ void CoreWorker::HandlePushTask(rpc::PushTaskRequest request,
   }
 }
 
+void CoreWorker::HandlePushTasks(rpc::PushTasksRequest request,
+                                 rpc::PushTasksReply *reply,
+                                 rpc::SendReplyCallback send_reply_callback) {
+  CoreWorkerDirectTaskReceiver::HandleTaskBatch(
+      std::move(request),
+      reply,
+      std::move(send_reply_callback),
+      [this](rpc::PushTaskRequest request,
+             rpc::PushTaskReply *reply,
+             rpc::SendReplyCallback send_reply_callback) {
+        HandlePushTask(std::move(request), reply, std::move(send_reply_callback));
+      },
+      [this](const rpc::Address &caller_address,
+             const rpc::ReportActorTaskReplyRequest &task_reply,
+             std::function<void(const Status &)> on_sent) {
+        rpc::ReportActorTaskReplyRequest request = task_reply;
+        request.mutable_executor_address()->CopyFrom(rpc_address_);
+        core_worker_client_pool_->GetOrConnect(caller_address)
+            ->ReportActorTaskReply(
+                request,
+                [on_sent = std::move(on_sent)](
+                    const Status &status, const rpc::ReportActorTaskReplyReply &reply) {
+                  on_sent(status);
+                });
+      },
+      [this](const rpc::Address &caller_address,
+             const Status &status,
+             std::function<void(bool)> on_checked) {
+        // The caller rejects the report if it was sent to the wrong worker, which
+        // means the caller has exited and its address was reused.
+        if (status.IsInvalid() || gcs_client_->Nodes().IsRemoved(
+                                      NodeID::FromBinary(caller_address.raylet_id()))) {
+          on_checked(true);
+          return;
+        }
+        auto lookup_status = gcs_client_->Workers().AsyncGet(
+            WorkerID::FromBinary(caller_address.worker_id()),
+            [on_checked](const Status &get_status,
+                         const boost::optional<rpc::WorkerTableData> &worker) {
+              on_checked(get_status.ok() && worker.has_value() && !worker->is_alive());
+            });
+        if (!lookup_status.ok()) {
+          on_checked(false);
+        }
+      },
+      io_service_);
+}
+
+void CoreWorker::HandleReportActorTaskReply(
+    rpc::ReportActorTaskReplyRequest request,
+    rpc::ReportActorTaskReplyReply *reply,
+    rpc::SendReplyCallback send_reply_callback) {
+  if (HandleWrongRecipient(WorkerID::FromBinary(request.intended_worker_id()),
+                           send_reply_callback)) {
+    return;
+  }
+  // The task was pushed through the client of the worker that executed it. If the
+  // client was disconnected since, the task has already been failed.
+  auto client = core_worker_client_pool_->GetByID(
+      WorkerID::FromBinary(request.executor_address().worker_id()));
+  if (client.has_value()) {
+    (*client)->HandleActorTaskReply(request);
+  }
+  send_reply_callback(Status::OK(), nullptr, nullptr);
+}
+
 void CoreWorker::HandleDirectActorCallArgWaitComplete(
     rpc::DirectActorCallArgWaitCompleteRequest request,
     rpc::DirectActorCallArgWaitCompleteReply *reply,
@@ -3042,6 +3129,162 @@ void CoreWorker::HandleGetObjectStatus(rpc::GetObjectStatusRequest request,
   RemoveLocalReference(object_id);
 }
 
+void CoreWorker::HandleGetObjectStatuses(rpc::GetObjectStatusesRequest request,
+                                         rpc::GetObjectStatusesReply *reply,
+                                         rpc::SendReplyCallback send_reply_callback) {
+  if (HandleWrongRecipient(WorkerID::FromBinary(request.owner_worker_id()),
+                           send_reply_callback)) {
+    RAY_LOG(INFO) << "Handling GetObjectStatuses for objects produced by a previous "
+                     "worker with the same address";
+    return;
+  }
+
+  std::vector<ObjectID> object_ids;
+  object_ids.reserve(request.object_ids_size());
+  for (const auto &object_id : request.object_ids()) {
+    object_ids.push_back(ObjectID::FromBinary(object_id));
+  }
+  RAY_LOG(DEBUG) << "Received GetObjectStatuses for " << object_ids.size()
+                 << " objects";
+  // Acquire references to the objects. This prevents them from being evicted
+  // out from under us while we check their status and start the Get.
+  for (const auto &object_id : object_ids) {
+    AddLocalReference(object_id, "<temporary (get object status)>");
+  }
+
+  // Add the status of the objects that are already known to the reply.
+  std::vector<ObjectID> pending_object_ids;
+  for (const auto &object_id : object_ids) {
+    if (!HasOwner(object_id)) {
+      // We owned this object, but the object has gone out of scope.
+      reply->add_object_ids(object_id.Binary());
+      reply->add_statuses()->set_status(rpc::GetObjectStatusReply::OUT_OF_SCOPE);
+      continue;
+    }
+    auto obj = memory_store_->GetIfExists(object_id);
+    if (obj == nullptr) {
+      pending_object_ids.push_back(object_id);
+      continue;
+    }
+    reply->add_object_ids(object_id.Binary());
+    if (reference_counter_->IsPlasmaObjectFreed(object_id)) {
+      reply->add_statuses()->set_status(rpc::GetObjectStatusReply::FREED);
+    } else {
+      PopulateObjectStatus(object_id, obj, reply->add_statuses());
+    }
+  }
+
+  if (pending_object_ids.empty()) {
+    send_reply_callback(Status::OK(), nullptr, nullptr);
+  } else {
+    // Reply once all of the objects have been created, or
+    // object_status_batch_wait_ms after the first of them has been, so that
+    // the caller doesn't have to ask again for the rest every time one more
+    // object is created. The caller will ask again
+    // for the objects that are still pending. The values are guaranteed to
+    // become available eventually because we own the objects and their ref
+    // counts are > 0.
+    auto pending = std::make_shared<PendingObjectStatusesRequest>(
+        reply, std::move(send_reply_callback), pending_object_ids.size());
+    const bool schedule_reply = reply->object_ids_size() > 0;
+    std::vector<ObjectID> objects_to_get;
+    {
+      absl::MutexLock lock(&object_status_mutex_);
+      pending->reply_scheduled = schedule_reply;
+      for (const auto &object_id : pending_object_ids) {
+        if (!object_status_waiters_.contains(object_id)) {
+          objects_to_get.push_back(object_id);
+        }
+        // Drop the requests that were already replied to through another
+        // object, so that a caller that keeps asking about an object that is
+        // not created yet does not grow the list.
+        auto &waiters = object_status_waiters_[object_id];
+        waiters.erase(std::remove_if(waiters.begin(),
+                                     waiters.end(),
+                                     [](const auto &waiter) { return waiter->replied; }),
+                      waiters.end());
+        waiters.push_back(pending);
+      }
+    }
+    if (schedule_reply) {
+      ScheduleObjectStatusesReply(pending);
+    }
+    for (const auto &object_id : objects_to_get) {
+      memory_store_->GetAsync(object_id,
+                              [this, object_id](std::shared_ptr<RayObject> obj) {
+                                OnObjectStatusReady(object_id, std::move(obj));
+                              });
+    }
+  }
+
+  for (const auto &object_id : object_ids) {
+    RemoveLocalReference(object_id);
+  }
+}
+
+void CoreWorker::OnObjectStatusReady(const ObjectID &object_id,
+                                     std::shared_ptr<RayObject> obj) {
+  const bool is_freed = reference_counter_->IsPlasmaObjectFreed(object_id);
+  // The requests that are complete and the ones that got the status of their
+  // first object.
+  std::vector<std::shared_ptr<PendingObjectStatusesRequest>> to_reply;
+  std::vector<std::shared_ptr<PendingObjectStatusesRequest>> to_schedule;
+  {
+    absl::MutexLock lock(&object_status_mutex_);
+    auto it = object_status_waiters_.find(object_id);
+    if (it == object_status_waiters_.end()) {
+      return;
+    }
+    for (auto &waiter : it->second) {
+      if (waiter->replied) {
+        continue;
+      }
+      waiter->reply->add_object_ids(object_id.Binary());
+      if (is_freed) {
+        waiter->reply->add_statuses()->set_status(rpc::GetObjectStatusReply::FREED);
+      } else {
+        PopulateObjectStatus(object_id, obj, waiter->reply->add_statuses());
+      }
+      waiter->num_pending--;
+      if (waiter->num_pending == 0) {
+        waiter->replied = true;
+        to_reply.push_back(std::move(waiter));
+      } else if (!waiter->reply_scheduled) {
+        waiter->reply_scheduled = true;
+        to_schedule.push_back(std::move(waiter));
+      }
+    }
+    object_status_waiters_.erase(it);
+  }
+
+  for (const auto &waiter : to_reply) {
+    waiter->send_reply_callback(Status::OK(), nullptr, nullptr);
+  }
+  for (const auto &waiter : to_schedule) {
+    ScheduleObjectStatusesReply(waiter);
+  }
+}
+
+void CoreWorker::ScheduleObjectStatusesReply(
+    const std::shared_ptr<PendingObjectStatusesRequest> &pending) {
+  auto reply = [this, pending]() {
+    {
+      absl::MutexLock lock(&object_status_mutex_);
+      if (pending->replied) {
+        return;
+      }
+      pending->replied = true;
+    }
+    pending->send_reply_callback(Status::OK(), nullptr, nullptr);
+  };
+  const int64_t wait_ms = RayConfig::instance().object_status_batch_wait_ms();
+  if (wait_ms <= 0) {
+    reply();
+  } else {
+    execute_after(io_service_, std::move(reply), wait_ms);
+  }
+}
+
 void CoreWorker::PopulateObjectStatus(const ObjectID &object_id,
                                       std::shared_ptr<RayObject> obj,
                                       rpc::GetObjectStatusReply *reply) {
@@ -991,6 +991,16 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
                       rpc::PushTaskReply *reply,
                       rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Implements gRPC server handler.
+  void HandlePushTasks(rpc::PushTasksRequest request,
+                       rpc::PushTasksReply *reply,
+                       rpc::SendReplyCallback send_reply_callback) override;
+
+  /// Implements gRPC server handler.
+  void HandleReportActorTaskReply(rpc::ReportActorTaskReplyRequest request,
+                                  rpc::ReportActorTaskReplyReply *reply,
+                                  rpc::SendReplyCallback send_reply_callback) override;
+
   /// Implements gRPC server handler.
   void HandleDirectActorCallArgWaitComplete(
       rpc::DirectActorCallArgWaitCompleteRequest request,
@@ -1007,6 +1017,11 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
                              rpc::GetObjectStatusReply *reply,
                              rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Implements gRPC server handler.
+  void HandleGetObjectStatuses(rpc::GetObjectStatusesRequest request,
+                               rpc::GetObjectStatusesReply *reply,
+                               rpc::SendReplyCallback send_reply_callback) override;
+
   /// Implements gRPC server handler.
   void HandleWaitForActorOutOfScope(rpc::WaitForActorOutOfScopeRequest request,
                                     rpc::WaitForActorOutOfScopeReply *reply,
@@ -1239,6 +1254,37 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
                             std::shared_ptr<RayObject> obj,
                             rpc::GetObjectStatusReply *reply);
 
+  /// A GetObjectStatuses request that is waiting for some of its objects to
+  /// be created.
+  struct PendingObjectStatusesRequest {
+    PendingObjectStatusesRequest(rpc::GetObjectStatusesReply *reply,
+                                 rpc::SendReplyCallback send_reply_callback,
+                                 size_t num_pending)
+        : reply(reply),
+          send_reply_callback(std::move(send_reply_callback)),
+          num_pending(num_pending) {}
+    rpc::GetObjectStatusesReply *reply;
+    rpc::SendReplyCallback send_reply_callback;
+    /// The number of requested objects whose status is not in the reply yet.
+    size_t num_pending;
+    /// Whether the reply is scheduled to be sent after
+    /// object_status_batch_wait_ms.
+    bool reply_scheduled = false;
+    bool replied = false;
+  };
+
+  /// Add the status of an object that has been created to the
+  /// GetObjectStatuses requests that are waiting for it. A request is replied
+  /// to once all of its objects are created, or object_status_batch_wait_ms
+  /// after the first of them is.
+  void OnObjectStatusReady(const ObjectID &object_id, std::shared_ptr<RayObject> obj);
+
+  /// Reply to a GetObjectStatuses request after object_status_batch_wait_ms,
+  /// with the status of the objects that are created by then. If the wait is
+  /// 0, reply right away.
+  void ScheduleObjectStatusesReply(
+      const std::shared_ptr<PendingObjectStatusesRequest> &pending);
+
   ///
   /// Private methods related to task submission.
   ///
@@ -1593,6 +1639,17 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
   absl::flat_hash_map<ObjectID, std::vector<std::function<void(void)>>>
       async_plasma_callbacks_ GUARDED_BY(plasma_mutex_);
 
+  // Guard for `object_status_waiters_` and the requests and replies in it.
+  absl::Mutex object_status_mutex_;
+
+  /// The GetObjectStatuses requests that are waiting for each object. An
+  /// object is in this map iff its value has been requested from the memory
+  /// store, so that a caller that asks again for the same object does not
+  /// register another callback.
+  absl::flat_hash_map<ObjectID,
+                      std::vector<std::shared_ptr<PendingObjectStatusesRequest>>>
+      object_status_waiters_ GUARDED_BY(object_status_mutex_);
+
   // Fallback for when GetAsync cannot directly get the requested object.
   void PlasmaCallback(SetResultCallback success,
                       std::shared_ptr<RayObject> ray_object,
@@ -16,7 +16,9 @@
 
 #include <boost/fiber/all.hpp>
 #include <chrono>
+#include <deque>
 
+#include "ray/common/ray_config.h"
 #include "ray/util/logging.h"
 namespace ray {
 namespace core {
@@ -48,38 +50,6 @@ class FiberEvent {
   bool ready_ = false;
 };
 
-/// Used by async actor mode. The FiberRateLimiter is a barrier that
-/// allows at most num fibers running at once. It implements the
-/// semaphore data structure.
-class FiberRateLimiter {
- public:
-  FiberRateLimiter(int num) : num_(num) {}
-
-  // Enter the semaphore. Wait for the value to be > 0 and decrement the value.
-  void Acquire() {
-    std::unique_lock<boost::fibers::mutex> lock(mutex_);
-    cond_.wait(lock, [this]() { return num_ > 0; });
-    num_ -= 1;
-  }
-
-  // Exit the semaphore. Increment the value and notify other waiter.
-  void Release() {
-    {
-      std::unique_lock<boost::fibers::mutex> lock(mutex_);
-      num_ += 1;
-    }
-    // NOTE(simon): This not does guarantee to wake up the first queued fiber.
-    // This could be a problem for certain workloads because there is no guarantee
-    // on task ordering.
-    cond_.notify_one();
-  }
-
- private:
-  boost::fibers::condition_variable cond_;
-  boost::fibers::mutex mutex_;
-  int num_ = 1;
-};
-
 using FiberChannel = boost::fibers::unbuffered_channel<std::function<void()>>;
 
 class FiberState {
@@ -90,7 +60,9 @@ class FiberState {
     return true;
   }
 
-  FiberState(int max_concurrency) : rate_limiter_(max_concurrency) {
+  FiberState(int max_concurrency)
+      : max_concurrency_(max_concurrency),
+        stack_size_(RayConfig::instance().async_actor_fiber_stack_size()) {
     fiber_runner_thread_ =
         std::thread(
             [&]() {
@@ -98,7 +70,14 @@ class FiberState {
                 std::function<void()> func;
                 auto op_status = channel_.pop(func);
                 if (op_status == boost::fibers::channel_op_status::success) {
-                  boost::fibers::fiber(boost::fibers::launch::dispatch, func).detach();
+                  if (num_running_fibers_ < max_concurrency_) {
+                    num_running_fibers_++;
+                    LaunchFiber(std::move(func));
+                  } else {
+                    // The call doesn't get a fiber, and so a stack, until a
+                    // running fiber picks it up, see RunCalls.
+                    queued_calls_.push_back(std::move(func));
+                  }
                 } else if (op_status == boost::fibers::channel_op_status::closed) {
                   // The channel was closed. We will just exit the loop and finish
                   // cleanup.
@@ -132,11 +111,7 @@ class FiberState {
   }
 
   void EnqueueFiber(std::function<void()> &&callback) {
-    auto op_status = channel_.push([this, callback]() {
-      rate_limiter_.Acquire();
-      callback();
-      rate_limiter_.Release();
-    });
+    auto op_status = channel_.push(std::move(callback));
     RAY_CHECK(op_status == boost::fibers::channel_op_status::success);
   }
 
@@ -148,12 +123,49 @@ class FiberState {
   }
 
  private:
+  void LaunchFiber(std::function<void()> &&func) {
+    auto run_calls = [this, func = std::move(func)]() mutable {
+      RunCalls(std::move(func));
+    };
+    if (stack_size_ > 0) {
+      boost::fibers::fiber(boost::fibers::launch::dispatch,
+                           std::allocator_arg,
+                           boost::fibers::fixedsize_stack(stack_size_),
+                           std::move(run_calls))
+          .detach();
+    } else {
+      boost::fibers::fiber(boost::fibers::launch::dispatch, std::move(run_calls))
+          .detach();
+    }
+  }
+
+  /// Run the call, and then the queued calls in order until there are none left,
+  /// on the stack of the current fiber. All fibers run on fiber_runner_thread_,
+  /// so the queue is only accessed by one thread.
+  void RunCalls(std::function<void()> func) {
+    while (true) {
+      func();
+      if (queued_calls_.empty()) {
+        num_running_fibers_--;
+        return;
+      }
+      func = std::move(queued_calls_.front());
+      queued_calls_.pop_front();
+    }
+  }
+
   /// The fiber channel used to send task between the submitter thread
   /// (main direct_actor_trasnport thread) and the fiber_runner_thread_ (defined below)
   FiberChannel channel_;
-  /// The fiber semaphore used to limit the number of concurrent fibers
-  /// running at once.
-  FiberRateLimiter rate_limiter_;
+  /// The max number of fibers running at once.
+  const int max_concurrency_;
+  /// The stack size of each fiber, or 0 for the default size.
+  const size_t stack_size_;
+  /// The number of fibers running calls. Only accessed by fiber_runner_thread_.
+  int num_running_fibers_ = 0;
+  /// The calls that wait for a running fiber to pick them up. Only accessed by
+  /// fiber_runner_thread_.
+  std::deque<std::function<void()>> queued_calls_;
   /// The fiber event used to notify that all worker fibers are stopped running.
   FiberEvent fiber_stopped_event_;
   /// The thread that runs all asyncio fibers. is_asyncio_ must be true.
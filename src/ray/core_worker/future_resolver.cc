@@ -14,6 +14,9 @@
 
 #include "ray/core_worker/future_resolver.h"
 
+#include "absl/container/flat_hash_set.h"
+#include "ray/common/ray_config.h"
+
 namespace ray {
 namespace core {
 
@@ -24,6 +27,10 @@ void FutureResolver::ResolveFutureAsync(const ObjectID &object_id,
     // with a borrowed reference executes on the object's owning worker.
     return;
   }
+  if (RayConfig::instance().object_status_batch_max_size() > 0) {
+    QueueFutures(owner_address, {object_id});
+    return;
+  }
   auto conn = owner_clients_->GetOrConnect(owner_address);
 
   rpc::GetObjectStatusRequest request;
@@ -37,6 +44,93 @@ void FutureResolver::ResolveFutureAsync(const ObjectID &object_id,
       });
 }
 
+void FutureResolver::QueueFutures(const rpc::Address &owner_address,
+                                  std::vector<ObjectID> object_ids) {
+  const auto owner_id = WorkerID::FromBinary(owner_address.worker_id());
+  bool schedule_flush = false;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = queued_futures_.find(owner_id);
+    if (it == queued_futures_.end()) {
+      queued_futures_.emplace(owner_id,
+                              OwnerFutures{owner_address, std::move(object_ids)});
+      schedule_flush = true;
+    } else {
+      auto &queued = it->second.object_ids;
+      queued.insert(queued.end(), object_ids.begin(), object_ids.end());
+    }
+  }
+  if (schedule_flush) {
+    io_service_.post([this, owner_id]() { FlushFutures(owner_id); },
+                     "FutureResolver.FlushFutures");
+  }
+}
+
+void FutureResolver::FlushFutures(const WorkerID &owner_id) {
+  OwnerFutures futures;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = queued_futures_.find(owner_id);
+    RAY_CHECK(it != queued_futures_.end());
+    futures = std::move(it->second);
+    queued_futures_.erase(it);
+  }
+
+  const auto &owner_address = futures.owner_address;
+  auto conn = owner_clients_->GetOrConnect(owner_address);
+  const size_t batch_size = RayConfig::instance().object_status_batch_max_size();
+  for (size_t start = 0; start < futures.object_ids.size(); start += batch_size) {
+    const size_t end = std::min(start + batch_size, futures.object_ids.size());
+    std::vector<ObjectID> object_ids(futures.object_ids.begin() + start,
+                                     futures.object_ids.begin() + end);
+    rpc::GetObjectStatusesRequest request;
+    request.set_owner_worker_id(owner_address.worker_id());
+    for (const auto &object_id : object_ids) {
+      request.add_object_ids(object_id.Binary());
+    }
+    RAY_LOG(DEBUG) << "Requesting the status of " << object_ids.size()
+                   << " objects from owner " << owner_id;
+    conn->GetObjectStatuses(
+        request,
+        [this, object_ids = std::move(object_ids), owner_address](
+            const Status &status, const rpc::GetObjectStatusesReply &reply) {
+          ProcessResolvedObjects(object_ids, owner_address, status, reply);
+        });
+  }
+}
+
+void FutureResolver::ProcessResolvedObjects(const std::vector<ObjectID> &object_ids,
+                                            const rpc::Address &owner_address,
+                                            const Status &status,
+                                            const rpc::GetObjectStatusesReply &reply) {
+  if (!status.ok()) {
+    for (const auto &object_id : object_ids) {
+      ProcessResolvedObject(
+          object_id, owner_address, status, rpc::GetObjectStatusReply());
+    }
+    return;
+  }
+
+  RAY_CHECK(reply.object_ids_size() == reply.statuses_size());
+  absl::flat_hash_set<ObjectID> resolved;
+  for (int i = 0; i < reply.object_ids_size(); i++) {
+    const auto object_id = ObjectID::FromBinary(reply.object_ids(i));
+    resolved.insert(object_id);
+    ProcessResolvedObject(object_id, owner_address, status, reply.statuses(i));
+  }
+  // The owner replies shortly after it knows the status of any of the objects,
+  // so ask again for the rest, together with any futures queued in the meantime.
+  std::vector<ObjectID> unresolved;
+  for (const auto &object_id : object_ids) {
+    if (!resolved.contains(object_id)) {
+      unresolved.push_back(object_id);
+    }
+  }
+  if (!unresolved.empty()) {
+    QueueFutures(owner_address, std::move(unresolved));
+  }
+}
+
 void FutureResolver::ProcessResolvedObject(const ObjectID &object_id,
                                            const rpc::Address &owner_address,
                                            const Status &status,
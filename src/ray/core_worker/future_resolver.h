@@ -15,7 +15,11 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/grpc_util.h"
 #include "ray/common/id.h"
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
@@ -37,18 +41,24 @@ class FutureResolver {
                  std::shared_ptr<ReferenceCounter> ref_counter,
                  ReportLocalityDataCallback report_locality_data_callback,
                  std::shared_ptr<rpc::CoreWorkerClientPool> core_worker_client_pool,
-                 const rpc::Address &rpc_address)
+                 const rpc::Address &rpc_address,
+                 instrumented_io_context &io_service)
       : in_memory_store_(store),
         reference_counter_(ref_counter),
         report_locality_data_callback_(std::move(report_locality_data_callback)),
         owner_clients_(core_worker_client_pool),
-        rpc_address_(rpc_address) {}
+        rpc_address_(rpc_address),
+        io_service_(io_service) {}
 
   /// Resolve the value for a future. This will periodically contact the given
   /// owner until the owner dies or the owner has finished creating the object.
   /// In either case, this will put an OBJECT_IN_PLASMA error as the future's
   /// value.
   ///
+  /// Futures with the same owner that are resolved around the same time are
+  /// batched into one GetObjectStatuses request, see
+  /// object_status_batch_max_size.
+  ///
   /// \param[in] object_id The ID of the future to resolve.
   /// \param[in] owner_address The address of the task or actor that owns the
   /// future.
@@ -66,6 +76,27 @@ class FutureResolver {
                              const rpc::GetObjectStatusReply &object_status);
 
  private:
+  /// The futures with the same owner whose status has not been requested yet.
+  struct OwnerFutures {
+    rpc::Address owner_address;
+    std::vector<ObjectID> object_ids;
+  };
+
+  /// Queue futures to be resolved by their owner. The queued futures are sent
+  /// to the owner in a batch from the event loop, so that the futures that are
+  /// resolved until then share the request.
+  void QueueFutures(const rpc::Address &owner_address, std::vector<ObjectID> object_ids);
+
+  /// Send the status requests for all queued futures of an owner.
+  void FlushFutures(const WorkerID &owner_id);
+
+  /// Process a reply to a GetObjectStatuses request, and queue the futures
+  /// that the owner did not report the status of yet.
+  void ProcessResolvedObjects(const std::vector<ObjectID> &object_ids,
+                              const rpc::Address &owner_address,
+                              const Status &status,
+                              const rpc::GetObjectStatusesReply &reply);
+
   /// Used to store values of resolved futures.
   std::shared_ptr<CoreWorkerMemoryStore> in_memory_store_;
 
@@ -82,6 +113,15 @@ class FutureResolver {
   /// address, so the owner can contact us to ask when our reference to the
   /// object has gone out of scope.
   const rpc::Address rpc_address_;
+
+  /// Used to send batched status requests.
+  instrumented_io_context &io_service_;
+
+  absl::Mutex mu_;
+
+  /// The futures to request the status of, keyed by owner. An owner has an
+  /// entry iff a flush is scheduled for it.
+  absl::flat_hash_map<WorkerID, OwnerFutures> queued_futures_ GUARDED_BY(mu_);
 };
 
 }  // namespace core
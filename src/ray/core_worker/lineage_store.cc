@@ -0,0 +1,203 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/lineage_store.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "ray/util/filesystem.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace core {
+
+LineageStore::LineageStore(std::string directory,
+                           std::string file_prefix,
+                           int64_t max_bytes,
+                           int64_t segment_bytes)
+    : directory_(std::move(directory)),
+      file_prefix_(std::move(file_prefix)),
+      max_bytes_(max_bytes),
+      segment_bytes_(segment_bytes) {
+  RAY_CHECK(segment_bytes_ > 0);
+}
+
+LineageStore::~LineageStore() {
+  absl::MutexLock lock(&mu_);
+  while (!segments_.empty()) {
+    RemoveSegment(segments_.begin()->first);
+  }
+}
+
+bool LineageStore::Put(const TaskID &task_id, const std::string &data) {
+  absl::MutexLock lock(&mu_);
+  RAY_CHECK(!index_.contains(task_id)) << "Lineage for task " << task_id
+                                       << " is already spilled";
+  const int64_t size = data.size();
+  if (num_bytes_ + size > max_bytes_) {
+    return false;
+  }
+  ReclaimSegmentsInternal();
+  if (!Append(task_id, data)) {
+    return false;
+  }
+  num_bytes_ += size;
+  return true;
+}
+
+bool LineageStore::Get(const TaskID &task_id, std::string *data) const {
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(task_id);
+  if (it == index_.end()) {
+    return false;
+  }
+  return Read(it->second, data);
+}
+
+void LineageStore::Delete(const TaskID &task_id) {
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(task_id);
+  if (it == index_.end()) {
+    return;
+  }
+  const Record record = it->second;
+  index_.erase(it);
+  num_bytes_ -= record.size;
+
+  auto segment_it = segments_.find(record.segment_id);
+  RAY_CHECK(segment_it != segments_.end());
+  auto &segment = segment_it->second;
+  segment.task_ids.erase(task_id);
+  segment.live_bytes -= record.size;
+}
+
+void LineageStore::ReclaimSegments() {
+  absl::MutexLock lock(&mu_);
+  ReclaimSegmentsInternal();
+}
+
+void LineageStore::ReclaimSegmentsInternal() {
+  if (segments_.empty()) {
+    return;
+  }
+  // Never reclaim the active segment, it is still being appended to. Copy the
+  // IDs of the sealed segments, since compaction may start new segments.
+  std::vector<uint64_t> sealed_segment_ids;
+  for (const auto &entry : segments_) {
+    if (entry.first != segments_.rbegin()->first) {
+      sealed_segment_ids.push_back(entry.first);
+    }
+  }
+  for (const auto segment_id : sealed_segment_ids) {
+    const auto &segment = segments_.at(segment_id);
+    if (segment.task_ids.empty()) {
+      RemoveSegment(segment_id);
+    } else if (segment.live_bytes * 2 < segment.size) {
+      CompactSegment(segment_id);
+    }
+  }
+}
+
+bool LineageStore::Append(const TaskID &task_id, const std::string &data) {
+  const int64_t size = data.size();
+  if (segments_.empty() || (segments_.rbegin()->second.size > 0 &&
+                            segments_.rbegin()->second.size + size > segment_bytes_)) {
+    if (!OpenSegment()) {
+      return false;
+    }
+  }
+  const uint64_t segment_id = segments_.rbegin()->first;
+  auto &segment = segments_.rbegin()->second;
+  segment.file->seekp(segment.size);
+  segment.file->write(data.data(), size);
+  if (!segment.file->good()) {
+    RAY_LOG(WARNING) << "Failed to write " << size << " bytes of lineage to "
+                     << segment.path;
+    segment.file->clear();
+    return false;
+  }
+
+  index_[task_id] = Record{segment_id, segment.size, size};
+  segment.task_ids.insert(task_id);
+  segment.size += size;
+  segment.live_bytes += size;
+  num_file_bytes_ += size;
+  return true;
+}
+
+bool LineageStore::Read(const Record &record, std::string *data) const {
+  const auto &segment = segments_.at(record.segment_id);
+  data->resize(record.size);
+  segment.file->seekg(record.offset);
+  segment.file->read(&(*data)[0], record.size);
+  if (segment.file->gcount() != record.size) {
+    RAY_LOG(ERROR) << "Failed to read " << record.size << " bytes of lineage from "
+                   << segment.path;
+    segment.file->clear();
+    return false;
+  }
+  return true;
+}
+
+bool LineageStore::OpenSegment() {
+  const uint64_t segment_id = next_segment_id_++;
+  Segment segment;
+  segment.path =
+      JoinPaths(directory_, "lineage_" + file_prefix_ + "_" + std::to_string(segment_id));
+  segment.file = std::make_unique<std::fstream>(
+      segment.path,
+      std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!segment.file->is_open()) {
+    RAY_LOG(WARNING) << "Failed to open lineage segment " << segment.path;
+    return false;
+  }
+  RAY_LOG(DEBUG) << "Opened lineage segment " << segment.path;
+  segments_.emplace(segment_id, std::move(segment));
+  return true;
+}
+
+void LineageStore::CompactSegment(uint64_t segment_id) {
+  auto &segment = segments_.at(segment_id);
+  RAY_LOG(DEBUG) << "Compacting lineage segment " << segment.path << ", "
+                 << segment.live_bytes << " of " << segment.size << " bytes are live";
+  // Copy the IDs, since they are erased from the segment as they are moved.
+  const std::vector<TaskID> task_ids(segment.task_ids.begin(), segment.task_ids.end());
+  std::string data;
+  for (const auto &task_id : task_ids) {
+    const Record record = index_.at(task_id);
+    if (!Read(record, &data) || !Append(task_id, data)) {
+      // Leave the rest of the segment in place. It will be compacted again the
+      // next time one of its records is deleted.
+      return;
+    }
+    segment.task_ids.erase(task_id);
+    segment.live_bytes -= record.size;
+  }
+  RemoveSegment(segment_id);
+}
+
+void LineageStore::RemoveSegment(uint64_t segment_id) {
+  auto it = segments_.find(segment_id);
+  RAY_CHECK(it != segments_.end());
+  it->second.file->close();
+  if (std::remove(it->second.path.c_str()) != 0) {
+    RAY_LOG(WARNING) << "Failed to delete lineage segment " << it->second.path;
+  }
+  num_file_bytes_ -= it->second.size;
+  segments_.erase(it);
+}
+
+}  // namespace core
+}  // namespace ray
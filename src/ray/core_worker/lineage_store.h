@@ -0,0 +1,176 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/id.h"
+
+namespace ray {
+namespace core {
+
+/// An on-disk store for the serialized specs of tasks that are only kept as
+/// lineage. The owner only needs these specs if it has to reconstruct a lost
+/// object, so they can be kept on local disk instead of in memory.
+///
+/// Specs are appended to a log that is split into fixed-size segments, and an
+/// in-memory index maps each task to its record. Only the owner process reads
+/// the log, and the lineage is lost anyway if the owner dies, so the files are
+/// deleted when the store is destroyed and nothing is recovered on startup.
+///
+/// Deleted records are reclaimed incrementally: once less than half of a
+/// sealed segment is live, its live records are copied to the end of the log
+/// and the segment file is deleted. Deleting a record only updates the index,
+/// the segments are reclaimed on the next Put, so that callers can delete
+/// records without doing disk I/O.
+///
+/// This class is thread-safe.
+class LineageStore {
+ public:
+  /// Create a lineage store.
+  ///
+  /// \param directory The directory to write the log segments to.
+  /// \param file_prefix A prefix for the segment file names. This should be
+  /// unique per process, e.g., the worker ID.
+  /// \param max_bytes The maximum number of live bytes to store.
+  /// \param segment_bytes The size at which a segment is sealed and a new one
+  /// is started.
+  LineageStore(std::string directory,
+               std::string file_prefix,
+               int64_t max_bytes,
+               int64_t segment_bytes = 64 * 1024 * 1024);
+
+  ~LineageStore();
+
+  /// Append a task spec to the log.
+  ///
+  /// \param task_id The ID of the task. This must not already be in the store.
+  /// \param data The serialized task spec.
+  /// \return Whether the spec was stored. This is false if the store is full
+  /// or the write failed.
+  bool Put(const TaskID &task_id, const std::string &data);
+
+  /// Read a task spec from the log.
+  ///
+  /// \param task_id The ID of the task.
+  /// \param[out] data The serialized task spec.
+  /// \return Whether the spec was found and read.
+  bool Get(const TaskID &task_id, std::string *data) const;
+
+  /// Delete a task spec. This is a no-op if the task is not in the store.
+  /// This does not touch the segment files.
+  void Delete(const TaskID &task_id);
+
+  /// Delete the sealed segments that have no live records, and compact the
+  /// ones that are less than half live. This is called by Put.
+  void ReclaimSegments();
+
+  /// Return whether the store has a spec for the task.
+  bool Contains(const TaskID &task_id) const {
+    absl::MutexLock lock(&mu_);
+    return index_.contains(task_id);
+  }
+
+  /// Return the number of specs in the store.
+  size_t NumEntries() const {
+    absl::MutexLock lock(&mu_);
+    return index_.size();
+  }
+
+  /// Return the number of bytes of specs in the store.
+  int64_t NumBytes() const {
+    absl::MutexLock lock(&mu_);
+    return num_bytes_;
+  }
+
+  /// Return the size of all segment files, including deleted records that
+  /// have not been reclaimed yet.
+  int64_t NumFileBytes() const {
+    absl::MutexLock lock(&mu_);
+    return num_file_bytes_;
+  }
+
+  /// Return the number of segment files.
+  size_t NumSegments() const {
+    absl::MutexLock lock(&mu_);
+    return segments_.size();
+  }
+
+ private:
+  struct Segment {
+    std::string path;
+    std::unique_ptr<std::fstream> file;
+    /// The end of the segment. Records are appended here.
+    int64_t size = 0;
+    /// The number of bytes of records that have not been deleted.
+    int64_t live_bytes = 0;
+    /// The tasks whose records are in this segment.
+    absl::flat_hash_set<TaskID> task_ids;
+  };
+
+  struct Record {
+    uint64_t segment_id;
+    int64_t offset;
+    int64_t size;
+  };
+
+  /// Append a record to the active segment, starting a new segment first if
+  /// the active one is full.
+  bool Append(const TaskID &task_id, const std::string &data)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Read a record from its segment.
+  bool Read(const Record &record, std::string *data) const EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Start a new active segment.
+  bool OpenSegment() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Reclaim the sealed segments, see ReclaimSegments.
+  void ReclaimSegmentsInternal() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Copy the live records of a sealed segment to the active segment and
+  /// delete the segment.
+  void CompactSegment(uint64_t segment_id) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Close and delete the file of a segment.
+  void RemoveSegment(uint64_t segment_id) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::string directory_;
+  const std::string file_prefix_;
+  const int64_t max_bytes_;
+  const int64_t segment_bytes_;
+
+  /// Protects all fields below. This is also held while reading and writing
+  /// the segment files, since their file positions are shared.
+  mutable absl::Mutex mu_;
+  /// The segments ordered by ID. The last one is the active segment.
+  std::map<uint64_t, Segment> segments_ GUARDED_BY(mu_);
+  /// The ID to use for the next segment.
+  uint64_t next_segment_id_ GUARDED_BY(mu_) = 0;
+  /// The location of each task's record.
+  absl::flat_hash_map<TaskID, Record> index_ GUARDED_BY(mu_);
+  int64_t num_bytes_ GUARDED_BY(mu_) = 0;
+  int64_t num_file_bytes_ GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace core
+}  // namespace ray
@@ -14,12 +14,30 @@
 
 #include "ray/core_worker/object_recovery_manager.h"
 
+#include "ray/common/ray_config.h"
 #include "ray/util/util.h"
 
 namespace ray {
 namespace core {
 
 bool ObjectRecoveryManager::RecoverObject(const ObjectID &object_id) {
+  bool started = false;
+  if (!StartRecovery(object_id, &started)) {
+    return false;
+  }
+  if (started) {
+    // Lookup the object in the GCS to find another copy.
+    RAY_CHECK_OK(object_lookup_(
+        object_id,
+        [this](const ObjectID &object_id, const std::vector<rpc::Address> &locations) {
+          PinOrReconstructObject(object_id, locations);
+        }));
+  }
+  return true;
+}
+
+bool ObjectRecoveryManager::StartRecovery(const ObjectID &object_id, bool *started) {
+  *started = false;
   if (object_id.TaskId().IsForActorCreationTask()) {
     // The GCS manages all actor restarts, so we should never try to
     // reconstruct an actor here.
@@ -61,12 +79,7 @@ bool ObjectRecoveryManager::RecoverObject(const ObjectID &object_id) {
           RAY_CHECK(objects_pending_recovery_.erase(object_id)) << object_id;
           RAY_LOG(INFO) << "Recovery complete for object " << object_id;
         });
-    // Lookup the object in the GCS to find another copy.
-    RAY_CHECK_OK(object_lookup_(
-        object_id,
-        [this](const ObjectID &object_id, const std::vector<rpc::Address> &locations) {
-          PinOrReconstructObject(object_id, locations);
-        }));
+    *started = true;
   } else if (requires_recovery) {
     RAY_LOG(DEBUG) << "Recovery already started for object " << object_id;
   } else {
@@ -76,6 +89,339 @@ bool ObjectRecoveryManager::RecoverObject(const ObjectID &object_id) {
   return true;
 }
 
+void ObjectRecoveryManager::RecoverObjects(const std::vector<ObjectID> &object_ids) {
+  if (!RayConfig::instance().object_recovery_bulk_mode()) {
+    for (const auto &object_id : object_ids) {
+      RAY_UNUSED(RecoverObject(object_id));
+    }
+    return;
+  }
+
+  std::vector<ObjectID> started_object_ids;
+  for (const auto &object_id : object_ids) {
+    bool started = false;
+    if (StartRecovery(object_id, &started) && started) {
+      started_object_ids.push_back(object_id);
+    }
+  }
+  if (started_object_ids.empty()) {
+    return;
+  }
+  RAY_LOG(INFO) << "Starting bulk recovery for " << started_object_ids.size()
+                << " lost objects";
+  LookupObjectsInPlan(std::make_shared<RecoveryPlan>(), started_object_ids);
+}
+
+void ObjectRecoveryManager::LookupObjectsInPlan(const std::shared_ptr<RecoveryPlan> &plan,
+                                                const std::vector<ObjectID> &object_ids) {
+  if (object_ids.empty()) {
+    return;
+  }
+  auto batch = std::make_shared<LookupBatch>();
+  batch->num_pending = object_ids.size();
+  {
+    absl::MutexLock lock(&mu_);
+    for (const auto &object_id : object_ids) {
+      plan->queued_lookups.emplace_back(object_id, batch);
+    }
+  }
+  IssueQueuedLookups(plan);
+}
+
+void ObjectRecoveryManager::IssueQueuedLookups(
+    const std::shared_ptr<RecoveryPlan> &plan) {
+  const int64_t max_inflight_lookups =
+      RayConfig::instance().object_recovery_max_inflight_lookups();
+  {
+    absl::MutexLock lock(&mu_);
+    if (plan->issuing_lookups) {
+      return;
+    }
+    plan->issuing_lookups = true;
+  }
+  while (true) {
+    std::shared_ptr<LookupBatch> batch;
+    ObjectID object_id;
+    {
+      absl::MutexLock lock(&mu_);
+      if (plan->queued_lookups.empty() ||
+          plan->num_inflight_lookups >= max_inflight_lookups) {
+        plan->issuing_lookups = false;
+        return;
+      }
+      object_id = plan->queued_lookups.front().first;
+      batch = std::move(plan->queued_lookups.front().second);
+      plan->queued_lookups.pop_front();
+      plan->num_inflight_lookups++;
+    }
+
+    RAY_CHECK_OK(object_lookup_(
+        object_id,
+        [this, plan, batch](const ObjectID &object_id,
+                            const std::vector<rpc::Address> &locations) {
+          bool batch_done = false;
+          {
+            absl::MutexLock lock(&mu_);
+            plan->num_inflight_lookups--;
+            if (locations.empty()) {
+              batch->objects_to_reconstruct.push_back(object_id);
+            } else {
+              plan->other_locations[object_id] = locations;
+              batch->objects_to_pin.push_back(object_id);
+            }
+            batch_done = --batch->num_pending == 0;
+          }
+          IssueQueuedLookups(plan);
+          if (batch_done) {
+            PinObjectsInPlan(plan, batch->objects_to_pin);
+            ReconstructObjectsInPlan(plan, batch->objects_to_reconstruct);
+          }
+        }));
+  }
+}
+
+void ObjectRecoveryManager::PinObjectsInPlan(const std::shared_ptr<RecoveryPlan> &plan,
+                                             const std::vector<ObjectID> &object_ids) {
+  // Try the next location of each object, with one request per node.
+  absl::flat_hash_map<NodeID, std::pair<rpc::Address, std::vector<ObjectID>>> requests;
+  {
+    absl::MutexLock lock(&mu_);
+    for (const auto &object_id : object_ids) {
+      auto &locations = plan->other_locations[object_id];
+      RAY_CHECK(!locations.empty());
+      auto &request = requests[NodeID::FromBinary(locations.back().raylet_id())];
+      request.first = locations.back();
+      request.second.push_back(object_id);
+      locations.pop_back();
+    }
+  }
+
+  for (auto &entry : requests) {
+    const auto node_id = entry.first;
+    auto &object_ids_at_node = entry.second.second;
+    RAY_LOG(DEBUG) << "Trying to pin copies of " << object_ids_at_node.size()
+                   << " lost objects at node " << node_id;
+    GetPinningClient(entry.second.first)
+        ->PinObjectIDs(
+            rpc_address_,
+            object_ids_at_node,
+            /*generator_id=*/ObjectID::Nil(),
+            [this, plan, node_id, object_ids = object_ids_at_node](
+                const Status &status, const rpc::PinObjectIDsReply &reply) {
+              std::vector<ObjectID> pinned;
+              std::vector<ObjectID> objects_to_retry;
+              std::vector<ObjectID> objects_to_reconstruct;
+              {
+                absl::MutexLock lock(&mu_);
+                for (size_t i = 0; i < object_ids.size(); i++) {
+                  auto it = plan->other_locations.find(object_ids[i]);
+                  if (status.ok() && static_cast<int>(i) < reply.successes_size() &&
+                      reply.successes(i)) {
+                    pinned.push_back(object_ids[i]);
+                  } else if (!it->second.empty()) {
+                    objects_to_retry.push_back(object_ids[i]);
+                    continue;
+                  } else {
+                    objects_to_reconstruct.push_back(object_ids[i]);
+                  }
+                  plan->other_locations.erase(it);
+                }
+              }
+              for (const auto &object_id : pinned) {
+                RAY_CHECK(in_memory_store_->Put(
+                    RayObject(rpc::ErrorType::OBJECT_IN_PLASMA), object_id));
+                reference_counter_->UpdateObjectPinnedAtRaylet(object_id, node_id);
+              }
+              if (pinned.size() < object_ids.size()) {
+                RAY_LOG(INFO) << "Error pinning new copies of "
+                              << object_ids.size() - pinned.size()
+                              << " lost objects at node " << node_id
+                              << ", trying again";
+              }
+              if (!objects_to_retry.empty()) {
+                PinObjectsInPlan(plan, objects_to_retry);
+              }
+              ReconstructObjectsInPlan(plan, objects_to_reconstruct);
+            });
+  }
+}
+
+void ObjectRecoveryManager::ReconstructObjectsInPlan(
+    const std::shared_ptr<RecoveryPlan> &plan, const std::vector<ObjectID> &object_ids) {
+  std::vector<ObjectID> dependencies_to_look_up;
+  for (const auto &object_id : object_ids) {
+    bool lineage_evicted = false;
+    if (!reference_counter_->IsObjectReconstructable(object_id, &lineage_evicted)) {
+      RAY_LOG(DEBUG) << "Object " << object_id << " is not reconstructable";
+      recovery_failure_callback_(
+          object_id,
+          lineage_evicted ? rpc::ErrorType::OBJECT_UNRECONSTRUCTABLE_LINEAGE_EVICTED
+                          : rpc::ErrorType::OBJECT_LOST,
+          /*pin_object=*/true);
+      continue;
+    }
+
+    // Lost objects that were returned by the same task are recovered by
+    // resubmitting the task once.
+    const auto task_id = object_id.TaskId();
+    bool already_planned = false;
+    bool already_finished = false;
+    {
+      absl::MutexLock lock(&mu_);
+      auto it = plan->tasks.find(task_id);
+      if (it != plan->tasks.end()) {
+        it->second.lost_objects.push_back(object_id);
+        already_planned = true;
+        already_finished = it->second.finished;
+      }
+    }
+    if (already_finished) {
+      // The object was lost again after its resubmitted task finished.
+      ReconstructObject(object_id);
+      continue;
+    } else if (already_planned) {
+      continue;
+    }
+
+    std::vector<ObjectID> task_deps;
+    if (!task_resubmitter_->GetTaskDependencies(task_id, &task_deps)) {
+      RAY_LOG(INFO) << "Failed to reconstruct object " << object_id
+                    << " because lineage has already been deleted";
+      recovery_failure_callback_(
+          object_id,
+          rpc::ErrorType::OBJECT_UNRECONSTRUCTABLE_MAX_ATTEMPTS_EXCEEDED,
+          /*pin_object=*/true);
+      continue;
+    }
+
+    // Start recovering the lost dependencies of the task. The task is only
+    // resubmitted once they are recovered.
+    std::vector<ObjectID> pending_deps;
+    for (const auto &dep : task_deps) {
+      bool started = false;
+      if (!StartRecovery(dep, &started)) {
+        RAY_LOG(INFO) << "Failed to reconstruct object " << dep;
+        // We do not pin the dependency because we may not be the owner.
+        recovery_failure_callback_(dep,
+                                   rpc::ErrorType::OBJECT_UNRECONSTRUCTABLE,
+                                   /*pin_object=*/false);
+        continue;
+      }
+      if (started) {
+        dependencies_to_look_up.push_back(dep);
+      }
+      absl::MutexLock lock(&mu_);
+      if (objects_pending_recovery_.contains(dep)) {
+        pending_deps.push_back(dep);
+      }
+    }
+
+    {
+      absl::MutexLock lock(&mu_);
+      auto inserted = plan->tasks.emplace(task_id, PlannedTask());
+      inserted.first->second.lost_objects.push_back(object_id);
+      if (!inserted.second) {
+        // The task was added to the plan concurrently.
+        continue;
+      }
+      // Hold one count until the callbacks for the dependencies are registered.
+      inserted.first->second.num_pending_deps = pending_deps.size() + 1;
+    }
+    for (const auto &dep : pending_deps) {
+      in_memory_store_->GetAsync(dep,
+                                 [this, plan, task_id](std::shared_ptr<RayObject> obj) {
+                                   OnPlannedTaskDependencyReady(plan, task_id);
+                                 });
+    }
+    OnPlannedTaskDependencyReady(plan, task_id);
+  }
+  LookupObjectsInPlan(plan, dependencies_to_look_up);
+}
+
+void ObjectRecoveryManager::OnPlannedTaskDependencyReady(
+    const std::shared_ptr<RecoveryPlan> &plan, const TaskID &task_id) {
+  {
+    absl::MutexLock lock(&mu_);
+    auto &task = plan->tasks[task_id];
+    if (--task.num_pending_deps > 0) {
+      return;
+    }
+    plan->ready_tasks.push_back(task_id);
+  }
+  ResubmitReadyTasks(plan);
+}
+
+void ObjectRecoveryManager::ResubmitReadyTasks(
+    const std::shared_ptr<RecoveryPlan> &plan) {
+  const int64_t max_inflight_tasks =
+      RayConfig::instance().object_recovery_max_inflight_tasks();
+  while (true) {
+    TaskID task_id;
+    std::vector<ObjectID> lost_objects;
+    {
+      absl::MutexLock lock(&mu_);
+      if (plan->ready_tasks.empty() || plan->num_inflight_tasks >= max_inflight_tasks) {
+        return;
+      }
+      task_id = plan->ready_tasks.front();
+      plan->ready_tasks.pop_front();
+      auto &task = plan->tasks[task_id];
+      task.resubmitted = true;
+      lost_objects = task.lost_objects;
+      plan->num_inflight_tasks++;
+    }
+
+    RAY_LOG(DEBUG) << "Attempting to reconstruct " << lost_objects.size()
+                   << " objects of task " << task_id;
+    // The lost dependencies of the task were already added to the plan.
+    std::vector<ObjectID> task_deps;
+    if (task_resubmitter_->ResubmitTask(task_id, &task_deps)) {
+      // The task is done once a new value is stored for its return objects.
+      in_memory_store_->GetAsync(
+          lost_objects.front(), [this, plan, task_id](std::shared_ptr<RayObject> obj) {
+            {
+              absl::MutexLock lock(&mu_);
+              plan->tasks[task_id].finished = true;
+              plan->num_inflight_tasks--;
+            }
+            ResubmitReadyTasks(plan);
+          });
+    } else {
+      {
+        absl::MutexLock lock(&mu_);
+        plan->num_inflight_tasks--;
+      }
+      for (const auto &object_id : lost_objects) {
+        RAY_LOG(INFO) << "Failed to reconstruct object " << object_id
+                      << " because lineage has already been deleted";
+        recovery_failure_callback_(
+            object_id,
+            rpc::ErrorType::OBJECT_UNRECONSTRUCTABLE_MAX_ATTEMPTS_EXCEEDED,
+            /*pin_object=*/true);
+      }
+    }
+  }
+}
+
+std::shared_ptr<PinObjectsInterface> ObjectRecoveryManager::GetPinningClient(
+    const rpc::Address &raylet_address) {
+  const auto node_id = NodeID::FromBinary(raylet_address.raylet_id());
+  if (node_id == NodeID::FromBinary(rpc_address_.raylet_id())) {
+    return local_object_pinning_client_;
+  }
+  absl::MutexLock lock(&mu_);
+  auto client_it = remote_object_pinning_clients_.find(node_id);
+  if (client_it == remote_object_pinning_clients_.end()) {
+    RAY_LOG(DEBUG) << "Connecting to raylet " << node_id;
+    client_it =
+        remote_object_pinning_clients_
+            .emplace(node_id,
+                     client_factory_(raylet_address.ip_address(), raylet_address.port()))
+            .first;
+  }
+  return client_it->second;
+}
+
 void ObjectRecoveryManager::PinOrReconstructObject(
     const ObjectID &object_id, const std::vector<rpc::Address> &locations) {
   RAY_LOG(DEBUG) << "Lost object " << object_id << " has " << locations.size()
@@ -101,23 +447,7 @@ void ObjectRecoveryManager::PinExistingObjectCopy(
   RAY_LOG(DEBUG) << "Trying to pin copy of lost object " << object_id << " at node "
                  << node_id;
 
-  std::shared_ptr<PinObjectsInterface> client;
-  if (node_id == NodeID::FromBinary(rpc_address_.raylet_id())) {
-    client = local_object_pinning_client_;
-  } else {
-    absl::MutexLock lock(&mu_);
-    auto client_it = remote_object_pinning_clients_.find(node_id);
-    if (client_it == remote_object_pinning_clients_.end()) {
-      RAY_LOG(DEBUG) << "Connecting to raylet " << node_id;
-      client_it = remote_object_pinning_clients_
-                      .emplace(node_id,
-                               client_factory_(raylet_address.ip_address(),
-                                               raylet_address.port()))
-                      .first;
-    }
-    client = client_it->second;
-  }
-
+  auto client = GetPinningClient(raylet_address);
   client->PinObjectIDs(rpc_address_,
                        {object_id},
                        /*generator_id=*/ObjectID::Nil(),
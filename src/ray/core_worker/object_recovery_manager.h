@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
@@ -89,7 +91,102 @@ class ObjectRecoveryManager {
   /// reconstruction failure callback will be called for this object).
   bool RecoverObject(const ObjectID &object_id);
 
+  /// Recover a set of objects that were lost together, e.g. all objects on a
+  /// removed node. Objects that are not recoverable are skipped, as if
+  /// RecoverObject returned false for them.
+  ///
+  /// If object_recovery_bulk_mode is enabled, the objects are recovered as one
+  /// plan. Copies are pinned with one request per node. The tasks to resubmit
+  /// are deduplicated, and a task is only resubmitted once all of its lost
+  /// dependencies are recovered, with at most
+  /// object_recovery_max_inflight_tasks resubmitted tasks pending at a time.
+  /// Likewise, at most object_recovery_max_inflight_lookups object lookups
+  /// are pending at a time. Otherwise, RecoverObject is called for each object.
+  void RecoverObjects(const std::vector<ObjectID> &object_ids);
+
  private:
+  /// A task that a bulk recovery plan resubmits.
+  struct PlannedTask {
+    /// The lost return objects of the task.
+    std::vector<ObjectID> lost_objects;
+    /// The number of dependencies of the task that are still being recovered.
+    int64_t num_pending_deps = 0;
+    /// Whether the task was resubmitted.
+    bool resubmitted = false;
+    /// Whether the resubmitted task finished.
+    bool finished = false;
+  };
+
+  /// The lost objects of a plan whose locations are looked up together. Once
+  /// all lookups return, the objects with other locations are pinned together,
+  /// and the rest are reconstructed together.
+  struct LookupBatch {
+    /// The number of objects in the batch that were not looked up yet.
+    size_t num_pending = 0;
+    std::vector<ObjectID> objects_to_pin;
+    std::vector<ObjectID> objects_to_reconstruct;
+  };
+
+  /// The state of a bulk recovery, see RecoverObjects. It is protected by mu_.
+  struct RecoveryPlan {
+    /// For the lost objects that are being pinned, the locations that were not
+    /// tried yet.
+    absl::flat_hash_map<ObjectID, std::vector<rpc::Address>> other_locations;
+    /// The tasks to resubmit.
+    absl::flat_hash_map<TaskID, PlannedTask> tasks;
+    /// The tasks whose dependencies are recovered, in the order they became ready.
+    std::deque<TaskID> ready_tasks;
+    /// The number of resubmitted tasks that did not finish yet.
+    int64_t num_inflight_tasks = 0;
+    /// The objects whose lookups were not issued yet, with their batches.
+    std::deque<std::pair<ObjectID, std::shared_ptr<LookupBatch>>> queued_lookups;
+    /// The number of issued lookups that did not return yet.
+    int64_t num_inflight_lookups = 0;
+    /// Whether a caller is issuing the queued lookups. Lookup callbacks may run
+    /// synchronously, so this keeps them from issuing more lookups recursively.
+    bool issuing_lookups = false;
+  };
+
+  /// Check whether the object can be recovered and, if it needs recovery, mark
+  /// it as pending recovery.
+  ///
+  /// \param[out] started Whether recovery for the object should be started by
+  /// the caller.
+  /// \return False if the object is not recoverable.
+  bool StartRecovery(const ObjectID &object_id, bool *started);
+
+  /// Look up the locations of lost objects that are part of a plan, and then
+  /// pin copies of the objects or reconstruct them.
+  void LookupObjectsInPlan(const std::shared_ptr<RecoveryPlan> &plan,
+                           const std::vector<ObjectID> &object_ids);
+
+  /// Issue queued lookups while fewer than object_recovery_max_inflight_lookups
+  /// lookups of the plan are pending.
+  void IssueQueuedLookups(const std::shared_ptr<RecoveryPlan> &plan);
+
+  /// Pin copies of lost objects at the locations in plan->other_locations,
+  /// with one request per node. Objects that cannot be pinned anywhere are
+  /// reconstructed.
+  void PinObjectsInPlan(const std::shared_ptr<RecoveryPlan> &plan,
+                        const std::vector<ObjectID> &object_ids);
+
+  /// Add the tasks that created the lost objects to the plan, and start
+  /// recovering their lost dependencies.
+  void ReconstructObjectsInPlan(const std::shared_ptr<RecoveryPlan> &plan,
+                                const std::vector<ObjectID> &object_ids);
+
+  /// Called when a dependency of a planned task is recovered.
+  void OnPlannedTaskDependencyReady(const std::shared_ptr<RecoveryPlan> &plan,
+                                    const TaskID &task_id);
+
+  /// Resubmit ready tasks while fewer than object_recovery_max_inflight_tasks
+  /// resubmitted tasks are pending.
+  void ResubmitReadyTasks(const std::shared_ptr<RecoveryPlan> &plan);
+
+  /// Get a client to pin objects at the given raylet.
+  std::shared_ptr<PinObjectsInterface> GetPinningClient(
+      const rpc::Address &raylet_address);
+
   /// Pin a new copy for a lost object from the given locations or, if that
   /// fails, attempt to reconstruct it by resubmitting the task that created
   /// the object.
@@ -14,6 +14,8 @@
 
 #include "ray/core_worker/reference_count.h"
 
+#include "absl/container/node_hash_set.h"
+
 #define PRINT_REF_COUNT(it)                                                        \
   RAY_LOG(DEBUG) << "REF " << it->first                                            \
                  << " borrowers: " << it->second.borrow().borrowers.size()         \
@@ -32,6 +34,50 @@ namespace {}  // namespace
 namespace ray {
 namespace core {
 
+const std::string *ReferenceCounter::InternCallSite(const std::string &call_site) {
+  // Call sites are empty unless record_ref_creation_sites is set, so don't take
+  // the lock for them.
+  static const auto *empty_call_site = new std::string();
+  if (call_site.empty()) {
+    return empty_call_site;
+  }
+  static absl::Mutex mutex;
+  static auto *call_sites = new absl::node_hash_set<std::string>();
+  absl::MutexLock lock(&mutex);
+  return &*call_sites->insert(call_site).first;
+}
+
+const std::string *ReferenceCounter::UnknownCallSite() {
+  static const std::string *unknown_call_site = InternCallSite("<unknown>");
+  return unknown_call_site;
+}
+
+std::shared_ptr<const rpc::Address> ReferenceCounter::InternOwnerAddress(
+    const rpc::Address &address) {
+  auto &entry = interned_owner_addresses_[address.worker_id()];
+  auto interned = entry.lock();
+  if (interned != nullptr && interned->raylet_id() == address.raylet_id() &&
+      interned->ip_address() == address.ip_address() &&
+      interned->port() == address.port()) {
+    return interned;
+  }
+  interned = std::make_shared<const rpc::Address>(address);
+  entry = interned;
+  if (interned_owner_addresses_.size() >
+      2 * std::max<size_t>(num_interned_owner_addresses_after_prune_, 64)) {
+    for (auto it = interned_owner_addresses_.begin();
+         it != interned_owner_addresses_.end();) {
+      if (it->second.expired()) {
+        interned_owner_addresses_.erase(it++);
+      } else {
+        it++;
+      }
+    }
+    num_interned_owner_addresses_after_prune_ = interned_owner_addresses_.size();
+  }
+  return interned;
+}
+
 bool ReferenceCounter::OwnObjects() const {
   absl::MutexLock lock(&mutex_);
   return !object_id_refs_.empty();
@@ -104,7 +150,7 @@ bool ReferenceCounter::AddBorrowedObjectInternal(const ObjectID &object_id,
   }
 
   RAY_LOG(DEBUG) << "Adding borrowed object " << object_id;
-  it->second.owner_address = owner_address;
+  it->second.owner_address = InternOwnerAddress(owner_address);
   it->second.foreign_owner_already_monitoring |= foreign_owner_already_monitoring;
 
   if (!outer_id.IsNil()) {
@@ -145,9 +191,10 @@ void ReferenceCounter::AddObjectRefStats(
 
     auto ref_proto = stats->add_object_refs();
     ref_proto->set_object_id(ref.first.Binary());
-    ref_proto->set_call_site(ref.second.call_site);
+    ref_proto->set_call_site(*ref.second.call_site);
     ref_proto->set_object_size(ref.second.object_size);
-    ref_proto->set_local_ref_count(ref.second.local_ref_count);
+    ref_proto->set_local_ref_count(ref.second.local_ref_count +
+                                   GetExtraLocalRefCount(ref.first));
     ref_proto->set_submitted_task_ref_count(ref.second.submitted_task_ref_count);
     auto it = pinned_objects.find(ref.first);
     if (it != pinned_objects.end()) {
@@ -156,7 +203,7 @@ void ReferenceCounter::AddObjectRefStats(
       if (ref.second.object_size <= 0) {
         ref_proto->set_object_size(it->second.first);
       }
-      if (ref.second.call_site.empty()) {
+      if (ref.second.call_site->empty()) {
         ref_proto->set_call_site(it->second.second);
       }
     }
@@ -226,12 +273,12 @@ void ReferenceCounter::AddDynamicReturn(const ObjectID &object_id,
   RAY_LOG(DEBUG) << "Adding dynamic return " << object_id
                  << " contained in generator object " << generator_id;
   RAY_CHECK(outer_it->second.owned_by_us);
-  RAY_CHECK(outer_it->second.owner_address.has_value());
-  rpc::Address owner_address(outer_it->second.owner_address.value());
+  RAY_CHECK(outer_it->second.owner_address != nullptr);
+  rpc::Address owner_address(*outer_it->second.owner_address);
   RAY_UNUSED(AddOwnedObjectInternal(object_id,
                                     {},
                                     owner_address,
-                                    outer_it->second.call_site,
+                                    *outer_it->second.call_site,
                                     /*object_size=*/-1,
                                     outer_it->second.is_reconstructable,
                                     /*add_local_ref=*/false,
@@ -259,7 +306,7 @@ bool ReferenceCounter::AddOwnedObjectInternal(
   // their arguments' lineage ref counts.
   auto it = object_id_refs_
                 .emplace(object_id,
-                         Reference(owner_address,
+                         Reference(InternOwnerAddress(owner_address),
                                    call_site,
                                    object_size,
                                    is_reconstructable,
@@ -300,6 +347,9 @@ void ReferenceCounter::AddLocalReference(const ObjectID &object_id,
   if (object_id.IsNil()) {
     return;
   }
+  if (TryAddLocalReferenceFast(object_id)) {
+    return;
+  }
   absl::MutexLock lock(&mutex_);
   auto it = object_id_refs_.find(object_id);
   if (it == object_id_refs_.end()) {
@@ -307,6 +357,16 @@ void ReferenceCounter::AddLocalReference(const ObjectID &object_id,
     it = object_id_refs_.emplace(object_id, Reference(call_site, -1)).first;
   }
   bool was_in_use = it->second.RefCount() > 0;
+  if (it->second.local_ref_count > 0) {
+    if (auto *shard = GetLocalRefShard(object_id)) {
+      // The object already has a local reference, so this one can't change whether
+      // it is in scope. Keep it in the object's shard, so that further references
+      // can be added and removed without taking mutex_.
+      absl::MutexLock shard_lock(&shard->mutex);
+      shard->extra_local_refs[object_id]++;
+      return;
+    }
+  }
   it->second.local_ref_count++;
   RAY_LOG(DEBUG) << "Add local reference " << object_id;
   PRINT_REF_COUNT(it);
@@ -327,9 +387,63 @@ void ReferenceCounter::SetNestedRefInUseRecursive(ReferenceTable::iterator inner
   }
 }
 
+bool ReferenceCounter::TryAddLocalReferenceFast(const ObjectID &object_id) {
+  auto *shard = GetLocalRefShard(object_id);
+  if (shard == nullptr) {
+    return false;
+  }
+  absl::MutexLock lock(&shard->mutex);
+  auto it = shard->extra_local_refs.find(object_id);
+  if (it == shard->extra_local_refs.end()) {
+    return false;
+  }
+  it->second++;
+  return true;
+}
+
+bool ReferenceCounter::TryRemoveLocalReferenceFast(const ObjectID &object_id) {
+  auto *shard = GetLocalRefShard(object_id);
+  if (shard == nullptr) {
+    return false;
+  }
+  absl::MutexLock lock(&shard->mutex);
+  auto it = shard->extra_local_refs.find(object_id);
+  if (it == shard->extra_local_refs.end() || it->second == 0) {
+    return false;
+  }
+  it->second--;
+  return true;
+}
+
+size_t ReferenceCounter::GetExtraLocalRefCount(const ObjectID &object_id) const {
+  auto *shard = GetLocalRefShard(object_id);
+  if (shard == nullptr) {
+    return 0;
+  }
+  absl::MutexLock lock(&shard->mutex);
+  auto it = shard->extra_local_refs.find(object_id);
+  return it == shard->extra_local_refs.end() ? 0 : it->second;
+}
+
+void ReferenceCounter::FlushLocalRefShard(ReferenceTable::iterator it) {
+  auto *shard = GetLocalRefShard(it->first);
+  if (shard == nullptr) {
+    return;
+  }
+  absl::MutexLock lock(&shard->mutex);
+  auto shard_it = shard->extra_local_refs.find(it->first);
+  if (shard_it != shard->extra_local_refs.end()) {
+    it->second.local_ref_count += shard_it->second;
+    shard->extra_local_refs.erase(shard_it);
+  }
+}
+
 void ReferenceCounter::ReleaseAllLocalReferences() {
   absl::MutexLock lock(&mutex_);
   std::vector<ObjectID> refs_to_remove;
+  for (auto it = object_id_refs_.begin(); it != object_id_refs_.end(); it++) {
+    FlushLocalRefShard(it);
+  }
   for (auto &ref : object_id_refs_) {
     for (int i = ref.second.local_ref_count; i > 0; --i) {
       refs_to_remove.push_back(ref.first);
@@ -345,6 +459,9 @@ void ReferenceCounter::RemoveLocalReference(const ObjectID &object_id,
   if (object_id.IsNil()) {
     return;
   }
+  if (TryRemoveLocalReferenceFast(object_id)) {
+    return;
+  }
   absl::MutexLock lock(&mutex_);
   RemoveLocalReferenceInternal(object_id, deleted);
 }
@@ -358,6 +475,18 @@ void ReferenceCounter::RemoveLocalReferenceInternal(const ObjectID &object_id,
                      << object_id;
     return;
   }
+  if (auto *shard = GetLocalRefShard(object_id)) {
+    absl::MutexLock shard_lock(&shard->mutex);
+    auto shard_it = shard->extra_local_refs.find(object_id);
+    if (shard_it != shard->extra_local_refs.end()) {
+      if (shard_it->second > 0) {
+        // A reference was added to the shard since the fast path was tried.
+        shard_it->second--;
+        return;
+      }
+      shard->extra_local_refs.erase(shard_it);
+    }
+  }
   if (it->second.local_ref_count == 0) {
     RAY_LOG(WARNING)
         << "Tried to decrease ref count for object ID that has count 0 " << object_id
@@ -478,7 +607,7 @@ int64_t ReferenceCounter::ReleaseLineageReferences(ReferenceTable::iterator ref)
     RAY_LOG(DEBUG) << "Releasing lineage internal for argument " << argument_id;
     arg_it->second.lineage_ref_count--;
     if (arg_it->second.ShouldDelete(lineage_pinning_enabled_)) {
-      RAY_CHECK(arg_it->second.on_ref_removed == nullptr);
+      RAY_CHECK(arg_it->second.cold().on_ref_removed == nullptr);
       lineage_bytes_evicted += ReleaseLineageReferences(arg_it);
       ReleasePlasmaObject(arg_it);
       EraseReference(arg_it);
@@ -604,10 +733,10 @@ void ReferenceCounter::DeleteReferenceInternal(ReferenceTable::iterator it,
                                                std::vector<ObjectID> *deleted) {
   const ObjectID id = it->first;
   RAY_LOG(DEBUG) << "Attempting to delete object " << id;
-  if (it->second.RefCount() == 0 && it->second.on_ref_removed) {
+  if (it->second.RefCount() == 0 && it->second.cold().on_ref_removed) {
     RAY_LOG(DEBUG) << "Calling on_ref_removed for object " << id;
-    it->second.on_ref_removed(id);
-    it->second.on_ref_removed = nullptr;
+    it->second.mutable_cold()->on_ref_removed(id);
+    it->second.mutable_cold()->on_ref_removed = nullptr;
   }
   PRINT_REF_COUNT(it);
 
@@ -687,20 +816,25 @@ int64_t ReferenceCounter::EvictLineage(int64_t min_bytes_to_evict) {
 }
 
 void ReferenceCounter::ReleasePlasmaObject(ReferenceTable::iterator it) {
-  if (it->second.on_delete) {
+  auto *cold = it->second.cold_info.get();
+  if (cold == nullptr) {
+    // There is no callback, pinned location, or spilled copy to release.
+    return;
+  }
+  if (cold->on_delete) {
     RAY_LOG(DEBUG) << "Calling on_delete for object " << it->first;
-    it->second.on_delete(it->first);
-    it->second.on_delete = nullptr;
+    cold->on_delete(it->first);
+    cold->on_delete = nullptr;
   }
-  it->second.pinned_at_raylet_id.reset();
-  if (it->second.spilled && !it->second.spilled_node_id.IsNil()) {
+  cold->pinned_at_raylet_id.reset();
+  if (cold->spilled && !cold->spilled_node_id.IsNil()) {
     // The spilled copy of the object should get deleted during the on_delete
     // callback, so reset the spill location metadata here.
     // NOTE(swang): Spilled copies in cloud storage are not GCed, so we do not
     // reset the spilled metadata.
-    it->second.spilled = false;
-    it->second.spilled_url = "";
-    it->second.spilled_node_id = NodeID::Nil();
+    cold->spilled = false;
+    cold->spilled_url = "";
+    cold->spilled_node_id = NodeID::Nil();
   }
 }
 
@@ -727,7 +861,7 @@ bool ReferenceCounter::SetDeleteCallback(
   // will resend the registration request after GCS restarts.
   // 2.After GCS restarts, GCS will send `WaitForActorOutOfScope` request to owned actors
   // again.
-  it->second.on_delete = callback;
+  it->second.mutable_cold()->on_delete = callback;
   return true;
 }
 
@@ -735,8 +869,8 @@ void ReferenceCounter::ResetObjectsOnRemovedNode(const NodeID &raylet_id) {
   absl::MutexLock lock(&mutex_);
   for (auto it = object_id_refs_.begin(); it != object_id_refs_.end(); it++) {
     const auto &object_id = it->first;
-    if (it->second.pinned_at_raylet_id.value_or(NodeID::Nil()) == raylet_id ||
-        it->second.spilled_node_id == raylet_id) {
+    if (it->second.cold().pinned_at_raylet_id.value_or(NodeID::Nil()) == raylet_id ||
+        it->second.cold().spilled_node_id == raylet_id) {
       ReleasePlasmaObject(it);
       if (!it->second.OutOfScope(lineage_pinning_enabled_)) {
         objects_to_recover_.push_back(object_id);
@@ -765,17 +899,17 @@ void ReferenceCounter::UpdateObjectPinnedAtRaylet(const ObjectID &object_id,
 
     // The object is still in scope. Track the raylet location until the object
     // has gone out of scope or the raylet fails, whichever happens first.
-    if (it->second.pinned_at_raylet_id.has_value()) {
+    if (it->second.cold().pinned_at_raylet_id.has_value()) {
       RAY_LOG(INFO) << "Updating primary location for object " << object_id << " to node "
                     << raylet_id << ", but it already has a primary location "
-                    << *it->second.pinned_at_raylet_id
+                    << *it->second.cold().pinned_at_raylet_id
                     << ". This should only happen during reconstruction";
     }
     // Only the owner tracks the location.
     RAY_CHECK(it->second.owned_by_us);
     if (!it->second.OutOfScope(lineage_pinning_enabled_)) {
       if (check_node_alive_(raylet_id)) {
-        it->second.pinned_at_raylet_id = raylet_id;
+        it->second.mutable_cold()->pinned_at_raylet_id = raylet_id;
       } else {
         ReleasePlasmaObject(it);
         objects_to_recover_.push_back(object_id);
@@ -793,8 +927,8 @@ bool ReferenceCounter::IsPlasmaObjectPinnedOrSpilled(const ObjectID &object_id,
   if (it != object_id_refs_.end()) {
     if (it->second.owned_by_us) {
       *owned_by_us = true;
-      *spilled = it->second.spilled;
-      *pinned_at = it->second.pinned_at_raylet_id.value_or(NodeID::Nil());
+      *spilled = it->second.cold().spilled;
+      *pinned_at = it->second.cold().pinned_at_raylet_id.value_or(NodeID::Nil());
     }
     return true;
   }
@@ -827,8 +961,10 @@ ReferenceCounter::GetAllReferenceCounts() const {
   std::unordered_map<ObjectID, std::pair<size_t, size_t>> all_ref_counts;
   all_ref_counts.reserve(object_id_refs_.size());
   for (const auto &[id, ref] : object_id_refs_) {
-    all_ref_counts.emplace(
-        id, std::pair<size_t, size_t>(ref.local_ref_count, ref.submitted_task_ref_count));
+    all_ref_counts.emplace(id,
+                           std::pair<size_t, size_t>(
+                               ref.local_ref_count + GetExtraLocalRefCount(id),
+                               ref.submitted_task_ref_count));
   }
   return all_ref_counts;
 }
@@ -838,6 +974,12 @@ void ReferenceCounter::PopAndClearLocalBorrowers(
     ReferenceCounter::ReferenceTableProto *proto,
     std::vector<ObjectID> *deleted) {
   absl::MutexLock lock(&mutex_);
+  for (const auto &borrowed_id : borrowed_ids) {
+    auto it = object_id_refs_.find(borrowed_id);
+    if (it != object_id_refs_.end()) {
+      FlushLocalRefShard(it);
+    }
+  }
   ReferenceProtoTable borrowed_refs;
   for (const auto &borrowed_id : borrowed_ids) {
     // Setting `deduct_local_ref` to true to decrease the ref count for each of the
@@ -1203,7 +1345,7 @@ void ReferenceCounter::SetRefRemovedCallback(
   } else {
     // We are still borrowing the object ID. Respond to the owner once we have
     // stopped borrowing it.
-    if (it->second.on_ref_removed != nullptr) {
+    if (it->second.cold().on_ref_removed != nullptr) {
       // TODO(swang): If the owner of an object dies and and is re-executed, it
       // is possible that we will receive a duplicate request to set
       // on_ref_removed. If messages are delayed and we overwrite the
@@ -1213,7 +1355,7 @@ void ReferenceCounter::SetRefRemovedCallback(
       RAY_LOG(WARNING) << "on_ref_removed already set for " << object_id
                        << ". The owner task must have died and been re-executed.";
     }
-    it->second.on_ref_removed = ref_removed_callback;
+    it->second.mutable_cold()->on_ref_removed = ref_removed_callback;
   }
 }
 
@@ -1240,7 +1382,7 @@ bool ReferenceCounter::AddObjectLocation(const ObjectID &object_id,
 void ReferenceCounter::AddObjectLocationInternal(ReferenceTable::iterator it,
                                                  const NodeID &node_id) {
   RAY_LOG(DEBUG) << "Adding location " << node_id << " for object " << it->first;
-  if (it->second.locations.emplace(node_id).second) {
+  if (it->second.mutable_cold()->locations.emplace(node_id).second) {
     // Only push to subscribers if we added a new location. We eagerly add the pinned
     // location without waiting for the object store notification to trigger a location
     // report, so there's a chance that we already knew about the node_id location.
@@ -1265,7 +1407,9 @@ bool ReferenceCounter::RemoveObjectLocation(const ObjectID &object_id,
 
 void ReferenceCounter::RemoveObjectLocationInternal(ReferenceTable::iterator it,
                                                     const NodeID &node_id) {
-  it->second.locations.erase(node_id);
+  if (it->second.cold_info != nullptr) {
+    it->second.cold_info->locations.erase(node_id);
+  }
   PushToLocationSubscribers(it);
 }
 
@@ -1291,7 +1435,7 @@ absl::optional<absl::flat_hash_set<NodeID>> ReferenceCounter::GetObjectLocations
                    << " that doesn't exist in the reference table";
     return absl::nullopt;
   }
-  return it->second.locations;
+  return it->second.cold().locations;
 }
 
 bool ReferenceCounter::HandleObjectSpilled(const ObjectID &object_id,
@@ -1311,15 +1455,16 @@ bool ReferenceCounter::HandleObjectSpilled(const ObjectID &object_id,
     return false;
   }
 
-  it->second.spilled = true;
+  auto *cold = it->second.mutable_cold();
+  cold->spilled = true;
   bool spilled_location_alive =
       spilled_node_id.IsNil() || check_node_alive_(spilled_node_id);
   if (spilled_location_alive) {
     if (spilled_url != "") {
-      it->second.spilled_url = spilled_url;
+      cold->spilled_url = spilled_url;
     }
     if (!spilled_node_id.IsNil()) {
-      it->second.spilled_node_id = spilled_node_id;
+      cold->spilled_node_id = spilled_node_id;
     }
     PushToLocationSubscribers(it);
   } else {
@@ -1348,7 +1493,7 @@ absl::optional<LocalityData> ReferenceCounter::GetLocalityData(
   const auto object_size = it->second.object_size;
   if (object_size < 0) {
     // We don't know the object size so we can't returned valid locality data.
-    RAY_LOG(DEBUG) << "Reference [" << it->second.call_site << "] for object "
+    RAY_LOG(DEBUG) << "Reference [" << *it->second.call_site << "] for object "
                    << object_id
                    << " has an unknown object size, locality data not available";
     return absl::nullopt;
@@ -1359,11 +1504,11 @@ absl::optional<LocalityData> ReferenceCounter::GetLocalityData(
   //   locations.
   // - If we don't own this object, this will contain a snapshot of the object locations
   //   at future resolution time.
-  auto node_ids = it->second.locations;
+  auto node_ids = it->second.cold().locations;
   // Add location of the primary copy since the object must be there: either in memory or
   // spilled.
-  if (it->second.pinned_at_raylet_id.has_value()) {
-    node_ids.emplace(it->second.pinned_at_raylet_id.value());
+  if (it->second.cold().pinned_at_raylet_id.has_value()) {
+    node_ids.emplace(it->second.cold().pinned_at_raylet_id.value());
   }
 
   // We should only reach here if we have valid locality data to return.
@@ -1386,7 +1531,7 @@ bool ReferenceCounter::ReportLocalityData(const ObjectID &object_id,
   RAY_CHECK(!it->second.owned_by_us)
       << "ReportLocalityData should only be used for borrowed references.";
   for (const auto &location : locations) {
-    it->second.locations.emplace(location);
+    it->second.mutable_cold()->locations.emplace(location);
   }
   if (object_size > 0) {
     it->second.object_size = object_size;
@@ -1441,11 +1586,11 @@ bool ReferenceCounter::IsObjectPendingCreation(const ObjectID &object_id) const
 
 void ReferenceCounter::PushToLocationSubscribers(ReferenceTable::iterator it) {
   const auto &object_id = it->first;
-  const auto &locations = it->second.locations;
+  const auto &locations = it->second.cold().locations;
   auto object_size = it->second.object_size;
-  const auto &spilled_url = it->second.spilled_url;
-  const auto &spilled_node_id = it->second.spilled_node_id;
-  const auto &optional_primary_node_id = it->second.pinned_at_raylet_id;
+  const auto &spilled_url = it->second.cold().spilled_url;
+  const auto &spilled_node_id = it->second.cold().spilled_node_id;
+  const auto &optional_primary_node_id = it->second.cold().pinned_at_raylet_id;
   const auto &primary_node_id = optional_primary_node_id.value_or(NodeID::Nil());
   RAY_LOG(DEBUG) << "Published message for " << object_id << ", " << locations.size()
                  << " locations, spilled url: [" << spilled_url
@@ -1480,13 +1625,13 @@ Status ReferenceCounter::FillObjectInformation(
 
 void ReferenceCounter::FillObjectInformationInternal(
     ReferenceTable::iterator it, rpc::WorkerObjectLocationsPubMessage *object_info) {
-  for (const auto &node_id : it->second.locations) {
+  for (const auto &node_id : it->second.cold().locations) {
     object_info->add_node_ids(node_id.Binary());
   }
   object_info->set_object_size(it->second.object_size);
-  object_info->set_spilled_url(it->second.spilled_url);
-  object_info->set_spilled_node_id(it->second.spilled_node_id.Binary());
-  auto primary_node_id = it->second.pinned_at_raylet_id.value_or(NodeID::Nil());
+  object_info->set_spilled_url(it->second.cold().spilled_url);
+  object_info->set_spilled_node_id(it->second.cold().spilled_node_id.Binary());
+  auto primary_node_id = it->second.cold().pinned_at_raylet_id.value_or(NodeID::Nil());
   object_info->set_primary_node_id(primary_node_id.Binary());
   object_info->set_pending_creation(it->second.pending_creation);
 }
@@ -1519,7 +1664,8 @@ void ReferenceCounter::PublishObjectLocationSnapshot(const ObjectID &object_id)
 ReferenceCounter::Reference ReferenceCounter::Reference::FromProto(
     const rpc::ObjectReferenceCount &ref_count) {
   Reference ref;
-  ref.owner_address = ref_count.reference().owner_address();
+  ref.owner_address =
+      std::make_shared<const rpc::Address>(ref_count.reference().owner_address());
   ref.local_ref_count = ref_count.has_local_ref() ? 1 : 0;
 
   for (const auto &borrower : ref_count.borrowers()) {
@@ -19,6 +19,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
+#include "ray/common/ray_config.h"
 #include "ray/core_worker/lease_policy.h"
 #include "ray/pubsub/publisher.h"
 #include "ray/pubsub/subscriber.h"
@@ -79,7 +80,12 @@ class ReferenceCounter : public ReferenceCounterInterface,
         borrower_pool_(client_factory),
         object_info_publisher_(object_info_publisher),
         object_info_subscriber_(object_info_subscriber),
-        check_node_alive_(check_node_alive) {}
+        check_node_alive_(check_node_alive) {
+    for (uint64_t i = 0; i < RayConfig::instance().reference_counter_num_local_ref_shards();
+         i++) {
+      local_ref_shards_.push_back(std::make_unique<LocalRefShard>());
+    }
+  }
 
   ~ReferenceCounter() {}
 
@@ -562,25 +568,58 @@ class ReferenceCounter : public ReferenceCounterInterface,
     absl::flat_hash_set<rpc::WorkerAddress> borrowers;
   };
 
+  /// Contains information that most references don't need: where the object's
+  /// value is stored, and the callbacks to call when the reference goes away.
+  struct ColdInfo {
+    /// If this object is owned by us and stored in plasma, this contains all
+    /// object locations.
+    absl::flat_hash_set<NodeID> locations;
+    /// If this object is owned by us and stored in plasma, and reference
+    /// counting is enabled, then some raylet must be pinning the object value.
+    /// This is the address of that raylet.
+    absl::optional<NodeID> pinned_at_raylet_id;
+    /// For objects that have been spilled to external storage, the URL from which
+    /// they can be retrieved.
+    std::string spilled_url = "";
+    /// The ID of the node that spilled the object.
+    /// This will be Nil if the object has not been spilled or if it is spilled
+    /// distributed external storage.
+    NodeID spilled_node_id = NodeID::Nil();
+    /// Whether this object has been spilled to external storage.
+    bool spilled = false;
+    /// Callback that will be called when this ObjectID no longer has
+    /// references.
+    std::function<void(const ObjectID &)> on_delete;
+    /// Callback that is called when this process is no longer a borrower
+    /// (RefCount() == 0).
+    std::function<void(const ObjectID &)> on_ref_removed;
+  };
+
+  /// A tracked reference. Most references only have a local ref and no
+  /// borrowers, so everything else lives in lazily allocated structs and the
+  /// owner address and call site are shared between references.
   struct Reference {
     /// Constructor for a reference whose origin is unknown.
     Reference() {}
-    Reference(std::string call_site, const int64_t object_size)
-        : call_site(call_site), object_size(object_size) {}
+    Reference(const std::string &call_site, const int64_t object_size)
+        : call_site(InternCallSite(call_site)), object_size(object_size) {}
     /// Constructor for a reference that we created.
-    Reference(const rpc::Address &owner_address,
-              std::string call_site,
+    Reference(std::shared_ptr<const rpc::Address> owner_address,
+              const std::string &call_site,
               const int64_t object_size,
               bool is_reconstructable,
               const absl::optional<NodeID> &pinned_at_raylet_id)
-        : call_site(call_site),
+        : call_site(InternCallSite(call_site)),
           object_size(object_size),
-          owner_address(owner_address),
-          pinned_at_raylet_id(pinned_at_raylet_id),
+          owner_address(std::move(owner_address)),
           owned_by_us(true),
           is_reconstructable(is_reconstructable),
           foreign_owner_already_monitoring(false),
-          pending_creation(!pinned_at_raylet_id.has_value()) {}
+          pending_creation(!pinned_at_raylet_id.has_value()) {
+      if (pinned_at_raylet_id.has_value()) {
+        mutable_cold()->pinned_at_raylet_id = pinned_at_raylet_id;
+      }
+    }
 
     /// Constructor from a protobuf. This is assumed to be a message from
     /// another process, so the object defaults to not being owned by us.
@@ -672,34 +711,36 @@ class ReferenceCounter : public ReferenceCounterInterface,
       return nested_reference_count.get();
     }
 
-    /// Description of the call site where the reference was created.
-    std::string call_site = "<unknown>";
+    /// Access ColdInfo without modifications.
+    /// Returns the default value of the struct if it is not set.
+    const ColdInfo &cold() const {
+      if (cold_info == nullptr) {
+        static auto *default_info = new ColdInfo();
+        return *default_info;
+      }
+      return *cold_info;
+    }
+
+    /// Returns the cold info for updates.
+    /// Creates the underlying field if it is not set.
+    ColdInfo *mutable_cold() {
+      if (cold_info == nullptr) {
+        cold_info = std::make_unique<ColdInfo>();
+      }
+      return cold_info.get();
+    }
+
+    /// Description of the call site where the reference was created. This
+    /// points to an interned string and is never null.
+    const std::string *call_site = UnknownCallSite();
     /// Object size if known, otherwise -1;
     int64_t object_size = -1;
-    /// If this object is owned by us and stored in plasma, this contains all
-    /// object locations.
-    absl::flat_hash_set<NodeID> locations;
     /// The object's owner's address, if we know it. If this process is the
     /// owner, then this is added during creation of the Reference. If this is
     /// process is a borrower, the borrower must add the owner's address before
-    /// using the ObjectID.
-    absl::optional<rpc::Address> owner_address;
-    /// If this object is owned by us and stored in plasma, and reference
-    /// counting is enabled, then some raylet must be pinning the object value.
-    /// This is the address of that raylet.
-    absl::optional<NodeID> pinned_at_raylet_id;
-    /// Whether we own the object. If we own the object, then we are
-    /// responsible for tracking the state of the task that creates the object
-    /// (see task_manager.h).
-    bool owned_by_us = false;
+    /// using the ObjectID. References with the same owner share the address.
+    std::shared_ptr<const rpc::Address> owner_address;
 
-    // Whether this object can be reconstructed via lineage. If false, then the
-    // object's value will be pinned as long as it is referenced by any other
-    // object's lineage. This should be set to false if the object was created
-    // by ray.put(), a task that cannot be retried, or its lineage was evicted.
-    bool is_reconstructable = false;
-    /// Whether the lineage of this object was evicted due to memory pressure.
-    bool lineage_evicted = false;
     /// The number of tasks that depend on this object that may be retried in
     /// the future (pending execution or finished but retryable). If the object
     /// is inlined (not stored in plasma), then its lineage ref count is 0
@@ -718,22 +759,21 @@ class ReferenceCounter : public ReferenceCounterInterface,
     /// Metadata related to borrowing.
     std::unique_ptr<BorrowInfo> borrow_info;
 
-    /// Callback that will be called when this ObjectID no longer has
-    /// references.
-    std::function<void(const ObjectID &)> on_delete;
-    /// Callback that is called when this process is no longer a borrower
-    /// (RefCount() == 0).
-    std::function<void(const ObjectID &)> on_ref_removed;
+    /// Object locations, spill metadata and callbacks.
+    std::unique_ptr<ColdInfo> cold_info;
 
-    /// For objects that have been spilled to external storage, the URL from which
-    /// they can be retrieved.
-    std::string spilled_url = "";
-    /// The ID of the node that spilled the object.
-    /// This will be Nil if the object has not been spilled or if it is spilled
-    /// distributed external storage.
-    NodeID spilled_node_id = NodeID::Nil();
-    /// Whether this object has been spilled to external storage.
-    bool spilled = false;
+    /// Whether we own the object. If we own the object, then we are
+    /// responsible for tracking the state of the task that creates the object
+    /// (see task_manager.h).
+    bool owned_by_us = false;
+
+    // Whether this object can be reconstructed via lineage. If false, then the
+    // object's value will be pinned as long as it is referenced by any other
+    // object's lineage. This should be set to false if the object was created
+    // by ray.put(), a task that cannot be retried, or its lineage was evicted.
+    bool is_reconstructable = false;
+    /// Whether the lineage of this object was evicted due to memory pressure.
+    bool lineage_evicted = false;
 
     /// Whether the object was created with a foreign owner (i.e., _owner set).
     /// In this case, the owner is already monitoring this reference with a
@@ -755,6 +795,20 @@ class ReferenceCounter : public ReferenceCounterInterface,
   using ReferenceTable = absl::flat_hash_map<ObjectID, Reference>;
   using ReferenceProtoTable = absl::flat_hash_map<ObjectID, rpc::ObjectReferenceCount>;
 
+  /// Get the interned copy of a call site. There are only as many call sites as
+  /// there are places in the code that create references, so interned call sites
+  /// are never freed. This is thread-safe.
+  static const std::string *InternCallSite(const std::string &call_site);
+
+  /// Get the interned "<unknown>" call site of default-constructed references. It is
+  /// interned once, so constructing a reference doesn't take the intern lock.
+  static const std::string *UnknownCallSite();
+
+  /// Get a copy of the owner address that is shared by all references with the
+  /// same owner.
+  std::shared_ptr<const rpc::Address> InternOwnerAddress(const rpc::Address &address)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   bool AddOwnedObjectInternal(const ObjectID &object_id,
                               const std::vector<ObjectID> &contained_ids,
                               const rpc::Address &owner_address,
@@ -940,6 +994,44 @@ class ReferenceCounter : public ReferenceCounterInterface,
                                     std::vector<ObjectID> *deleted)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  /// Local reference counts of objects that already have a local reference in
+  /// object_id_refs_, beyond those counted there. An object has an entry here
+  /// only while its local_ref_count in object_id_refs_ is at least 1, so further
+  /// local references can be added and removed under the shard's lock alone,
+  /// without changing whether the object is in scope.
+  ///
+  /// Lock order: mutex_ is always taken before a shard's mutex.
+  struct LocalRefShard {
+    absl::Mutex mutex;
+    absl::flat_hash_map<ObjectID, size_t> extra_local_refs GUARDED_BY(mutex);
+  };
+
+  /// Get the local reference shard of the object, or nullptr if sharding is disabled.
+  LocalRefShard *GetLocalRefShard(const ObjectID &object_id) const {
+    if (local_ref_shards_.empty()) {
+      return nullptr;
+    }
+    return local_ref_shards_[object_id.Hash() % local_ref_shards_.size()].get();
+  }
+
+  /// Try to add a local reference to an object that already has one, without
+  /// taking mutex_. Returns false if the caller must take the slow path.
+  bool TryAddLocalReferenceFast(const ObjectID &object_id) LOCKS_EXCLUDED(mutex_);
+
+  /// Try to remove a local reference that was added through the fast path,
+  /// without taking mutex_. Returns false if the caller must take the slow path.
+  bool TryRemoveLocalReferenceFast(const ObjectID &object_id) LOCKS_EXCLUDED(mutex_);
+
+  /// Get the number of local references to the object held in its shard.
+  size_t GetExtraLocalRefCount(const ObjectID &object_id) const
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Move the object's local references from its shard back into object_id_refs_.
+  /// This must be called before local_ref_count is decremented by anything other
+  /// than RemoveLocalReference, so that the count can't drop to 0 while the shard
+  /// still holds references.
+  void FlushLocalRefShard(ReferenceTable::iterator it) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   /// Address of our RPC server. This is used to determine whether we own a
   /// given object or not, by comparing our WorkerID with the WorkerID of the
   /// object's owner.
@@ -1010,6 +1102,16 @@ class ReferenceCounter : public ReferenceCounterInterface,
   /// due to node failure. These objects are still in scope and need to be
   /// recovered.
   std::vector<ObjectID> objects_to_recover_ GUARDED_BY(mutex_);
+
+  /// Owner addresses shared by references, keyed by the owner's worker ID.
+  /// Expired entries are pruned whenever the map doubles in size.
+  absl::flat_hash_map<std::string, std::weak_ptr<const rpc::Address>>
+      interned_owner_addresses_ GUARDED_BY(mutex_);
+  /// The size of interned_owner_addresses_ after it was last pruned.
+  size_t num_interned_owner_addresses_after_prune_ GUARDED_BY(mutex_) = 0;
+
+  /// The shards of local reference counts. Immutable after construction.
+  std::vector<std::unique_ptr<LocalRefShard>> local_ref_shards_;
 };
 
 }  // namespace core
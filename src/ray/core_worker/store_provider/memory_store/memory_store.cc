@@ -158,18 +158,25 @@ CoreWorkerMemoryStore::CoreWorkerMemoryStore(
       raylet_client_(raylet_client),
       check_signals_(check_signals),
       unhandled_exception_handler_(unhandled_exception_handler),
-      object_allocator_(std::move(object_allocator)) {}
+      object_allocator_(std::move(object_allocator)) {
+  const uint64_t num_shards = std::max<uint64_t>(
+      RayConfig::instance().core_worker_memory_store_num_shards(), 1);
+  for (uint64_t i = 0; i < num_shards; i++) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
 
 void CoreWorkerMemoryStore::GetAsync(
     const ObjectID &object_id, std::function<void(std::shared_ptr<RayObject>)> callback) {
   std::shared_ptr<RayObject> ptr;
   {
-    absl::MutexLock lock(&mu_);
-    auto iter = objects_.find(object_id);
-    if (iter != objects_.end()) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    auto iter = shard.objects.find(object_id);
+    if (iter != shard.objects.end()) {
       ptr = iter->second;
     } else {
-      object_async_get_requests_[object_id].push_back(callback);
+      shard.object_async_get_requests[object_id].push_back(callback);
     }
     if (ptr != nullptr) {
       ptr->SetAccessed();
@@ -184,9 +191,10 @@ void CoreWorkerMemoryStore::GetAsync(
 std::shared_ptr<RayObject> CoreWorkerMemoryStore::GetIfExists(const ObjectID &object_id) {
   std::shared_ptr<RayObject> ptr;
   {
-    absl::MutexLock lock(&mu_);
-    auto iter = objects_.find(object_id);
-    if (iter != objects_.end()) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    auto iter = shard.objects.find(object_id);
+    if (iter != shard.objects.end()) {
       ptr = iter->second;
     }
     if (ptr != nullptr) {
@@ -210,23 +218,24 @@ bool CoreWorkerMemoryStore::Put(const RayObject &object, const ObjectID &object_
   // TODO(edoakes): we should instead return a flag to the caller to put the object in
   // plasma.
   {
-    absl::MutexLock lock(&mu_);
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
 
-    auto iter = objects_.find(object_id);
-    if (iter != objects_.end()) {
+    auto iter = shard.objects.find(object_id);
+    if (iter != shard.objects.end()) {
       return true;  // Object already exists in the store, which is fine.
     }
 
-    auto async_callback_it = object_async_get_requests_.find(object_id);
-    if (async_callback_it != object_async_get_requests_.end()) {
+    auto async_callback_it = shard.object_async_get_requests.find(object_id);
+    if (async_callback_it != shard.object_async_get_requests.end()) {
       auto &callbacks = async_callback_it->second;
       async_callbacks = std::move(callbacks);
-      object_async_get_requests_.erase(async_callback_it);
+      shard.object_async_get_requests.erase(async_callback_it);
     }
 
     bool should_add_entry = true;
-    auto object_request_iter = object_get_requests_.find(object_id);
-    if (object_request_iter != object_get_requests_.end()) {
+    auto object_request_iter = shard.object_get_requests.find(object_id);
+    if (object_request_iter != shard.object_get_requests.end()) {
       auto &get_requests = object_request_iter->second;
       for (auto &get_request : get_requests) {
         get_request->Set(object_id, object_entry);
@@ -243,7 +252,7 @@ bool CoreWorkerMemoryStore::Put(const RayObject &object, const ObjectID &object_
 
     if (should_add_entry) {
       // If there is no existing get request, then add the `RayObject` to map.
-      EmplaceObjectAndUpdateStats(object_id, object_entry);
+      EmplaceObjectAndUpdateStats(shard, object_id, object_entry);
     } else {
       // It is equivalent to the object being added and immediately deleted from the
       // store.
@@ -294,16 +303,17 @@ Status CoreWorkerMemoryStore::GetImpl(const std::vector<ObjectID> &object_ids,
     absl::flat_hash_set<ObjectID> remaining_ids;
     absl::flat_hash_set<ObjectID> ids_to_remove;
 
-    absl::MutexLock lock(&mu_);
     // Check for existing objects and see if this get request can be fullfilled.
     for (size_t i = 0; i < object_ids.size() && count < num_objects; i++) {
       const auto &object_id = object_ids[i];
-      auto iter = objects_.find(object_id);
-      if (iter != objects_.end()) {
+      auto &shard = GetShard(object_id);
+      absl::MutexLock lock(&shard.mu);
+      auto iter = shard.objects.find(object_id);
+      if (iter != shard.objects.end()) {
         iter->second->SetAccessed();
         (*results)[i] = iter->second;
         if (remove_after_get) {
-          // Note that we cannot remove the object_id from `objects_` now,
+          // Note that we cannot remove the object_id from `objects` now,
           // because `object_ids` might have duplicate ids.
           ids_to_remove.insert(object_id);
         }
@@ -317,7 +327,9 @@ Status CoreWorkerMemoryStore::GetImpl(const std::vector<ObjectID> &object_ids,
     // Clean up the objects if ref counting is off.
     if (ref_counter_ == nullptr) {
       for (const auto &object_id : ids_to_remove) {
-        EraseObjectAndUpdateStats(object_id);
+        auto &shard = GetShard(object_id);
+        absl::MutexLock lock(&shard.mu);
+        EraseObjectAndUpdateStats(shard, object_id);
       }
     }
 
@@ -333,8 +345,24 @@ Status CoreWorkerMemoryStore::GetImpl(const std::vector<ObjectID> &object_ids,
                                                required_objects,
                                                remove_after_get,
                                                abort_if_any_object_is_exception);
+    // The objects may have been put since they were checked above, when their
+    // shards weren't locked. Check them again in the same critical section as
+    // registering the request, so that a Put can't be missed.
     for (const auto &object_id : get_request->ObjectIds()) {
-      object_get_requests_[object_id].push_back(get_request);
+      auto &shard = GetShard(object_id);
+      absl::MutexLock lock(&shard.mu);
+      auto iter = shard.objects.find(object_id);
+      if (iter != shard.objects.end()) {
+        get_request->Set(object_id, iter->second);
+        // The request ignores objects once it is ready, so only remove the ones
+        // that it returns.
+        if (remove_after_get && ref_counter_ == nullptr &&
+            get_request->Get(object_id) != nullptr) {
+          EraseObjectAndUpdateStats(shard, object_id);
+        }
+      } else {
+        shard.object_get_requests[object_id].push_back(get_request);
+      }
     }
   }
 
@@ -378,31 +406,31 @@ Status CoreWorkerMemoryStore::GetImpl(const std::vector<ObjectID> &object_ids,
     RAY_CHECK_OK(raylet_client_->NotifyDirectCallTaskUnblocked());
   }
 
-  {
-    absl::MutexLock lock(&mu_);
-    // Populate results.
-    for (size_t i = 0; i < object_ids.size(); i++) {
-      const auto &object_id = object_ids[i];
-      if ((*results)[i] == nullptr) {
-        (*results)[i] = get_request->Get(object_id);
+  // Remove get request. After this, no Put can set more objects in the request, so
+  // the results below are final.
+  for (const auto &object_id : get_request->ObjectIds()) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    auto object_request_iter = shard.object_get_requests.find(object_id);
+    if (object_request_iter != shard.object_get_requests.end()) {
+      auto &get_requests = object_request_iter->second;
+      // Erase get_request from the vector.
+      auto it = std::find(get_requests.begin(), get_requests.end(), get_request);
+      if (it != get_requests.end()) {
+        get_requests.erase(it);
+        // If the vector is empty, remove the object ID from the map.
+        if (get_requests.empty()) {
+          shard.object_get_requests.erase(object_request_iter);
+        }
       }
     }
+  }
 
-    // Remove get request.
-    for (const auto &object_id : get_request->ObjectIds()) {
-      auto object_request_iter = object_get_requests_.find(object_id);
-      if (object_request_iter != object_get_requests_.end()) {
-        auto &get_requests = object_request_iter->second;
-        // Erase get_request from the vector.
-        auto it = std::find(get_requests.begin(), get_requests.end(), get_request);
-        if (it != get_requests.end()) {
-          get_requests.erase(it);
-          // If the vector is empty, remove the object ID from the map.
-          if (get_requests.empty()) {
-            object_get_requests_.erase(object_request_iter);
-          }
-        }
-      }
+  // Populate results.
+  for (size_t i = 0; i < object_ids.size(); i++) {
+    const auto &object_id = object_ids[i];
+    if ((*results)[i] == nullptr) {
+      (*results)[i] = get_request->Get(object_id);
     }
   }
 
@@ -475,35 +503,38 @@ Status CoreWorkerMemoryStore::Wait(const absl::flat_hash_set<ObjectID> &object_i
 
 void CoreWorkerMemoryStore::Delete(const absl::flat_hash_set<ObjectID> &object_ids,
                                    absl::flat_hash_set<ObjectID> *plasma_ids_to_delete) {
-  absl::MutexLock lock(&mu_);
   for (const auto &object_id : object_ids) {
-    auto it = objects_.find(object_id);
-    if (it != objects_.end()) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    auto it = shard.objects.find(object_id);
+    if (it != shard.objects.end()) {
       if (it->second->IsInPlasmaError()) {
         plasma_ids_to_delete->insert(object_id);
       } else {
         OnDelete(it->second);
-        EraseObjectAndUpdateStats(object_id);
+        EraseObjectAndUpdateStats(shard, object_id);
       }
     }
   }
 }
 
 void CoreWorkerMemoryStore::Delete(const std::vector<ObjectID> &object_ids) {
-  absl::MutexLock lock(&mu_);
   for (const auto &object_id : object_ids) {
-    auto it = objects_.find(object_id);
-    if (it != objects_.end()) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    auto it = shard.objects.find(object_id);
+    if (it != shard.objects.end()) {
       OnDelete(it->second);
-      EraseObjectAndUpdateStats(object_id);
+      EraseObjectAndUpdateStats(shard, object_id);
     }
   }
 }
 
 bool CoreWorkerMemoryStore::Contains(const ObjectID &object_id, bool *in_plasma) {
-  absl::MutexLock lock(&mu_);
-  auto it = objects_.find(object_id);
-  if (it != objects_.end()) {
+  auto &shard = GetShard(object_id);
+  absl::MutexLock lock(&shard.mu);
+  auto it = shard.objects.find(object_id);
+  if (it != shard.objects.end()) {
     if (it->second->IsInPlasmaError()) {
       *in_plasma = true;
     }
@@ -512,6 +543,15 @@ bool CoreWorkerMemoryStore::Contains(const ObjectID &object_id, bool *in_plasma)
   return false;
 }
 
+int CoreWorkerMemoryStore::Size() {
+  int size = 0;
+  for (const auto &shard : shards_) {
+    absl::MutexLock lock(&shard->mu);
+    size += shard->objects.size();
+  }
+  return size;
+}
+
 inline bool IsUnhandledError(const std::shared_ptr<RayObject> &obj) {
   rpc::ErrorType error_type;
   // TODO(ekl) note that this doesn't warn on errors that are stored in plasma.
@@ -529,67 +569,74 @@ void CoreWorkerMemoryStore::OnDelete(std::shared_ptr<RayObject> obj) {
 }
 
 void CoreWorkerMemoryStore::NotifyUnhandledErrors() {
-  absl::MutexLock lock(&mu_);
   int64_t threshold = absl::GetCurrentTimeNanos() - kUnhandledErrorGracePeriodNanos;
-  auto it = objects_.begin();
   int count = 0;
-  while (it != objects_.end() && count < kMaxUnhandledErrorScanItems) {
-    const auto &obj = it->second;
-    if (IsUnhandledError(obj) && obj->CreationTimeNanos() < threshold &&
-        unhandled_exception_handler_ != nullptr) {
-      obj->SetAccessed();
-      unhandled_exception_handler_(*obj);
+  for (const auto &shard : shards_) {
+    if (count >= kMaxUnhandledErrorScanItems) {
+      break;
+    }
+    absl::MutexLock lock(&shard->mu);
+    auto it = shard->objects.begin();
+    while (it != shard->objects.end() && count < kMaxUnhandledErrorScanItems) {
+      const auto &obj = it->second;
+      if (IsUnhandledError(obj) && obj->CreationTimeNanos() < threshold &&
+          unhandled_exception_handler_ != nullptr) {
+        obj->SetAccessed();
+        unhandled_exception_handler_(*obj);
+      }
+      it++;
+      count++;
     }
-    it++;
-    count++;
   }
 }
 
-inline void CoreWorkerMemoryStore::EraseObjectAndUpdateStats(const ObjectID &object_id) {
-  auto it = objects_.find(object_id);
-  if (it == objects_.end()) {
+inline void CoreWorkerMemoryStore::EraseObjectAndUpdateStats(Shard &shard,
+                                                             const ObjectID &object_id) {
+  auto it = shard.objects.find(object_id);
+  if (it == shard.objects.end()) {
     return;
   }
 
   if (it->second->IsInPlasmaError()) {
-    num_in_plasma_ -= 1;
+    shard.num_in_plasma -= 1;
   } else {
-    num_local_objects_ -= 1;
-    num_local_objects_bytes_ -= it->second->GetSize();
+    shard.num_local_objects -= 1;
+    shard.num_local_objects_bytes -= it->second->GetSize();
   }
-  RAY_CHECK(num_in_plasma_ >= 0 && num_local_objects_ >= 0 &&
-            num_local_objects_bytes_ >= 0);
-  objects_.erase(it);
+  RAY_CHECK(shard.num_in_plasma >= 0 && shard.num_local_objects >= 0 &&
+            shard.num_local_objects_bytes >= 0);
+  shard.objects.erase(it);
 }
 
 inline void CoreWorkerMemoryStore::EmplaceObjectAndUpdateStats(
-    const ObjectID &object_id, std::shared_ptr<RayObject> &object_entry) {
-  auto inserted = objects_.emplace(object_id, object_entry).second;
+    Shard &shard, const ObjectID &object_id, std::shared_ptr<RayObject> &object_entry) {
+  auto inserted = shard.objects.emplace(object_id, object_entry).second;
   if (inserted) {
     if (object_entry->IsInPlasmaError()) {
-      num_in_plasma_ += 1;
+      shard.num_in_plasma += 1;
     } else {
-      num_local_objects_ += 1;
-      num_local_objects_bytes_ += object_entry->GetSize();
+      shard.num_local_objects += 1;
+      shard.num_local_objects_bytes += object_entry->GetSize();
     }
   }
-  RAY_CHECK(num_in_plasma_ >= 0 && num_local_objects_ >= 0 &&
-            num_local_objects_bytes_ >= 0);
+  RAY_CHECK(shard.num_in_plasma >= 0 && shard.num_local_objects >= 0 &&
+            shard.num_local_objects_bytes >= 0);
 }
 
 MemoryStoreStats CoreWorkerMemoryStore::GetMemoryStoreStatisticalData() {
-  absl::MutexLock lock(&mu_);
   MemoryStoreStats item;
-  item.num_in_plasma = num_in_plasma_;
-  item.num_local_objects = num_local_objects_;
-  item.num_local_objects_bytes = num_local_objects_bytes_;
+  for (const auto &shard : shards_) {
+    absl::MutexLock lock(&shard->mu);
+    item.num_in_plasma += shard->num_in_plasma;
+    item.num_local_objects += shard->num_local_objects;
+    item.num_local_objects_bytes += shard->num_local_objects_bytes;
+  }
   return item;
 }
 
 void CoreWorkerMemoryStore::RecordMetrics() {
-  absl::MutexLock lock(&mu_);
   ray::stats::STATS_object_store_memory.Record(
-      num_local_objects_bytes_,
+      GetMemoryStoreStatisticalData().num_local_objects_bytes,
       {{ray::stats::LocationKey, ray::stats::kObjectLocWorkerHeap}});
 }
 
@@ -40,6 +40,10 @@ class CoreWorkerMemoryStore;
 /// The class provides implementations for local process memory store.
 /// An example usage for this is to retrieve the returned objects from direct
 /// actor call (see direct_actor_transport.cc).
+///
+/// Objects are sharded by ID into independently locked shards, so that threads
+/// putting and getting different objects, such as the threads of a threaded actor
+/// and the task completion callbacks, don't contend on a single lock.
 class CoreWorkerMemoryStore {
  public:
   /// Create a memory store.
@@ -142,10 +146,7 @@ class CoreWorkerMemoryStore {
   /// Returns the number of objects in this store.
   ///
   /// \return Count of objects in the store.
-  int Size() {
-    absl::MutexLock lock(&mu_);
-    return objects_.size();
-  }
+  int Size();
 
   /// Returns stats data of memory usage.
   ///
@@ -183,14 +184,49 @@ class CoreWorkerMemoryStore {
   /// Called when an object is deleted from the store.
   void OnDelete(std::shared_ptr<RayObject> obj);
 
-  /// Emplace the given object entry to the in-memory-store and update stats properly.
-  void EmplaceObjectAndUpdateStats(const ObjectID &object_id,
-                                   std::shared_ptr<RayObject> &object_entry)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  /// A subset of the objects in the store, and the requests waiting for them.
+  struct Shard {
+    /// Protects the data structures below.
+    mutable absl::Mutex mu;
+
+    /// Map from object ID to `RayObject`.
+    /// NOTE: This map should be modified by EmplaceObjectAndUpdateStats and
+    /// EraseObjectAndUpdateStats.
+    absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> objects GUARDED_BY(mu);
+
+    /// Map from object ID to its get requests.
+    absl::flat_hash_map<ObjectID, std::vector<std::shared_ptr<GetRequest>>>
+        object_get_requests GUARDED_BY(mu);
+
+    /// Map from object ID to its async get requests.
+    absl::flat_hash_map<ObjectID,
+                        std::vector<std::function<void(std::shared_ptr<RayObject>)>>>
+        object_async_get_requests GUARDED_BY(mu);
+
+    /// Number of objects in the plasma store for this shard.
+    int32_t num_in_plasma GUARDED_BY(mu) = 0;
+    /// Number of objects that don't exist in the plasma store.
+    int32_t num_local_objects GUARDED_BY(mu) = 0;
+    /// Number of bytes used by this shard on heap, including both
+    /// placeholder values for objects in plasma and inlined small returned
+    /// objects from task.
+    int64_t num_local_objects_bytes GUARDED_BY(mu) = 0;
+  };
+
+  /// Get the shard that the object belongs to.
+  Shard &GetShard(const ObjectID &object_id) const {
+    return *shards_[object_id.Hash() % shards_.size()];
+  }
+
+  /// Emplace the given object entry to the shard and update stats properly.
+  static void EmplaceObjectAndUpdateStats(Shard &shard,
+                                          const ObjectID &object_id,
+                                          std::shared_ptr<RayObject> &object_entry)
+      EXCLUSIVE_LOCKS_REQUIRED(shard.mu);
 
-  /// Erase the object of the object id from the in memory store and update stats
-  /// properly.
-  void EraseObjectAndUpdateStats(const ObjectID &object_id) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  /// Erase the object of the object id from the shard and update stats properly.
+  static void EraseObjectAndUpdateStats(Shard &shard, const ObjectID &object_id)
+      EXCLUSIVE_LOCKS_REQUIRED(shard.mu);
 
   /// If enabled, holds a reference to local worker ref counter. TODO(ekl) make this
   /// mandatory once Java is supported.
@@ -199,22 +235,8 @@ class CoreWorkerMemoryStore {
   // If set, this will be used to notify worker blocked / unblocked on get calls.
   std::shared_ptr<raylet::RayletClient> raylet_client_ = nullptr;
 
-  /// Protects the data structures below.
-  mutable absl::Mutex mu_;
-
-  /// Map from object ID to `RayObject`.
-  /// NOTE: This map should be modified by EmplaceObjectAndUpdateStats and
-  /// EraseObjectAndUpdateStats.
-  absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> objects_ GUARDED_BY(mu_);
-
-  /// Map from object ID to its get requests.
-  absl::flat_hash_map<ObjectID, std::vector<std::shared_ptr<GetRequest>>>
-      object_get_requests_ GUARDED_BY(mu_);
-
-  /// Map from object ID to its async get requests.
-  absl::flat_hash_map<ObjectID,
-                      std::vector<std::function<void(std::shared_ptr<RayObject>)>>>
-      object_async_get_requests_ GUARDED_BY(mu_);
+  /// The shards of the store. Immutable after construction.
+  std::vector<std::unique_ptr<Shard>> shards_;
 
   /// Function passed in to be called to check for signals (e.g., Ctrl-C).
   std::function<Status()> check_signals_;
@@ -222,18 +244,6 @@ class CoreWorkerMemoryStore {
   /// Function called to report unhandled exceptions.
   std::function<void(const RayObject &)> unhandled_exception_handler_;
 
-  ///
-  /// Below information is stats.
-  ///
-  /// Number of objects in the plasma store for this memory store.
-  int32_t num_in_plasma_ GUARDED_BY(mu_) = 0;
-  /// Number of objects that don't exist in the plasma store.
-  int32_t num_local_objects_ GUARDED_BY(mu_) = 0;
-  /// Number of bytes used by this memory store on heap, including both
-  /// placeholder values for objects in plasma and inlined small returned
-  /// objects from task.
-  int64_t num_local_objects_bytes_ GUARDED_BY(mu_) = 0;
-
   /// This lambda is used to allow language frontend to allocate the objects
   /// in the memory store.
   std::function<std::shared_ptr<RayObject>(const RayObject &object,
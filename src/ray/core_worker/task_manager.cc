@@ -30,6 +30,59 @@ const int64_t kTaskFailureThrottlingThreshold = 50;
 // Throttle task failure logs to once this interval.
 const int64_t kTaskFailureLoggingFrequencyMillis = 5000;
 
+namespace {
+
+/// Append the objects that the task depends on, i.e. its arguments passed by
+/// reference and the references inlined in its other arguments.
+void AppendTaskDependencies(const TaskSpecification &spec,
+                            std::vector<ObjectID> *task_deps) {
+  for (size_t i = 0; i < spec.NumArgs(); i++) {
+    if (spec.ArgByRef(i)) {
+      task_deps->push_back(spec.ArgId(i));
+    } else {
+      const auto &inlined_refs = spec.ArgInlinedRefs(i);
+      for (const auto &inlined_ref : inlined_refs) {
+        task_deps->push_back(ObjectID::FromBinary(inlined_ref.object_id()));
+      }
+    }
+  }
+}
+
+/// Fill in the info of a task that is owned by this worker.
+void FillTaskInfoEntry(const TaskSpecification &task_spec,
+                       rpc::TaskStatus task_state,
+                       const NodeID &node_id,
+                       rpc::TaskInfoEntry *entry) {
+  rpc::TaskType type;
+  if (task_spec.IsNormalTask()) {
+    type = rpc::TaskType::NORMAL_TASK;
+  } else if (task_spec.IsActorCreationTask()) {
+    type = rpc::TaskType::ACTOR_CREATION_TASK;
+    entry->set_actor_id(task_spec.ActorCreationId().Binary());
+  } else {
+    RAY_CHECK(task_spec.IsActorTask());
+    type = rpc::TaskType::ACTOR_TASK;
+    entry->set_actor_id(task_spec.ActorId().Binary());
+  }
+  entry->set_type(type);
+  entry->set_name(task_spec.GetName());
+  entry->set_language(task_spec.GetLanguage());
+  entry->set_func_or_class_name(task_spec.FunctionDescriptor()->CallString());
+  entry->set_scheduling_state(task_state);
+  entry->set_job_id(task_spec.JobId().Binary());
+  if (!node_id.IsNil()) {
+    entry->set_node_id(node_id.Binary());
+  }
+  entry->set_task_id(task_spec.TaskId().Binary());
+  entry->set_parent_task_id(task_spec.ParentTaskId().Binary());
+  const auto &resources_map = task_spec.GetRequiredResources().GetResourceMap();
+  entry->mutable_required_resources()->insert(resources_map.begin(),
+                                              resources_map.end());
+  entry->mutable_runtime_env_info()->CopyFrom(task_spec.RuntimeEnvInfo());
+}
+
+}  // namespace
+
 std::vector<rpc::ObjectReference> TaskManager::AddPendingTask(
     const rpc::Address &caller_address,
     const TaskSpecification &spec,
@@ -115,6 +168,14 @@ bool TaskManager::ResubmitTask(const TaskID &task_id, std::vector<ObjectID> *tas
   TaskSpecification spec;
   bool resubmit = false;
   std::vector<ObjectID> return_ids;
+  // If the task was spilled, read its spec back before taking the lock, since
+  // this reads from disk.
+  const bool was_spilled = lineage_store_ != nullptr && lineage_store_->Contains(task_id);
+  absl::optional<TaskSpecification> spilled_spec;
+  if (was_spilled) {
+    spilled_spec = ReadSpilledLineage(task_id);
+  }
+  bool spilled_concurrently = false;
   {
     absl::MutexLock lock(&mu_);
     auto it = submissible_tasks_.find(task_id);
@@ -124,7 +185,18 @@ bool TaskManager::ResubmitTask(const TaskID &task_id, std::vector<ObjectID> *tas
       return false;
     }
 
-    if (!it->second.IsPending()) {
+    if (!it->second.IsPending() && it->second.IsSpilled() && !was_spilled) {
+      // The task was spilled after we checked. Read its spec back and try again.
+      spilled_concurrently = true;
+    } else if (!it->second.IsPending()) {
+      if (it->second.IsSpilled()) {
+        if (!spilled_spec.has_value()) {
+          RAY_LOG(ERROR) << "Failed to read the spilled lineage of task " << task_id
+                         << ", its return objects cannot be reconstructed.";
+          return false;
+        }
+        RestoreSpilledLineage(task_id, it->second, std::move(*spilled_spec));
+      }
       resubmit = true;
       MarkTaskRetryOnResubmit(it->second);
       num_pending_tasks_++;
@@ -148,17 +220,12 @@ bool TaskManager::ResubmitTask(const TaskID &task_id, std::vector<ObjectID> *tas
     }
   }
 
+  if (spilled_concurrently) {
+    return ResubmitTask(task_id, task_deps);
+  }
+
   if (resubmit) {
-    for (size_t i = 0; i < spec.NumArgs(); i++) {
-      if (spec.ArgByRef(i)) {
-        task_deps->push_back(spec.ArgId(i));
-      } else {
-        const auto &inlined_refs = spec.ArgInlinedRefs(i);
-        for (const auto &inlined_ref : inlined_refs) {
-          task_deps->push_back(ObjectID::FromBinary(inlined_ref.object_id()));
-        }
-      }
-    }
+    AppendTaskDependencies(spec, task_deps);
 
     reference_counter_->UpdateResubmittedTaskReferences(return_ids, *task_deps);
 
@@ -189,6 +256,27 @@ bool TaskManager::ResubmitTask(const TaskID &task_id, std::vector<ObjectID> *tas
   return true;
 }
 
+bool TaskManager::GetTaskDependencies(const TaskID &task_id,
+                                      std::vector<ObjectID> *task_deps) const {
+  absl::MutexLock lock(&mu_);
+  auto it = submissible_tasks_.find(task_id);
+  if (it == submissible_tasks_.end()) {
+    return false;
+  }
+  if (it->second.IsPending()) {
+    // The task will not be resubmitted, so it has no dependencies to recover.
+    return true;
+  }
+  if (it->second.IsSpilled()) {
+    task_deps->insert(task_deps->end(),
+                      it->second.spilled_arg_ids.begin(),
+                      it->second.spilled_arg_ids.end());
+  } else {
+    AppendTaskDependencies(it->second.spec, task_deps);
+  }
+  return true;
+}
+
 void TaskManager::DrainAndShutdown(std::function<void()> shutdown) {
   bool has_pending_tasks = false;
   {
@@ -400,6 +488,22 @@ void TaskManager::CompletePendingTask(const TaskID &task_id,
       release_lineage = false;
       it->second.lineage_footprint_bytes = it->second.spec.GetMessage().ByteSizeLong();
       total_lineage_footprint_bytes_ += it->second.lineage_footprint_bytes;
+      if (lineage_store_ != nullptr) {
+        lineage_spill_queue_.push_back(task_id);
+        // Drop the tasks that can no longer be spilled once they make up most
+        // of the queue, so that it doesn't grow while nothing is spilled.
+        if (lineage_spill_queue_.size() > 2 * submissible_tasks_.size()) {
+          std::deque<TaskID> spill_queue;
+          for (const auto &lineage_task_id : lineage_spill_queue_) {
+            auto lineage_it = submissible_tasks_.find(lineage_task_id);
+            if (lineage_it != submissible_tasks_.end() &&
+                !lineage_it->second.IsPending() && !lineage_it->second.IsSpilled()) {
+              spill_queue.push_back(lineage_task_id);
+            }
+          }
+          lineage_spill_queue_.swap(spill_queue);
+        }
+      }
       if (total_lineage_footprint_bytes_ > max_lineage_bytes_) {
         RAY_LOG(INFO) << "Total lineage size is " << total_lineage_footprint_bytes_ / 1e6
                       << "MB, which exceeds the limit of " << max_lineage_bytes_ / 1e6
@@ -413,8 +517,16 @@ void TaskManager::CompletePendingTask(const TaskID &task_id,
   }
 
   RemoveFinishedTaskReferences(spec, release_lineage, worker_addr, reply.borrowed_refs());
+  if (min_lineage_bytes_to_evict > 0 && lineage_store_ != nullptr) {
+    // Spill the oldest lineage first, and only evict lineage once the lineage
+    // store is full.
+    auto bytes_spilled = SpillLineage(min_lineage_bytes_to_evict);
+    RAY_LOG(INFO) << "Spilled " << bytes_spilled / 1e6 << "MB of task lineage, "
+                  << lineage_store_->NumBytes() / 1e6 << "MB is on disk.";
+    min_lineage_bytes_to_evict -= bytes_spilled;
+  }
   if (min_lineage_bytes_to_evict > 0) {
-    // Evict at least half of the current lineage.
+    // Evict at least half of the current lineage that is in memory.
     auto bytes_evicted = reference_counter_->EvictLineage(min_lineage_bytes_to_evict);
     RAY_LOG(INFO) << "Evicted " << bytes_evicted / 1e6 << "MB of task lineage.";
   }
@@ -674,18 +786,24 @@ int64_t TaskManager::RemoveLineageReference(const ObjectID &object_id,
   if (it->second.reconstructable_return_ids.empty() && !it->second.IsPending()) {
     // If the task can no longer be retried, decrement the lineage ref count
     // for each of the task's args.
-    for (size_t i = 0; i < it->second.spec.NumArgs(); i++) {
-      if (it->second.spec.ArgByRef(i)) {
-        released_objects->push_back(it->second.spec.ArgId(i));
-      } else {
-        const auto &inlined_refs = it->second.spec.ArgInlinedRefs(i);
-        for (const auto &inlined_ref : inlined_refs) {
-          released_objects->push_back(ObjectID::FromBinary(inlined_ref.object_id()));
+    if (it->second.IsSpilled()) {
+      released_objects->insert(released_objects->end(),
+                               it->second.spilled_arg_ids.begin(),
+                               it->second.spilled_arg_ids.end());
+      lineage_store_->Delete(task_id);
+    } else {
+      for (size_t i = 0; i < it->second.spec.NumArgs(); i++) {
+        if (it->second.spec.ArgByRef(i)) {
+          released_objects->push_back(it->second.spec.ArgId(i));
+        } else {
+          const auto &inlined_refs = it->second.spec.ArgInlinedRefs(i);
+          for (const auto &inlined_ref : inlined_refs) {
+            released_objects->push_back(ObjectID::FromBinary(inlined_ref.object_id()));
+          }
         }
       }
+      total_lineage_footprint_bytes_ -= it->second.lineage_footprint_bytes;
     }
-
-    total_lineage_footprint_bytes_ -= it->second.lineage_footprint_bytes;
     // The task has finished and none of the return IDs are in scope anymore,
     // so it is safe to remove the task spec.
     submissible_tasks_.erase(it);
@@ -752,9 +870,24 @@ void TaskManager::MarkTaskReturnObjectsFailed(
 }
 
 absl::optional<TaskSpecification> TaskManager::GetTaskSpec(const TaskID &task_id) const {
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = submissible_tasks_.find(task_id);
+    if (it == submissible_tasks_.end()) {
+      return absl::optional<TaskSpecification>();
+    }
+    if (!it->second.IsSpilled()) {
+      return it->second.spec;
+    }
+  }
+  auto spec = ReadSpilledLineage(task_id);
+  if (spec.has_value()) {
+    return spec;
+  }
+  // The spec may have been restored while it was read.
   absl::MutexLock lock(&mu_);
   auto it = submissible_tasks_.find(task_id);
-  if (it == submissible_tasks_.end()) {
+  if (it == submissible_tasks_.end() || it->second.IsSpilled()) {
     return absl::optional<TaskSpecification>();
   }
   return it->second.spec;
@@ -783,7 +916,8 @@ void TaskManager::AddTaskStatusInfo(rpc::CoreWorkerStats *stats) const {
       continue;
     }
     ref->set_task_status(it->second.GetStatus());
-    ref->set_attempt_number(it->second.spec.AttemptNumber());
+    ref->set_attempt_number(it->second.IsSpilled() ? it->second.spilled_attempt_number
+                                                   : it->second.spec.AttemptNumber());
   }
 }
 
@@ -865,53 +999,147 @@ void TaskManager::SetTaskStatus(
 
 void TaskManager::FillTaskInfo(rpc::GetCoreWorkerStatsReply *reply,
                                const int64_t limit) const {
-  absl::MutexLock lock(&mu_);
-  auto total = submissible_tasks_.size();
-  auto count = 0;
-  for (const auto &task_it : submissible_tasks_) {
-    if (limit != -1 && count >= limit) {
-      break;
-    }
-    count += 1;
-
-    const auto &task_entry = task_it.second;
-    auto entry = reply->add_owned_task_info_entries();
-    const auto &task_spec = task_entry.spec;
-    const auto &task_state = task_entry.GetStatus();
-    const auto &node_id = task_entry.GetNodeId();
-    rpc::TaskType type;
-    if (task_spec.IsNormalTask()) {
-      type = rpc::TaskType::NORMAL_TASK;
-    } else if (task_spec.IsActorCreationTask()) {
-      type = rpc::TaskType::ACTOR_CREATION_TASK;
-      entry->set_actor_id(task_spec.ActorCreationId().Binary());
-    } else {
-      RAY_CHECK(task_spec.IsActorTask());
-      type = rpc::TaskType::ACTOR_TASK;
-      entry->set_actor_id(task_spec.ActorId().Binary());
+  // The spilled tasks whose specs have to be read from disk after releasing the lock.
+  std::vector<std::tuple<TaskID, rpc::TaskStatus, NodeID>> spilled_tasks;
+  {
+    absl::MutexLock lock(&mu_);
+    auto total = submissible_tasks_.size();
+    auto count = 0;
+    for (const auto &task_it : submissible_tasks_) {
+      if (limit != -1 && count >= limit) {
+        break;
+      }
+      count += 1;
+
+      const auto &task_entry = task_it.second;
+      if (task_entry.IsSpilled()) {
+        spilled_tasks.emplace_back(
+            task_it.first, task_entry.GetStatus(), task_entry.GetNodeId());
+        continue;
+      }
+      FillTaskInfoEntry(task_entry.spec,
+                        task_entry.GetStatus(),
+                        task_entry.GetNodeId(),
+                        reply->add_owned_task_info_entries());
     }
-    entry->set_type(type);
-    entry->set_name(task_spec.GetName());
-    entry->set_language(task_spec.GetLanguage());
-    entry->set_func_or_class_name(task_spec.FunctionDescriptor()->CallString());
-    entry->set_scheduling_state(task_state);
-    entry->set_job_id(task_spec.JobId().Binary());
-    if (!node_id.IsNil()) {
-      entry->set_node_id(node_id.Binary());
+    reply->set_tasks_total(total);
+  }
+
+  for (const auto &spilled_task : spilled_tasks) {
+    const auto spec = ReadSpilledLineage(std::get<0>(spilled_task));
+    if (spec.has_value()) {
+      FillTaskInfoEntry(*spec,
+                        std::get<1>(spilled_task),
+                        std::get<2>(spilled_task),
+                        reply->add_owned_task_info_entries());
     }
-    entry->set_task_id(task_spec.TaskId().Binary());
-    entry->set_parent_task_id(task_spec.ParentTaskId().Binary());
-    const auto &resources_map = task_spec.GetRequiredResources().GetResourceMap();
-    entry->mutable_required_resources()->insert(resources_map.begin(),
-                                                resources_map.end());
-    entry->mutable_runtime_env_info()->CopyFrom(task_spec.RuntimeEnvInfo());
   }
-  reply->set_tasks_total(total);
 }
 
 void TaskManager::RecordMetrics() {
   absl::MutexLock lock(&mu_);
   task_counter_.FlushOnChangeCallbacks();
+  ray::stats::STATS_task_lineage_bytes.Record(total_lineage_footprint_bytes_,
+                                              {{"Location", "InMemory"}});
+  ray::stats::STATS_task_lineage_bytes.Record(
+      lineage_store_ == nullptr ? 0 : lineage_store_->NumBytes(),
+      {{"Location", "Spilled"}});
+}
+
+int64_t TaskManager::SpillLineage(int64_t min_bytes) {
+  struct SpilledSpec {
+    TaskID task_id;
+    int num_successful_executions;
+    int32_t attempt_number;
+    std::string data;
+  };
+  // Pick the oldest lineage and serialize it under the lock, but write it to
+  // the lineage store without holding the lock.
+  std::vector<SpilledSpec> specs;
+  {
+    absl::MutexLock lock(&mu_);
+    int64_t bytes_picked = 0;
+    while (bytes_picked < min_bytes && !lineage_spill_queue_.empty()) {
+      const TaskID task_id = lineage_spill_queue_.front();
+      lineage_spill_queue_.pop_front();
+      auto it = submissible_tasks_.find(task_id);
+      if (it == submissible_tasks_.end() || it->second.IsPending() ||
+          it->second.IsSpilled() || it->second.spilling) {
+        continue;
+      }
+      it->second.spilling = true;
+      specs.push_back({task_id,
+                       it->second.num_successful_executions,
+                       it->second.spec.AttemptNumber(),
+                       it->second.spec.GetMessage().SerializeAsString()});
+      bytes_picked += it->second.lineage_footprint_bytes;
+    }
+  }
+
+  size_t num_written = 0;
+  while (num_written < specs.size() &&
+         lineage_store_->Put(specs[num_written].task_id, specs[num_written].data)) {
+    num_written++;
+  }
+
+  int64_t bytes_spilled = 0;
+  // The tasks that didn't fit in the lineage store. They are still the oldest
+  // lineage, so they go back to the front of the queue.
+  std::vector<TaskID> not_spilled;
+  absl::MutexLock lock(&mu_);
+  for (size_t i = 0; i < specs.size(); i++) {
+    const auto &task_id = specs[i].task_id;
+    auto it = submissible_tasks_.find(task_id);
+    if (it != submissible_tasks_.end()) {
+      it->second.spilling = false;
+    }
+    // The task may have been released or resubmitted while its spec was
+    // written, in which case the spilled spec is not needed.
+    const bool still_lineage =
+        it != submissible_tasks_.end() && !it->second.IsPending() &&
+        it->second.num_successful_executions == specs[i].num_successful_executions;
+    if (i >= num_written) {
+      if (still_lineage) {
+        not_spilled.push_back(task_id);
+      }
+      continue;
+    }
+    if (!still_lineage) {
+      lineage_store_->Delete(task_id);
+      continue;
+    }
+
+    auto &task_entry = it->second;
+    AppendTaskDependencies(task_entry.spec, &task_entry.spilled_arg_ids);
+    task_entry.spilled_attempt_number = specs[i].attempt_number;
+    task_entry.spec = TaskSpecification();
+    task_entry.spec_spilled = true;
+    total_lineage_footprint_bytes_ -= task_entry.lineage_footprint_bytes;
+    bytes_spilled += task_entry.lineage_footprint_bytes;
+  }
+  lineage_spill_queue_.insert(
+      lineage_spill_queue_.begin(), not_spilled.begin(), not_spilled.end());
+  return bytes_spilled;
+}
+
+void TaskManager::RestoreSpilledLineage(const TaskID &task_id,
+                                        TaskEntry &task_entry,
+                                        TaskSpecification spec) {
+  RAY_LOG(DEBUG) << "Restored spilled lineage of task " << task_id;
+  lineage_store_->Delete(task_id);
+  task_entry.spec = std::move(spec);
+  task_entry.spec_spilled = false;
+  task_entry.spilled_arg_ids.clear();
+  total_lineage_footprint_bytes_ += task_entry.lineage_footprint_bytes;
+}
+
+absl::optional<TaskSpecification> TaskManager::ReadSpilledLineage(
+    const TaskID &task_id) const {
+  std::string data;
+  if (lineage_store_ == nullptr || !lineage_store_->Get(task_id, &data)) {
+    return absl::nullopt;
+  }
+  return TaskSpecification(data);
 }
 
 void TaskManager::RecordTaskStatusEvent(
@@ -936,15 +1164,24 @@ void TaskManager::RecordTaskStatusEvent(
 }
 
 ObjectID TaskManager::TaskGeneratorId(const TaskID &task_id) const {
-  absl::MutexLock lock(&mu_);
-  auto it = submissible_tasks_.find(task_id);
-  if (it == submissible_tasks_.end()) {
-    return ObjectID::Nil();
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = submissible_tasks_.find(task_id);
+    if (it == submissible_tasks_.end()) {
+      return ObjectID::Nil();
+    }
+    if (!it->second.IsSpilled()) {
+      if (!it->second.spec.ReturnsDynamic()) {
+        return ObjectID::Nil();
+      }
+      return it->second.spec.ReturnId(0);
+    }
   }
-  if (!it->second.spec.ReturnsDynamic()) {
+  const auto spec = GetTaskSpec(task_id);
+  if (!spec.has_value() || !spec->ReturnsDynamic()) {
     return ObjectID::Nil();
   }
-  return it->second.spec.ReturnId(0);
+  return spec->ReturnId(0);
 }
 
 }  // namespace core
@@ -14,11 +14,14 @@
 
 #pragma once
 
+#include <deque>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
 #include "ray/common/task/task.h"
+#include "ray/core_worker/lineage_store.h"
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 #include "ray/core_worker/task_event_buffer.h"
 #include "ray/stats/metric_defs.h"
@@ -73,6 +76,9 @@ class TaskResubmissionInterface {
  public:
   virtual bool ResubmitTask(const TaskID &task_id, std::vector<ObjectID> *task_deps) = 0;
 
+  virtual bool GetTaskDependencies(const TaskID &task_id,
+                                   std::vector<ObjectID> *task_deps) const = 0;
+
   virtual ~TaskResubmissionInterface() {}
 };
 
@@ -95,13 +101,15 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
               RetryTaskCallback retry_task_callback,
               PushErrorCallback push_error_callback,
               int64_t max_lineage_bytes,
-              worker::TaskEventBuffer &task_event_buffer)
+              worker::TaskEventBuffer &task_event_buffer,
+              std::unique_ptr<LineageStore> lineage_store = nullptr)
       : in_memory_store_(in_memory_store),
         reference_counter_(reference_counter),
         put_in_local_plasma_callback_(put_in_local_plasma_callback),
         retry_task_callback_(retry_task_callback),
         push_error_callback_(push_error_callback),
         max_lineage_bytes_(max_lineage_bytes),
+        lineage_store_(std::move(lineage_store)),
         task_event_buffer_(task_event_buffer) {
     task_counter_.SetOnChangeCallback(
         [this](const std::tuple<std::string, rpc::TaskStatus, bool> key)
@@ -150,6 +158,17 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   /// already pending, Invalid if the task spec is no longer present.
   bool ResubmitTask(const TaskID &task_id, std::vector<ObjectID> *task_deps) override;
 
+  /// Get the dependencies that a task would have if it were resubmitted now,
+  /// without resubmitting it. This is used to resubmit lost lineage in
+  /// dependency order.
+  ///
+  /// \param[in] task_id The ID of the task.
+  /// \param[out] task_deps The object dependencies of the task. This is not
+  /// populated if the task is already pending.
+  /// \return Whether the task can be resubmitted or is already pending.
+  bool GetTaskDependencies(const TaskID &task_id,
+                           std::vector<ObjectID> *task_deps) const override;
+
   /// Wait for all pending tasks to finish, and then shutdown.
   ///
   /// \param shutdown The shutdown callback to call.
@@ -273,11 +292,17 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   /// Return the number of pending tasks.
   size_t NumPendingTasks() const;
 
+  /// Return the size of the task specs that are kept in memory as lineage.
   int64_t TotalLineageFootprintBytes() const {
     absl::MutexLock lock(&mu_);
     return total_lineage_footprint_bytes_;
   }
 
+  /// Return the size of the task specs that were spilled to the lineage store.
+  int64_t SpilledLineageBytes() const {
+    return lineage_store_ == nullptr ? 0 : lineage_store_->NumBytes();
+  }
+
   /// Record that the given task's dependencies have been created and the task
   /// can now be scheduled for execution.
   ///
@@ -381,6 +406,10 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
       return GetStatus() == rpc::TaskStatus::SUBMITTED_TO_WORKER;
     }
 
+    /// Whether the task spec was spilled to the lineage store. Only tasks
+    /// that finished and are pinned as lineage are spilled.
+    bool IsSpilled() const { return spec_spilled; }
+
     /// The task spec. This is pinned as long as the following are true:
     /// - The task is still pending execution. This means that the task may
     /// fail and so it may be retried in the future.
@@ -392,7 +421,8 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
     /// the worker fails. We could avoid this by either not caching the full
     /// TaskSpec for tasks that cannot be retried (e.g., actor tasks), or by
     /// storing a shared_ptr to a PushTaskRequest protobuf for all tasks.
-    const TaskSpecification spec;
+    /// This is empty if the spec was spilled to the lineage store.
+    TaskSpecification spec;
     // Number of times this task may be resubmitted. If this reaches 0, then
     // the task entry may be erased.
     int32_t num_retries_left;
@@ -420,6 +450,17 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
     int64_t lineage_footprint_bytes = 0;
     // Number of times this task successfully completed execution so far.
     int num_successful_executions = 0;
+    // Whether the spec was spilled to the lineage store.
+    bool spec_spilled = false;
+    // Whether the spec is being written to the lineage store. The spec stays
+    // in memory until the write finishes.
+    bool spilling = false;
+    // If the spec was spilled, the objects that the task's lineage pins, i.e.
+    // the task's arguments. These are kept in memory so that the lineage can
+    // be released without reading back the spec.
+    std::vector<ObjectID> spilled_arg_ids;
+    // If the spec was spilled, the attempt number of the spec.
+    int32_t spilled_attempt_number = 0;
 
    private:
     // The task's current execution and metric status (name, status, is_retry).
@@ -473,6 +514,29 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   absl::flat_hash_set<ObjectID> GetTaskReturnObjectsToStoreInPlasma(
       const TaskID &task_id, bool *first_execution = nullptr) const LOCKS_EXCLUDED(mu_);
 
+  /// Spill the specs of the tasks that became lineage the longest time ago to
+  /// the lineage store. The specs are picked under the lock but written to
+  /// disk without holding it.
+  ///
+  /// \param[in] min_bytes The amount of lineage to spill.
+  /// \return The amount of lineage that was spilled, in bytes. This is less
+  /// than min_bytes if the lineage store is full.
+  int64_t SpillLineage(int64_t min_bytes) LOCKS_EXCLUDED(mu_);
+
+  /// Put the spec of a task that was spilled back into its entry and remove
+  /// it from the lineage store.
+  void RestoreSpilledLineage(const TaskID &task_id,
+                             TaskEntry &task_entry,
+                             TaskSpecification spec) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Read the spec of a task from the lineage store. This reads from disk, so
+  /// it must not be called while holding the lock.
+  ///
+  /// \return The spec, or nullopt if the task is not spilled or the spec
+  /// could not be read.
+  absl::optional<TaskSpecification> ReadSpilledLineage(const TaskID &task_id) const
+      LOCKS_EXCLUDED(mu_);
+
   /// Shutdown if all tasks are finished and shutdown is scheduled.
   void ShutdownIfNeeded() LOCKS_EXCLUDED(mu_);
 
@@ -550,8 +614,20 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   /// execution.
   size_t num_pending_tasks_ = 0;
 
+  /// The size of the task specs that are pinned in memory as lineage. This
+  /// does not include specs spilled to the lineage store.
   int64_t total_lineage_footprint_bytes_ GUARDED_BY(mu_) = 0;
 
+  /// If set, lineage over max_lineage_bytes_ is spilled here and only evicted
+  /// once the store is full. The store is thread-safe, and it's only read and
+  /// written without holding mu_ since that does disk I/O.
+  const std::unique_ptr<LineageStore> lineage_store_;
+
+  /// Tasks in the order that they became lineage, used to pick the lineage
+  /// to spill first. This may contain tasks that were since resubmitted,
+  /// spilled or released, which are skipped when spilling.
+  std::deque<TaskID> lineage_spill_queue_ GUARDED_BY(mu_);
+
   /// Optional shutdown hook to call when pending tasks all finish.
   std::function<void()> shutdown_hook_ GUARDED_BY(mu_) = nullptr;
 
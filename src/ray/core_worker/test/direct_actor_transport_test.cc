@@ -16,6 +16,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/ray_config.h"
 #include "ray/common/task/task_spec.h"
 #include "ray/common/test_util.h"
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
@@ -84,6 +85,11 @@ class MockWorkerClient : public rpc::CoreWorkerClientInterface {
     callbacks.push_back(callback);
   }
 
+  void PushActorTasks(rpc::PushTaskBatch batch) override {
+    batch_sizes.push_back(batch.size());
+    rpc::CoreWorkerClientInterface::PushActorTasks(std::move(batch));
+  }
+
   int64_t ClientProcessedUpToSeqno() override { return acked_seqno; }
 
   bool ReplyPushTask(Status status = Status::OK(), size_t index = 0) {
@@ -99,6 +105,7 @@ class MockWorkerClient : public rpc::CoreWorkerClientInterface {
   rpc::Address addr;
   std::vector<rpc::ClientCallback<rpc::PushTaskReply>> callbacks;
   std::vector<uint64_t> received_seq_nos;
+  std::vector<size_t> batch_sizes;
   int64_t acked_seqno = 0;
 };
 
@@ -124,7 +131,10 @@ class DirectActorSubmitterTest : public ::testing::TestWithParam<bool> {
             },
             io_context) {}
 
-  void TearDown() override { io_context.stop(); }
+  void TearDown() override {
+    io_context.stop();
+    RayConfig::instance().initialize("");
+  }
 
   int num_clients_connected_ = 0;
   int64_t last_queue_warning_ = 0;
@@ -697,6 +707,94 @@ TEST_P(DirectActorSubmitterTest, TestPendingTasks) {
   ASSERT_FALSE(submitter_.PendingTasksFull(actor_id));
 }
 
+TEST_P(DirectActorSubmitterTest, TestBatchedSubmitTask) {
+  auto execute_out_of_order = GetParam();
+  // Only full batches are sent during the test.
+  RayConfig::instance().initialize(
+      R"({"actor_task_batch_max_size": 3, "actor_task_batch_window_us": 60000000})");
+  CoreWorkerDirectActorTaskSubmitter submitter(
+      *client_pool_,
+      *store_,
+      *task_finisher_,
+      actor_creator_,
+      [](const ActorID &actor_id, int64_t num_queued) {},
+      io_context);
+  rpc::Address addr;
+  auto worker_id = WorkerID::FromRandom();
+  addr.set_worker_id(worker_id.Binary());
+  ActorID actor_id = ActorID::Of(JobID::FromInt(0), TaskID::Nil(), 0);
+  submitter.AddActorQueueIfNotExists(actor_id, -1, execute_out_of_order);
+  submitter.ConnectActor(actor_id, addr, 0);
+
+  for (int i = 0; i < 5; i++) {
+    auto task = CreateActorTaskHelper(actor_id, worker_id, i);
+    ASSERT_TRUE(submitter.SubmitTask(task).ok());
+  }
+  io_context.poll();
+  if (execute_out_of_order) {
+    // Tasks to out of order actors are not batched.
+    ASSERT_TRUE(worker_client_->batch_sizes.empty());
+    ASSERT_THAT(worker_client_->received_seq_nos, ElementsAre(0, 1, 2, 3, 4));
+    return;
+  }
+  // The first three tasks are sent in one batch, in order. The other two wait
+  // for the batch to fill up.
+  ASSERT_THAT(worker_client_->batch_sizes, ElementsAre(3));
+  ASSERT_THAT(worker_client_->received_seq_nos, ElementsAre(0, 1, 2));
+
+  EXPECT_CALL(*task_finisher_, CompletePendingTask(_, _, _, _)).Times(3);
+  while (!worker_client_->callbacks.empty()) {
+    ASSERT_TRUE(worker_client_->ReplyPushTask());
+  }
+
+  // The actor restarts. The tasks that were waiting in the batch are failed like
+  // any other inflight task, and the batch is never sent.
+  EXPECT_CALL(*task_finisher_, FailOrRetryPendingTask(_, _, _, _, _, _))
+      .Times(2)
+      .WillRepeatedly(Return(true));
+  const auto death_cause = CreateMockDeathCause();
+  submitter.DisconnectActor(actor_id, 1, /*dead=*/false, death_cause);
+  io_context.poll();
+  ASSERT_THAT(worker_client_->batch_sizes, ElementsAre(3));
+}
+
+TEST_P(DirectActorSubmitterTest, TestBatchWindow) {
+  auto execute_out_of_order = GetParam();
+  RayConfig::instance().initialize(
+      R"({"actor_task_batch_max_size": 64, "actor_task_batch_window_us": 1000})");
+  CoreWorkerDirectActorTaskSubmitter submitter(
+      *client_pool_,
+      *store_,
+      *task_finisher_,
+      actor_creator_,
+      [](const ActorID &actor_id, int64_t num_queued) {},
+      io_context);
+  rpc::Address addr;
+  auto worker_id = WorkerID::FromRandom();
+  addr.set_worker_id(worker_id.Binary());
+  ActorID actor_id = ActorID::Of(JobID::FromInt(0), TaskID::Nil(), 0);
+  submitter.AddActorQueueIfNotExists(actor_id, -1, execute_out_of_order);
+  submitter.ConnectActor(actor_id, addr, 0);
+
+  for (int i = 0; i < 2; i++) {
+    auto task = CreateActorTaskHelper(actor_id, worker_id, i);
+    ASSERT_TRUE(submitter.SubmitTask(task).ok());
+  }
+  // The partial batch is sent once the window has passed.
+  io_context.run_for(std::chrono::milliseconds(100));
+  if (execute_out_of_order) {
+    ASSERT_TRUE(worker_client_->batch_sizes.empty());
+  } else {
+    ASSERT_THAT(worker_client_->batch_sizes, ElementsAre(2));
+  }
+  ASSERT_THAT(worker_client_->received_seq_nos, ElementsAre(0, 1));
+
+  EXPECT_CALL(*task_finisher_, CompletePendingTask(_, _, _, _)).Times(2);
+  while (!worker_client_->callbacks.empty()) {
+    ASSERT_TRUE(worker_client_->ReplyPushTask());
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(ExecuteOutOfOrder,
                          DirectActorSubmitterTest,
                          ::testing::Values(true, false));
@@ -764,8 +862,12 @@ class DirectActorReceiverTest : public ::testing::Test {
     return Status::OK();
   }
 
+  void TearDown() override { RayConfig::instance().initialize(""); }
+
   void StartIOService() { main_io_service_.run(); }
 
+  instrumented_io_context &GetIOService() { return main_io_service_; }
+
   void StopIOService() {
     // We must delete the receiver before stopping the IO service, since it
     // contains timers referencing the service.
@@ -872,6 +974,149 @@ TEST_F(DirectActorReceiverTest, TestNewTaskFromDifferentWorker) {
   StopIOService();
 }
 
+TEST_F(DirectActorReceiverTest, TestTaskBatch) {
+  ActorID actor_id = ActorID::Of(JobID::FromInt(0), TaskID::Nil(), 0);
+  WorkerID worker_id = WorkerID::FromRandom();
+  TaskID caller_id = TaskID::ForActorTask(JobID::FromInt(0), TaskID::Nil(), 0, actor_id);
+  int64_t curr_timestamp = current_sys_time_ms();
+
+  // The tasks are pushed in reverse order. The scheduling queue still executes them
+  // in sequence number order.
+  rpc::PushTasksRequest request;
+  std::vector<std::string> task_ids;
+  for (int i = 2; i >= 0; i--) {
+    request.add_requests()->CopyFrom(
+        CreatePushTaskRequestHelper(actor_id, i, worker_id, caller_id, curr_timestamp));
+    task_ids.push_back(request.requests().rbegin()->task_spec().task_id());
+  }
+  rpc::PushTasksReply reply;
+  int callback_count = 0;
+  auto reply_callback = [&callback_count](Status status,
+                                          std::function<void()> success,
+                                          std::function<void()> failure) {
+    ++callback_count;
+    ASSERT_TRUE(status.ok());
+  };
+  absl::Mutex mu;
+  std::vector<rpc::ReportActorTaskReplyRequest> task_replies;
+  receiver_->UpdateConcurrencyGroupsCache(actor_id, {});
+  CoreWorkerDirectTaskReceiver::HandleTaskBatch(
+      request,
+      &reply,
+      reply_callback,
+      [this](rpc::PushTaskRequest request,
+             rpc::PushTaskReply *reply,
+             rpc::SendReplyCallback send_reply_callback) {
+        receiver_->HandleTask(request, reply, send_reply_callback);
+      },
+      [&](const rpc::Address &caller_address,
+          const rpc::ReportActorTaskReplyRequest &task_reply,
+          std::function<void(const Status &)> on_sent) {
+        ASSERT_EQ(caller_address.worker_id(), worker_id.Binary());
+        {
+          absl::MutexLock lock(&mu);
+          task_replies.push_back(task_reply);
+        }
+        on_sent(Status::OK());
+      },
+      [](const rpc::Address &caller_address,
+         const Status &status,
+         std::function<void(bool)> on_checked) { on_checked(false); },
+      GetIOService());
+  // The batch is replied to once the tasks are queued, before any of them finishes.
+  ASSERT_EQ(callback_count, 1);
+
+  // Each task is replied to on its own once it finishes.
+  StartIOService();
+  ASSERT_TRUE(WaitForCondition(
+      [&]() {
+        absl::MutexLock lock(&mu);
+        return task_replies.size() == 3;
+      },
+      10 * 1000));
+  absl::MutexLock lock(&mu);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(task_replies[i].intended_worker_id(), worker_id.Binary());
+    ASSERT_EQ(task_replies[i].task_id(), task_ids[2 - i]);
+    ASSERT_TRUE(task_replies[i].status_code().empty());
+  }
+
+  StopIOService();
+}
+
+TEST_F(DirectActorReceiverTest, TestTaskBatchReportFailure) {
+  RayConfig::instance().initialize(
+      R"({"actor_task_reply_report_initial_retry_delay_ms": 1})");
+  ActorID actor_id = ActorID::Of(JobID::FromInt(0), TaskID::Nil(), 0);
+  WorkerID worker_id = WorkerID::FromRandom();
+  TaskID caller_id = TaskID::ForActorTask(JobID::FromInt(0), TaskID::Nil(), 0, actor_id);
+  int64_t curr_timestamp = current_sys_time_ms();
+
+  rpc::PushTasksRequest request;
+  std::vector<std::string> task_ids;
+  for (int i = 0; i < 3; i++) {
+    request.add_requests()->CopyFrom(
+        CreatePushTaskRequestHelper(actor_id, i, worker_id, caller_id, curr_timestamp));
+    task_ids.push_back(request.requests().rbegin()->task_spec().task_id());
+  }
+  rpc::PushTasksReply reply;
+  auto reply_callback = [](Status status,
+                           std::function<void()> success,
+                           std::function<void()> failure) {
+    ASSERT_TRUE(status.ok());
+  };
+  // The report of the first task is dropped twice, and the caller is still alive,
+  // so it is retried until it gets through. The report of the second task is
+  // rejected because the caller is dead, so it is given up on.
+  absl::flat_hash_map<std::string, int> num_attempts;
+  std::vector<std::string> reported_task_ids;
+  int num_checks = 0;
+  receiver_->UpdateConcurrencyGroupsCache(actor_id, {});
+  CoreWorkerDirectTaskReceiver::HandleTaskBatch(
+      request,
+      &reply,
+      reply_callback,
+      [this](rpc::PushTaskRequest request,
+             rpc::PushTaskReply *reply,
+             rpc::SendReplyCallback send_reply_callback) {
+        receiver_->HandleTask(request, reply, send_reply_callback);
+      },
+      [&](const rpc::Address &caller_address,
+          const rpc::ReportActorTaskReplyRequest &task_reply,
+          std::function<void(const Status &)> on_sent) {
+        int attempt = ++num_attempts[task_reply.task_id()];
+        if (task_reply.task_id() == task_ids[0] && attempt <= 2) {
+          on_sent(Status::GrpcUnavailable("dropped"));
+        } else if (task_reply.task_id() == task_ids[1]) {
+          on_sent(Status::Invalid("wrong recipient"));
+        } else {
+          reported_task_ids.push_back(task_reply.task_id());
+          on_sent(Status::OK());
+        }
+      },
+      [&](const rpc::Address &caller_address,
+          const Status &status,
+          std::function<void(bool)> on_checked) {
+        num_checks++;
+        on_checked(status.IsInvalid());
+      },
+      GetIOService());
+
+  // The io service runs until the reports are done, so a report that is retried
+  // forever would hang the test.
+  StartIOService();
+  ASSERT_EQ(num_attempts[task_ids[0]], 3);
+  ASSERT_EQ(num_attempts[task_ids[1]], 1);
+  ASSERT_EQ(num_attempts[task_ids[2]], 1);
+  ASSERT_EQ(num_checks, 3);
+  std::vector<std::string> expected_task_ids = {task_ids[0], task_ids[2]};
+  std::sort(reported_task_ids.begin(), reported_task_ids.end());
+  std::sort(expected_task_ids.begin(), expected_task_ids.end());
+  ASSERT_EQ(reported_task_ids, expected_task_ids);
+
+  StopIOService();
+}
+
 }  // namespace core
 }  // namespace ray
 
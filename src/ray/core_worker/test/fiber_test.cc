@@ -0,0 +1,166 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/fiber.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+
+#if defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+// Emulate GCC's __SANITIZE_THREAD__ flag
+#define __SANITIZE_THREAD__
+#endif
+#endif
+
+namespace ray {
+namespace core {
+
+// boost fiber doesn't have tsan support yet
+// https://github.com/boostorg/context/issues/124
+#ifndef __SANITIZE_THREAD__
+
+void WaitFor(const std::atomic<int> &counter, int value) {
+  while (counter < value) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+}
+
+/// The resident set size of this process, or 0 if it is unknown.
+int64_t GetRSSBytes() {
+  std::ifstream statm("/proc/self/statm");
+  int64_t size = 0;
+  int64_t resident = 0;
+  if (!(statm >> size >> resident)) {
+    return 0;
+  }
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+class FiberStateTest : public ::testing::Test {
+ public:
+  void TearDown() override { RayConfig::instance().initialize(""); }
+};
+
+TEST_F(FiberStateTest, TestMaxConcurrency) {
+  FiberState fiber_state(2);
+  std::vector<std::unique_ptr<FiberEvent>> events;
+  for (int i = 0; i < 5; i++) {
+    events.push_back(std::make_unique<FiberEvent>());
+  }
+  std::atomic<int> started{0};
+  std::atomic<int> finished{0};
+  std::vector<int> start_order;
+  for (int i = 0; i < 5; i++) {
+    fiber_state.EnqueueFiber([&, i]() {
+      start_order.push_back(i);
+      started++;
+      events[i]->Wait();
+      finished++;
+    });
+  }
+  WaitFor(started, 2);
+  absl::SleepFor(absl::Milliseconds(10));
+  ASSERT_EQ(started, 2);
+
+  // Each finished call lets one queued call start, in the order they were queued.
+  events[1]->Notify();
+  WaitFor(started, 3);
+  events[0]->Notify();
+  WaitFor(started, 4);
+  absl::SleepFor(absl::Milliseconds(10));
+  ASSERT_EQ(started, 4);
+  for (int i = 2; i < 5; i++) {
+    events[i]->Notify();
+  }
+  WaitFor(finished, 5);
+  ASSERT_EQ(start_order, (std::vector<int>{0, 1, 2, 3, 4}));
+
+  fiber_state.Stop();
+  fiber_state.Join();
+}
+
+/// Start num_calls calls that all wait for an event, of which at most
+/// max_concurrency run at once. Measure the memory that they use while in flight,
+/// and then the latency from notifying each event until its call finishes.
+void BenchmarkInFlightCalls(int num_calls, int max_concurrency, uint64_t stack_size) {
+  RayConfig::instance().initialize(
+      absl::StrCat(R"({"async_actor_fiber_stack_size": )", stack_size, "}"));
+  std::vector<std::unique_ptr<FiberEvent>> events;
+  for (int i = 0; i < num_calls; i++) {
+    events.push_back(std::make_unique<FiberEvent>());
+  }
+  std::vector<absl::Time> notify_times(num_calls);
+  std::vector<double> latencies_us(num_calls);
+  std::atomic<int> started{0};
+  std::atomic<int> finished{0};
+
+  const int64_t rss_before = GetRSSBytes();
+  FiberState fiber_state(max_concurrency);
+  for (int i = 0; i < num_calls; i++) {
+    fiber_state.EnqueueFiber([&, i]() {
+      started++;
+      events[i]->Wait();
+      latencies_us[i] = absl::ToDoubleMicroseconds(absl::Now() - notify_times[i]);
+      finished++;
+    });
+  }
+  WaitFor(started, std::min(num_calls, max_concurrency));
+  const int64_t rss_in_flight = GetRSSBytes();
+
+  for (int i = 0; i < num_calls; i++) {
+    notify_times[i] = absl::Now();
+    events[i]->Notify();
+  }
+  WaitFor(finished, num_calls);
+  std::sort(latencies_us.begin(), latencies_us.end());
+  RAY_LOG(INFO) << num_calls << " calls in flight with max_concurrency "
+                << max_concurrency << " and stack size "
+                << (stack_size == 0 ? "default" : std::to_string(stack_size)) << ": "
+                << (rss_in_flight - rss_before) / num_calls
+                << " bytes of RSS per call, latency p50 " << latencies_us[num_calls / 2]
+                << "us p99 "
+                << latencies_us[static_cast<size_t>(0.99 * (num_calls - 1))] << "us";
+  fiber_state.Stop();
+  fiber_state.Join();
+}
+
+// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST_F(FiberStateTest, DISABLED_BenchmarkInFlightCalls) {
+  // Each running call holds a stack, and each stack is a separate mapping, so
+  // running calls stay well below the default limit on the number of mappings of
+  // a process.
+  for (uint64_t stack_size : {0, 16 * 1024}) {
+    BenchmarkInFlightCalls(10000, 10000, stack_size);
+    BenchmarkInFlightCalls(100000, 1000, stack_size);
+  }
+}
+
+#endif
+
+}  // namespace core
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,306 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/future_resolver.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/time/clock.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
+#include "ray/pubsub/mock_pubsub.h"
+
+namespace ray {
+namespace core {
+
+/// A mock owner that replies to status requests once the objects are created.
+class MockOwnerClient : public rpc::CoreWorkerClientInterface {
+ public:
+  void GetObjectStatus(
+      const rpc::GetObjectStatusRequest &request,
+      const rpc::ClientCallback<rpc::GetObjectStatusReply> &callback) override {
+    num_requests++;
+    requests.push_back(
+        {std::vector<ObjectID>{ObjectID::FromBinary(request.object_id())}, callback});
+  }
+
+  void GetObjectStatuses(
+      const rpc::GetObjectStatusesRequest &request,
+      const rpc::ClientCallback<rpc::GetObjectStatusesReply> &callback) override {
+    num_requests++;
+    std::vector<ObjectID> object_ids;
+    for (const auto &object_id : request.object_ids()) {
+      object_ids.push_back(ObjectID::FromBinary(object_id));
+    }
+    batch_requests.push_back({std::move(object_ids), callback});
+  }
+
+  /// Reply to every request that has at least one created object. Returns the
+  /// number of requests replied to.
+  int ReplyCreated() {
+    int num_replied = 0;
+    for (auto it = requests.begin(); it != requests.end();) {
+      if (created.contains(it->first[0])) {
+        it->second(Status::OK(), CreatedStatus());
+        it = requests.erase(it);
+        num_replied++;
+      } else {
+        it++;
+      }
+    }
+    for (auto it = batch_requests.begin(); it != batch_requests.end();) {
+      rpc::GetObjectStatusesReply reply;
+      for (const auto &object_id : it->first) {
+        if (created.contains(object_id)) {
+          reply.add_object_ids(object_id.Binary());
+          reply.add_statuses()->CopyFrom(CreatedStatus());
+        }
+      }
+      if (reply.object_ids_size() > 0) {
+        it->second(Status::OK(), reply);
+        it = batch_requests.erase(it);
+        num_replied++;
+      } else {
+        it++;
+      }
+    }
+    return num_replied;
+  }
+
+  /// Fail the oldest batched request.
+  bool FailBatchRequest() {
+    if (batch_requests.empty()) {
+      return false;
+    }
+    batch_requests.front().second(Status::IOError("owner died"),
+                                  rpc::GetObjectStatusesReply());
+    batch_requests.pop_front();
+    return true;
+  }
+
+  static rpc::GetObjectStatusReply CreatedStatus() {
+    rpc::GetObjectStatusReply reply;
+    reply.set_status(rpc::GetObjectStatusReply::CREATED);
+    reply.mutable_object()->set_metadata(
+        std::to_string(static_cast<int>(rpc::ErrorType::OBJECT_IN_PLASMA)));
+    return reply;
+  }
+
+  absl::flat_hash_set<ObjectID> created;
+  int num_requests = 0;
+  std::list<std::pair<std::vector<ObjectID>,
+                      rpc::ClientCallback<rpc::GetObjectStatusReply>>>
+      requests;
+  std::list<std::pair<std::vector<ObjectID>,
+                      rpc::ClientCallback<rpc::GetObjectStatusesReply>>>
+      batch_requests;
+};
+
+class FutureResolverTest : public ::testing::Test {
+ public:
+  FutureResolverTest()
+      : store_(std::make_shared<CoreWorkerMemoryStore>()),
+        publisher_(std::make_shared<mock_pubsub::MockPublisher>()),
+        subscriber_(std::make_shared<mock_pubsub::MockSubscriber>()),
+        reference_counter_(std::make_shared<ReferenceCounter>(
+            rpc::Address(),
+            publisher_.get(),
+            subscriber_.get(),
+            [](const NodeID &node_id) { return true; })) {
+    client_pool_ = std::make_shared<rpc::CoreWorkerClientPool>(
+        [this](const rpc::Address &addr) {
+          auto &client = owners_[WorkerID::FromBinary(addr.worker_id())];
+          if (client == nullptr) {
+            client = std::make_shared<MockOwnerClient>();
+          }
+          return client;
+        });
+    resolver_ = std::make_unique<FutureResolver>(
+        store_,
+        reference_counter_,
+        [](const ObjectID &, const absl::flat_hash_set<NodeID> &, uint64_t) {},
+        client_pool_,
+        rpc::Address(),
+        io_service_);
+  }
+
+  void TearDown() override { RayConfig::instance().initialize(""); }
+
+  rpc::Address OwnerAddress(const WorkerID &owner_id) {
+    rpc::Address address;
+    address.set_worker_id(owner_id.Binary());
+    return address;
+  }
+
+  std::shared_ptr<MockOwnerClient> Owner(const WorkerID &owner_id) {
+    return owners_[owner_id];
+  }
+
+  void RunEventLoop() {
+    io_service_.restart();
+    io_service_.poll();
+  }
+
+  bool IsResolved(const ObjectID &object_id) {
+    return store_->GetIfExists(object_id) != nullptr;
+  }
+
+  instrumented_io_context io_service_;
+  std::shared_ptr<CoreWorkerMemoryStore> store_;
+  std::shared_ptr<mock_pubsub::MockPublisher> publisher_;
+  std::shared_ptr<mock_pubsub::MockSubscriber> subscriber_;
+  std::shared_ptr<ReferenceCounter> reference_counter_;
+  absl::flat_hash_map<WorkerID, std::shared_ptr<MockOwnerClient>> owners_;
+  std::shared_ptr<rpc::CoreWorkerClientPool> client_pool_;
+  std::unique_ptr<FutureResolver> resolver_;
+};
+
+TEST_F(FutureResolverTest, TestBatchFuturesWithSameOwner) {
+  const auto owner1 = WorkerID::FromRandom();
+  const auto owner2 = WorkerID::FromRandom();
+  std::vector<ObjectID> object_ids;
+  for (int i = 0; i < 3; i++) {
+    object_ids.push_back(ObjectID::FromRandom());
+    resolver_->ResolveFutureAsync(object_ids.back(), OwnerAddress(owner1));
+  }
+  const auto other_object_id = ObjectID::FromRandom();
+  resolver_->ResolveFutureAsync(other_object_id, OwnerAddress(owner2));
+
+  // One request is sent to each owner.
+  RunEventLoop();
+  ASSERT_EQ(Owner(owner1)->num_requests, 1);
+  ASSERT_EQ(Owner(owner1)->batch_requests.front().first, object_ids);
+  ASSERT_EQ(Owner(owner2)->num_requests, 1);
+
+  // The owner replies with the objects that are created.
+  Owner(owner1)->created.insert(object_ids[0]);
+  Owner(owner1)->created.insert(object_ids[1]);
+  ASSERT_EQ(Owner(owner1)->ReplyCreated(), 1);
+  ASSERT_TRUE(IsResolved(object_ids[0]));
+  ASSERT_TRUE(store_->GetIfExists(object_ids[0])->IsInPlasmaError());
+  ASSERT_TRUE(IsResolved(object_ids[1]));
+  ASSERT_FALSE(IsResolved(object_ids[2]));
+
+  // The remaining object is requested again, together with a future that was
+  // added in the meantime.
+  const auto new_object_id = ObjectID::FromRandom();
+  resolver_->ResolveFutureAsync(new_object_id, OwnerAddress(owner1));
+  RunEventLoop();
+  ASSERT_EQ(Owner(owner1)->num_requests, 2);
+  ASSERT_EQ(Owner(owner1)->batch_requests.front().first,
+            (std::vector<ObjectID>{object_ids[2], new_object_id}));
+  Owner(owner1)->created.insert(object_ids[2]);
+  Owner(owner1)->created.insert(new_object_id);
+  ASSERT_EQ(Owner(owner1)->ReplyCreated(), 1);
+  ASSERT_TRUE(IsResolved(object_ids[2]));
+  ASSERT_TRUE(IsResolved(new_object_id));
+  RunEventLoop();
+  ASSERT_EQ(Owner(owner1)->num_requests, 2);
+
+  // If the owner fails, all of the objects in the request get an error.
+  ASSERT_TRUE(Owner(owner2)->FailBatchRequest());
+  rpc::ErrorType error_type;
+  ASSERT_TRUE(store_->GetIfExists(other_object_id)->IsException(&error_type));
+  ASSERT_EQ(error_type, rpc::ErrorType::OWNER_DIED);
+  RunEventLoop();
+  ASSERT_EQ(Owner(owner2)->num_requests, 1);
+}
+
+TEST_F(FutureResolverTest, TestMaxBatchSize) {
+  RayConfig::instance().initialize(R"({"object_status_batch_max_size": 2})");
+  const auto owner_id = WorkerID::FromRandom();
+  for (int i = 0; i < 5; i++) {
+    resolver_->ResolveFutureAsync(ObjectID::FromRandom(), OwnerAddress(owner_id));
+  }
+  RunEventLoop();
+  ASSERT_EQ(Owner(owner_id)->num_requests, 3);
+}
+
+TEST_F(FutureResolverTest, TestBatchingDisabled) {
+  RayConfig::instance().initialize(R"({"object_status_batch_max_size": 0})");
+  const auto owner_id = WorkerID::FromRandom();
+  std::vector<ObjectID> object_ids;
+  for (int i = 0; i < 3; i++) {
+    object_ids.push_back(ObjectID::FromRandom());
+    resolver_->ResolveFutureAsync(object_ids.back(), OwnerAddress(owner_id));
+  }
+  // One request is sent per object, without waiting for the event loop.
+  ASSERT_EQ(Owner(owner_id)->num_requests, 3);
+  ASSERT_TRUE(Owner(owner_id)->batch_requests.empty());
+  for (const auto &object_id : object_ids) {
+    Owner(owner_id)->created.insert(object_id);
+  }
+  ASSERT_EQ(Owner(owner_id)->ReplyCreated(), 3);
+  for (const auto &object_id : object_ids) {
+    ASSERT_TRUE(IsResolved(object_id));
+  }
+}
+
+// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST_F(FutureResolverTest, DISABLED_BenchmarkFanIn) {
+  // Resolve 10k futures from one owner. The owner creates the objects in waves,
+  // e.g. as the tasks that return them finish.
+  const int num_objects = 10000;
+  const int num_waves = 10;
+  for (int64_t batch_size : {0, 1000}) {
+    RayConfig::instance().initialize(
+        absl::StrCat(R"({"object_status_batch_max_size": )", batch_size, "}"));
+    const auto owner_id = WorkerID::FromRandom();
+    std::vector<ObjectID> object_ids;
+    for (int i = 0; i < num_objects; i++) {
+      object_ids.push_back(ObjectID::FromRandom());
+    }
+
+    auto start = absl::Now();
+    for (const auto &object_id : object_ids) {
+      resolver_->ResolveFutureAsync(object_id, OwnerAddress(owner_id));
+    }
+    RunEventLoop();
+    auto owner = Owner(owner_id);
+    for (int wave = 0; wave < num_waves; wave++) {
+      for (int i = wave * num_objects / num_waves;
+           i < (wave + 1) * num_objects / num_waves;
+           i++) {
+        owner->created.insert(object_ids[i]);
+      }
+      while (owner->ReplyCreated() > 0) {
+        RunEventLoop();
+      }
+    }
+    auto elapsed = absl::Now() - start;
+
+    for (const auto &object_id : object_ids) {
+      ASSERT_TRUE(IsResolved(object_id));
+    }
+    ASSERT_TRUE(owner->requests.empty());
+    ASSERT_TRUE(owner->batch_requests.empty());
+    if (batch_size == 0) {
+      ASSERT_EQ(owner->num_requests, num_objects);
+    } else {
+      ASSERT_LE(owner->num_requests, 2 * num_waves);
+    }
+    RAY_LOG(INFO) << "Resolved " << num_objects << " futures from one owner with "
+                  << (batch_size == 0 ? "unbatched" : "batched") << " status requests: "
+                  << owner->num_requests << " RPCs, "
+                  << absl::ToDoubleMilliseconds(elapsed) << "ms";
+  }
+}
+
+}  // namespace core
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
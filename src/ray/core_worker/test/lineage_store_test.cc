@@ -0,0 +1,168 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/lineage_store.h"
+
+#include "gtest/gtest.h"
+#include "ray/util/filesystem.h"
+
+namespace ray {
+namespace core {
+
+class LineageStoreTest : public ::testing::Test {
+ public:
+  LineageStoreTest() : file_prefix_(WorkerID::FromRandom().Hex()) {}
+
+  std::unique_ptr<LineageStore> CreateStore(int64_t max_bytes, int64_t segment_bytes) {
+    return std::make_unique<LineageStore>(
+        GetUserTempDir(), file_prefix_, max_bytes, segment_bytes);
+  }
+
+  bool SegmentFileExists(int segment_id) {
+    std::ifstream file(JoinPaths(GetUserTempDir(),
+                                 "lineage_" + file_prefix_ + "_" +
+                                     std::to_string(segment_id)));
+    return file.good();
+  }
+
+  const std::string file_prefix_;
+};
+
+TEST_F(LineageStoreTest, TestPutGetDelete) {
+  auto store = CreateStore(/*max_bytes=*/1024, /*segment_bytes=*/1024);
+  auto task1 = TaskID::FromRandom(JobID::FromInt(1));
+  auto task2 = TaskID::FromRandom(JobID::FromInt(1));
+  ASSERT_TRUE(store->Put(task1, "spec1"));
+  ASSERT_TRUE(store->Put(task2, std::string("spec\0two", 8)));
+  ASSERT_EQ(store->NumEntries(), 2);
+  ASSERT_EQ(store->NumBytes(), 13);
+
+  std::string data;
+  ASSERT_TRUE(store->Get(task1, &data));
+  ASSERT_EQ(data, "spec1");
+  ASSERT_TRUE(store->Get(task2, &data));
+  ASSERT_EQ(data, std::string("spec\0two", 8));
+
+  store->Delete(task1);
+  ASSERT_FALSE(store->Contains(task1));
+  ASSERT_FALSE(store->Get(task1, &data));
+  ASSERT_TRUE(store->Contains(task2));
+  ASSERT_EQ(store->NumBytes(), 8);
+  // Deleting a task that is not in the store is a no-op.
+  store->Delete(task1);
+  ASSERT_EQ(store->NumEntries(), 1);
+
+  // The segment files are deleted with the store.
+  ASSERT_TRUE(SegmentFileExists(0));
+  store.reset();
+  ASSERT_FALSE(SegmentFileExists(0));
+}
+
+TEST_F(LineageStoreTest, TestMaxBytes) {
+  auto store = CreateStore(/*max_bytes=*/10, /*segment_bytes=*/1024);
+  auto task1 = TaskID::FromRandom(JobID::FromInt(1));
+  auto task2 = TaskID::FromRandom(JobID::FromInt(1));
+  ASSERT_TRUE(store->Put(task1, std::string(6, 'a')));
+  ASSERT_FALSE(store->Put(task2, std::string(6, 'b')));
+  ASSERT_FALSE(store->Contains(task2));
+  store->Delete(task1);
+  ASSERT_TRUE(store->Put(task2, std::string(6, 'b')));
+}
+
+TEST_F(LineageStoreTest, TestPutReclaimsSegments) {
+  auto store = CreateStore(/*max_bytes=*/1024, /*segment_bytes=*/60);
+  std::vector<TaskID> task_ids;
+  for (int i = 0; i < 3; i++) {
+    task_ids.push_back(TaskID::FromRandom(JobID::FromInt(1)));
+    ASSERT_TRUE(store->Put(task_ids.back(), std::string(30, 'a' + i)));
+  }
+  ASSERT_EQ(store->NumSegments(), 2);
+  store->Delete(task_ids[0]);
+  store->Delete(task_ids[1]);
+  ASSERT_TRUE(SegmentFileExists(0));
+  ASSERT_TRUE(store->Put(TaskID::FromRandom(JobID::FromInt(1)), std::string(30, 'd')));
+  ASSERT_EQ(store->NumSegments(), 1);
+  ASSERT_FALSE(SegmentFileExists(0));
+}
+
+TEST_F(LineageStoreTest, TestDeleteSegment) {
+  auto store = CreateStore(/*max_bytes=*/1024, /*segment_bytes=*/60);
+  std::vector<TaskID> task_ids;
+  for (int i = 0; i < 5; i++) {
+    task_ids.push_back(TaskID::FromRandom(JobID::FromInt(1)));
+    ASSERT_TRUE(store->Put(task_ids.back(), std::string(30, 'a' + i)));
+  }
+  // Each segment fits 2 records.
+  ASSERT_EQ(store->NumSegments(), 3);
+  ASSERT_EQ(store->NumFileBytes(), 150);
+
+  // A sealed segment is deleted once all of its records are deleted.
+  store->Delete(task_ids[0]);
+  store->ReclaimSegments();
+  ASSERT_EQ(store->NumSegments(), 3);
+  ASSERT_TRUE(SegmentFileExists(0));
+  // Deleting a record doesn't touch the files until the segments are reclaimed.
+  store->Delete(task_ids[1]);
+  ASSERT_EQ(store->NumSegments(), 3);
+  ASSERT_TRUE(SegmentFileExists(0));
+  store->ReclaimSegments();
+  ASSERT_EQ(store->NumSegments(), 2);
+  ASSERT_FALSE(SegmentFileExists(0));
+  ASSERT_EQ(store->NumFileBytes(), 90);
+}
+
+TEST_F(LineageStoreTest, TestSegmentCompaction) {
+  auto store = CreateStore(/*max_bytes=*/1024, /*segment_bytes=*/100);
+  std::vector<TaskID> task_ids;
+  for (int i = 0; i < 7; i++) {
+    task_ids.push_back(TaskID::FromRandom(JobID::FromInt(1)));
+    ASSERT_TRUE(store->Put(task_ids.back(), std::string(30, 'a' + i)));
+  }
+  // Each segment fits 3 records.
+  ASSERT_EQ(store->NumSegments(), 3);
+  ASSERT_EQ(store->NumFileBytes(), 210);
+
+  // Once less than half of a sealed segment is live, its live records are
+  // moved to the end of the log and the segment is deleted.
+  store->Delete(task_ids[0]);
+  store->ReclaimSegments();
+  ASSERT_EQ(store->NumSegments(), 3);
+  store->Delete(task_ids[1]);
+  store->ReclaimSegments();
+  ASSERT_EQ(store->NumSegments(), 2);
+  ASSERT_FALSE(SegmentFileExists(0));
+  ASSERT_EQ(store->NumFileBytes(), 150);
+  ASSERT_EQ(store->NumBytes(), 150);
+
+  // The active segment is never compacted.
+  store->Delete(task_ids[6]);
+  store->ReclaimSegments();
+  ASSERT_EQ(store->NumSegments(), 2);
+  ASSERT_EQ(store->NumFileBytes(), 150);
+  ASSERT_EQ(store->NumBytes(), 120);
+
+  std::string data;
+  for (int i = 2; i < 6; i++) {
+    ASSERT_TRUE(store->Get(task_ids[i], &data));
+    ASSERT_EQ(data, std::string(30, 'a' + i));
+  }
+}
+
+}  // namespace core
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -14,8 +14,12 @@
 
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 
+#include <atomic>
+#include <thread>
+
 #include "absl/synchronization/mutex.h"
 #include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
 #include "ray/common/test_util.h"
 
 namespace ray {
@@ -84,9 +88,9 @@ TEST(TestMemoryStore, TestMemoryStoreStats) {
   // Iterate through the memory store and compare the values that are obtained by
   // GetMemoryStoreStatisticalData.
   auto fill_expected_memory_stats = [&](MemoryStoreStats &expected_item) {
-    {
-      absl::MutexLock lock(&provider->mu_);
-      for (const auto &it : provider->objects_) {
+    for (const auto &shard : provider->shards_) {
+      absl::MutexLock lock(&shard->mu);
+      for (const auto &it : shard->objects) {
         if (it.second->IsInPlasmaError()) {
           expected_item.num_in_plasma += 1;
         } else {
@@ -137,6 +141,104 @@ TEST(TestMemoryStore, TestMemoryStoreStats) {
   ASSERT_EQ(item.num_local_objects_bytes, expected_item3.num_local_objects_bytes);
 }
 
+TEST(TestMemoryStore, TestConcurrentPutAndGet) {
+  // Objects are put by some threads while others block on getting them, so that
+  // gets race with puts to other shards.
+  auto provider = std::make_shared<CoreWorkerMemoryStore>();
+  const int num_threads = 8;
+  const int num_objects = 200;
+  std::vector<std::vector<ObjectID>> object_ids(num_threads);
+  for (auto &ids : object_ids) {
+    for (int i = 0; i < num_objects; i++) {
+      ids.push_back(ObjectID::FromRandom());
+    }
+  }
+  auto buffer = MakeLocalMemoryBufferFromString("hello");
+  RayObject object(buffer, nullptr, std::vector<rpc::ObjectReference>());
+
+  std::vector<std::thread> threads;
+  std::atomic<int> num_found(0);
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      WorkerContext context(
+          WorkerType::WORKER, WorkerID::FromRandom(), JobID::FromInt(0));
+      const auto &ids = object_ids[t];
+      for (int i = 0; i < num_objects; i += 10) {
+        std::vector<ObjectID> batch(ids.begin() + i, ids.begin() + i + 10);
+        std::vector<std::shared_ptr<RayObject>> results;
+        RAY_CHECK_OK(provider->Get(batch, batch.size(), -1, context, false, &results));
+        for (const auto &result : results) {
+          if (result != nullptr) {
+            num_found++;
+          }
+        }
+      }
+    });
+    threads.emplace_back([&, t]() {
+      for (const auto &id : object_ids[(t + 1) % num_threads]) {
+        RAY_CHECK(provider->Put(object, id));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(num_found, num_threads * num_objects);
+  ASSERT_EQ(provider->Size(), num_threads * num_objects);
+  ASSERT_EQ(provider->GetMemoryStoreStatisticalData().num_local_objects,
+            num_threads * num_objects);
+}
+
+class TestMemoryStorePerf : public ::testing::Test {
+ protected:
+  void TearDown() override { RayConfig::instance().initialize(""); }
+};
+
+// Performance benchmark for putting, getting and deleting objects from many threads,
+// with a single shard and with the default number of shards. Disabled by default,
+// run it with --gtest_also_run_disabled_tests.
+TEST_F(TestMemoryStorePerf, DISABLED_TestConcurrentPerf) {
+  const int num_ops_per_thread = 20000;
+  auto buffer = MakeLocalMemoryBufferFromString("hello");
+  RayObject object(buffer, nullptr, std::vector<rpc::ObjectReference>());
+  for (uint64_t num_shards : {1, 16}) {
+    RayConfig::instance().initialize(
+        "{\"core_worker_memory_store_num_shards\": " + std::to_string(num_shards) + "}");
+    for (int num_threads : {1, 2, 4, 8, 16, 32}) {
+      auto provider = std::make_shared<CoreWorkerMemoryStore>();
+      std::vector<std::vector<ObjectID>> object_ids(num_threads);
+      for (auto &ids : object_ids) {
+        for (int i = 0; i < num_ops_per_thread; i++) {
+          ids.push_back(ObjectID::FromRandom());
+        }
+      }
+      std::vector<std::thread> threads;
+      int64_t start_ms = current_time_ms();
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+          WorkerContext context(
+              WorkerType::WORKER, WorkerID::FromRandom(), JobID::FromInt(0));
+          std::vector<std::shared_ptr<RayObject>> results;
+          for (const auto &id : object_ids[t]) {
+            RAY_CHECK(provider->Put(object, id));
+            RAY_CHECK(provider->GetIfExists(id) != nullptr);
+            RAY_CHECK_OK(provider->Get({id}, 1, 0, context, false, &results));
+            provider->Delete(std::vector<ObjectID>{id});
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      int64_t duration_ms = std::max<int64_t>(current_time_ms() - start_ms, 1);
+      RAY_LOG(INFO) << num_shards << " shard(s), " << num_threads << " thread(s): "
+                    << 4.0 * num_threads * num_ops_per_thread / duration_ms / 1000
+                    << " million ops/s.";
+      ASSERT_EQ(provider->Size(), 0);
+    }
+  }
+}
+
 /// A mock manager that manages all test buffers. This mocks
 /// that memory pressure is able to be awared.
 class MockBufferManager {
@@ -14,8 +14,10 @@
 
 #include "ray/core_worker/object_recovery_manager.h"
 
+#include "absl/time/clock.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
 #include "ray/common/task/task_spec.h"
 #include "ray/common/task/task_util.h"
 #include "ray/common/test_util.h"
@@ -49,11 +51,25 @@ class MockTaskResubmitter : public TaskResubmissionInterface {
       task_deps->push_back(dep);
     }
     num_tasks_resubmitted++;
+    resubmitted_tasks.push_back(task_id);
+    return true;
+  }
+
+  bool GetTaskDependencies(const TaskID &task_id,
+                           std::vector<ObjectID> *task_deps) const {
+    auto it = task_specs.find(task_id);
+    if (it == task_specs.end()) {
+      return false;
+    }
+    for (const auto &dep : it->second) {
+      task_deps->push_back(dep);
+    }
     return true;
   }
 
   absl::flat_hash_map<TaskID, std::vector<ObjectID>> task_specs;
   int num_tasks_resubmitted = 0;
+  std::vector<TaskID> resubmitted_tasks;
 };
 
 class MockRayletClient : public PinObjectsInterface {
@@ -63,23 +79,27 @@ class MockRayletClient : public PinObjectsInterface {
       const std::vector<ObjectID> &object_ids,
       const ObjectID &generator_id,
       const rpc::ClientCallback<rpc::PinObjectIDsReply> &callback) override {
-    RAY_LOG(INFO) << "PinObjectIDs " << object_ids.size();
-    callbacks.push_back(callback);
+    RAY_LOG(DEBUG) << "PinObjectIDs " << object_ids.size();
+    callbacks.push_back({object_ids.size(), callback});
   }
 
   size_t Flush(bool success = true) {
-    std::list<rpc::ClientCallback<rpc::PinObjectIDsReply>> callbacks_snapshot;
+    std::list<std::pair<size_t, rpc::ClientCallback<rpc::PinObjectIDsReply>>>
+        callbacks_snapshot;
     std::swap(callbacks_snapshot, callbacks);
     size_t flushed = callbacks_snapshot.size();
     for (const auto &callback : callbacks_snapshot) {
       rpc::PinObjectIDsReply reply;
-      reply.add_successes(success);
-      callback(Status::OK(), reply);
+      for (size_t i = 0; i < callback.first; i++) {
+        reply.add_successes(success);
+      }
+      callback.second(Status::OK(), reply);
     }
     return flushed;
   }
 
-  std::list<rpc::ClientCallback<rpc::PinObjectIDsReply>> callbacks = {};
+  std::list<std::pair<size_t, rpc::ClientCallback<rpc::PinObjectIDsReply>>> callbacks =
+      {};
 };
 
 class MockObjectDirectory {
@@ -87,6 +107,7 @@ class MockObjectDirectory {
   void AsyncGetLocations(const ObjectID &object_id,
                          const ObjectLookupCallback &callback) {
     callbacks.push_back({object_id, callback});
+    num_lookups++;
   }
 
   void SetLocations(const ObjectID &object_id,
@@ -95,18 +116,17 @@ class MockObjectDirectory {
   }
 
   size_t Flush() {
-    size_t flushed = callbacks.size();
-    for (const auto &pair : callbacks) {
+    std::vector<std::pair<ObjectID, ObjectLookupCallback>> callbacks_snapshot;
+    std::swap(callbacks_snapshot, callbacks);
+    for (const auto &pair : callbacks_snapshot) {
       pair.second(pair.first, locations[pair.first]);
     }
-    for (size_t i = 0; i < flushed; i++) {
-      callbacks.erase(callbacks.begin());
-    }
-    return flushed;
+    return callbacks_snapshot.size();
   }
 
   std::vector<std::pair<ObjectID, ObjectLookupCallback>> callbacks = {};
   absl::flat_hash_map<ObjectID, std::vector<rpc::Address>> locations;
+  size_t num_lookups = 0;
 };
 
 class ObjectRecoveryManagerTestBase : public ::testing::Test {
@@ -397,6 +417,236 @@ TEST_F(ObjectRecoveryManagerTest, TestLineageEvicted) {
             rpc::ErrorType::OBJECT_UNRECONSTRUCTABLE_LINEAGE_EVICTED);
 }
 
+class ObjectRecoveryManagerBulkTest : public ObjectRecoveryManagerTestBase {
+ public:
+  ObjectRecoveryManagerBulkTest() : ObjectRecoveryManagerTestBase(true) {
+    RayConfig::instance().initialize(R"({"object_recovery_bulk_mode": true})");
+  }
+
+  ~ObjectRecoveryManagerBulkTest() { RayConfig::instance().initialize(""); }
+
+  void AddOwnedObject(const ObjectID &object_id) {
+    ref_counter_->AddOwnedObject(object_id,
+                                 {},
+                                 rpc::Address(),
+                                 "",
+                                 0,
+                                 true,
+                                 /*add_local_ref=*/true);
+  }
+
+  rpc::Address NodeAddress(const NodeID &node_id) {
+    rpc::Address address;
+    address.set_raylet_id(node_id.Binary());
+    return address;
+  }
+
+  /// Store the return objects of the resubmitted tasks, as if the tasks
+  /// finished.
+  void FinishResubmittedTasks(
+      const absl::flat_hash_map<TaskID, std::vector<ObjectID>> &task_returns) {
+    auto resubmitted_tasks = std::move(task_resubmitter_->resubmitted_tasks);
+    task_resubmitter_->resubmitted_tasks.clear();
+    for (const auto &task_id : resubmitted_tasks) {
+      for (const auto &object_id : task_returns.at(task_id)) {
+        RAY_UNUSED(
+            memory_store_->Put(RayObject(rpc::ErrorType::OBJECT_IN_PLASMA), object_id));
+      }
+    }
+  }
+};
+
+TEST_F(ObjectRecoveryManagerBulkTest, TestPinCopiesPerNode) {
+  const auto node1 = NodeID::FromRandom();
+  const auto node2 = NodeID::FromRandom();
+  std::vector<ObjectID> object_ids;
+  for (int i = 0; i < 4; i++) {
+    object_ids.push_back(ObjectID::FromRandom());
+    AddOwnedObject(object_ids.back());
+  }
+  object_directory_->SetLocations(object_ids[0], {NodeAddress(node1)});
+  object_directory_->SetLocations(object_ids[1], {NodeAddress(node1)});
+  object_directory_->SetLocations(object_ids[2], {NodeAddress(node2)});
+  // The first location of the last object has no copy anymore.
+  object_directory_->SetLocations(object_ids[3],
+                                  {NodeAddress(node2), NodeAddress(node1)});
+
+  manager_.RecoverObjects(object_ids);
+  ASSERT_EQ(object_directory_->Flush(), 4);
+  // One request per node.
+  ASSERT_EQ(raylet_client_->callbacks.size(), 2);
+  ASSERT_EQ(raylet_client_->callbacks.front().first, 3);
+  ASSERT_EQ(raylet_client_->callbacks.back().first, 1);
+  auto callbacks = std::move(raylet_client_->callbacks);
+  raylet_client_->callbacks.clear();
+  rpc::PinObjectIDsReply reply;
+  reply.add_successes(true);
+  reply.add_successes(true);
+  reply.add_successes(false);
+  callbacks.front().second(Status::OK(), reply);
+  callbacks.back().second(Status::OK(), reply);
+  // The object that failed to pin is retried at its other location.
+  ASSERT_EQ(raylet_client_->callbacks.size(), 1);
+  ASSERT_EQ(raylet_client_->Flush(), 1);
+
+  for (const auto &object_id : object_ids) {
+    ASSERT_NE(memory_store_->GetIfExists(object_id), nullptr);
+  }
+  ASSERT_TRUE(failed_reconstructions_.empty());
+  ASSERT_EQ(task_resubmitter_->num_tasks_resubmitted, 0);
+}
+
+TEST_F(ObjectRecoveryManagerBulkTest, TestReconstructionOrder) {
+  RayConfig::instance().initialize(
+      R"({"object_recovery_bulk_mode": true, "object_recovery_max_inflight_tasks": 1})");
+  // A chain of tasks a -> b -> c, where c has two return objects. All of the
+  // objects are lost.
+  const auto a = ObjectID::FromRandom();
+  const auto b = ObjectID::FromRandom();
+  const auto task_c = TaskID::FromRandom(JobID::FromInt(1));
+  const auto c1 = ObjectID::FromIndex(task_c, 1);
+  const auto c2 = ObjectID::FromIndex(task_c, 2);
+  for (const auto &object_id : {a, b, c1, c2}) {
+    AddOwnedObject(object_id);
+  }
+  task_resubmitter_->AddTask(a.TaskId(), {});
+  task_resubmitter_->AddTask(b.TaskId(), {a});
+  task_resubmitter_->AddTask(task_c, {b});
+  absl::flat_hash_map<TaskID, std::vector<ObjectID>> task_returns = {
+      {a.TaskId(), {a}}, {b.TaskId(), {b}}, {task_c, {c1, c2}}};
+
+  manager_.RecoverObjects({c2, b, c1, a});
+  ASSERT_EQ(object_directory_->Flush(), 4);
+  // Each task is resubmitted once, after the tasks it depends on finished.
+  ASSERT_EQ(task_resubmitter_->resubmitted_tasks, std::vector<TaskID>{a.TaskId()});
+  FinishResubmittedTasks(task_returns);
+  ASSERT_EQ(task_resubmitter_->resubmitted_tasks, std::vector<TaskID>{b.TaskId()});
+  FinishResubmittedTasks(task_returns);
+  ASSERT_EQ(task_resubmitter_->resubmitted_tasks, std::vector<TaskID>{task_c});
+  FinishResubmittedTasks(task_returns);
+  ASSERT_EQ(task_resubmitter_->num_tasks_resubmitted, 3);
+  ASSERT_EQ(object_directory_->Flush(), 0);
+  ASSERT_TRUE(failed_reconstructions_.empty());
+
+  // The objects can be recovered again.
+  memory_store_->Delete({c1});
+  manager_.RecoverObjects({c1});
+  ASSERT_EQ(object_directory_->Flush(), 1);
+  ASSERT_EQ(task_resubmitter_->resubmitted_tasks, std::vector<TaskID>{task_c});
+}
+
+TEST_F(ObjectRecoveryManagerBulkTest, TestReconstructionFails) {
+  const auto dep_id = ObjectID::FromRandom();
+  const auto object_id = ObjectID::FromRandom();
+  AddOwnedObject(dep_id);
+  AddOwnedObject(object_id);
+  task_resubmitter_->AddTask(object_id.TaskId(), {dep_id});
+
+  manager_.RecoverObjects({object_id});
+  ASSERT_EQ(object_directory_->Flush(), 1);
+  // The lineage of the dependency was deleted.
+  ASSERT_EQ(object_directory_->Flush(), 1);
+  ASSERT_EQ(failed_reconstructions_[dep_id],
+            rpc::ErrorType::OBJECT_UNRECONSTRUCTABLE_MAX_ATTEMPTS_EXCEEDED);
+  // The task is still resubmitted, and it will fail with the dependency's error.
+  ASSERT_EQ(failed_reconstructions_.count(object_id), 0);
+  ASSERT_EQ(task_resubmitter_->resubmitted_tasks,
+            std::vector<TaskID>{object_id.TaskId()});
+}
+
+TEST_F(ObjectRecoveryManagerBulkTest, TestMaxInflightLookups) {
+  RayConfig::instance().initialize(
+      R"({"object_recovery_bulk_mode": true, "object_recovery_max_inflight_lookups": 2})");
+  const auto node_id = NodeID::FromRandom();
+  std::vector<ObjectID> object_ids;
+  for (int i = 0; i < 5; i++) {
+    object_ids.push_back(ObjectID::FromRandom());
+    AddOwnedObject(object_ids.back());
+    object_directory_->SetLocations(object_ids.back(), {NodeAddress(node_id)});
+  }
+
+  manager_.RecoverObjects(object_ids);
+  // The next lookups are only issued once the pending ones return.
+  ASSERT_EQ(object_directory_->Flush(), 2);
+  ASSERT_EQ(object_directory_->Flush(), 2);
+  ASSERT_TRUE(raylet_client_->callbacks.empty());
+  ASSERT_EQ(object_directory_->Flush(), 1);
+  ASSERT_EQ(object_directory_->num_lookups, 5);
+  // The objects are still pinned with one request.
+  ASSERT_EQ(raylet_client_->Flush(), 1);
+  for (const auto &object_id : object_ids) {
+    ASSERT_NE(memory_store_->GetIfExists(object_id), nullptr);
+  }
+}
+
+// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST_F(ObjectRecoveryManagerBulkTest, DISABLED_BenchmarkNodeLoss) {
+  // A node that held 100k objects is removed. A fifth of the objects have
+  // copies on other nodes, and the rest were returned by tasks with 4 return
+  // objects each.
+  const int num_objects = 100000;
+  const int num_nodes = 10;
+  const int num_returns = 4;
+  for (bool bulk : {false, true}) {
+    RayConfig::instance().initialize(absl::StrCat(
+        R"({"object_recovery_bulk_mode": )", bulk ? "true" : "false", "}"));
+    std::vector<ObjectID> object_ids;
+    absl::flat_hash_map<TaskID, std::vector<ObjectID>> task_returns;
+    std::vector<rpc::Address> node_addresses;
+    for (int i = 0; i < num_nodes; i++) {
+      node_addresses.push_back(NodeAddress(NodeID::FromRandom()));
+    }
+    for (int i = 0; i < num_objects / 5; i++) {
+      object_ids.push_back(ObjectID::FromRandom());
+      object_directory_->SetLocations(object_ids.back(), {node_addresses[i % num_nodes]});
+    }
+    while (object_ids.size() < num_objects) {
+      const auto task_id = TaskID::FromRandom(JobID::FromInt(1));
+      task_resubmitter_->AddTask(task_id, {});
+      for (int i = 1; i <= num_returns; i++) {
+        object_ids.push_back(ObjectID::FromIndex(task_id, i));
+        task_returns[task_id].push_back(object_ids.back());
+      }
+    }
+    for (const auto &object_id : object_ids) {
+      AddOwnedObject(object_id);
+    }
+    task_resubmitter_->num_tasks_resubmitted = 0;
+    object_directory_->num_lookups = 0;
+
+    auto start = absl::Now();
+    manager_.RecoverObjects(object_ids);
+    int num_pin_requests = 0;
+    while (true) {
+      size_t flushed = object_directory_->Flush();
+      num_pin_requests += raylet_client_->callbacks.size();
+      flushed += raylet_client_->Flush();
+      flushed += task_resubmitter_->resubmitted_tasks.size();
+      FinishResubmittedTasks(task_returns);
+      if (flushed == 0) {
+        break;
+      }
+    }
+    auto elapsed = absl::Now() - start;
+
+    for (const auto &object_id : object_ids) {
+      ASSERT_NE(memory_store_->GetIfExists(object_id), nullptr);
+    }
+    ASSERT_TRUE(failed_reconstructions_.empty());
+    RAY_LOG(INFO) << (bulk ? "Bulk" : "Per-object") << " recovery of " << num_objects
+                  << " lost objects: " << object_directory_->num_lookups
+                  << " lookups, " << num_pin_requests << " pin requests, "
+                  << task_resubmitter_->num_tasks_resubmitted << " task resubmissions, "
+                  << absl::ToDoubleMilliseconds(elapsed) << "ms";
+    ASSERT_EQ(object_directory_->num_lookups, num_objects);
+    if (bulk) {
+      ASSERT_EQ(num_pin_requests, num_nodes);
+      ASSERT_EQ(task_resubmitter_->num_tasks_resubmitted,
+                num_objects * 4 / 5 / num_returns);
+    }
+  }
+}
+
 }  // namespace core
 }  // namespace ray
 
@@ -14,6 +14,11 @@
 
 #include "ray/core_worker/reference_count.h"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <thread>
 #include <vector>
 
 #include "absl/functional/bind_front.h"
@@ -21,12 +26,40 @@
 #include "gtest/gtest.h"
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/asio/periodical_runner.h"
+#include "ray/common/ray_config.h"
 #include "ray/common/ray_object.h"
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 #include "ray/pubsub/mock_pubsub.h"
 #include "ray/pubsub/publisher.h"
 #include "ray/pubsub/subscriber.h"
 
+// Track the number of live heap bytes, so that the memory benchmark below can
+// report how many bytes the reference counter uses per tracked object. Each
+// allocation is prefixed with its size.
+static std::atomic<int64_t> live_heap_bytes{0};
+static constexpr size_t kAllocationHeaderSize = alignof(std::max_align_t);
+
+void *operator new(size_t size) {
+  void *ptr = std::malloc(size + kAllocationHeaderSize);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  *static_cast<size_t *>(ptr) = size;
+  live_heap_bytes += size;
+  return static_cast<char *>(ptr) + kAllocationHeaderSize;
+}
+
+void operator delete(void *ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  void *base = static_cast<char *>(ptr) - kAllocationHeaderSize;
+  live_heap_bytes -= *static_cast<size_t *>(base);
+  std::free(base);
+}
+
+void operator delete(void *ptr, size_t size) noexcept { operator delete(ptr); }
+
 namespace ray {
 namespace core {
 
@@ -47,6 +80,7 @@ class ReferenceCountTest : public ::testing::Test {
   }
 
   virtual void TearDown() {
+    RayConfig::instance().initialize("");
     AssertNoLeaks();
     publisher_.reset();
     subscriber_.reset();
@@ -619,6 +653,164 @@ TEST_F(ReferenceCountTest, TestReferenceStats) {
   rc->RemoveLocalReference(id2, nullptr);
 }
 
+// Tests that local references added to an object that is already in scope are
+// counted correctly, whether they go through the shards or the main table.
+TEST_F(ReferenceCountTest, TestLocalRefShards) {
+  ObjectID id = ObjectID::FromRandom();
+  std::vector<ObjectID> out;
+
+  rc->AddLocalReference(id, "");
+  rc->AddLocalReference(id, "");
+  rc->AddLocalReference(id, "");
+  ASSERT_EQ(rc->GetAllReferenceCounts()[id].first, 3);
+  rpc::CoreWorkerStats stats;
+  rc->AddObjectRefStats({}, &stats, -1);
+  ASSERT_EQ(stats.object_refs(0).local_ref_count(), 3);
+
+  rc->RemoveLocalReference(id, &out);
+  rc->RemoveLocalReference(id, &out);
+  ASSERT_TRUE(rc->HasReference(id));
+  ASSERT_EQ(rc->GetAllReferenceCounts()[id].first, 1);
+  // Add a reference again after the shard has been drained.
+  rc->AddLocalReference(id, "");
+  rc->RemoveLocalReference(id, &out);
+  ASSERT_TRUE(rc->HasReference(id));
+  ASSERT_TRUE(out.empty());
+  rc->RemoveLocalReference(id, &out);
+  ASSERT_FALSE(rc->HasReference(id));
+  ASSERT_EQ(out.size(), 1);
+
+  // References in the shards are released too.
+  rc->AddLocalReference(id, "");
+  rc->AddLocalReference(id, "");
+  rc->ReleaseAllLocalReferences();
+  ASSERT_FALSE(rc->HasReference(id));
+}
+
+// Tests that concurrent local references keep the object in scope until the
+// last one is removed.
+TEST_F(ReferenceCountTest, TestConcurrentLocalReferences) {
+  const int num_threads = 8;
+  const int num_iterations = 10000;
+  std::vector<ObjectID> ids;
+  for (int i = 0; i < 4; i++) {
+    ids.push_back(ObjectID::FromRandom());
+    rc->AddLocalReference(ids.back(), "");
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < num_iterations; i++) {
+        const auto &id = ids[(t + i) % ids.size()];
+        rc->AddLocalReference(id, "");
+        rc->AddLocalReference(id, "");
+        rc->RemoveLocalReference(id, nullptr);
+        rc->RemoveLocalReference(id, nullptr);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto ref_counts = rc->GetAllReferenceCounts();
+  for (const auto &id : ids) {
+    ASSERT_EQ(ref_counts[id].first, 1);
+    rc->RemoveLocalReference(id, nullptr);
+    ASSERT_FALSE(rc->HasReference(id));
+  }
+}
+
+// Measures the throughput of adding and removing local references from many
+// threads, with and without the local reference shards. Disabled by default, run it
+// with --gtest_also_run_disabled_tests.
+TEST_F(ReferenceCountTest, DISABLED_BenchmarkLocalReferenceContention) {
+  const int num_objects = 1000;
+  const int num_iterations = 100000;
+  for (uint64_t num_shards : {0, 16}) {
+    RayConfig::instance().initialize(
+        absl::StrCat(R"({"reference_counter_num_local_ref_shards": )", num_shards, "}"));
+    ReferenceCounter counter(
+        rpc::Address(), publisher_.get(), subscriber_.get(), [](const NodeID &node_id) {
+          return true;
+        });
+    std::vector<ObjectID> ids;
+    for (int i = 0; i < num_objects; i++) {
+      ids.push_back(ObjectID::FromRandom());
+      counter.AddLocalReference(ids.back(), "");
+    }
+    for (int num_threads : {1, 4, 16}) {
+      auto start = absl::Now();
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+          for (int i = 0; i < num_iterations; i++) {
+            const auto &id = ids[(t * 7919 + i) % ids.size()];
+            counter.AddLocalReference(id, "");
+            counter.RemoveLocalReference(id, nullptr);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      double seconds = absl::ToDoubleSeconds(absl::Now() - start);
+      RAY_LOG(INFO) << num_shards << " shards, " << num_threads << " threads: "
+                    << 2 * num_iterations * num_threads / seconds << " ops/s";
+    }
+    for (const auto &id : ids) {
+      counter.RemoveLocalReference(id, nullptr);
+    }
+    ASSERT_EQ(counter.NumObjectIDsInScope(), 0);
+  }
+}
+
+// Measures the heap memory used per tracked object, for objects that we own and
+// for objects that we only hold a local reference to. Disabled by default, run it
+// with --gtest_also_run_disabled_tests.
+TEST_F(ReferenceCountTest, DISABLED_BenchmarkBytesPerObject) {
+  const int num_objects = 100000;
+  rpc::Address owner_address;
+  owner_address.set_raylet_id(NodeID::FromRandom().Binary());
+  owner_address.set_ip_address("10.0.0.1");
+  owner_address.set_port(1234);
+  owner_address.set_worker_id(WorkerID::FromRandom().Binary());
+  std::vector<ObjectID> ids;
+  for (int i = 0; i < num_objects; i++) {
+    ids.push_back(ObjectID::FromRandom());
+  }
+
+  for (bool owned : {false, true}) {
+    testing::NiceMock<mock_pubsub::MockPublisher> publisher;
+    int64_t start_bytes = live_heap_bytes;
+    auto counter = std::make_unique<ReferenceCounter>(
+        rpc::Address(), &publisher, subscriber_.get(), [](const NodeID &node_id) {
+          return true;
+        });
+    for (const auto &id : ids) {
+      if (owned) {
+        counter->AddOwnedObject(id,
+                           {},
+                           owner_address,
+                           "ray_perf.py:42:small_value",
+                           /*object_size=*/100,
+                           /*is_reconstructable=*/true,
+                           /*add_local_ref=*/true);
+      } else {
+        counter->AddLocalReference(id, "");
+      }
+    }
+    int64_t bytes = live_heap_bytes - start_bytes;
+    ASSERT_EQ(counter->GetAllReferenceCounts().size(), num_objects);
+    RAY_LOG(INFO) << (owned ? "Owned" : "Borrowed") << " objects: "
+                  << static_cast<double>(bytes) / num_objects
+                  << " bytes per tracked object";
+    for (const auto &id : ids) {
+      counter->RemoveLocalReference(id, nullptr);
+    }
+    ASSERT_EQ(counter->NumObjectIDsInScope(), 0);
+  }
+}
+
 TEST_F(ReferenceCountTest, TestReferenceStatsLimit) {
   ObjectID id1 = ObjectID::FromRandom();
   ObjectID id2 = ObjectID::FromRandom();
@@ -23,6 +23,7 @@
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 #include "ray/core_worker/task_event_buffer.h"
 #include "ray/pubsub/mock_pubsub.h"
+#include "ray/util/filesystem.h"
 
 namespace ray {
 namespace core {
@@ -72,7 +73,8 @@ class MockTaskEventBuffer : public worker::TaskEventBuffer {
 class TaskManagerTest : public ::testing::Test {
  public:
   TaskManagerTest(bool lineage_pinning_enabled = false,
-                  int64_t max_lineage_bytes = 1024 * 1024 * 1024)
+                  int64_t max_lineage_bytes = 1024 * 1024 * 1024,
+                  std::unique_ptr<LineageStore> lineage_store = nullptr)
       : addr_(GetRandomWorkerAddr()),
         publisher_(std::make_shared<mock_pubsub::MockPublisher>()),
         subscriber_(std::make_shared<mock_pubsub::MockSubscriber>()),
@@ -102,7 +104,8 @@ class TaskManagerTest : public ::testing::Test {
                const std::string &error_message,
                double timestamp) { return Status::OK(); },
             max_lineage_bytes,
-            *task_event_buffer_mock_.get()) {}
+            *task_event_buffer_mock_.get(),
+            std::move(lineage_store)) {}
 
   virtual void TearDown() { AssertNoLeaks(); }
 
@@ -111,6 +114,9 @@ class TaskManagerTest : public ::testing::Test {
     ASSERT_EQ(manager_.submissible_tasks_.size(), 0);
     ASSERT_EQ(manager_.num_pending_tasks_, 0);
     ASSERT_EQ(manager_.total_lineage_footprint_bytes_, 0);
+    if (manager_.lineage_store_ != nullptr) {
+      ASSERT_EQ(manager_.lineage_store_->NumEntries(), 0);
+    }
   }
 
   rpc::Address addr_;
@@ -132,6 +138,17 @@ class TaskManagerLineageTest : public TaskManagerTest {
   TaskManagerLineageTest() : TaskManagerTest(true, /*max_lineage_bytes=*/10000) {}
 };
 
+class TaskManagerLineageSpillTest : public TaskManagerTest {
+ public:
+  // Spill all lineage as soon as a task finishes.
+  TaskManagerLineageSpillTest()
+      : TaskManagerTest(true,
+                        /*max_lineage_bytes=*/1,
+                        std::make_unique<LineageStore>(GetUserTempDir(),
+                                                       WorkerID::FromRandom().Hex(),
+                                                       /*max_bytes=*/1024 * 1024)) {}
+};
+
 TEST_F(TaskManagerTest, TestTaskSuccess) {
   rpc::Address caller_address;
   ObjectID dep1 = ObjectID::FromRandom();
@@ -852,7 +869,12 @@ TEST_F(TaskManagerLineageTest, TestResubmitTask) {
   ASSERT_FALSE(reference_counter_->IsObjectPendingCreation(return_id));
 
   // The task finished, its return ID is still in scope, and the return object
-  // was stored in plasma. It is okay to resubmit it now.
+  // was stored in plasma. It is okay to resubmit it now. Getting its
+  // dependencies does not resubmit it.
+  std::vector<ObjectID> task_deps;
+  ASSERT_TRUE(manager_.GetTaskDependencies(spec.TaskId(), &task_deps));
+  ASSERT_EQ(task_deps, spec.GetDependencyIds());
+  ASSERT_EQ(num_retries_, 0);
   ASSERT_TRUE(manager_.ResubmitTask(spec.TaskId(), &resubmitted_task_deps));
   ASSERT_EQ(resubmitted_task_deps, spec.GetDependencyIds());
   ASSERT_EQ(num_retries_, 1);
@@ -865,6 +887,9 @@ TEST_F(TaskManagerLineageTest, TestResubmitTask) {
   reference_counter_->RemoveLocalReference(return_id, nullptr);
   // The task is still pending execution.
   ASSERT_TRUE(manager_.IsTaskPending(spec.TaskId()));
+  task_deps.clear();
+  ASSERT_TRUE(manager_.GetTaskDependencies(spec.TaskId(), &task_deps));
+  ASSERT_TRUE(task_deps.empty());
   // A task that is already pending does not get resubmitted.
   ASSERT_TRUE(manager_.ResubmitTask(spec.TaskId(), &resubmitted_task_deps));
   ASSERT_TRUE(resubmitted_task_deps.empty());
@@ -876,12 +901,71 @@ TEST_F(TaskManagerLineageTest, TestResubmitTask) {
   manager_.CompletePendingTask(spec.TaskId(), reply, rpc::Address(), false);
   ASSERT_FALSE(manager_.IsTaskPending(spec.TaskId()));
   // The task cannot be resubmitted because its spec has been released.
+  ASSERT_FALSE(manager_.GetTaskDependencies(spec.TaskId(), &task_deps));
   ASSERT_FALSE(manager_.ResubmitTask(spec.TaskId(), &resubmitted_task_deps));
   ASSERT_TRUE(resubmitted_task_deps.empty());
   ASSERT_EQ(num_retries_, 1);
   ASSERT_EQ(reference_counter_->NumObjectIDsInScope(), 0);
 }
 
+TEST_F(TaskManagerLineageSpillTest, TestResubmitSpilledTask) {
+  rpc::Address caller_address;
+  ObjectID dep1 = ObjectID::FromRandom();
+  ObjectID dep2 = ObjectID::FromRandom();
+  auto spec = CreateTaskHelper(1, {dep1, dep2});
+  const int64_t spec_size = spec.GetMessage().ByteSizeLong();
+  auto return_id = spec.ReturnId(0);
+  int num_retries = 3;
+  manager_.AddPendingTask(caller_address, spec, "", num_retries);
+
+  // The task completes.
+  manager_.MarkDependenciesResolved(spec.TaskId());
+  manager_.MarkTaskWaitingForExecution(
+      spec.TaskId(), NodeID::FromRandom(), WorkerID::FromRandom());
+  rpc::PushTaskReply reply;
+  auto return_object = reply.add_return_objects();
+  return_object->set_object_id(return_id.Binary());
+  auto data = GenerateRandomBuffer();
+  return_object->set_data(data->Data(), data->Size());
+  return_object->set_in_plasma(true);
+  manager_.CompletePendingTask(spec.TaskId(), reply, rpc::Address(), false);
+
+  // The task's lineage was spilled instead of evicted. It still pins the
+  // task's dependencies.
+  ASSERT_TRUE(manager_.IsTaskSubmissible(spec.TaskId()));
+  ASSERT_EQ(manager_.TotalLineageFootprintBytes(), 0);
+  ASSERT_EQ(manager_.SpilledLineageBytes(), spec_size);
+  ASSERT_TRUE(reference_counter_->HasReference(dep1));
+  ASSERT_TRUE(reference_counter_->HasReference(dep2));
+  auto spilled_spec = manager_.GetTaskSpec(spec.TaskId());
+  ASSERT_TRUE(spilled_spec.has_value());
+  ASSERT_EQ(spilled_spec->TaskId(), spec.TaskId());
+  ASSERT_EQ(spilled_spec->GetDependencyIds(), spec.GetDependencyIds());
+  // The dependencies are known without reading back the spec.
+  std::vector<ObjectID> task_deps;
+  ASSERT_TRUE(manager_.GetTaskDependencies(spec.TaskId(), &task_deps));
+  ASSERT_EQ(task_deps, spec.GetDependencyIds());
+
+  // The spec is read back when the task is resubmitted.
+  std::vector<ObjectID> resubmitted_task_deps;
+  ASSERT_TRUE(manager_.ResubmitTask(spec.TaskId(), &resubmitted_task_deps));
+  ASSERT_EQ(resubmitted_task_deps, spec.GetDependencyIds());
+  ASSERT_EQ(num_retries_, 1);
+  ASSERT_EQ(manager_.SpilledLineageBytes(), 0);
+
+  // The resubmitted task finishes and its lineage is spilled again.
+  manager_.CompletePendingTask(spec.TaskId(), reply, rpc::Address(), false);
+  ASSERT_EQ(manager_.TotalLineageFootprintBytes(), 0);
+  ASSERT_EQ(manager_.SpilledLineageBytes(), spec_size);
+
+  // All lineage should be erased.
+  reference_counter_->RemoveLocalReference(return_id, nullptr);
+  ASSERT_FALSE(manager_.IsTaskSubmissible(spec.TaskId()));
+  ASSERT_FALSE(reference_counter_->HasReference(dep1));
+  ASSERT_FALSE(reference_counter_->HasReference(dep2));
+  ASSERT_EQ(manager_.SpilledLineageBytes(), 0);
+}
+
 // Test resubmission for a task that was successfully executed once and stored
 // its return values in plasma. On re-execution, the task's return values
 // should be stored in plasma again, even if the worker returns its values
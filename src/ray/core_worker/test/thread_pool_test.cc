@@ -0,0 +1,238 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/transport/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
+#include "ray/core_worker/transport/concurrency_group_manager.h"
+
+namespace ray {
+namespace core {
+
+void WaitFor(const std::atomic<int> &counter, int value) {
+  while (counter < value) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+}
+
+class ThreadPoolTest : public ::testing::Test {
+ protected:
+  void TearDown() override { RayConfig::instance().initialize(""); }
+};
+
+/// Tracks how many tasks of a group run at the same time.
+struct ConcurrencyTracker {
+  void Run() {
+    int current = ++running;
+    int max = max_running;
+    while (current > max && !max_running.compare_exchange_weak(max, current)) {
+    }
+    absl::SleepFor(absl::Microseconds(500));
+    running--;
+    finished++;
+  }
+
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  std::atomic<int> finished{0};
+};
+
+TEST_F(ThreadPoolTest, TestWorkStealingThreadPool) {
+  WorkStealingThreadPool pool(4);
+  std::atomic<int> finished{0};
+  // Tasks posted from a thread of the pool go to that thread's queue, and the
+  // other threads steal them.
+  absl::Mutex mu;
+  std::set<std::thread::id> thread_ids;
+  pool.Post([&]() {
+    for (int i = 0; i < 100; i++) {
+      pool.Post([&]() {
+        {
+          absl::MutexLock lock(&mu);
+          thread_ids.insert(std::this_thread::get_id());
+        }
+        absl::SleepFor(absl::Microseconds(100));
+        finished++;
+      });
+    }
+  });
+  WaitFor(finished, 100);
+  {
+    absl::MutexLock lock(&mu);
+    ASSERT_GT(thread_ids.size(), 1);
+  }
+  pool.Stop();
+  pool.Join();
+  // Stop and Join can be called again, e.g., by each executor that shares the pool.
+  pool.Stop();
+  pool.Join();
+}
+
+TEST_F(ThreadPoolTest, TestSharedPoolConcurrencyLimit) {
+  auto pool = std::make_shared<WorkStealingThreadPool>(6);
+  BoundedExecutor executor1(2, pool);
+  BoundedExecutor executor2(4, pool);
+  ConcurrencyTracker tracker1;
+  ConcurrencyTracker tracker2;
+  for (int i = 0; i < 50; i++) {
+    executor1.Post([&]() { tracker1.Run(); });
+    executor2.Post([&]() { tracker2.Run(); });
+  }
+  WaitFor(tracker1.finished, 50);
+  WaitFor(tracker2.finished, 50);
+  ASSERT_EQ(tracker1.max_running, 2);
+  ASSERT_LE(tracker2.max_running, 4);
+  executor1.Stop();
+  executor1.Join();
+  executor2.Stop();
+  executor2.Join();
+}
+
+TEST_F(ThreadPoolTest, TestConcurrencyGroupManagerWorkStealing) {
+  RayConfig::instance().initialize(
+      R"({"actor_executor_work_stealing": true,
+          "actor_executor_work_stealing_num_threads": 4})");
+  std::vector<ConcurrencyGroup> groups = {ConcurrencyGroup("io", 2, {}),
+                                          ConcurrencyGroup("compute", 3, {})};
+  ConcurrencyGroupManager<BoundedExecutor> manager(groups, 1);
+  static auto empty = std::make_shared<ray::EmptyFunctionDescriptor>();
+  ConcurrencyTracker io_tracker;
+  ConcurrencyTracker default_tracker;
+  for (int i = 0; i < 20; i++) {
+    manager.GetExecutor("io", empty)->Post([&]() { io_tracker.Run(); });
+    manager.GetDefaultExecutor()->Post([&]() { default_tracker.Run(); });
+  }
+  WaitFor(io_tracker.finished, 20);
+  WaitFor(default_tracker.finished, 20);
+  ASSERT_EQ(io_tracker.max_running, 2);
+  ASSERT_EQ(default_tracker.max_running, 1);
+  manager.Stop();
+}
+
+TEST_F(ThreadPoolTest, TestConcurrencyGroupManagerBlockedGroup) {
+  RayConfig::instance().initialize(R"({"actor_executor_work_stealing": true})");
+  std::vector<ConcurrencyGroup> groups = {ConcurrencyGroup("io", 4, {})};
+  ConcurrencyGroupManager<BoundedExecutor> manager(groups, 1);
+  static auto empty = std::make_shared<ray::EmptyFunctionDescriptor>();
+  // By default the pool has a thread for every slot, so the io tasks that wait for
+  // a task of the default group can't keep it from running.
+  std::atomic<int> default_finished{0};
+  std::atomic<int> io_finished{0};
+  for (int i = 0; i < 4; i++) {
+    manager.GetExecutor("io", empty)->Post([&]() {
+      WaitFor(default_finished, 1);
+      io_finished++;
+    });
+  }
+  absl::SleepFor(absl::Milliseconds(10));
+  manager.GetDefaultExecutor()->Post([&]() { default_finished++; });
+  WaitFor(io_finished, 4);
+  manager.Stop();
+}
+
+TEST_F(ThreadPoolTest, TestConcurrencyGroupManagerFewerThreads) {
+  RayConfig::instance().initialize(
+      R"({"actor_executor_work_stealing": true,
+          "actor_executor_work_stealing_num_threads": 2})");
+  std::vector<ConcurrencyGroup> groups = {ConcurrencyGroup("io", 2, {}),
+                                          ConcurrencyGroup("compute", 3, {})};
+  ConcurrencyGroupManager<BoundedExecutor> manager(groups, 2);
+  static auto empty = std::make_shared<ray::EmptyFunctionDescriptor>();
+  // The groups share 2 threads, although they could run 7 tasks together.
+  ConcurrencyTracker tracker;
+  for (int i = 0; i < 20; i++) {
+    manager.GetExecutor("io", empty)->Post([&]() { tracker.Run(); });
+    manager.GetExecutor("compute", empty)->Post([&]() { tracker.Run(); });
+    manager.GetDefaultExecutor()->Post([&]() { tracker.Run(); });
+  }
+  WaitFor(tracker.finished, 60);
+  ASSERT_LE(tracker.max_running, 2);
+  manager.Stop();
+}
+
+// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST_F(ThreadPoolTest, DISABLED_BenchmarkSkewedGroupLoad) {
+  // One hot group gets most of the tasks, and three cold groups get a trickle.
+  // Each task spins for a while. Compare the queueing latency of the tasks with
+  // a thread pool per group and with a shared work-stealing pool.
+  const int num_hot_tasks = 4000;
+  const int cold_every = 10;
+  const auto task_duration = absl::Microseconds(50);
+  std::vector<ConcurrencyGroup> groups = {ConcurrencyGroup("hot", 4, {}),
+                                          ConcurrencyGroup("cold1", 4, {}),
+                                          ConcurrencyGroup("cold2", 4, {}),
+                                          ConcurrencyGroup("cold3", 4, {})};
+  static auto empty = std::make_shared<ray::EmptyFunctionDescriptor>();
+  for (bool work_stealing : {false, true}) {
+    RayConfig::instance().initialize(absl::StrCat(
+        R"({"actor_executor_work_stealing": )", work_stealing ? "true" : "false", "}"));
+    ConcurrencyGroupManager<BoundedExecutor> manager(groups, 1);
+    absl::Mutex mu;
+    std::vector<double> hot_latencies_us;
+    std::vector<double> cold_latencies_us;
+    std::atomic<int> finished{0};
+    auto post = [&](const std::string &group, std::vector<double> *latencies) {
+      auto posted = absl::Now();
+      manager.GetExecutor(group, empty)->Post([&, posted, latencies]() {
+        auto start = absl::Now();
+        {
+          absl::MutexLock lock(&mu);
+          latencies->push_back(absl::ToDoubleMicroseconds(start - posted));
+        }
+        while (absl::Now() - start < task_duration) {
+        }
+        finished++;
+      });
+    };
+
+    auto start = absl::Now();
+    int num_tasks = 0;
+    for (int i = 0; i < num_hot_tasks; i++) {
+      post("hot", &hot_latencies_us);
+      num_tasks++;
+      if (i % cold_every == 0) {
+        post(groups[1 + (i / cold_every) % 3].name, &cold_latencies_us);
+        num_tasks++;
+      }
+    }
+    WaitFor(finished, num_tasks);
+    auto elapsed = absl::Now() - start;
+    manager.Stop();
+
+    auto percentile = [](std::vector<double> &latencies, double p) {
+      std::sort(latencies.begin(), latencies.end());
+      return latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+    };
+    RAY_LOG(INFO) << (work_stealing ? "Shared work-stealing pool" : "Pool per group")
+                  << ": " << num_tasks << " tasks in "
+                  << absl::ToDoubleMilliseconds(elapsed) << "ms, hot group latency p50 "
+                  << percentile(hot_latencies_us, 0.5) << "us p99 "
+                  << percentile(hot_latencies_us, 0.99) << "us, cold group latency p50 "
+                  << percentile(cold_latencies_us, 0.5) << "us p99 "
+                  << percentile(cold_latencies_us, 0.99) << "us";
+  }
+}
+
+}  // namespace core
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
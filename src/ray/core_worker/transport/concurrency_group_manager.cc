@@ -14,20 +14,84 @@
 
 #include "ray/core_worker/transport/concurrency_group_manager.h"
 
+#include <algorithm>
+
+#include "ray/common/ray_config.h"
 #include "ray/core_worker/fiber.h"
 #include "ray/core_worker/transport/thread_pool.h"
 
 namespace ray {
 namespace core {
 
+namespace {
+
+/// Creates the executors of the concurrency groups of an actor. By default,
+/// each executor is independent of the others.
+template <typename ExecutorType>
+class ExecutorFactory {
+ public:
+  explicit ExecutorFactory(int32_t total_max_concurrency) {}
+
+  std::shared_ptr<ExecutorType> Create(int32_t max_concurrency) {
+    return std::make_shared<ExecutorType>(max_concurrency);
+  }
+};
+
+/// The thread pool executors of an actor can share one work-stealing pool. By
+/// default the pool has a thread for every slot of every group, so a group that
+/// blocks on another group can't deadlock. A smaller pool, where the groups take
+/// turns on the threads, is opt-in.
+template <>
+class ExecutorFactory<BoundedExecutor> {
+ public:
+  explicit ExecutorFactory(int32_t total_max_concurrency) {
+    if (RayConfig::instance().actor_executor_work_stealing() &&
+        total_max_concurrency > 0) {
+      int64_t num_threads =
+          RayConfig::instance().actor_executor_work_stealing_num_threads();
+      if (num_threads <= 0) {
+        num_threads = total_max_concurrency;
+      }
+      shared_pool_ = std::make_shared<WorkStealingThreadPool>(
+          std::min<int64_t>(num_threads, total_max_concurrency));
+    }
+  }
+
+  std::shared_ptr<BoundedExecutor> Create(int32_t max_concurrency) {
+    if (shared_pool_) {
+      return std::make_shared<BoundedExecutor>(max_concurrency, shared_pool_);
+    }
+    return std::make_shared<BoundedExecutor>(max_concurrency);
+  }
+
+ private:
+  std::shared_ptr<WorkStealingThreadPool> shared_pool_;
+};
+
+}  // namespace
+
 template <typename ExecutorType>
 ConcurrencyGroupManager<ExecutorType>::ConcurrencyGroupManager(
     const std::vector<ConcurrencyGroup> &concurrency_groups,
     const int32_t max_concurrency_for_default_concurrency_group) {
+  // If max concurrency of default group is 1 and there is no other concurrency group of
+  // this actor, the tasks of default group will be performed in main thread instead of
+  // any executor pool, otherwise tasks in any concurrency group should be performed in
+  // the thread pools instead of main thread.
+  const bool need_default_executor =
+      ExecutorType::NeedDefaultExecutor(max_concurrency_for_default_concurrency_group) ||
+      !concurrency_groups.empty();
+  int32_t total_max_concurrency =
+      need_default_executor ? max_concurrency_for_default_concurrency_group : 0;
+  for (auto &group : concurrency_groups) {
+    total_max_concurrency += group.max_concurrency;
+  }
+  ExecutorFactory<ExecutorType> executor_factory(total_max_concurrency);
+
   for (auto &group : concurrency_groups) {
     const auto name = group.name;
     const auto max_concurrency = group.max_concurrency;
-    auto executor = std::make_shared<ExecutorType>(max_concurrency);
+    auto executor = executor_factory.Create(max_concurrency);
     auto &fds = group.function_descriptors;
     for (auto fd : fds) {
       functions_to_executor_index_[fd->ToString()] = executor;
@@ -35,14 +99,9 @@ ConcurrencyGroupManager<ExecutorType>::ConcurrencyGroupManager(
     name_to_executor_index_[name] = executor;
   }
 
-  // If max concurrency of default group is 1 and there is no other concurrency group of
-  // this actor, the tasks of default group will be performed in main thread instead of
-  // any executor pool, otherwise tasks in any concurrency group should be performed in
-  // the thread pools instead of main thread.
-  if (ExecutorType::NeedDefaultExecutor(max_concurrency_for_default_concurrency_group) ||
-      !concurrency_groups.empty()) {
+  if (need_default_executor) {
     defatult_executor_ =
-        std::make_shared<ExecutorType>(max_concurrency_for_default_concurrency_group);
+        executor_factory.Create(max_concurrency_for_default_concurrency_group);
   }
 }
 
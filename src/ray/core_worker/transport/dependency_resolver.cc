@@ -18,7 +18,7 @@ namespace ray {
 namespace core {
 
 void InlineDependencies(
-    absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> dependencies,
+    const absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> &dependencies,
     TaskSpecification &task,
     std::vector<ObjectID> *inlined_dependency_ids,
     std::vector<ObjectID> *contained_ids) {
@@ -62,37 +62,41 @@ void LocalDependencyResolver::CancelDependencyResolution(const TaskID &task_id)
   pending_tasks_.erase(task_id);
 }
 
-void LocalDependencyResolver::ResolveDependencies(
-    TaskSpecification &task, std::function<void(Status)> on_dependencies_resolved) {
-  std::unordered_set<ObjectID> local_dependency_ids;
-  std::unordered_set<ActorID> actor_dependency_ids;
+void LocalDependencyResolver::GetDependencies(
+    const TaskSpecification &task,
+    std::unordered_set<ObjectID> *local_dependency_ids,
+    std::unordered_set<ActorID> *actor_dependency_ids) const {
   for (size_t i = 0; i < task.NumArgs(); i++) {
     if (task.ArgByRef(i)) {
-      local_dependency_ids.insert(task.ArgId(i));
+      local_dependency_ids->insert(task.ArgId(i));
     }
     for (const auto &in : task.ArgInlinedRefs(i)) {
       auto object_id = ObjectID::FromBinary(in.object_id());
       if (ObjectID::IsActorID(object_id)) {
         auto actor_id = ObjectID::ToActorID(object_id);
         if (actor_creator_.IsActorInRegistering(actor_id)) {
-          actor_dependency_ids.insert(ObjectID::ToActorID(object_id));
+          actor_dependency_ids->insert(ObjectID::ToActorID(object_id));
         }
       }
     }
   }
-  if (local_dependency_ids.empty() && actor_dependency_ids.empty()) {
-    on_dependencies_resolved(Status::OK());
-    return;
-  }
+}
 
+void LocalDependencyResolver::ResolveDependenciesAsync(
+    TaskSpecification &task,
+    std::unordered_set<ObjectID> local_dependency_ids,
+    std::unordered_set<ActorID> actor_dependency_ids,
+    std::function<void(Status)> on_dependencies_resolved) {
   const auto task_id = task.TaskId();
   {
     absl::MutexLock lock(&mu_);
     // This is deleted when the last dependency fetch callback finishes.
     auto inserted = pending_tasks_.emplace(
         task_id,
-        std::make_unique<TaskState>(
-            task, local_dependency_ids, actor_dependency_ids, on_dependencies_resolved));
+        std::make_unique<TaskState>(task,
+                                    local_dependency_ids,
+                                    actor_dependency_ids,
+                                    std::move(on_dependencies_resolved)));
     RAY_CHECK(inserted.second);
   }
 
@@ -137,7 +141,7 @@ void LocalDependencyResolver::ResolveDependencies(
 
   for (const auto &actor_id : actor_dependency_ids) {
     actor_creator_.AsyncWaitForActorRegisterFinish(
-        actor_id, [this, task_id, on_dependencies_resolved](const Status &status) {
+        actor_id, [this, task_id](const Status &status) {
           std::unique_ptr<TaskState> resolved_task_state = nullptr;
 
           {
@@ -15,6 +15,8 @@
 #pragma once
 
 #include <memory>
+#include <unordered_set>
+#include <utility>
 
 #include "ray/common/id.h"
 #include "ray/common/task/task_spec.h"
@@ -49,8 +51,23 @@ class LocalDependencyResolver {
   /// \param[in] on_dependencies_resolved A callback to call once the task's dependencies
   /// have been resolved. Note that we will not call this if the dependency
   /// resolution is cancelled.
-  void ResolveDependencies(TaskSpecification &task,
-                           std::function<void(Status)> on_dependencies_resolved);
+  template <typename Callback>
+  void ResolveDependencies(TaskSpecification &task, Callback &&on_dependencies_resolved) {
+    std::unordered_set<ObjectID> local_dependency_ids;
+    std::unordered_set<ActorID> actor_dependency_ids;
+    GetDependencies(task, &local_dependency_ids, &actor_dependency_ids);
+    if (local_dependency_ids.empty() && actor_dependency_ids.empty()) {
+      // Most tasks have nothing to wait for. Call the callback inline so that it
+      // does not have to be stored in a heap-allocated std::function.
+      on_dependencies_resolved(Status::OK());
+      return;
+    }
+    ResolveDependenciesAsync(
+        task,
+        std::move(local_dependency_ids),
+        std::move(actor_dependency_ids),
+        std::function<void(Status)>(std::forward<Callback>(on_dependencies_resolved)));
+  }
 
   /// Cancel resolution of the given task's dependencies. Its registered
   /// callback will not be called.
@@ -64,16 +81,28 @@ class LocalDependencyResolver {
   }
 
  private:
+  /// Collect the task's arguments that are passed by reference and the actors
+  /// that its arguments depend on that are still being registered.
+  void GetDependencies(const TaskSpecification &task,
+                       std::unordered_set<ObjectID> *local_dependency_ids,
+                       std::unordered_set<ActorID> *actor_dependency_ids) const;
+
+  /// Wait for the given dependencies of the task, which must not all be empty.
+  void ResolveDependenciesAsync(TaskSpecification &task,
+                                std::unordered_set<ObjectID> local_dependency_ids,
+                                std::unordered_set<ActorID> actor_dependency_ids,
+                                std::function<void(Status)> on_dependencies_resolved);
+
   struct TaskState {
     TaskState(TaskSpecification t,
               const std::unordered_set<ObjectID> &deps,
               const std::unordered_set<ActorID> &actor_ids,
               std::function<void(Status)> on_dependencies_resolved)
-        : task(t),
+        : task(std::move(t)),
           local_dependencies(),
           actor_dependencies_remaining(actor_ids.size()),
           status(Status::OK()),
-          on_dependencies_resolved(on_dependencies_resolved) {
+          on_dependencies_resolved(std::move(on_dependencies_resolved)) {
       for (const auto &dep : deps) {
         local_dependencies.emplace(dep, nullptr);
       }
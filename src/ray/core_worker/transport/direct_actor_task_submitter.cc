@@ -16,6 +16,7 @@
 
 #include <thread>
 
+#include "ray/common/asio/asio_util.h"
 #include "ray/common/task/task.h"
 #include "ray/gcs/pb_util.h"
 
@@ -168,6 +169,9 @@ void CoreWorkerDirectActorTaskSubmitter::DisconnectRpcClient(ClientQueue &queue)
   core_worker_client_pool_.Disconnect(WorkerID::FromBinary(queue.worker_id));
   queue.worker_id.clear();
   queue.pending_force_kill.reset();
+  // The callbacks of the batched tasks are failed along with the other inflight
+  // tasks.
+  queue.pending_batch.clear();
 }
 
 void CoreWorkerDirectActorTaskSubmitter::FailInflightTasks(
@@ -487,7 +491,39 @@ void CoreWorkerDirectActorTaskSubmitter::PushActorTask(ClientQueue &queue,
   task_finisher_.MarkTaskWaitingForExecution(task_id,
                                              NodeID::FromBinary(addr.raylet_id()),
                                              WorkerID::FromBinary(addr.worker_id()));
-  queue.rpc_client->PushActorTask(std::move(request), skip_queue, wrapped_callback);
+  if (skip_queue || batch_max_size_ <= 1) {
+    queue.rpc_client->PushActorTask(std::move(request), skip_queue, wrapped_callback);
+    return;
+  }
+
+  // Hold the task back for a short while, so that tasks that are sent right after
+  // it go out in the same RPC. The batch keeps the order of the tasks, so the
+  // actor still executes them in sequence number order.
+  queue.pending_batch.emplace_back(std::move(request), std::move(wrapped_callback));
+  if (queue.pending_batch.size() >= batch_max_size_) {
+    FlushPendingBatch(queue);
+  } else if (!queue.batch_flush_scheduled) {
+    queue.batch_flush_scheduled = true;
+    execute_after_us(
+        io_service_,
+        [this, actor_id]() {
+          absl::MutexLock lock(&mu_);
+          auto it = client_queues_.find(actor_id);
+          RAY_CHECK(it != client_queues_.end());
+          it->second.batch_flush_scheduled = false;
+          FlushPendingBatch(it->second);
+        },
+        batch_window_us_);
+  }
+}
+
+void CoreWorkerDirectActorTaskSubmitter::FlushPendingBatch(ClientQueue &queue) {
+  if (queue.pending_batch.empty() || !queue.rpc_client) {
+    return;
+  }
+  rpc::PushTaskBatch batch;
+  batch.swap(queue.pending_batch);
+  queue.rpc_client->PushActorTasks(std::move(batch));
 }
 
 void CoreWorkerDirectActorTaskSubmitter::HandlePushTaskReply(
@@ -78,7 +78,9 @@ class CoreWorkerDirectActorTaskSubmitter
         resolver_(store, task_finisher, actor_creator),
         task_finisher_(task_finisher),
         warn_excess_queueing_(warn_excess_queueing),
-        io_service_(io_service) {
+        io_service_(io_service),
+        batch_max_size_(::RayConfig::instance().actor_task_batch_max_size()),
+        batch_window_us_(::RayConfig::instance().actor_task_batch_window_us()) {
     next_queueing_warn_threshold_ =
         ::RayConfig::instance().actor_excess_queueing_warn_threshold();
   }
@@ -219,6 +221,14 @@ class CoreWorkerDirectActorTaskSubmitter
     absl::flat_hash_map<TaskID, rpc::ClientCallback<rpc::PushTaskReply>>
         inflight_task_callbacks;
 
+    /// Tasks that are waiting to be sent to the actor together in one PushTasks
+    /// RPC. Their callbacks are also in inflight_task_callbacks. Only used if
+    /// actor_task_batch_max_size is greater than 1.
+    rpc::PushTaskBatch pending_batch;
+
+    /// Whether a timer to send pending_batch is running.
+    bool batch_flush_scheduled = false;
+
     /// The max number limit of task capacity used for back pressure.
     /// If the number of tasks in requests >= max_pending_calls, it can't continue to
     /// push task to ClientQueue.
@@ -254,6 +264,11 @@ class CoreWorkerDirectActorTaskSubmitter
                      const TaskSpecification &task_spec,
                      bool skip_queue) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Send the tasks waiting in the actor's pending batch, if any.
+  ///
+  /// \param[in] queue The actor queue. Contains the RPC client state.
+  void FlushPendingBatch(ClientQueue &queue) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   void HandlePushTaskReply(const Status &status,
                            const rpc::PushTaskReply &reply,
                            const rpc::Address &addr,
@@ -310,6 +325,12 @@ class CoreWorkerDirectActorTaskSubmitter
   /// The event loop where the actor task events are handled.
   instrumented_io_context &io_service_;
 
+  /// The max number of tasks to send to an actor in one PushTasks RPC.
+  const uint64_t batch_max_size_;
+
+  /// How long to wait for a batch to fill up before sending it.
+  const uint64_t batch_window_us_;
+
   friend class CoreWorkerTest;
 };
 
@@ -14,8 +14,10 @@
 
 #include "ray/core_worker/transport/direct_actor_transport.h"
 
+#include <algorithm>
 #include <thread>
 
+#include "ray/common/asio/asio_util.h"
 #include "ray/common/task/task.h"
 #include "ray/gcs/pb_util.h"
 
@@ -293,6 +295,141 @@ void CoreWorkerDirectTaskReceiver::HandleTask(
   }
 }
 
+namespace {
+
+/// Send the reply to a task that was pushed in a PushTasks RPC to its caller. If the
+/// send fails, retry it after retry_delay_ms, with the delay doubling up to
+/// actor_task_reply_report_max_retry_delay_ms, until it succeeds or the caller is
+/// known to be dead. Then call on_done with the status of the last send.
+void ReportTaskReplyWithRetries(
+    const rpc::Address &caller_address,
+    std::shared_ptr<rpc::ReportActorTaskReplyRequest> task_reply,
+    std::function<void(const rpc::Address &,
+                       const rpc::ReportActorTaskReplyRequest &,
+                       std::function<void(const Status &)>)> report_task_reply,
+    std::function<void(const rpc::Address &, const Status &, std::function<void(bool)>)>
+        check_caller_dead,
+    instrumented_io_context &io_service,
+    int64_t retry_delay_ms,
+    std::function<void(const Status &)> on_done) {
+  report_task_reply(
+      caller_address,
+      *task_reply,
+      [caller_address,
+       task_reply,
+       report_task_reply,
+       check_caller_dead,
+       &io_service,
+       retry_delay_ms,
+       on_done = std::move(on_done)](const Status &status) mutable {
+        if (status.ok()) {
+          on_done(status);
+          return;
+        }
+        check_caller_dead(
+            caller_address,
+            status,
+            [caller_address,
+             task_reply = std::move(task_reply),
+             report_task_reply = std::move(report_task_reply),
+             check_caller_dead,
+             &io_service,
+             retry_delay_ms,
+             status,
+             on_done = std::move(on_done)](bool caller_dead) mutable {
+              const auto task_id = TaskID::FromBinary(task_reply->task_id());
+              if (caller_dead) {
+                RAY_LOG(WARNING) << "Failed to report the reply to actor task "
+                                 << task_id << " because its caller is dead: " << status;
+                on_done(status);
+                return;
+              }
+              RAY_LOG(WARNING) << "Failed to report the reply to actor task " << task_id
+                               << " to its caller, retrying in " << retry_delay_ms
+                               << "ms: " << status;
+              const int64_t next_retry_delay_ms = std::min<int64_t>(
+                  2 * retry_delay_ms,
+                  RayConfig::instance().actor_task_reply_report_max_retry_delay_ms());
+              execute_after(
+                  io_service,
+                  [caller_address,
+                   task_reply = std::move(task_reply),
+                   report_task_reply = std::move(report_task_reply),
+                   check_caller_dead = std::move(check_caller_dead),
+                   &io_service,
+                   next_retry_delay_ms,
+                   on_done = std::move(on_done)]() mutable {
+                    ReportTaskReplyWithRetries(caller_address,
+                                               std::move(task_reply),
+                                               std::move(report_task_reply),
+                                               std::move(check_caller_dead),
+                                               io_service,
+                                               next_retry_delay_ms,
+                                               std::move(on_done));
+                  },
+                  retry_delay_ms);
+            });
+      });
+}
+
+}  // namespace
+
+void CoreWorkerDirectTaskReceiver::HandleTaskBatch(
+    rpc::PushTasksRequest request,
+    rpc::PushTasksReply *reply,
+    rpc::SendReplyCallback send_reply_callback,
+    const std::function<void(rpc::PushTaskRequest,
+                             rpc::PushTaskReply *,
+                             rpc::SendReplyCallback)> &handle_task,
+    const std::function<void(const rpc::Address &,
+                             const rpc::ReportActorTaskReplyRequest &,
+                             std::function<void(const Status &)>)> &report_task_reply,
+    const std::function<void(const rpc::Address &,
+                             const Status &,
+                             std::function<void(bool)>)> &check_caller_dead,
+    instrumented_io_context &io_service) {
+  for (auto &task_request : *request.mutable_requests()) {
+    const auto &task_spec = task_request.task_spec();
+    auto task_reply = std::make_shared<rpc::ReportActorTaskReplyRequest>();
+    task_reply->set_intended_worker_id(task_spec.caller_address().worker_id());
+    task_reply->set_task_id(task_spec.task_id());
+    task_reply->set_attempt_number(task_spec.attempt_number());
+    auto task_reply_callback = [task_reply,
+                                caller_address = task_spec.caller_address(),
+                                report_task_reply,
+                                check_caller_dead,
+                                &io_service](Status status,
+                                             std::function<void()> success,
+                                             std::function<void()> failure) {
+      if (!status.ok()) {
+        task_reply->set_status_code(status.CodeAsString());
+        task_reply->set_status_message(status.message());
+      }
+      ReportTaskReplyWithRetries(
+          caller_address,
+          task_reply,
+          report_task_reply,
+          check_caller_dead,
+          io_service,
+          RayConfig::instance().actor_task_reply_report_initial_retry_delay_ms(),
+          [success = std::move(success),
+           failure = std::move(failure)](const Status &status) {
+            if (status.ok() && success) {
+              success();
+            } else if (!status.ok() && failure) {
+              failure();
+            }
+          });
+    };
+    handle_task(std::move(task_request),
+                task_reply->mutable_reply(),
+                std::move(task_reply_callback));
+  }
+  // The tasks are queued. Each of them is replied to on its own once it finishes, so
+  // that a task can depend on the result of an earlier task in the same batch.
+  send_reply_callback(Status::OK(), nullptr, nullptr);
+}
+
 void CoreWorkerDirectTaskReceiver::RunNormalTasksFromQueue() {
   // If the scheduling queue is empty, return.
   if (normal_scheduling_queue_->TaskQueueEmpty()) {
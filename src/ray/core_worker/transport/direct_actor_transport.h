@@ -87,6 +87,40 @@ class CoreWorkerDirectTaskReceiver {
                   rpc::PushTaskReply *reply,
                   rpc::SendReplyCallback send_reply_callback);
 
+  /// Handle a batch of tasks pushed with PushTasks. Each task is passed to
+  /// `handle_task` in order, as if it had been pushed on its own, so the tasks
+  /// go through the same scheduling queue and sequence number checks. The batch
+  /// is replied to once the tasks are queued, and the reply to each task is
+  /// passed to `report_task_reply` once the task finishes.
+  ///
+  /// \param[in] request The request message.
+  /// \param[out] reply The reply message.
+  /// \param[in] send_reply_callback The callback to be called when the batch is queued.
+  /// \param[in] handle_task The handler for a single task. Its reply callback may
+  /// be called from any thread.
+  /// \param[in] report_task_reply Sends the reply to a task to the caller at the given
+  /// address, and calls the given callback with the status of the send.
+  /// \param[in] check_caller_dead Checks whether the caller at the given address is
+  /// known to be dead, given the status of a failed send, and calls the given
+  /// callback with the result.
+  /// \param[in] io_service The event loop to retry failed sends on. The caller has
+  /// no other way to learn the result of a task, so a failed send is retried with
+  /// backoff until it succeeds or the caller is known to be dead.
+  static void HandleTaskBatch(
+      rpc::PushTasksRequest request,
+      rpc::PushTasksReply *reply,
+      rpc::SendReplyCallback send_reply_callback,
+      const std::function<void(rpc::PushTaskRequest,
+                               rpc::PushTaskReply *,
+                               rpc::SendReplyCallback)> &handle_task,
+      const std::function<void(const rpc::Address &,
+                               const rpc::ReportActorTaskReplyRequest &,
+                               std::function<void(const Status &)>)> &report_task_reply,
+      const std::function<void(const rpc::Address &,
+                               const Status &,
+                               std::function<void(bool)>)> &check_caller_dead,
+      instrumented_io_context &io_service);
+
   /// Pop tasks from the queue and execute them sequentially
   void RunNormalTasksFromQueue();
 
@@ -16,10 +16,39 @@
 
 #include "ray/core_worker/transport/dependency_resolver.h"
 #include "ray/gcs/pb_util.h"
+#include "ray/stats/metric_defs.h"
 
 namespace ray {
 namespace core {
 
+namespace {
+
+/// Whether a worker leased for tasks of one scheduling key can run the tasks
+/// of another one. The worker's resources are granted for a resource shape and
+/// its process is started with a runtime env, so those have to match. The
+/// function, the depth and the dependencies only affect which worker the
+/// raylet picks, so they are ignored.
+bool CanReuseLease(const SchedulingKey &key,
+                   const TaskSpecification &spec,
+                   const SchedulingKey &other_key,
+                   const TaskSpecification &other_spec) {
+  if (!std::get<2>(key).IsNil() || !std::get<2>(other_key).IsNil()) {
+    // Actor creation leases are held by the actor.
+    return false;
+  }
+  if (std::get<3>(key) != std::get<3>(other_key)) {
+    return false;
+  }
+  if (std::get<0>(key) == std::get<0>(other_key)) {
+    return true;
+  }
+  return spec.GetLanguage() == other_spec.GetLanguage() &&
+         spec.GetRequiredResources() == other_spec.GetRequiredResources() &&
+         spec.GetSchedulingStrategy() == other_spec.GetSchedulingStrategy();
+}
+
+}  // namespace
+
 Status CoreWorkerDirectTaskSubmitter::SubmitTask(TaskSpecification task_spec) {
   RAY_LOG(DEBUG) << "Submit task " << task_spec.TaskId();
   num_tasks_submitted_++;
@@ -195,16 +224,42 @@ void CoreWorkerDirectTaskSubmitter::OnWorkerIdle(
 
   auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
   auto &current_queue = scheduling_key_entry.task_queue;
+  const bool lease_expired = current_time_ms() > lease_entry.lease_expiration_time;
   // Return the worker if there was an error executing the previous task,
   // the lease is expired; Return the worker if there are no more applicable
   // queued tasks.
-  if ((was_error || worker_exiting ||
-       current_time_ms() > lease_entry.lease_expiration_time) ||
-      current_queue.empty()) {
+  if ((was_error || worker_exiting || lease_expired) || current_queue.empty()) {
     RAY_CHECK(scheduling_key_entry.active_workers.size() >= 1);
 
     // Return the worker only if there are no tasks to do.
     if (!lease_entry.is_busy) {
+      if (!was_error && !worker_exiting && !lease_expired &&
+          RayConfig::instance().worker_lease_reuse_across_scheduling_keys()) {
+        // There are no more tasks for this scheduling key, but the worker can
+        // run the queued tasks of another one without a new lease.
+        auto reuse_key = FindSchedulingKeyToReuseLease(scheduling_key);
+        if (reuse_key.has_value()) {
+          RAY_LOG(DEBUG) << "Reusing lease of worker " << addr.worker_id
+                         << " for another scheduling key";
+          scheduling_key_entry.active_workers.erase(addr);
+          if (scheduling_key_entry.CanDelete()) {
+            scheduling_key_entries_.erase(scheduling_key);
+          }
+          lease_entry.scheduling_key = *reuse_key;
+          auto &reuse_entry = scheduling_key_entries_[*reuse_key];
+          RAY_CHECK(reuse_entry.active_workers.emplace(addr).second);
+          num_leases_reused_++;
+          stats::STATS_core_worker_lease_reuses_total.Record(1);
+          // This pushes the queued tasks to the worker and cancels the lease
+          // requests that are no longer needed.
+          OnWorkerIdle(addr,
+                       *reuse_key,
+                       /*was_error=*/false,
+                       /*worker_exiting=*/false,
+                       assigned_resources);
+          return;
+        }
+      }
       ReturnWorker(addr, was_error, worker_exiting, scheduling_key);
     }
   } else {
@@ -230,6 +285,39 @@ void CoreWorkerDirectTaskSubmitter::OnWorkerIdle(
   RequestNewWorkerIfNeeded(scheduling_key);
 }
 
+absl::optional<SchedulingKey>
+CoreWorkerDirectTaskSubmitter::FindSchedulingKeyToReuseLease(
+    const SchedulingKey &scheduling_key) {
+  auto it = scheduling_key_entries_.find(scheduling_key);
+  RAY_CHECK(it != scheduling_key_entries_.end());
+  const auto &resource_spec = it->second.resource_spec;
+
+  // Prefer the key with the most tasks that are not covered by a pending lease
+  // request, since it would otherwise have to wait the longest.
+  absl::optional<SchedulingKey> best_key;
+  int64_t best_backlog = -1;
+  size_t best_queue_size = 0;
+  for (const auto &[other_key, other_entry] : scheduling_key_entries_) {
+    if (other_key == scheduling_key || other_entry.task_queue.empty() ||
+        !other_entry.AllWorkersBusy()) {
+      continue;
+    }
+    if (!CanReuseLease(
+            scheduling_key, resource_spec, other_key, other_entry.resource_spec)) {
+      continue;
+    }
+    const int64_t backlog = other_entry.BacklogSize();
+    const size_t queue_size = other_entry.task_queue.size();
+    if (backlog > best_backlog ||
+        (backlog == best_backlog && queue_size > best_queue_size)) {
+      best_key = other_key;
+      best_backlog = backlog;
+      best_queue_size = queue_size;
+    }
+  }
+  return best_key;
+}
+
 void CoreWorkerDirectTaskSubmitter::CancelWorkerLeaseIfNeeded(
     const SchedulingKey &scheduling_key) {
   auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
@@ -584,27 +672,32 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
   RAY_LOG(DEBUG) << "Pushing task " << task_spec.TaskId() << " to worker "
                  << addr.worker_id << " of raylet " << addr.raylet_id;
   auto task_id = task_spec.TaskId();
-  auto request = std::make_unique<rpc::PushTaskRequest>();
   bool is_actor = task_spec.IsActorTask();
   bool is_actor_creation = task_spec.IsActorCreationTask();
-
-  // NOTE(swang): CopyFrom is needed because if we use Swap here and the task
-  // fails, then the task data will be gone when the TaskManager attempts to
-  // access the task.
-  request->mutable_task_spec()->CopyFrom(task_spec.GetMessage());
-  request->mutable_resource_mapping()->CopyFrom(assigned_resources);
-  request->set_intended_worker_id(addr.worker_id.Binary());
+  bool retry_exceptions = task_spec.GetMessage().retry_exceptions();
+
+  rpc::PushTaskRequest request;
+  // The request borrows the task spec instead of copying it. This is safe because
+  // the request is serialized before PushNormalTask returns, and the spec is
+  // released from the request right after. We can't Swap the spec in either,
+  // since the TaskManager still needs it if the task fails.
+  request.unsafe_arena_set_allocated_task_spec(
+      const_cast<rpc::TaskSpec *>(&task_spec.GetMessage()));
+  request.mutable_resource_mapping()->CopyFrom(assigned_resources);
+  request.set_intended_worker_id(addr.worker_id.Binary());
+  // Normal tasks have no ordering constraint.
+  request.set_sequence_number(-1);
+  request.set_client_processed_up_to(-1);
   task_finisher_->MarkTaskWaitingForExecution(task_id, addr.raylet_id, addr.worker_id);
   client.PushNormalTask(
-      std::move(request),
+      request,
       [this,
-       task_spec,
        task_id,
        is_actor,
        is_actor_creation,
+       retry_exceptions,
        scheduling_key,
-       addr,
-       assigned_resources](Status status, const rpc::PushTaskReply &reply) {
+       addr](Status status, const rpc::PushTaskReply &reply) {
         {
           RAY_LOG(DEBUG) << "Task " << task_id << " finished from worker "
                          << addr.worker_id << " of raylet " << addr.raylet_id;
@@ -647,7 +740,7 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
                          scheduling_key,
                          /*error=*/!status.ok(),
                          /*worker_exiting=*/reply.worker_exiting(),
-                         assigned_resources);
+                         lease_entry.assigned_resources);
           }
         }
         if (status.ok()) {
@@ -656,7 +749,7 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
                            << " was cancelled before it started running.";
             RAY_UNUSED(
                 task_finisher_->FailPendingTask(task_id, rpc::ErrorType::TASK_CANCELLED));
-          } else if (!task_spec.GetMessage().retry_exceptions() ||
+          } else if (!retry_exceptions ||
                      !reply.is_retryable_error() ||
                      !task_finisher_->RetryTaskIfPossible(
                          task_id,
@@ -667,6 +760,7 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
           }
         }
       });
+  request.unsafe_arena_release_task_spec();
 }
 
 void CoreWorkerDirectTaskSubmitter::HandleGetTaskFailureCause(
@@ -133,6 +133,11 @@ class CoreWorkerDirectTaskSubmitter {
     return num_leases_requested_;
   }
 
+  int64_t GetNumLeasesReused() {
+    absl::MutexLock lock(&mu_);
+    return num_leases_reused_;
+  }
+
   /// Report worker backlog information to the local raylet.
   /// Since each worker only reports to its local rayet
   /// we avoid double counting backlogs in autoscaler.
@@ -156,6 +161,17 @@ class CoreWorkerDirectTaskSubmitter {
       const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Find another scheduling key whose queued tasks can run on an idle worker
+  /// leased for the given scheduling key, so that the lease can be reused
+  /// instead of returned to the raylet. Only keys whose workers are all busy
+  /// are considered.
+  ///
+  /// \param[in] scheduling_key The scheduling key of the idle worker.
+  /// \return The scheduling key with the largest backlog among the compatible
+  /// ones, or nullopt if there is none.
+  absl::optional<SchedulingKey> FindSchedulingKeyToReuseLease(
+      const SchedulingKey &scheduling_key) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// Get an existing lease client or connect a new one. If a raylet_address is
   /// provided, this connects to a remote raylet. Else, this connects to the
   /// local raylet.
@@ -368,6 +384,7 @@ class CoreWorkerDirectTaskSubmitter {
 
   int64_t num_tasks_submitted_ = 0;
   int64_t num_leases_requested_ GUARDED_BY(mu_) = 0;
+  int64_t num_leases_reused_ GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace core
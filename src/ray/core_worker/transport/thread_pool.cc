@@ -16,16 +16,186 @@
 
 #include <boost/asio/post.hpp>
 
+#include "ray/util/logging.h"
+
 namespace ray {
 namespace core {
 
-BoundedExecutor::BoundedExecutor(int max_concurrency) : pool_(max_concurrency){};
+namespace {
+
+/// The pool and the index of the queue of the current thread, if it is a thread
+/// of a WorkStealingThreadPool.
+thread_local WorkStealingThreadPool *current_pool = nullptr;
+thread_local size_t current_queue_index = 0;
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(int num_threads) {
+  RAY_CHECK(num_threads > 0);
+  for (int i = 0; i < num_threads; i++) {
+    queues_.push_back(std::make_unique<TaskQueue>());
+  }
+  for (int i = 0; i < num_threads; i++) {
+    threads_.emplace_back([this, i]() { RunThread(i); });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  Stop();
+  Join();
+}
+
+void WorkStealingThreadPool::Post(std::function<void()> fn) {
+  const size_t index = current_pool == this
+                           ? current_queue_index
+                           : next_queue_.fetch_add(1) % queues_.size();
+  {
+    auto &queue = *queues_[index];
+    absl::MutexLock lock(&queue.mu);
+    queue.tasks.push_back(std::move(fn));
+  }
+  num_queued_++;
+  if (num_waiting_ > 0) {
+    absl::MutexLock lock(&mu_);
+    cond_var_.Signal();
+  }
+}
+
+void WorkStealingThreadPool::Stop() {
+  stopped_ = true;
+  absl::MutexLock lock(&mu_);
+  cond_var_.SignalAll();
+}
+
+void WorkStealingThreadPool::Join() {
+  absl::MutexLock lock(&join_mu_);
+  if (joined_) {
+    return;
+  }
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+  joined_ = true;
+}
+
+void WorkStealingThreadPool::RunThread(size_t index) {
+  current_pool = this;
+  current_queue_index = index;
+  std::function<void()> fn;
+  while (!stopped_) {
+    if (PopTask(index, &fn)) {
+      fn();
+      fn = nullptr;
+      continue;
+    }
+    // Wait for a task to be posted. A thread that posts a task checks whether
+    // any thread is waiting after it queues the task, so either we see the
+    // task here or the poster signals us.
+    num_waiting_++;
+    {
+      absl::MutexLock lock(&mu_);
+      while (num_queued_ <= 0 && !stopped_) {
+        cond_var_.Wait(&mu_);
+      }
+    }
+    num_waiting_--;
+  }
+}
+
+bool WorkStealingThreadPool::PopTask(size_t index, std::function<void()> *fn) {
+  {
+    auto &queue = *queues_[index];
+    absl::MutexLock lock(&queue.mu);
+    if (!queue.tasks.empty()) {
+      *fn = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      num_queued_--;
+      return true;
+    }
+  }
+  // Steal from the back of the other queues, so that their own threads keep
+  // running their tasks in order.
+  for (size_t i = 1; i < queues_.size(); i++) {
+    auto &queue = *queues_[(index + i) % queues_.size()];
+    absl::MutexLock lock(&queue.mu);
+    if (!queue.tasks.empty()) {
+      *fn = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      num_queued_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+BoundedExecutor::BoundedExecutor(int max_concurrency)
+    : max_concurrency_(max_concurrency),
+      pool_(std::make_unique<boost::asio::thread_pool>(max_concurrency)){};
+
+BoundedExecutor::BoundedExecutor(int max_concurrency,
+                                 std::shared_ptr<WorkStealingThreadPool> shared_pool)
+    : max_concurrency_(max_concurrency), shared_pool_(std::move(shared_pool)) {
+  RAY_CHECK(max_concurrency_ > 0);
+}
+
+BoundedExecutor::~BoundedExecutor() {
+  if (shared_pool_) {
+    // The tasks in the shared pool refer to this executor.
+    shared_pool_->Stop();
+    shared_pool_->Join();
+  }
+}
+
+void BoundedExecutor::Post(std::function<void()> fn) {
+  if (pool_) {
+    boost::asio::post(*pool_, std::move(fn));
+    return;
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    if (num_posted_ >= max_concurrency_) {
+      waiting_tasks_.push_back(std::move(fn));
+      return;
+    }
+    num_posted_++;
+  }
+  PostToSharedPool(std::move(fn));
+}
+
+void BoundedExecutor::PostToSharedPool(std::function<void()> fn) {
+  shared_pool_->Post([this, fn = std::move(fn)]() {
+    fn();
+    std::function<void()> next;
+    {
+      absl::MutexLock lock(&mu_);
+      if (waiting_tasks_.empty()) {
+        num_posted_--;
+        return;
+      }
+      next = std::move(waiting_tasks_.front());
+      waiting_tasks_.pop_front();
+    }
+    PostToSharedPool(std::move(next));
+  });
+}
 
 /// Stop the thread pool.
-void BoundedExecutor::Stop() { pool_.stop(); }
+void BoundedExecutor::Stop() {
+  if (pool_) {
+    pool_->stop();
+  } else {
+    shared_pool_->Stop();
+  }
+}
 
 /// Join the thread pool.
-void BoundedExecutor::Join() { pool_.join(); }
+void BoundedExecutor::Join() {
+  if (pool_) {
+    pool_->join();
+  } else {
+    shared_pool_->Join();
+  }
+}
 
 }  // namespace core
 }  // namespace ray
@@ -17,9 +17,11 @@
 #include <boost/asio/post.hpp>
 #include <boost/asio/thread_pool.hpp>
 #include <boost/thread.hpp>
+#include <deque>
 #include <list>
 #include <queue>
 #include <set>
+#include <thread>
 #include <utility>
 
 #include "absl/base/thread_annotations.h"
@@ -31,6 +33,59 @@
 namespace ray {
 namespace core {
 
+/// A thread pool in which each thread has its own queue of tasks. A thread runs
+/// the tasks in its own queue first, and steals tasks from the other threads'
+/// queues when its own queue is empty. This is shared by the executors of the
+/// concurrency groups of one actor, so that threads are not tied to a group.
+class WorkStealingThreadPool {
+ public:
+  explicit WorkStealingThreadPool(int num_threads);
+
+  ~WorkStealingThreadPool();
+
+  /// Post a task. A task posted from a thread of this pool goes to that
+  /// thread's queue. Other tasks are spread over the queues round-robin.
+  void Post(std::function<void()> fn);
+
+  /// Stop the threads. Tasks that are not running yet are dropped. This can
+  /// be called more than once.
+  void Stop();
+
+  /// Wait for the threads to exit. This can be called more than once.
+  void Join();
+
+  int NumThreads() const { return queues_.size(); }
+
+ private:
+  struct TaskQueue {
+    absl::Mutex mu;
+    std::deque<std::function<void()>> tasks GUARDED_BY(mu);
+  };
+
+  /// The loop that each thread runs.
+  void RunThread(size_t index);
+
+  /// Pop a task from the thread's own queue, or else steal one from another
+  /// thread's queue.
+  bool PopTask(size_t index, std::function<void()> *fn);
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> threads_;
+  /// The queue to push the next task posted from outside the pool to.
+  std::atomic<size_t> next_queue_{0};
+  /// The number of tasks in all queues.
+  std::atomic<int64_t> num_queued_{0};
+  /// The number of threads that are waiting for a task to be posted.
+  std::atomic<int64_t> num_waiting_{0};
+  std::atomic<bool> stopped_{false};
+
+  absl::Mutex mu_;
+  absl::CondVar cond_var_;
+
+  absl::Mutex join_mu_;
+  bool joined_ GUARDED_BY(join_mu_) = false;
+};
+
 /// Wraps a thread-pool to block posts until the pool has free slots. This is used
 /// by the SchedulingQueue to provide backpressure to clients.
 class BoundedExecutor {
@@ -42,8 +97,16 @@ class BoundedExecutor {
 
   explicit BoundedExecutor(int max_concurrency);
 
+  /// Create an executor that runs its tasks on a pool of threads shared with
+  /// other executors. At most max_concurrency of its tasks are queued in or
+  /// running on the pool at a time, the rest wait in this executor.
+  BoundedExecutor(int max_concurrency,
+                  std::shared_ptr<WorkStealingThreadPool> shared_pool);
+
+  ~BoundedExecutor();
+
   /// Posts work to the pool
-  void Post(std::function<void()> fn) { boost::asio::post(pool_, std::move(fn)); }
+  void Post(std::function<void()> fn);
 
   /// Stop the thread pool.
   void Stop();
@@ -52,8 +115,24 @@ class BoundedExecutor {
   void Join();
 
  private:
-  /// The underlying thread pool for running tasks.
-  boost::asio::thread_pool pool_;
+  /// Post a task to the shared pool. The task posts the next waiting task of
+  /// this executor when it finishes.
+  void PostToSharedPool(std::function<void()> fn);
+
+  const int max_concurrency_;
+
+  /// The underlying thread pool for running tasks. This is only used if there
+  /// is no shared pool.
+  std::unique_ptr<boost::asio::thread_pool> pool_;
+
+  /// The pool of threads shared with the other executors of the actor.
+  std::shared_ptr<WorkStealingThreadPool> shared_pool_;
+
+  absl::Mutex mu_;
+  /// The number of tasks that are queued in or running on the shared pool.
+  int num_posted_ GUARDED_BY(mu_) = 0;
+  /// The tasks that wait for one of the posted tasks to finish.
+  std::deque<std::function<void()>> waiting_tasks_ GUARDED_BY(mu_);
 };
 
 }  // namespace core
@@ -35,7 +35,7 @@ struct GcsServerMocker {
   class MockWorkerClient : public rpc::CoreWorkerClientInterface {
    public:
     void PushNormalTask(
-        std::unique_ptr<rpc::PushTaskRequest> request,
+        const rpc::PushTaskRequest &request,
         const rpc::ClientCallback<rpc::PushTaskReply> &callback) override {
       callbacks.push_back(callback);
     }
@@ -0,0 +1,84 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/broadcast_manager.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace ray {
+
+NodeID BroadcastManager::ChooseRelay(const ObjectID &object_id,
+                                     const NodeID &requester_id) {
+  if (!Enabled()) {
+    return NodeID::Nil();
+  }
+  auto it = receivers_.find(object_id);
+  if (it == receivers_.end() ||
+      static_cast<int64_t>(it->second.node_ids.size()) < max_fanout_) {
+    return NodeID::Nil();
+  }
+  auto &receivers = it->second;
+  // The requester may be retrying a pull from this node, in which case it
+  // shouldn't be forwarded to itself.
+  if (std::find(receivers.node_ids.begin(), receivers.node_ids.end(), requester_id) !=
+      receivers.node_ids.end()) {
+    return NodeID::Nil();
+  }
+  num_pulls_forwarded_++;
+  return receivers.node_ids[receivers.next_relay_index++ % receivers.node_ids.size()];
+}
+
+void BroadcastManager::AddReceiver(const ObjectID &object_id, const NodeID &node_id) {
+  if (!Enabled()) {
+    return;
+  }
+  auto &node_ids = receivers_[object_id].node_ids;
+  if (std::find(node_ids.begin(), node_ids.end(), node_id) == node_ids.end()) {
+    node_ids.push_back(node_id);
+  }
+}
+
+void BroadcastManager::RemoveReceiver(const ObjectID &object_id,
+                                      const NodeID &node_id) {
+  auto it = receivers_.find(object_id);
+  if (it == receivers_.end()) {
+    return;
+  }
+  auto &node_ids = it->second.node_ids;
+  node_ids.erase(std::remove(node_ids.begin(), node_ids.end(), node_id), node_ids.end());
+  if (node_ids.empty()) {
+    receivers_.erase(it);
+  }
+}
+
+void BroadcastManager::RemoveReceivers(const ObjectID &object_id) {
+  receivers_.erase(object_id);
+}
+
+size_t BroadcastManager::NumReceivers(const ObjectID &object_id) const {
+  auto it = receivers_.find(object_id);
+  return it == receivers_.end() ? 0 : it->second.node_ids.size();
+}
+
+std::string BroadcastManager::DebugString() const {
+  std::stringstream result;
+  result << "BroadcastManager:";
+  result << "\n- max fanout: " << max_fanout_;
+  result << "\n- num objects being sent: " << receivers_.size();
+  result << "\n- num pull requests forwarded: " << num_pulls_forwarded_;
+  return result.str();
+}
+
+}  // namespace ray
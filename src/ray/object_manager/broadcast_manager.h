@@ -0,0 +1,93 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "ray/common/id.h"
+
+namespace ray {
+
+/// Forms relay trees for objects that many nodes pull at the same time.
+///
+/// A node sends an object directly to at most `max_fanout` nodes at a time. Pull
+/// requests from further nodes are forwarded round-robin to the nodes it is sending
+/// the object to. These relay the chunks onward as they receive them, before the
+/// object is sealed, and forward pull requests to their own receivers once they
+/// are at their fanout in turn. An object that N nodes pull at once is then sent
+/// through a tree of depth O(log N), and every node sends it at most `max_fanout`
+/// times.
+///
+/// This class is not thread-safe.
+class BroadcastManager {
+ public:
+  /// Create a broadcast manager.
+  ///
+  /// \param max_fanout The max number of nodes to send an object to at a time
+  ///                   before forwarding pull requests to them. Pull requests
+  ///                   are never forwarded if this is 0.
+  explicit BroadcastManager(int64_t max_fanout) : max_fanout_(max_fanout) {}
+
+  /// Whether pull requests can be forwarded to other nodes.
+  bool Enabled() const { return max_fanout_ > 0; }
+
+  /// Choose the node that a pull request for an object should be forwarded to.
+  ///
+  /// \param object_id The object to send.
+  /// \param requester_id The node that requested the object.
+  /// \return The node that should relay the object to the requester, or nil if
+  ///         this node should send the object itself.
+  NodeID ChooseRelay(const ObjectID &object_id, const NodeID &requester_id);
+
+  /// Called when this node starts sending an object to another node, either by
+  /// pushing it or by relaying its chunks.
+  void AddReceiver(const ObjectID &object_id, const NodeID &node_id);
+
+  /// Called when this node is done pushing an object to another node.
+  void RemoveReceiver(const ObjectID &object_id, const NodeID &node_id);
+
+  /// Called when this node stops relaying the chunks of an object, because the
+  /// object was sealed or is no longer being received.
+  void RemoveReceivers(const ObjectID &object_id);
+
+  /// Return the number of nodes an object is being sent to. For testing only.
+  size_t NumReceivers(const ObjectID &object_id) const;
+
+  /// Return the number of pull requests forwarded so far. For testing only.
+  int64_t NumPullsForwarded() const { return num_pulls_forwarded_; }
+
+  std::string DebugString() const;
+
+ private:
+  /// The nodes that an object is being sent to.
+  struct Receivers {
+    std::vector<NodeID> node_ids;
+    /// The index of the next receiver to forward a pull request to.
+    size_t next_relay_index = 0;
+  };
+
+  /// Max number of nodes to send an object to at a time.
+  const int64_t max_fanout_;
+
+  /// The nodes that each object is being sent to.
+  absl::flat_hash_map<ObjectID, Receivers> receivers_;
+
+  /// Running total of pull requests forwarded to other nodes.
+  int64_t num_pulls_forwarded_ = 0;
+};
+
+}  // namespace ray
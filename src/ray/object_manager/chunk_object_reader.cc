@@ -63,4 +63,16 @@ absl::optional<std::string> ChunkObjectReader::GetChunk(uint64_t chunk_index) co
   }
   return absl::optional<std::string>(std::move(result));
 }
+
+absl::optional<absl::string_view> ChunkObjectReader::GetChunkView(
+    uint64_t chunk_index) const {
+  const char *memory = object_->GetContiguousMemory();
+  if (memory == nullptr) {
+    return absl::optional<absl::string_view>();
+  }
+  const auto cur_chunk_offset = chunk_index * chunk_size_;
+  const auto cur_chunk_size =
+      std::min(chunk_size_, object_->GetObjectSize() - cur_chunk_offset);
+  return absl::string_view(memory + cur_chunk_offset, cur_chunk_size);
+}
 };  // namespace ray
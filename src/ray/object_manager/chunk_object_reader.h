@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "absl/strings/string_view.h"
 #include "ray/object_manager/spilled_object_reader.h"
 
 namespace ray {
@@ -29,6 +30,8 @@ class ChunkObjectReader {
 
   uint64_t GetNumChunks() const;
 
+  uint64_t GetChunkSize() const { return chunk_size_; }
+
   /// Return the value in a given chunk, identified by chunk_index.
   /// It migh return an empty optional if the file is deleted.
   ///
@@ -36,6 +39,15 @@ class ChunkObjectReader {
   ///                    equal to GetNumChunks() yields undefined behavior.
   absl::optional<std::string> GetChunk(uint64_t chunk_index) const;
 
+  /// Return a view of the given chunk that references the memory of the
+  /// underlying object without copying it. The view is valid for as long as
+  /// this reader is alive. Returns an empty optional if the underlying object
+  /// is not contiguous in memory, in which case GetChunk must be used.
+  ///
+  /// \param chunk_index the index of chunk to return. index greater or
+  ///                    equal to GetNumChunks() yields undefined behavior.
+  absl::optional<absl::string_view> GetChunkView(uint64_t chunk_index) const;
+
   const IObjectReader &GetObject() const { return *object_; }
 
  private:
@@ -51,4 +51,15 @@ bool MemoryObjectReader::ReadFromMetadataSection(uint64_t offset,
   return true;
 }
 
+const char *MemoryObjectReader::GetContiguousMemory() const {
+  const auto data = reinterpret_cast<const char *>(object_buffer_.data->Data());
+  const auto metadata = reinterpret_cast<const char *>(object_buffer_.metadata->Data());
+  // Plasma always stores the metadata right after the data, but the buffers
+  // can be constructed separately.
+  if (GetMetadataSize() > 0 && metadata != data + GetDataSize()) {
+    return nullptr;
+  }
+  return data;
+}
+
 }  // namespace ray
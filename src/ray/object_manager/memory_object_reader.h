@@ -36,6 +36,10 @@ class MemoryObjectReader : public IObjectReader {
                                uint64_t size,
                                char *output) const override;
 
+  /// The object is pinned in plasma for as long as object_buffer_ is alive, so
+  /// its memory can be referenced directly.
+  const char *GetContiguousMemory() const override;
+
  private:
   const plasma::ObjectBuffer object_buffer_;
   const rpc::Address owner_address_;
@@ -14,15 +14,29 @@
 
 #include "ray/object_manager/object_buffer_pool.h"
 
+#include <algorithm>
+
 #include "absl/time/time.h"
 #include "ray/common/status.h"
 #include "ray/util/logging.h"
 
 namespace ray {
 
+namespace {
+/// Number of chunks that objects are split into, unless that makes chunks smaller
+/// than the min chunk size or larger than the max chunk size.
+const uint64_t kTargetNumChunks = 8;
+}  // namespace
+
 ObjectBufferPool::ObjectBufferPool(
-    std::shared_ptr<plasma::PlasmaClientInterface> store_client, uint64_t chunk_size)
-    : store_client_(store_client), default_chunk_size_(chunk_size) {}
+    std::shared_ptr<plasma::PlasmaClientInterface> store_client,
+    uint64_t chunk_size,
+    uint64_t min_chunk_size)
+    : store_client_(store_client),
+      default_chunk_size_(chunk_size),
+      min_chunk_size_(std::min(min_chunk_size, chunk_size)) {
+  RAY_CHECK(min_chunk_size_ > 0) << "min_chunk_size shouldn't be 0";
+}
 
 ObjectBufferPool::~ObjectBufferPool() {
   absl::MutexLock lock(&pool_mutex_);
@@ -57,15 +71,24 @@ ObjectBufferPool::~ObjectBufferPool() {
   RAY_CHECK_OK(store_client_->Disconnect());
 }
 
+uint64_t ObjectBufferPool::GetChunkSize(uint64_t data_size) const {
+  uint64_t chunk_size = (data_size + kTargetNumChunks - 1) / kTargetNumChunks;
+  // Round up to a multiple of the min chunk size, so that objects of similar
+  // sizes share the same chunk size.
+  chunk_size = (chunk_size + min_chunk_size_ - 1) / min_chunk_size_ * min_chunk_size_;
+  return std::min(std::max(chunk_size, min_chunk_size_), default_chunk_size_);
+}
+
 uint64_t ObjectBufferPool::GetNumChunks(uint64_t data_size) const {
-  return (data_size + default_chunk_size_ - 1) / default_chunk_size_;
+  const uint64_t chunk_size = GetChunkSize(data_size);
+  return (data_size + chunk_size - 1) / chunk_size;
 }
 
 uint64_t ObjectBufferPool::GetBufferLength(uint64_t chunk_index,
                                            uint64_t data_size) const {
-  return (chunk_index + 1) * default_chunk_size_ > data_size
-             ? data_size % default_chunk_size_
-             : default_chunk_size_;
+  const uint64_t chunk_size = GetChunkSize(data_size);
+  return (chunk_index + 1) * chunk_size > data_size ? data_size % chunk_size
+                                                    : chunk_size;
 }
 
 std::pair<std::shared_ptr<MemoryObjectReader>, ray::Status>
@@ -118,7 +141,8 @@ void ObjectBufferPool::WriteChunk(const ObjectID &object_id,
                                   uint64_t data_size,
                                   uint64_t metadata_size,
                                   const uint64_t chunk_index,
-                                  const std::string &data) {
+                                  const std::string &data,
+                                  std::vector<NodeID> *relay_destinations) {
   absl::MutexLock lock(&pool_mutex_);
   auto it = create_buffer_state_.find(object_id);
   if (it == create_buffer_state_.end() || chunk_index >= it->second.chunk_state.size() ||
@@ -139,6 +163,9 @@ void ObjectBufferPool::WriteChunk(const ObjectID &object_id,
   std::memcpy(chunk_info.data, data.data(), chunk_info.buffer_length);
   it->second.chunk_state.at(chunk_index) = CreateChunkState::SEALED;
   it->second.num_seals_remaining--;
+  if (relay_destinations != nullptr) {
+    *relay_destinations = it->second.relay_destinations;
+  }
   if (it->second.num_seals_remaining == 0) {
     RAY_CHECK_OK(store_client_->Seal(object_id));
     RAY_CHECK_OK(store_client_->Release(object_id));
@@ -148,9 +175,81 @@ void ObjectBufferPool::WriteChunk(const ObjectID &object_id,
   }
 }
 
+void ObjectBufferPool::AddRelayDestination(
+    const ObjectID &object_id,
+    const NodeID &node_id,
+    std::vector<rpc::PushRequest> *written_chunks) {
+  rpc::PushRequest header;
+  std::vector<ChunkInfo> sealed_chunks;
+  {
+    absl::MutexLock lock(&pool_mutex_);
+    auto it = create_buffer_state_.find(object_id);
+    if (it == create_buffer_state_.end()) {
+      auto &pending = pending_relay_destinations_[object_id];
+      if (std::find(pending.begin(), pending.end(), node_id) == pending.end()) {
+        pending.push_back(node_id);
+      }
+      return;
+    }
+    auto &state = it->second;
+    // A node that asks again is already a destination, it is only sent the chunks
+    // written so far again.
+    if (std::find(state.relay_destinations.begin(),
+                  state.relay_destinations.end(),
+                  node_id) == state.relay_destinations.end()) {
+      state.relay_destinations.push_back(node_id);
+    }
+    header.set_object_id(object_id.Binary());
+    header.mutable_owner_address()->CopyFrom(state.owner_address);
+    header.set_data_size(state.data_size);
+    header.set_metadata_size(state.metadata_size);
+    for (size_t i = 0; i < state.chunk_info.size(); i++) {
+      if (state.chunk_state[i] == CreateChunkState::SEALED) {
+        sealed_chunks.push_back(state.chunk_info[i]);
+      }
+    }
+  }
+  if (sealed_chunks.empty()) {
+    return;
+  }
+
+  // Copy the chunks without holding the lock, so that chunks of other objects can be
+  // written meanwhile. Sealed chunks are not written to again.
+  for (const auto &chunk_info : sealed_chunks) {
+    rpc::PushRequest chunk = header;
+    chunk.set_chunk_index(chunk_info.chunk_index);
+    chunk.set_data(chunk_info.data, chunk_info.buffer_length);
+    written_chunks->push_back(std::move(chunk));
+  }
+
+  absl::MutexLock lock(&pool_mutex_);
+  auto it = create_buffer_state_.find(object_id);
+  if (it == create_buffer_state_.end() ||
+      it->second.chunk_info.front().buffer_ref != sealed_chunks.front().buffer_ref) {
+    // The object was sealed or aborted while the chunks were copied, in which case the
+    // buffer may have been reused. Drop the copies, the node will retry its pull.
+    RAY_LOG(DEBUG) << "Object " << object_id
+                   << " was sealed or aborted while relaying its chunks to " << node_id;
+    written_chunks->clear();
+  }
+}
+
+std::vector<NodeID> ObjectBufferPool::TakePendingRelayDestinations(
+    const ObjectID &object_id) {
+  absl::MutexLock lock(&pool_mutex_);
+  std::vector<NodeID> relay_destinations;
+  auto it = pending_relay_destinations_.find(object_id);
+  if (it != pending_relay_destinations_.end()) {
+    relay_destinations = std::move(it->second);
+    pending_relay_destinations_.erase(it);
+  }
+  return relay_destinations;
+}
+
 void ObjectBufferPool::AbortCreate(const ObjectID &object_id) {
   absl::MutexLock lock(&pool_mutex_);
   AbortCreateInternal(object_id);
+  pending_relay_destinations_.erase(object_id);
 }
 
 void ObjectBufferPool::AbortCreateInternal(const ObjectID &object_id) {
@@ -167,18 +266,18 @@ std::vector<ObjectBufferPool::ChunkInfo> ObjectBufferPool::BuildChunks(
     uint8_t *data,
     uint64_t data_size,
     std::shared_ptr<Buffer> buffer_ref) {
+  const uint64_t chunk_size = GetChunkSize(data_size);
   uint64_t space_remaining = data_size;
   std::vector<ChunkInfo> chunks;
   int64_t position = 0;
   while (space_remaining) {
     position = data_size - space_remaining;
-    if (space_remaining < default_chunk_size_) {
+    if (space_remaining < chunk_size) {
       chunks.emplace_back(chunks.size(), data + position, space_remaining, buffer_ref);
       space_remaining = 0;
     } else {
-      chunks.emplace_back(
-          chunks.size(), data + position, default_chunk_size_, buffer_ref);
-      space_remaining -= default_chunk_size_;
+      chunks.emplace_back(chunks.size(), data + position, chunk_size, buffer_ref);
+      space_remaining -= chunk_size;
     }
   }
   return chunks;
@@ -276,10 +375,16 @@ ray::Status ObjectBufferPool::EnsureBufferExists(const ObjectID &object_id,
   auto inserted = create_buffer_state_.emplace(
       std::piecewise_construct,
       std::forward_as_tuple(object_id),
-      std::forward_as_tuple(metadata_size,
+      std::forward_as_tuple(owner_address,
+                            metadata_size,
                             data_size,
                             BuildChunks(object_id, mutable_data, data_size, data)));
   RAY_CHECK(inserted.first->second.chunk_info.size() == num_chunks);
+  auto pending_it = pending_relay_destinations_.find(object_id);
+  if (pending_it != pending_relay_destinations_.end()) {
+    inserted.first->second.relay_destinations = std::move(pending_it->second);
+    pending_relay_destinations_.erase(pending_it);
+  }
   RAY_LOG(DEBUG) << "Created object " << object_id
                  << " in plasma store, number of chunks: " << num_chunks
                  << ", chunk index: " << chunk_index;
@@ -297,6 +402,8 @@ std::string ObjectBufferPool::DebugString() const {
   std::stringstream result;
   result << "BufferPool:";
   result << "\n- create buffer state map size: " << create_buffer_state_.size();
+  result << "\n- pending relay destinations map size: "
+         << pending_relay_destinations_.size();
   return result.str();
 }
 
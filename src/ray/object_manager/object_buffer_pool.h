@@ -28,6 +28,7 @@
 #include "ray/common/status.h"
 #include "ray/object_manager/memory_object_reader.h"
 #include "ray/object_manager/plasma/client.h"
+#include "src/ray/protobuf/object_manager.pb.h"
 
 namespace ray {
 
@@ -59,15 +60,28 @@ class ObjectBufferPool {
   /// Constructor.
   ///
   /// \param store_client Plasma store client. Used for testing purposes only.
-  /// \param chunk_size The chunk size into which objects are to be split.
+  /// \param chunk_size The max chunk size into which objects are to be split.
+  /// \param min_chunk_size The min chunk size into which objects are to be split,
+  /// see GetChunkSize.
   ObjectBufferPool(std::shared_ptr<plasma::PlasmaClientInterface> store_client,
-                   const uint64_t chunk_size);
+                   const uint64_t chunk_size,
+                   const uint64_t min_chunk_size);
 
   ~ObjectBufferPool();
 
   /// This object cannot be copied due to pool_mutex.
   RAY_DISALLOW_COPY_AND_ASSIGN(ObjectBufferPool);
 
+  /// Computes the chunk size for transferring an object and its metadata. Objects
+  /// are split into a few chunks so that they can be transferred over multiple
+  /// connections in parallel, with chunks between the min and max chunk size.
+  /// Senders and receivers must agree on the chunk size of an object, so this only
+  /// depends on the object size.
+  ///
+  /// \param data_size The size of the object + metadata.
+  /// \return The size of all but the last chunk of the object.
+  uint64_t GetChunkSize(uint64_t data_size) const;
+
   /// Computes the number of chunks needed to transfer an object and its metadata.
   ///
   /// \param data_size The size of the object + metadata.
@@ -124,11 +138,42 @@ class ObjectBufferPool {
   /// \param object_id The ObjectID.
   /// \param chunk_index The index of the chunk.
   /// \param data The data to write into the chunk.
+  /// \param[out] relay_destinations If the chunk was written, the nodes that the
+  /// caller must relay it to, see AddRelayDestination.
   void WriteChunk(const ObjectID &object_id,
                   uint64_t data_size,
                   uint64_t metadata_size,
                   uint64_t chunk_index,
-                  const std::string &data) LOCKS_EXCLUDED(pool_mutex_);
+                  const std::string &data,
+                  std::vector<NodeID> *relay_destinations = nullptr)
+      LOCKS_EXCLUDED(pool_mutex_);
+
+  /// Relay the chunks of an object that is being received to another node as they
+  /// are written, before the object is sealed. Each chunk is relayed exactly once:
+  /// chunks written before this call are returned in written_chunks, and later
+  /// chunks are returned by WriteChunk. If the buffer of the object hasn't been
+  /// created yet, the node is added once it is, see TakePendingRelayDestinations.
+  /// Adding a node that is already a destination only returns the written chunks
+  /// again. The chunks are copied without holding the pool lock.
+  ///
+  /// \param object_id The ObjectID.
+  /// \param node_id The node to relay the chunks to.
+  /// \param[out] written_chunks Copies of the chunks that were already written, for
+  /// the caller to send to the node. Empty if the object was sealed or aborted
+  /// while they were copied.
+  void AddRelayDestination(const ObjectID &object_id,
+                           const NodeID &node_id,
+                           std::vector<rpc::PushRequest> *written_chunks)
+      LOCKS_EXCLUDED(pool_mutex_);
+
+  /// Remove the relay destinations of an object whose buffer was never created.
+  /// This happens if the object was sealed or aborted before AddRelayDestination
+  /// was called, in which case the caller must send the object to them another way.
+  ///
+  /// \param object_id The ObjectID.
+  /// \return The relay destinations that were not added to the object buffer.
+  std::vector<NodeID> TakePendingRelayDestinations(const ObjectID &object_id)
+      LOCKS_EXCLUDED(pool_mutex_);
 
   /// Free a list of objects from object store.
   ///
@@ -137,7 +182,8 @@ class ObjectBufferPool {
   void FreeObjects(const std::vector<ObjectID> &object_ids) LOCKS_EXCLUDED(pool_mutex_);
 
   /// Abort the create operation associated with an object. This destroys the buffer
-  /// state, including create operations in progress for all chunks of the object.
+  /// state, including create operations in progress for all chunks of the object,
+  /// and removes the relay destinations of the object.
   void AbortCreate(const ObjectID &object_id) LOCKS_EXCLUDED(pool_mutex_);
 
   /// Returns debug string for class.
@@ -173,14 +219,18 @@ class ObjectBufferPool {
 
   /// Holds the state of creating chunks. Members are protected by pool_mutex_.
   struct CreateBufferState {
-    CreateBufferState(uint64_t metadata_size,
+    CreateBufferState(const rpc::Address &owner_address,
+                      uint64_t metadata_size,
                       uint64_t data_size,
                       std::vector<ChunkInfo> chunk_info)
-        : metadata_size(metadata_size),
+        : owner_address(owner_address),
+          metadata_size(metadata_size),
           data_size(data_size),
           chunk_info(chunk_info),
           chunk_state(chunk_info.size(), CreateChunkState::AVAILABLE),
           num_seals_remaining(chunk_info.size()) {}
+    /// The address of the object's owner.
+    rpc::Address owner_address;
     /// Total size of the object metadata.
     uint64_t metadata_size;
     /// Total size of the object data.
@@ -193,6 +243,8 @@ class ObjectBufferPool {
     std::vector<CreateChunkState> chunk_state;
     /// The number of chunks left to seal before the buffer is sealed.
     uint64_t num_seals_remaining;
+    /// The nodes that chunks are relayed to as they are written.
+    std::vector<NodeID> relay_destinations;
   };
 
   /// Returned when GetChunk or CreateChunk fails.
@@ -212,6 +264,9 @@ class ObjectBufferPool {
   /// The state of a buffer that's currently being used.
   absl::flat_hash_map<ray::ObjectID, CreateBufferState> create_buffer_state_
       GUARDED_BY(pool_mutex_);
+  /// The relay destinations of objects whose buffer hasn't been created yet.
+  absl::flat_hash_map<ray::ObjectID, std::vector<NodeID>> pending_relay_destinations_
+      GUARDED_BY(pool_mutex_);
 
   /// Plasma client pool.
   std::shared_ptr<plasma::PlasmaClientInterface> store_client_;
@@ -219,6 +274,9 @@ class ObjectBufferPool {
   /// Determines the maximum chunk size to be transferred by a single thread.
   const uint64_t default_chunk_size_;
 
+  /// Chunks of small objects are not split any further than this.
+  const uint64_t min_chunk_size_;
+
   friend class ObjectBufferPoolTest;
 };
 
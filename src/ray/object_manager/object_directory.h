@@ -92,6 +92,18 @@ class IObjectDirectory {
                                                const rpc::Address &owner_address,
                                                const OnLocationsFound &callback) = 0;
 
+  /// Get the known locations and size of an object that is subscribed to, without
+  /// contacting its owner.
+  ///
+  /// \param object_id The object to look up.
+  /// \param node_ids[out] The nodes that have a copy of the object.
+  /// \param object_size[out] The size of the object.
+  /// \return False if no one is subscribed to the object or its locations have not
+  /// been received yet.
+  virtual bool GetSubscribedObjectLocations(const ObjectID &object_id,
+                                            std::unordered_set<NodeID> *node_ids,
+                                            size_t *object_size) const = 0;
+
   /// Unsubscribe to object location notifications.
   ///
   /// \param callback_id The id associated with a callback. This was given
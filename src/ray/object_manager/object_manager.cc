@@ -95,7 +95,9 @@ ObjectManager::ObjectManager(
                 "ObjectManager.ObjectDeleted");
           })),
       buffer_pool_store_client_(std::make_shared<plasma::PlasmaClient>()),
-      buffer_pool_(buffer_pool_store_client_, config_.object_chunk_size),
+      buffer_pool_(buffer_pool_store_client_,
+                   config_.object_chunk_size,
+                   config_.min_object_chunk_size),
       rpc_work_(rpc_service_),
       object_manager_server_("ObjectManager",
                              config_.object_manager_port,
@@ -106,12 +108,15 @@ ObjectManager::ObjectManager(
       restore_spilled_object_(restore_spilled_object),
       get_spilled_object_url_(get_spilled_object_url),
       pull_retry_timer_(*main_service_,
-                        boost::posix_time::milliseconds(config.timer_freq_ms)) {
+                        boost::posix_time::milliseconds(config.timer_freq_ms)),
+      broadcast_manager_(RayConfig::instance().object_manager_broadcast_fanout()) {
   RAY_CHECK(config_.rpc_service_threads_number > 0);
 
-  push_manager_.reset(new PushManager(/* max_chunks_in_flight= */ std::max(
-      static_cast<int64_t>(1L),
-      static_cast<int64_t>(config_.max_bytes_in_flight / config_.object_chunk_size))));
+  push_manager_.reset(new PushManager(
+      /* max_chunks_in_flight= */ std::max(
+          static_cast<int64_t>(1L),
+          static_cast<int64_t>(config_.max_bytes_in_flight / config_.object_chunk_size)),
+      RayConfig::instance().object_manager_push_congestion_control()));
 
   pull_retry_timer_.async_wait([this](const boost::system::error_code &e) { Tick(e); });
 
@@ -120,13 +125,15 @@ ObjectManager::ObjectManager(
   };
   const auto &send_pull_request = [this](const ObjectID &object_id,
                                          const NodeID &client_id) {
-    SendPullRequest(object_id, client_id);
+    SendPullRequest(object_id, client_id, self_node_id_);
   };
   const auto &cancel_pull_request = [this](const ObjectID &object_id) {
     // We must abort this object because it may have only been partially
     // created and will cause a leak if we never receive the rest of the
     // object. This is a no-op if the object is already sealed or evicted.
     buffer_pool_.AbortCreate(object_id);
+    // Nodes that this node was relaying the object to will retry their pulls.
+    broadcast_manager_.RemoveReceivers(object_id);
   };
   const auto &get_time = []() { return absl::GetCurrentTimeNanos() / 1e9; };
   int64_t available_memory = config.object_store_memory;
@@ -197,6 +204,16 @@ void ObjectManager::HandleObjectAdded(const ObjectInfo &object_info) {
   // Give the pull manager a chance to pin actively pulled objects.
   pull_manager_->PinNewObjectIfNeeded(object_id);
 
+  if (broadcast_manager_.Enabled()) {
+    // All received chunks have been relayed. Nodes that asked for the object
+    // before any chunk was received, but were not added as relay destinations in
+    // time, are sent the whole object.
+    broadcast_manager_.RemoveReceivers(object_id);
+    for (const auto &node_id : buffer_pool_.TakePendingRelayDestinations(object_id)) {
+      Push(object_id, node_id);
+    }
+  }
+
   // Handle the unfulfilled_push_requests_ which contains the push request that is not
   // completed due to unsatisfied local objects.
   auto iter = unfulfilled_push_requests_.find(object_id);
@@ -222,6 +239,7 @@ void ObjectManager::HandleObjectDeleted(const ObjectID &object_id) {
   used_memory_ -= object_info.data_size + object_info.metadata_size;
   RAY_CHECK(!local_objects_.empty() || used_memory_ == 0);
   object_directory_->ReportObjectRemoved(object_id, self_node_id_, object_info);
+  broadcast_manager_.RemoveReceivers(object_id);
 
   // Ask the pull manager to fetch this object again as soon as possible, if
   // it was needed by an active pull request.
@@ -269,15 +287,17 @@ void ObjectManager::CancelPull(uint64_t request_id) {
   }
 }
 
-void ObjectManager::SendPullRequest(const ObjectID &object_id, const NodeID &client_id) {
+void ObjectManager::SendPullRequest(const ObjectID &object_id,
+                                    const NodeID &client_id,
+                                    const NodeID &requester_id) {
   auto rpc_client = GetRpcClient(client_id);
   if (rpc_client) {
     // Try pulling from the client.
     rpc_service_.post(
-        [this, object_id, client_id, rpc_client]() {
+        [object_id, client_id, requester_id, rpc_client]() {
           rpc::PullRequest pull_request;
           pull_request.set_object_id(object_id.Binary());
-          pull_request.set_node_id(self_node_id_.Binary());
+          pull_request.set_node_id(requester_id.Binary());
 
           rpc_client->Pull(
               pull_request,
@@ -415,11 +435,12 @@ void ObjectManager::PushLocalObject(const ObjectID &object_id, const NodeID &nod
     local_objects_[object_id].object_info.metadata_size = 1;
   }
 
-  PushObjectInternal(object_id,
-                     node_id,
-                     std::make_shared<ChunkObjectReader>(std::move(object_reader),
-                                                         config_.object_chunk_size),
-                     /*from_disk=*/false);
+  const uint64_t chunk_size = buffer_pool_.GetChunkSize(object_reader->GetObjectSize());
+  PushObjectInternal(
+      object_id,
+      node_id,
+      std::make_shared<ChunkObjectReader>(std::move(object_reader), chunk_size),
+      /*from_disk=*/false);
 }
 
 void ObjectManager::PushFromFilesystem(const ObjectID &object_id,
@@ -428,7 +449,7 @@ void ObjectManager::PushFromFilesystem(const ObjectID &object_id,
   // SpilledObjectReader::CreateSpilledObjectReader does synchronous IO; schedule it off
   // main thread.
   rpc_service_.post(
-      [this, object_id, node_id, spilled_url, chunk_size = config_.object_chunk_size]() {
+      [this, object_id, node_id, spilled_url]() {
         auto optional_spilled_object =
             SpilledObjectReader::CreateSpilledObjectReader(spilled_url);
         if (!optional_spilled_object.has_value()) {
@@ -436,6 +457,8 @@ void ObjectManager::PushFromFilesystem(const ObjectID &object_id,
               << "Ignoring stale read request for already deleted object: " << object_id;
           return;
         }
+        const uint64_t chunk_size =
+            buffer_pool_.GetChunkSize(optional_spilled_object->GetObjectSize());
         auto chunk_object_reader = std::make_shared<ChunkObjectReader>(
             std::make_shared<SpilledObjectReader>(
                 std::move(optional_spilled_object.value())),
@@ -475,8 +498,13 @@ void ObjectManager::PushObjectInternal(const ObjectID &object_id,
                  << ", total data size: " << chunk_reader->GetObject().GetObjectSize();
 
   auto push_id = UniqueID::FromRandom();
+  broadcast_manager_.AddReceiver(object_id, node_id);
   push_manager_->StartPush(
-      node_id, object_id, chunk_reader->GetNumChunks(), [=](int64_t chunk_id) {
+      node_id,
+      object_id,
+      chunk_reader->GetNumChunks(),
+      chunk_reader->GetChunkSize(),
+      [=](int64_t chunk_id) {
         rpc_service_.post(
             [=]() {
               // Post to the multithreaded RPC event loop so that data is copied
@@ -493,6 +521,9 @@ void ObjectManager::PushObjectInternal(const ObjectID &object_id,
                     main_service_->post(
                         [this, node_id, object_id]() {
                           push_manager_->OnChunkComplete(node_id, object_id);
+                          if (!push_manager_->IsPushing(node_id, object_id)) {
+                            broadcast_manager_.RemoveReceiver(object_id, node_id);
+                          }
                         },
                         "ObjectManager.Push");
                   },
@@ -523,21 +554,6 @@ void ObjectManager::SendObjectChunk(const UniqueID &push_id,
   push_request.set_metadata_size(chunk_reader->GetObject().GetMetadataSize());
   push_request.set_chunk_index(chunk_index);
 
-  // read a chunk into push_request and handle errors.
-  auto optional_chunk = chunk_reader->GetChunk(chunk_index);
-  if (!optional_chunk.has_value()) {
-    RAY_LOG(DEBUG) << "Read chunk " << chunk_index << " of object " << object_id
-                   << " failed. It may have been evicted.";
-    on_complete(Status::IOError("Failed to read spilled object"));
-    return;
-  }
-  push_request.set_data(std::move(optional_chunk.value()));
-  if (from_disk) {
-    num_bytes_pushed_from_disk_ += push_request.data().length();
-  } else {
-    num_bytes_pushed_from_plasma_ += push_request.data().length();
-  }
-
   // record the time cost between send chunk and receive reply
   rpc::ClientCallback<rpc::PushReply> callback =
       [this, start_time, object_id, node_id, chunk_index, on_complete](
@@ -553,9 +569,114 @@ void ObjectManager::SendObjectChunk(const UniqueID &push_id,
         on_complete(status);
       };
 
+  // If the object is pinned in memory, reference the chunk from the request
+  // instead of copying it. The request holds on to the chunk reader, which keeps
+  // the object pinned until gRPC is done with the chunk.
+  if (RayConfig::instance().object_manager_zero_copy_push()) {
+    auto optional_chunk_view = chunk_reader->GetChunkView(chunk_index);
+    if (optional_chunk_view.has_value()) {
+      rpc::ZeroCopyPushRequest zero_copy_request;
+      zero_copy_request.header = std::move(push_request);
+      zero_copy_request.data = optional_chunk_view.value();
+      zero_copy_request.data_holder = chunk_reader;
+      RecordBytesPushed(zero_copy_request.data.length(), from_disk);
+      rpc_client->Push(zero_copy_request, callback);
+      return;
+    }
+  }
+
+  // read a chunk into push_request and handle errors.
+  auto optional_chunk = chunk_reader->GetChunk(chunk_index);
+  if (!optional_chunk.has_value()) {
+    RAY_LOG(DEBUG) << "Read chunk " << chunk_index << " of object " << object_id
+                   << " failed. It may have been evicted.";
+    on_complete(Status::IOError("Failed to read spilled object"));
+    return;
+  }
+  push_request.set_data(std::move(optional_chunk.value()));
+  RecordBytesPushed(push_request.data().length(), from_disk);
   rpc_client->Push(push_request, callback);
 }
 
+void ObjectManager::RecordBytesPushed(uint64_t num_bytes, bool from_disk) {
+  if (from_disk) {
+    num_bytes_pushed_from_disk_ += num_bytes;
+  } else {
+    num_bytes_pushed_from_plasma_ += num_bytes;
+  }
+}
+
+void ObjectManager::PushOrRelay(const ObjectID &object_id, const NodeID &node_id) {
+  const NodeID relay_id = broadcast_manager_.ChooseRelay(object_id, node_id);
+  if (!relay_id.IsNil()) {
+    RAY_LOG(DEBUG) << "Forwarding pull request from " << node_id << " for object "
+                   << object_id << " to " << relay_id;
+    SendPullRequest(object_id, relay_id, node_id);
+    return;
+  }
+  if (broadcast_manager_.Enabled() && local_objects_.count(object_id) == 0 &&
+      pull_manager_->IsObjectActive(object_id)) {
+    // The object is being received, relay it instead of waiting until it's sealed.
+    RelayObject(object_id, node_id);
+    return;
+  }
+  Push(object_id, node_id);
+}
+
+void ObjectManager::RelayObject(const ObjectID &object_id, const NodeID &node_id) {
+  RAY_LOG(DEBUG) << "Relaying object " << object_id << " to " << node_id;
+  std::vector<rpc::PushRequest> written_chunks;
+  buffer_pool_.AddRelayDestination(object_id, node_id, &written_chunks);
+  broadcast_manager_.AddReceiver(object_id, node_id);
+  const auto push_id = UniqueID::FromRandom().Binary();
+  for (auto &chunk : written_chunks) {
+    chunk.set_push_id(push_id);
+    RelayObjectChunk(std::make_shared<rpc::PushRequest>(std::move(chunk)), node_id);
+  }
+}
+
+void ObjectManager::RelayObjectChunk(std::shared_ptr<rpc::PushRequest> chunk,
+                                     const NodeID &node_id) {
+  auto rpc_client = GetRpcClient(node_id);
+  if (!rpc_client) {
+    // The node will retry its pull request.
+    RAY_LOG(INFO) << "Failed to establish connection to relay object chunks.";
+    return;
+  }
+  const ObjectID object_id = ObjectID::FromBinary(chunk->object_id());
+  push_manager_->RelayChunk(
+      node_id, object_id, chunk->data().size(), [=]() {
+        rpc::ZeroCopyPushRequest request;
+        request.header.set_push_id(chunk->push_id());
+        request.header.set_object_id(chunk->object_id());
+        request.header.mutable_owner_address()->CopyFrom(chunk->owner_address());
+        request.header.set_node_id(self_node_id_.Binary());
+        request.header.set_data_size(chunk->data_size());
+        request.header.set_metadata_size(chunk->metadata_size());
+        request.header.set_chunk_index(chunk->chunk_index());
+        request.data = chunk->data();
+        request.data_holder = chunk;
+        num_bytes_relayed_ += request.data.size();
+        rpc_client->Push(
+            request,
+            [this, chunk, object_id, node_id](const Status &status,
+                                              const rpc::PushReply &reply) {
+              if (!status.ok()) {
+                RAY_LOG(WARNING) << "Relay object " << object_id << " chunk to node "
+                                 << node_id << " failed due to" << status.message()
+                                 << ", chunk index: " << chunk->chunk_index();
+              }
+              // Post back to the main event loop because the PushManager is not
+              // thread-safe.
+              main_service_->post(
+                  [this, node_id, object_id]() {
+                    push_manager_->OnChunkComplete(node_id, object_id);
+                  },
+                  "ObjectManager.RelayChunk");
+            });
+      });
+}
+
 /// Implementation of ObjectManagerServiceHandler
 void ObjectManager::HandlePush(rpc::PushRequest request,
                                rpc::PushReply *reply,
@@ -570,8 +691,15 @@ void ObjectManager::HandlePush(rpc::PushRequest request,
   const rpc::Address &owner_address = request.owner_address();
   const std::string &data = request.data();
 
-  bool success = ReceiveObjectChunk(
-      node_id, object_id, owner_address, data_size, metadata_size, chunk_index, data);
+  std::vector<NodeID> relay_destinations;
+  bool success = ReceiveObjectChunk(node_id,
+                                    object_id,
+                                    owner_address,
+                                    data_size,
+                                    metadata_size,
+                                    chunk_index,
+                                    data,
+                                    &relay_destinations);
   num_chunks_received_total_++;
   if (!success) {
     num_chunks_received_total_failed_++;
@@ -580,6 +708,18 @@ void ObjectManager::HandlePush(rpc::PushRequest request,
                   << num_chunks_received_total_failed_ << "/"
                   << num_chunks_received_total_ << " failed";
   }
+  if (!relay_destinations.empty()) {
+    // Forward the chunk to the nodes that pulled the object from this node while
+    // it was being received. The chunk is shared by the outgoing requests.
+    auto chunk = std::make_shared<rpc::PushRequest>(std::move(request));
+    main_service_->post(
+        [this, chunk, relay_destinations = std::move(relay_destinations)]() {
+          for (const auto &relay_id : relay_destinations) {
+            RelayObjectChunk(chunk, relay_id);
+          }
+        },
+        "ObjectManager.RelayChunk");
+  }
 
   send_reply_callback(Status::OK(), nullptr, nullptr);
 }
@@ -590,7 +730,8 @@ bool ObjectManager::ReceiveObjectChunk(const NodeID &node_id,
                                        uint64_t data_size,
                                        uint64_t metadata_size,
                                        uint64_t chunk_index,
-                                       const std::string &data) {
+                                       const std::string &data,
+                                       std::vector<NodeID> *relay_destinations) {
   num_bytes_received_total_ += data.size();
   RAY_LOG(DEBUG) << "ReceiveObjectChunk on " << self_node_id_ << " from " << node_id
                  << " of object " << object_id << " chunk index: " << chunk_index
@@ -618,7 +759,8 @@ bool ObjectManager::ReceiveObjectChunk(const NodeID &node_id,
 
   if (chunk_status.ok()) {
     // Avoid handling this chunk if it's already being handled by another process.
-    buffer_pool_.WriteChunk(object_id, data_size, metadata_size, chunk_index, data);
+    buffer_pool_.WriteChunk(
+        object_id, data_size, metadata_size, chunk_index, data, relay_destinations);
     return true;
   } else {
     num_chunks_received_failed_due_to_plasma_++;
@@ -638,7 +780,7 @@ void ObjectManager::HandlePull(rpc::PullRequest request,
   RAY_LOG(DEBUG) << "Received pull request from node " << node_id << " for object ["
                  << object_id << "].";
 
-  main_service_->post([this, object_id, node_id]() { Push(object_id, node_id); },
+  main_service_->post([this, object_id, node_id]() { PushOrRelay(object_id, node_id); },
                       "ObjectManager.HandlePull");
   send_reply_callback(Status::OK(), nullptr, nullptr);
 }
@@ -654,6 +796,10 @@ void ObjectManager::HandleFreeObjects(rpc::FreeObjectsRequest request,
   send_reply_callback(Status::OK(), nullptr, nullptr);
 }
 
+void ObjectManager::HandleNodeRemoved(const NodeID &node_id) {
+  push_manager_->HandleNodeRemoved(node_id);
+}
+
 void ObjectManager::FreeObjects(const std::vector<ObjectID> &object_ids,
                                 bool local_only) {
   buffer_pool_.FreeObjects(object_ids);
@@ -729,8 +875,11 @@ std::string ObjectManager::DebugString() const {
          << num_chunks_received_cancelled_;
   result << "\n- num chunks received failed / plasma error: "
          << num_chunks_received_failed_due_to_plasma_;
+  result << "\n- num bytes pushed from plasma: " << num_bytes_pushed_from_plasma_.load();
+  result << "\n- num bytes pushed from disk: " << num_bytes_pushed_from_disk_.load();
   result << "\nEvent stats:" << rpc_service_.stats().StatsString();
   result << "\n" << push_manager_->DebugString();
+  result << "\n" << broadcast_manager_.DebugString();
   result << "\n" << object_directory_->DebugString();
   result << "\n" << buffer_pool_.DebugString();
   result << "\n" << pull_manager_->DebugString();
@@ -759,6 +908,7 @@ void ObjectManager::RecordMetrics() {
   ray::stats::STATS_object_manager_bytes.Record(num_bytes_pushed_from_disk_,
                                                 "PushedFromLocalDisk");
   ray::stats::STATS_object_manager_bytes.Record(num_bytes_received_total_, "Received");
+  ray::stats::STATS_object_manager_bytes.Record(num_bytes_relayed_, "Relayed");
 
   ray::stats::STATS_object_manager_received_chunks.Record(num_chunks_received_total_,
                                                           "Total");
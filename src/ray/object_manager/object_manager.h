@@ -15,6 +15,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <boost/asio.hpp>
 #include <boost/asio/error.hpp>
 #include <boost/bind/bind.hpp>
@@ -33,6 +34,7 @@
 #include "ray/common/id.h"
 #include "ray/common/ray_config.h"
 #include "ray/common/status.h"
+#include "ray/object_manager/broadcast_manager.h"
 #include "ray/object_manager/chunk_object_reader.h"
 #include "ray/object_manager/common.h"
 #include "ray/object_manager/object_buffer_pool.h"
@@ -62,6 +64,9 @@ struct ObjectManagerConfig {
   unsigned int pull_timeout_ms;
   /// Object chunk size, in bytes
   uint64_t object_chunk_size;
+  /// Min object chunk size, in bytes. Chunks of objects that are small relative
+  /// to object_chunk_size are between this and object_chunk_size.
+  uint64_t min_object_chunk_size;
   /// Max object push bytes in flight.
   uint64_t max_bytes_in_flight;
   /// The store socket name.
@@ -229,6 +234,11 @@ class ObjectManager : public ObjectManagerInterface,
   ///                   or send it to all the object stores.
   void FreeObjects(const std::vector<ObjectID> &object_ids, bool local_only);
 
+  /// Cancel the pushes to a node that was removed from the cluster.
+  ///
+  /// \param node_id The ID of the removed node.
+  void HandleNodeRemoved(const NodeID &node_id);
+
   /// Returns debug string for class.
   ///
   /// \return string.
@@ -316,6 +326,34 @@ class ObjectManager : public ObjectManagerInterface,
                        std::shared_ptr<ChunkObjectReader> chunk_reader,
                        bool from_disk);
 
+  /// Update the metrics for bytes pushed to remote object managers.
+  void RecordBytesPushed(uint64_t num_bytes, bool from_disk);
+
+  /// Send an object to a remote object manager that requested it. If this node is
+  /// already sending the object to as many nodes as the broadcast fanout allows,
+  /// the request is forwarded to one of them instead. If the object is still being
+  /// received, its chunks are relayed as they arrive.
+  ///
+  /// \param object_id The object's id.
+  /// \param node_id The remote node's id.
+  void PushOrRelay(const ObjectID &object_id, const NodeID &node_id);
+
+  /// Relay the chunks of an object that is being received to a remote object
+  /// manager, both those received so far and those still to come.
+  ///
+  /// \param object_id The object's id.
+  /// \param node_id The remote node's id.
+  void RelayObject(const ObjectID &object_id, const NodeID &node_id);
+
+  /// Send a received chunk of an object on to a remote object manager. The chunk
+  /// is sent through the PushManager, which limits the chunks in flight to the node
+  /// like those of other pushes. The data is referenced by the outgoing request
+  /// instead of copied.
+  ///
+  /// \param chunk The chunk, as received.
+  /// \param node_id The remote node's id.
+  void RelayObjectChunk(std::shared_ptr<rpc::PushRequest> chunk, const NodeID &node_id);
+
   /// Handle starting, running, and stopping asio rpc_service.
   void StartRpcService();
   void RunRpcService(int index);
@@ -370,6 +408,7 @@ class ObjectManager : public ObjectManagerInterface,
   /// \param metadata_size Metadata size
   /// \param chunk_index Chunk index
   /// \param data Chunk data
+  /// \param[out] relay_destinations The nodes to relay the chunk to, if any.
   /// \return Whether the chunk was successfully written into the local object
   /// store. This can fail if the chunk was already received in the past, or if
   /// the object is no longer being actively pulled.
@@ -379,13 +418,18 @@ class ObjectManager : public ObjectManagerInterface,
                           uint64_t data_size,
                           uint64_t metadata_size,
                           uint64_t chunk_index,
-                          const std::string &data);
+                          const std::string &data,
+                          std::vector<NodeID> *relay_destinations);
 
   /// Send pull request
   ///
   /// \param object_id Object id
   /// \param client_id Remote server client id
-  void SendPullRequest(const ObjectID &object_id, const NodeID &client_id);
+  /// \param requester_id The node that the object should be sent to. This is a
+  /// different node than this one if the pull request is being forwarded.
+  void SendPullRequest(const ObjectID &object_id,
+                       const NodeID &client_id,
+                       const NodeID &requester_id);
 
   /// Get the rpc client according to the node ID
   ///
@@ -466,13 +510,18 @@ class ObjectManager : public ObjectManagerInterface,
   /// Object pull manager.
   std::unique_ptr<PullManager> pull_manager_;
 
+  /// Forms relay trees for objects that are pulled by many nodes at once.
+  BroadcastManager broadcast_manager_;
+
   /// Running sum of the amount of memory used in the object store.
   int64_t used_memory_ = 0;
 
   /// Metrics for bytes pushed and received.
   size_t num_bytes_received_total_ = 0;
-  size_t num_bytes_pushed_from_disk_ = 0;
-  size_t num_bytes_pushed_from_plasma_ = 0;
+  /// Updated from the RPC threads that read the chunks.
+  std::atomic<size_t> num_bytes_pushed_from_disk_ = 0;
+  std::atomic<size_t> num_bytes_pushed_from_plasma_ = 0;
+  size_t num_bytes_relayed_ = 0;
 
   /// Running total of received chunks.
   size_t num_chunks_received_total_ = 0;
@@ -53,5 +53,11 @@ class IObjectReader {
   virtual bool ReadFromMetadataSection(uint64_t offset,
                                        uint64_t size,
                                        char *output) const = 0;
+
+  /// Return a pointer to the data section immediately followed by the metadata
+  /// section, if the whole object is in memory that stays valid and immutable for
+  /// the lifetime of this reader. Otherwise return nullptr, and the object can
+  /// only be read by copying through ReadFromDataSection/ReadFromMetadataSection.
+  virtual const char *GetContiguousMemory() const { return nullptr; }
 };
 }  // namespace ray
@@ -475,6 +475,19 @@ OwnershipBasedObjectDirectory::LookupAllRemoteConnections() const {
   return remote_connections;
 }
 
+bool OwnershipBasedObjectDirectory::GetSubscribedObjectLocations(
+    const ObjectID &object_id,
+    std::unordered_set<NodeID> *node_ids,
+    size_t *object_size) const {
+  auto it = listeners_.find(object_id);
+  if (it == listeners_.end() || !it->second.subscribed) {
+    return false;
+  }
+  *node_ids = it->second.current_object_locations;
+  *object_size = it->second.object_size;
+  return true;
+}
+
 void OwnershipBasedObjectDirectory::HandleNodeRemoved(const NodeID &node_id) {
   for (auto &[object_id, listener] : listeners_) {
     bool updated = listener.current_object_locations.erase(node_id);
@@ -62,6 +62,9 @@ class OwnershipBasedObjectDirectory : public IObjectDirectory {
                                        const ObjectID &object_id,
                                        const rpc::Address &owner_address,
                                        const OnLocationsFound &callback) override;
+  bool GetSubscribedObjectLocations(const ObjectID &object_id,
+                                    std::unordered_set<NodeID> *node_ids,
+                                    size_t *object_size) const override;
   ray::Status UnsubscribeObjectLocations(const UniqueID &callback_id,
                                          const ObjectID &object_id) override;
 
@@ -16,6 +16,8 @@
 // under the License.
 #pragma once
 
+#include <sstream>
+
 #include "absl/types/optional.h"
 #include "ray/object_manager/plasma/common.h"
 #include "ray/object_manager/plasma/compat.h"
@@ -59,6 +61,12 @@ class IAllocator {
 
   /// Get the number of bytes fallback allocated so far.
   virtual int64_t FallbackAllocated() const = 0;
+
+  /// Record the allocator specific metrics.
+  virtual void RecordMetrics() const {}
+
+  /// Debug dump the allocator specific stats.
+  virtual void GetDebugDump(std::stringstream &buffer) const {}
 };
 
 }  // namespace plasma
@@ -96,10 +96,12 @@ struct Allocation {
         fallback_allocated(false) {}
 
   friend class PlasmaAllocator;
+  friend class SlabAllocator;
   friend class DummyAllocator;
   friend struct ObjectLifecycleManagerTest;
   FRIEND_TEST(ObjectStoreTest, PassThroughTest);
   FRIEND_TEST(EvictionPolicyTest, Test);
+  friend struct EvictionPoliciesTest;
   friend struct GetRequestQueueTest;
 };
 
@@ -145,6 +147,7 @@ class LocalObject {
   FRIEND_TEST(ObjectLifecycleManagerTest, RemoveReferenceOneRefNotSealed);
   friend struct ObjectStatsCollectorTest;
   FRIEND_TEST(EvictionPolicyTest, Test);
+  friend struct EvictionPoliciesTest;
   friend struct GetRequestQueueTest;
 
   /// Allocation Info;
@@ -26,6 +26,8 @@
 #define _GNU_SOURCE /* Turns on fallocate() definition */
 #endif              /* _GNU_SOURCE */
 #include <fcntl.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
 #endif /* __linux__ */
 
 #include <stddef.h>
@@ -41,6 +43,8 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "ray/common/ray_config.h"
 #include "ray/object_manager/plasma/plasma.h"
 
@@ -81,6 +85,16 @@ int fake_munmap(void *, int64_t);
 #define MAP_POPULATE 0
 #endif
 
+#ifdef __linux__
+// Not defined by older libc headers.
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB 0x0004U
+#endif
+#ifndef MFD_HUGE_2MB
+#define MFD_HUGE_2MB (21U << 26)
+#endif
+#endif /* __linux__ */
+
 constexpr int GRANULARITY_MULTIPLIER = 2;
 
 namespace {
@@ -96,6 +110,10 @@ int64_t next_mmap_unique_id = INVALID_UNIQUE_FD_ID + 1;
 char *initial_region_ptr = nullptr;
 size_t initial_region_size = 0;
 
+// Size of the huge pages that back the initial region if plasma_huge_page_arena
+// is enabled.
+constexpr int64_t kHugePageSize = 2 * 1024 * 1024;
+
 void *pointer_advance(void *p, ptrdiff_t n) { return (unsigned char *)p + n; }
 
 void *pointer_retreat(void *p, ptrdiff_t n) { return (unsigned char *)p - n; }
@@ -116,6 +134,16 @@ struct DLMallocConfig {
 };
 
 DLMallocConfig dlmalloc_config;
+
+// Returns the number of bytes to map for a region of the given size. The initial
+// region is rounded up to whole huge pages if plasma_huge_page_arena is enabled,
+// because huge page backed mappings can only be unmapped in whole huge pages.
+int64_t GetMappedSize(int64_t size, bool initial_region) {
+  if (initial_region && RayConfig::instance().plasma_huge_page_arena()) {
+    return (size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  }
+  return size;
+}
 }  // namespace
 
 #ifdef _WIN32
@@ -138,89 +166,204 @@ void create_and_mmap_buffer(int64_t size, void **pointer, HANDLE *handle) {
   }
 }
 #else
-void create_and_mmap_buffer(int64_t size, void **pointer, int *fd) {
-  // Create a buffer. This is creating a temporary file and then
-  // immediately unlinking it so we do not leave traces in the system.
-  std::string file_template = dlmalloc_config.directory;
-
-  // In never-OOM mode, fallback to allocating from the filesystem. Note that these
-  // allocations will be run with dlmallopt(M_MMAP_THRESHOLD, 0) set by
-  // plasma_allocator.cc.
-  if (allocated_once && dlmalloc_config.fallback_enabled) {
-    file_template = dlmalloc_config.fallback_directory;
-  }
-
-  file_template += "/plasmaXXXXXX";
-  RAY_LOG(INFO) << "create_and_mmap_buffer(" << size << ", " << file_template << ")";
-  std::vector<char> file_name(file_template.begin(), file_template.end());
-  file_name.push_back('\0');
-  *fd = mkstemp(&file_name[0]);
+#ifdef __linux__
+// Creates an anonymous file backed by 2MB huge pages and maps it. Returns false
+// if the kernel has no huge pages to spare, in which case the caller falls back
+// to regular pages.
+bool mmap_huge_page_buffer(int64_t size, int flags, void **pointer, int *fd) {
+#ifdef SYS_memfd_create
+  *fd = syscall(SYS_memfd_create, "plasma", MFD_HUGETLB | MFD_HUGE_2MB);
   if (*fd < 0) {
-    RAY_LOG(FATAL) << "create_buffer failed to open file " << &file_name[0] << ", error"
-                   << std::strerror(errno);
+    RAY_LOG(WARNING) << "memfd_create(MFD_HUGETLB) failed, falling back to regular "
+                     << "pages: " << std::strerror(errno);
+    return false;
   }
-  // Immediately unlink the file so we do not leave traces in the system.
-  if (unlink(&file_name[0]) != 0) {
-    RAY_LOG(FATAL) << "failed to unlink file " << &file_name[0] << ", error"
-                   << std::strerror(errno);
+  if (ftruncate(*fd, (off_t)size) != 0) {
+    RAY_LOG(WARNING) << "failed to ftruncate huge page file, falling back to regular "
+                     << "pages: " << std::strerror(errno);
+    close(*fd);
+    return false;
   }
-  if (!dlmalloc_config.hugepages_enabled) {
-    // Increase the size of the file to the desired size. This seems not to be
-    // needed for files that are backed by the huge page fs, see also
-    // http://www.mail-archive.com/kvm-devel@lists.sourceforge.net/msg14737.html
-    if (ftruncate(*fd, (off_t)size) != 0) {
-      RAY_LOG(FATAL) << "failed to ftruncate file " << &file_name[0] << ", error"
-                     << std::strerror(errno);
+  // Huge pages are reserved at mmap time, so this fails with ENOMEM if there
+  // are not enough free huge pages.
+  *pointer = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, *fd, 0);
+  if (*pointer == MAP_FAILED) {
+    RAY_LOG(WARNING) << "mmap of " << size << " bytes of huge pages failed, falling "
+                     << "back to regular pages: " << std::strerror(errno)
+                     << " (you may have to increase /proc/sys/vm/nr_hugepages)";
+    close(*fd);
+    return false;
+  }
+  RAY_LOG(INFO) << "Mapped " << size << " bytes of plasma memory backed by huge pages.";
+  return true;
+#else
+  RAY_LOG(WARNING) << "memfd_create is not supported, falling back to regular pages.";
+  return false;
+#endif
+}
+
+// Sets the NUMA memory policy of the given region according to the
+// plasma_numa_nodes config. This must be called before the pages are touched.
+void bind_to_numa_nodes(void *pointer, int64_t size) {
+  const std::string &config = RayConfig::instance().plasma_numa_nodes();
+  std::vector<unsigned long> nodemask;
+  const size_t bits_per_word = 8 * sizeof(unsigned long);
+  int num_nodes = 0;
+  for (absl::string_view node_str : absl::StrSplit(config, ',', absl::SkipEmpty())) {
+    int node;
+    if (!absl::SimpleAtoi(node_str, &node) || node < 0) {
+      RAY_LOG(FATAL) << "Invalid NUMA node " << node_str
+                     << " in plasma_numa_nodes: " << config;
     }
+    if (nodemask.size() <= node / bits_per_word) {
+      nodemask.resize(node / bits_per_word + 1);
+    }
+    nodemask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+    num_nodes++;
+  }
+  if (num_nodes == 0) {
+    return;
+  }
+  // Bind to a single node, or spread the pages over the nodes so that readers
+  // on all of them get the same bandwidth.
+  const int mode = num_nodes == 1 ? MPOL_BIND : MPOL_INTERLEAVE;
+  // The kernel ignores the last bit of maxnode.
+  const unsigned long maxnode = nodemask.size() * bits_per_word + 1;
+  if (syscall(SYS_mbind, pointer, size, mode, nodemask.data(), maxnode, 0) != 0) {
+    RAY_LOG(WARNING) << "mbind to NUMA nodes " << config
+                     << " failed: " << std::strerror(errno);
+  } else {
+    RAY_LOG(INFO) << (mode == MPOL_BIND ? "Bound" : "Interleaved")
+                  << " plasma memory to NUMA nodes " << config;
   }
+}
+#endif /* __linux__ */
 
+void create_and_mmap_buffer(int64_t size, void **pointer, int *fd) {
   // MAP_POPULATE can be used to pre-populate the page tables for this memory region
   // which avoids work when accessing the pages later. However it causes long pauses
   // when mmapping the files. Only supported on Linux.
   auto flags = MAP_SHARED;
+  bool populate = false;
   if (RayConfig::instance().preallocate_plasma_memory()) {
     if (!MAP_POPULATE) {
       RAY_LOG(FATAL) << "MAP_POPULATE is not supported on this platform.";
     }
-    RAY_LOG(INFO) << "Preallocating all plasma memory using MAP_POPULATE.";
+    RAY_LOG(INFO) << "Preallocating all plasma memory.";
+    populate = true;
+  }
+  // The page size and NUMA policy of the initial region have to be set up before
+  // its pages are populated, so we touch them ourselves after that.
+  const bool huge_page_arena =
+      !allocated_once && RayConfig::instance().plasma_huge_page_arena();
+  const bool numa_bound =
+      !allocated_once && !RayConfig::instance().plasma_numa_nodes().empty();
+  if (populate && !numa_bound && !huge_page_arena) {
     flags |= MAP_POPULATE;
   }
 
+  *pointer = MAP_FAILED;
 #ifdef __linux__
-  // For fallback allocation, use fallocate to ensure follow up access to this
-  // mmaped file doesn't cause SIGBUS. Only supported on Linux.
-  if (allocated_once && dlmalloc_config.fallback_enabled) {
-    RAY_LOG(DEBUG) << "Preallocating fallback allocation using fallocate";
-    int ret = fallocate(*fd, /*mode*/ 0, /*offset*/ 0, size);
-    if (ret != 0) {
-      if (errno == EOPNOTSUPP || errno == ENOSYS) {
-        // in case that fallocate is not supported by current filesystem or kernel,
-        // we continue to mmap
-        RAY_LOG(DEBUG) << "fallocate is not supported: " << std::strerror(errno);
-      } else {
-        // otherwise we short circuit the allocation with OOM error.
-        RAY_LOG(ERROR) << "Out of disk space with fallocate error: "
+  if (huge_page_arena && mmap_huge_page_buffer(size, flags, pointer, fd)) {
+    initial_region_ptr = static_cast<char *>(*pointer);
+    initial_region_size = size;
+  }
+#endif /* __linux__ */
+
+  if (*pointer == MAP_FAILED) {
+    // Create a buffer. This is creating a temporary file and then
+    // immediately unlinking it so we do not leave traces in the system.
+    std::string file_template = dlmalloc_config.directory;
+
+    // In never-OOM mode, fallback to allocating from the filesystem. Note that these
+    // allocations will be run with dlmallopt(M_MMAP_THRESHOLD, 0) set by
+    // plasma_allocator.cc.
+    if (allocated_once && dlmalloc_config.fallback_enabled) {
+      file_template = dlmalloc_config.fallback_directory;
+    }
+
+    file_template += "/plasmaXXXXXX";
+    RAY_LOG(INFO) << "create_and_mmap_buffer(" << size << ", " << file_template << ")";
+    std::vector<char> file_name(file_template.begin(), file_template.end());
+    file_name.push_back('\0');
+    *fd = mkstemp(&file_name[0]);
+    if (*fd < 0) {
+      RAY_LOG(FATAL) << "create_buffer failed to open file " << &file_name[0]
+                     << ", error" << std::strerror(errno);
+    }
+    // Immediately unlink the file so we do not leave traces in the system.
+    if (unlink(&file_name[0]) != 0) {
+      RAY_LOG(FATAL) << "failed to unlink file " << &file_name[0] << ", error"
+                     << std::strerror(errno);
+    }
+    if (!dlmalloc_config.hugepages_enabled) {
+      // Increase the size of the file to the desired size. This seems not to be
+      // needed for files that are backed by the huge page fs, see also
+      // http://www.mail-archive.com/kvm-devel@lists.sourceforge.net/msg14737.html
+      if (ftruncate(*fd, (off_t)size) != 0) {
+        RAY_LOG(FATAL) << "failed to ftruncate file " << &file_name[0] << ", error"
                        << std::strerror(errno);
-        *pointer = MFAIL;
-        return;
       }
     }
-  }
+
+#ifdef __linux__
+    // For fallback allocation, use fallocate to ensure follow up access to this
+    // mmaped file doesn't cause SIGBUS. Only supported on Linux.
+    if (allocated_once && dlmalloc_config.fallback_enabled) {
+      RAY_LOG(DEBUG) << "Preallocating fallback allocation using fallocate";
+      int ret = fallocate(*fd, /*mode*/ 0, /*offset*/ 0, size);
+      if (ret != 0) {
+        if (errno == EOPNOTSUPP || errno == ENOSYS) {
+          // in case that fallocate is not supported by current filesystem or kernel,
+          // we continue to mmap
+          RAY_LOG(DEBUG) << "fallocate is not supported: " << std::strerror(errno);
+        } else {
+          // otherwise we short circuit the allocation with OOM error.
+          RAY_LOG(ERROR) << "Out of disk space with fallocate error: "
+                         << std::strerror(errno);
+          *pointer = MFAIL;
+          return;
+        }
+      }
+    }
 #endif /* __linux__ */
 
-  *pointer = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, *fd, 0);
-  if (*pointer == MAP_FAILED) {
-    RAY_LOG(ERROR) << "mmap failed with error: " << std::strerror(errno);
-    if (errno == ENOMEM && dlmalloc_config.hugepages_enabled) {
-      RAY_LOG(ERROR)
-          << "  (this probably means you have to increase /proc/sys/vm/nr_hugepages)";
+    *pointer = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, *fd, 0);
+    if (*pointer == MAP_FAILED) {
+      RAY_LOG(ERROR) << "mmap failed with error: " << std::strerror(errno);
+      if (errno == ENOMEM && dlmalloc_config.hugepages_enabled) {
+        RAY_LOG(ERROR)
+            << "  (this probably means you have to increase /proc/sys/vm/nr_hugepages)";
+      }
+      return;
+    } else if (!allocated_once) {
+      initial_region_ptr = static_cast<char *>(*pointer);
+      initial_region_size = size;
     }
-  } else if (!allocated_once) {
-    initial_region_ptr = static_cast<char *>(*pointer);
-    initial_region_size = size;
+
+#ifdef __linux__
+    if (huge_page_arena) {
+      // Ask for transparent huge pages instead. This only takes effect for shared
+      // memory if /sys/kernel/mm/transparent_hugepage/shmem_enabled allows it.
+      if (madvise(*pointer, size, MADV_HUGEPAGE) != 0) {
+        RAY_LOG(WARNING) << "madvise(MADV_HUGEPAGE) call failed: "
+                         << std::strerror(errno);
+      }
+    }
+#endif /* __linux__ */
   }
 
 #ifdef __linux__
+  if (numa_bound) {
+    bind_to_numa_nodes(*pointer, size);
+  }
+  if (populate && (numa_bound || huge_page_arena)) {
+    const int64_t page_size = sysconf(_SC_PAGESIZE);
+    for (int64_t i = 0; i < size; i += page_size) {
+      static_cast<volatile char *>(*pointer)[i] = 0;
+    }
+  }
+
   if (RayConfig::instance().raylet_core_dump_exclude_plasma_store()) {
     int rval = madvise(initial_region_ptr, initial_region_size, MADV_DONTDUMP);
     if (rval) {
@@ -251,7 +394,7 @@ void *fake_mmap(size_t size) {
   // Add kMmapRegionsGap so that the returned pointer is deliberately not
   // page-aligned. This ensures that the segments of memory returned by
   // fake_mmap are never contiguous.
-  size += kMmapRegionsGap;
+  size = GetMappedSize(size + kMmapRegionsGap, /*initial_region=*/!allocated_once);
 
   void *pointer;
   MEMFD_TYPE_NON_UNIQUE fd;
@@ -276,7 +419,8 @@ void *fake_mmap(size_t size) {
 
 int fake_munmap(void *addr, int64_t size) {
   addr = pointer_retreat(addr, kMmapRegionsGap);
-  size += kMmapRegionsGap;
+  size = GetMappedSize(size + kMmapRegionsGap,
+                       /*initial_region=*/addr == initial_region_ptr);
 
   auto entry = mmap_records.find(addr);
 
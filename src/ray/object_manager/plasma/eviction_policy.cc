@@ -24,24 +24,50 @@
 
 namespace plasma {
 
+namespace {
+/// The cost of fetching or restoring an object again in the GDSF policy, in
+/// bytes. Besides transferring the object, every fetch pays for the location
+/// lookup and a few round trips, which we count as 1 MiB of transfer.
+constexpr double kFetchOverheadBytes = 1024 * 1024;
+
+/// Implements IEvictionPolicy::RequireSpace in terms of
+/// IEvictionPolicy::ChooseObjectsToEvict, which is the same for all policies.
+int64_t RequireSpaceWithPolicy(IEvictionPolicy &policy,
+                               const IAllocator &allocator,
+                               int64_t size,
+                               std::vector<ObjectID> &objects_to_evict) {
+  // Check if there is enough space to create the object.
+  int64_t required_space = allocator.Allocated() + size - allocator.GetFootprintLimit();
+  // Try to free up at least as much space as we need right now but ideally
+  // up to 20% of the total capacity.
+  int64_t space_to_free = std::max(required_space, allocator.GetFootprintLimit() / 5);
+  // Choose some objects to evict, and update the return pointers.
+  int64_t num_bytes_evicted =
+      policy.ChooseObjectsToEvict(space_to_free, objects_to_evict);
+  RAY_LOG(DEBUG) << "There is not enough space to create this object, so evicting "
+                 << objects_to_evict.size() << " objects to free up " << num_bytes_evicted
+                 << " bytes. The number of bytes in use (before "
+                 << "this eviction) is " << allocator.Allocated() << ".";
+  return required_space - num_bytes_evicted;
+}
+}  // namespace
+
 void LRUCache::Add(const ObjectID &key, int64_t size) {
-  auto it = item_map_.find(key);
-  RAY_CHECK(it == item_map_.end());
-  // Note that it is important to use a list so the iterators stay valid.
-  item_list_.emplace_front(key, size);
-  item_map_.emplace(key, item_list_.begin());
+  uint32_t index = entries_.Insert(key);
+  entries_[index].size = size;
+  item_list_.PushFront(index);
   used_capacity_ += size;
 }
 
 int64_t LRUCache::Remove(const ObjectID &key) {
-  auto it = item_map_.find(key);
-  if (it == item_map_.end()) {
+  uint32_t index = entries_.Find(key);
+  if (index == kNilIndex) {
     return -1;
   }
-  int64_t size = it->second->second;
+  int64_t size = entries_[index].size;
   used_capacity_ -= size;
-  item_list_.erase(it->second);
-  item_map_.erase(it);
+  item_list_.Erase(index);
+  entries_.Erase(index);
   RAY_CHECK(used_capacity_ >= 0) << DebugString();
   return size;
 }
@@ -60,8 +86,9 @@ int64_t LRUCache::OriginalCapacity() const { return original_capacity_; }
 int64_t LRUCache::RemainingCapacity() const { return capacity_ - used_capacity_; }
 
 void LRUCache::Foreach(std::function<void(const ObjectID &)> f) {
-  for (auto &pair : item_list_) {
-    f(pair.first);
+  for (uint32_t index = item_list_.Front(); index != kNilIndex;
+       index = item_list_.Next(index)) {
+    f(entries_[index].object_id);
   }
 }
 
@@ -71,7 +98,7 @@ std::string LRUCache::DebugString() const {
   result << "\n(" << name_
          << ") used: " << 100. * (1. - (RemainingCapacity() / (double)OriginalCapacity()))
          << "%";
-  result << "\n(" << name_ << ") num objects: " << item_map_.size();
+  result << "\n(" << name_ << ") num objects: " << entries_.Size();
   result << "\n(" << name_ << ") num evictions: " << num_evictions_total_;
   result << "\n(" << name_ << ") bytes evicted: " << bytes_evicted_total_;
   return result.str();
@@ -80,18 +107,21 @@ std::string LRUCache::DebugString() const {
 int64_t LRUCache::ChooseObjectsToEvict(int64_t num_bytes_required,
                                        std::vector<ObjectID> &objects_to_evict) {
   int64_t bytes_evicted = 0;
-  auto it = item_list_.end();
-  while (bytes_evicted < num_bytes_required && it != item_list_.begin()) {
-    it--;
-    objects_to_evict.push_back(it->first);
-    bytes_evicted += it->second;
-    bytes_evicted_total_ += it->second;
+  for (uint32_t index = item_list_.Back();
+       bytes_evicted < num_bytes_required && index != kNilIndex;
+       index = item_list_.Prev(index)) {
+    const auto &entry = entries_[index];
+    objects_to_evict.push_back(entry.object_id);
+    bytes_evicted += entry.size;
+    bytes_evicted_total_ += entry.size;
     num_evictions_total_ += 1;
   }
   return bytes_evicted;
 }
 
-bool LRUCache::Exists(const ObjectID &key) const { return item_map_.count(key) > 0; }
+bool LRUCache::Exists(const ObjectID &key) const {
+  return entries_.Find(key) != kNilIndex;
+}
 
 EvictionPolicy::EvictionPolicy(const IObjectStore &object_store,
                                const IAllocator &allocator)
@@ -117,18 +147,7 @@ void EvictionPolicy::ObjectCreated(const ObjectID &object_id) {
 
 int64_t EvictionPolicy::RequireSpace(int64_t size,
                                      std::vector<ObjectID> &objects_to_evict) {
-  // Check if there is enough space to create the object.
-  int64_t required_space = allocator_.Allocated() + size - allocator_.GetFootprintLimit();
-  // Try to free up at least as much space as we need right now but ideally
-  // up to 20% of the total capacity.
-  int64_t space_to_free = std::max(required_space, allocator_.GetFootprintLimit() / 5);
-  // Choose some objects to evict, and update the return pointers.
-  int64_t num_bytes_evicted = ChooseObjectsToEvict(space_to_free, objects_to_evict);
-  RAY_LOG(DEBUG) << "There is not enough space to create this object, so evicting "
-                 << objects_to_evict.size() << " objects to free up " << num_bytes_evicted
-                 << " bytes. The number of bytes in use (before "
-                 << "this eviction) is " << allocator_.Allocated() << ".";
-  return required_space - num_bytes_evicted;
+  return RequireSpaceWithPolicy(*this, allocator_, size, objects_to_evict);
 }
 
 void EvictionPolicy::BeginObjectAccess(const ObjectID &object_id) {
@@ -158,4 +177,267 @@ bool EvictionPolicy::IsObjectExists(const ObjectID &object_id) const {
 }
 
 std::string EvictionPolicy::DebugString() const { return cache_.DebugString(); }
+
+SegmentedLRUEvictionPolicy::SegmentedLRUEvictionPolicy(const IObjectStore &object_store,
+                                                       const IAllocator &allocator,
+                                                       double protected_fraction)
+    : object_store_(object_store),
+      allocator_(allocator),
+      protected_capacity_(
+          static_cast<int64_t>(allocator.GetFootprintLimit() * protected_fraction)) {}
+
+void SegmentedLRUEvictionPolicy::ObjectCreated(const ObjectID &object_id) {
+  uint32_t index = entries_.Insert(object_id);
+  entries_[index].size = object_store_.GetObject(object_id)->GetObjectSize();
+  Link(index, Segment::kProbation);
+}
+
+int64_t SegmentedLRUEvictionPolicy::RequireSpace(
+    int64_t size, std::vector<ObjectID> &objects_to_evict) {
+  return RequireSpaceWithPolicy(*this, allocator_, size, objects_to_evict);
+}
+
+void SegmentedLRUEvictionPolicy::BeginObjectAccess(const ObjectID &object_id) {
+  uint32_t index = entries_.Find(object_id);
+  RAY_CHECK(index != kNilIndex) << object_id;
+  Unlink(index);
+}
+
+void SegmentedLRUEvictionPolicy::EndObjectAccess(const ObjectID &object_id) {
+  uint32_t index = entries_.Find(object_id);
+  RAY_CHECK(index != kNilIndex) << object_id;
+  Unlink(index);
+  auto &entry = entries_[index];
+  entry.num_accesses++;
+  // The creator of an object releases it once, so only count it as reused if
+  // it is released again.
+  Link(index, entry.num_accesses > 1 ? Segment::kProtected : Segment::kProbation);
+  while (protected_bytes_ > protected_capacity_) {
+    uint32_t demoted = protected_.Back();
+    Unlink(demoted);
+    Link(demoted, Segment::kProbation);
+  }
+}
+
+int64_t SegmentedLRUEvictionPolicy::ChooseObjectsToEvict(
+    int64_t num_bytes_required, std::vector<ObjectID> &objects_to_evict) {
+  int64_t bytes_evicted = 0;
+  for (auto *segment : {&probation_, &protected_}) {
+    while (bytes_evicted < num_bytes_required && !segment->Empty()) {
+      uint32_t index = segment->Back();
+      objects_to_evict.push_back(entries_[index].object_id);
+      bytes_evicted += entries_[index].size;
+      num_evictions_total_++;
+      Unlink(index);
+      entries_.Erase(index);
+    }
+  }
+  bytes_evicted_total_ += bytes_evicted;
+  return bytes_evicted;
+}
+
+void SegmentedLRUEvictionPolicy::RemoveObject(const ObjectID &object_id) {
+  uint32_t index = entries_.Find(object_id);
+  if (index == kNilIndex) {
+    return;
+  }
+  Unlink(index);
+  entries_.Erase(index);
+}
+
+std::string SegmentedLRUEvictionPolicy::DebugString() const {
+  std::stringstream result;
+  result << "\n(segmented lru) protected capacity: " << protected_capacity_;
+  result << "\n(segmented lru) probation bytes: " << probation_bytes_;
+  result << "\n(segmented lru) protected bytes: " << protected_bytes_;
+  result << "\n(segmented lru) num objects: " << entries_.Size();
+  result << "\n(segmented lru) num evictions: " << num_evictions_total_;
+  result << "\n(segmented lru) bytes evicted: " << bytes_evicted_total_;
+  return result.str();
+}
+
+void SegmentedLRUEvictionPolicy::Link(uint32_t index, Segment segment) {
+  auto &entry = entries_[index];
+  RAY_CHECK(entry.segment == Segment::kPinned);
+  entry.segment = segment;
+  if (segment == Segment::kProbation) {
+    probation_.PushFront(index);
+    probation_bytes_ += entry.size;
+  } else {
+    protected_.PushFront(index);
+    protected_bytes_ += entry.size;
+  }
+}
+
+void SegmentedLRUEvictionPolicy::Unlink(uint32_t index) {
+  auto &entry = entries_[index];
+  if (entry.segment == Segment::kProbation) {
+    probation_.Erase(index);
+    probation_bytes_ -= entry.size;
+  } else if (entry.segment == Segment::kProtected) {
+    protected_.Erase(index);
+    protected_bytes_ -= entry.size;
+  }
+  entry.segment = Segment::kPinned;
+}
+
+bool SegmentedLRUEvictionPolicy::IsObjectExists(const ObjectID &object_id) const {
+  uint32_t index = entries_.Find(object_id);
+  return index != kNilIndex && entries_[index].segment != Segment::kPinned;
+}
+
+bool SegmentedLRUEvictionPolicy::IsObjectProtected(const ObjectID &object_id) const {
+  uint32_t index = entries_.Find(object_id);
+  return index != kNilIndex && entries_[index].segment == Segment::kProtected;
+}
+
+GreedyDualSizeFrequencyEvictionPolicy::GreedyDualSizeFrequencyEvictionPolicy(
+    const IObjectStore &object_store, const IAllocator &allocator)
+    : object_store_(object_store), allocator_(allocator) {}
+
+void GreedyDualSizeFrequencyEvictionPolicy::ObjectCreated(const ObjectID &object_id) {
+  uint32_t index = entries_.Insert(object_id);
+  entries_[index].size = object_store_.GetObject(object_id)->GetObjectSize();
+  Push(index);
+}
+
+int64_t GreedyDualSizeFrequencyEvictionPolicy::RequireSpace(
+    int64_t size, std::vector<ObjectID> &objects_to_evict) {
+  return RequireSpaceWithPolicy(*this, allocator_, size, objects_to_evict);
+}
+
+void GreedyDualSizeFrequencyEvictionPolicy::BeginObjectAccess(const ObjectID &object_id) {
+  uint32_t index = entries_.Find(object_id);
+  RAY_CHECK(index != kNilIndex) << object_id;
+  Remove(index);
+}
+
+void GreedyDualSizeFrequencyEvictionPolicy::EndObjectAccess(const ObjectID &object_id) {
+  uint32_t index = entries_.Find(object_id);
+  RAY_CHECK(index != kNilIndex) << object_id;
+  Remove(index);
+  entries_[index].frequency++;
+  Push(index);
+}
+
+int64_t GreedyDualSizeFrequencyEvictionPolicy::ChooseObjectsToEvict(
+    int64_t num_bytes_required, std::vector<ObjectID> &objects_to_evict) {
+  int64_t bytes_evicted = 0;
+  while (bytes_evicted < num_bytes_required && !heap_.empty()) {
+    uint32_t index = heap_.front();
+    const auto &entry = entries_[index];
+    inflation_ = std::max(inflation_, entry.priority);
+    objects_to_evict.push_back(entry.object_id);
+    bytes_evicted += entry.size;
+    num_evictions_total_++;
+    Remove(index);
+    entries_.Erase(index);
+  }
+  bytes_evicted_total_ += bytes_evicted;
+  return bytes_evicted;
+}
+
+void GreedyDualSizeFrequencyEvictionPolicy::RemoveObject(const ObjectID &object_id) {
+  uint32_t index = entries_.Find(object_id);
+  if (index == kNilIndex) {
+    return;
+  }
+  Remove(index);
+  entries_.Erase(index);
+}
+
+std::string GreedyDualSizeFrequencyEvictionPolicy::DebugString() const {
+  std::stringstream result;
+  result << "\n(gdsf) evictable bytes: " << evictable_bytes_;
+  result << "\n(gdsf) num objects: " << entries_.Size();
+  result << "\n(gdsf) num evictable objects: " << heap_.size();
+  result << "\n(gdsf) inflation: " << inflation_;
+  result << "\n(gdsf) num evictions: " << num_evictions_total_;
+  result << "\n(gdsf) bytes evicted: " << bytes_evicted_total_;
+  return result.str();
+}
+
+void GreedyDualSizeFrequencyEvictionPolicy::Push(uint32_t index) {
+  auto &entry = entries_[index];
+  RAY_CHECK(entry.heap_index == kNilIndex);
+  const double size = std::max<int64_t>(entry.size, 1);
+  entry.priority =
+      inflation_ + entry.frequency * (kFetchOverheadBytes + entry.size) / size;
+  entry.heap_index = static_cast<uint32_t>(heap_.size());
+  heap_.push_back(index);
+  evictable_bytes_ += entry.size;
+  SiftUp(entry.heap_index);
+}
+
+void GreedyDualSizeFrequencyEvictionPolicy::Remove(uint32_t index) {
+  auto &entry = entries_[index];
+  if (entry.heap_index == kNilIndex) {
+    return;
+  }
+  const size_t position = entry.heap_index;
+  Swap(position, heap_.size() - 1);
+  heap_.pop_back();
+  entry.heap_index = kNilIndex;
+  evictable_bytes_ -= entry.size;
+  if (position < heap_.size()) {
+    SiftDown(position);
+    SiftUp(position);
+  }
+}
+
+void GreedyDualSizeFrequencyEvictionPolicy::SiftUp(size_t position) {
+  while (position > 0) {
+    size_t parent = (position - 1) / 2;
+    if (entries_[heap_[parent]].priority <= entries_[heap_[position]].priority) {
+      break;
+    }
+    Swap(position, parent);
+    position = parent;
+  }
+}
+
+void GreedyDualSizeFrequencyEvictionPolicy::SiftDown(size_t position) {
+  while (true) {
+    size_t smallest = position;
+    for (size_t child = 2 * position + 1; child <= 2 * position + 2; child++) {
+      if (child < heap_.size() &&
+          entries_[heap_[child]].priority < entries_[heap_[smallest]].priority) {
+        smallest = child;
+      }
+    }
+    if (smallest == position) {
+      break;
+    }
+    Swap(position, smallest);
+    position = smallest;
+  }
+}
+
+void GreedyDualSizeFrequencyEvictionPolicy::Swap(size_t a, size_t b) {
+  std::swap(heap_[a], heap_[b]);
+  entries_[heap_[a]].heap_index = static_cast<uint32_t>(a);
+  entries_[heap_[b]].heap_index = static_cast<uint32_t>(b);
+}
+
+bool GreedyDualSizeFrequencyEvictionPolicy::IsObjectExists(
+    const ObjectID &object_id) const {
+  uint32_t index = entries_.Find(object_id);
+  return index != kNilIndex && entries_[index].heap_index != kNilIndex;
+}
+
+std::unique_ptr<IEvictionPolicy> CreateEvictionPolicy(const std::string &policy,
+                                                      const IObjectStore &object_store,
+                                                      const IAllocator &allocator) {
+  if (policy == "lru") {
+    return std::make_unique<EvictionPolicy>(object_store, allocator);
+  } else if (policy == "slru") {
+    return std::make_unique<SegmentedLRUEvictionPolicy>(object_store, allocator);
+  } else if (policy == "gdsf") {
+    return std::make_unique<GreedyDualSizeFrequencyEvictionPolicy>(object_store,
+                                                                   allocator);
+  }
+  RAY_LOG(FATAL) << "Unknown plasma eviction policy \"" << policy
+                 << "\", must be one of lru, slru or gdsf.";
+  return nullptr;
+}
 }  // namespace plasma
@@ -24,12 +24,13 @@
 #pragma once
 
 #include <functional>
-#include <list>
+#include <limits>
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "ray/object_manager/plasma/common.h"
 #include "ray/object_manager/plasma/object_store.h"
 #include "ray/object_manager/plasma/plasma.h"
@@ -102,6 +103,109 @@ class IEvictionPolicy {
   virtual std::string DebugString() const = 0;
 };
 
+/// Index that marks the end of an IntrusiveList, or an entry that is not linked.
+constexpr uint32_t kNilIndex = std::numeric_limits<uint32_t>::max();
+
+/// Table of per-object entries of an eviction policy. Entries are stored in a
+/// vector and addressed by index, and the slots of removed entries are reused.
+/// Once the table has grown to the number of objects in the store, adding and
+/// removing entries does not allocate. Entry must have an object_id field.
+template <typename Entry>
+class EntryTable {
+ public:
+  /// Adds a default constructed entry for the object, which must not be in the
+  /// table yet, and returns its index.
+  uint32_t Insert(const ObjectID &object_id) {
+    uint32_t index;
+    if (free_indices_.empty()) {
+      index = static_cast<uint32_t>(entries_.size());
+      entries_.emplace_back();
+    } else {
+      index = free_indices_.back();
+      free_indices_.pop_back();
+      entries_[index] = Entry();
+    }
+    entries_[index].object_id = object_id;
+    RAY_CHECK(index_.emplace(object_id, index).second) << object_id;
+    return index;
+  }
+
+  /// Returns the index of the object's entry, or kNilIndex if there is none.
+  uint32_t Find(const ObjectID &object_id) const {
+    auto it = index_.find(object_id);
+    return it == index_.end() ? kNilIndex : it->second;
+  }
+
+  void Erase(uint32_t index) {
+    index_.erase(entries_[index].object_id);
+    free_indices_.push_back(index);
+  }
+
+  Entry &operator[](uint32_t index) { return entries_[index]; }
+
+  const Entry &operator[](uint32_t index) const { return entries_[index]; }
+
+  size_t Size() const { return index_.size(); }
+
+ private:
+  std::vector<Entry> entries_;
+  /// Slots of erased entries.
+  std::vector<uint32_t> free_indices_;
+  absl::flat_hash_map<ObjectID, uint32_t> index_;
+};
+
+/// Doubly-linked list threaded through the prev and next fields of the entries
+/// of an EntryTable. Unlike std::list, linking and unlinking an entry never
+/// allocates, and entries can move between lists of the same table in O(1).
+template <typename Entry>
+class IntrusiveList {
+ public:
+  explicit IntrusiveList(EntryTable<Entry> &table) : table_(table) {}
+
+  void PushFront(uint32_t index) {
+    Entry &entry = table_[index];
+    entry.prev = kNilIndex;
+    entry.next = head_;
+    if (head_ != kNilIndex) {
+      table_[head_].prev = index;
+    } else {
+      tail_ = index;
+    }
+    head_ = index;
+  }
+
+  void Erase(uint32_t index) {
+    Entry &entry = table_[index];
+    if (entry.prev != kNilIndex) {
+      table_[entry.prev].next = entry.next;
+    } else {
+      head_ = entry.next;
+    }
+    if (entry.next != kNilIndex) {
+      table_[entry.next].prev = entry.prev;
+    } else {
+      tail_ = entry.prev;
+    }
+    entry.prev = kNilIndex;
+    entry.next = kNilIndex;
+  }
+
+  uint32_t Front() const { return head_; }
+
+  uint32_t Back() const { return tail_; }
+
+  uint32_t Next(uint32_t index) const { return table_[index].next; }
+
+  uint32_t Prev(uint32_t index) const { return table_[index].prev; }
+
+  bool Empty() const { return head_ == kNilIndex; }
+
+ private:
+  EntryTable<Entry> &table_;
+  uint32_t head_ = kNilIndex;
+  uint32_t tail_ = kNilIndex;
+};
+
 class LRUCache {
  public:
   LRUCache(const std::string &name, int64_t size)
@@ -134,13 +238,17 @@ class LRUCache {
   std::string DebugString() const;
 
  private:
-  /// A doubly-linked list containing the items in the cache and
-  /// their sizes in LRU order.
-  typedef std::list<std::pair<ObjectID, int64_t>> ItemList;
-  ItemList item_list_;
-  /// A hash table mapping the object ID of an object in the cache to its
-  /// location in the doubly linked list item_list_.
-  absl::flat_hash_map<ObjectID, ItemList::iterator> item_map_;
+  struct Entry {
+    ObjectID object_id;
+    int64_t size = 0;
+    uint32_t prev = kNilIndex;
+    uint32_t next = kNilIndex;
+  };
+
+  /// The items in the cache and their sizes.
+  EntryTable<Entry> entries_;
+  /// A doubly-linked list of the items in the cache in LRU order.
+  IntrusiveList<Entry> item_list_{entries_};
 
   /// The name of this cache, used for debugging purposes only.
   const std::string name_;
@@ -196,4 +304,147 @@ class EvictionPolicy : public IEvictionPolicy {
   FRIEND_TEST(EvictionPolicyTest, Test);
 };
 
+/// Segmented LRU eviction policy. Objects that are released for the first time
+/// enter a probationary segment, and are promoted to a protected segment when
+/// they are released again after another access. Objects are evicted from the
+/// probationary segment first, so a scan over many objects that are only used
+/// once does not flush out the objects that are used repeatedly. The protected
+/// segment is bounded, and its least recently used objects are demoted back to
+/// the probationary segment when it overflows.
+class SegmentedLRUEvictionPolicy : public IEvictionPolicy {
+ public:
+  /// \param protected_fraction The fraction of the store capacity that objects
+  /// in the protected segment can occupy.
+  SegmentedLRUEvictionPolicy(const IObjectStore &object_store,
+                             const IAllocator &allocator,
+                             double protected_fraction = 0.8);
+
+  void ObjectCreated(const ObjectID &object_id) override;
+
+  int64_t RequireSpace(int64_t size, std::vector<ObjectID> &objects_to_evict) override;
+
+  void BeginObjectAccess(const ObjectID &object_id) override;
+
+  void EndObjectAccess(const ObjectID &object_id) override;
+
+  int64_t ChooseObjectsToEvict(int64_t num_bytes_required,
+                               std::vector<ObjectID> &objects_to_evict) override;
+
+  void RemoveObject(const ObjectID &object_id) override;
+
+  std::string DebugString() const override;
+
+ private:
+  enum class Segment : uint8_t { kPinned, kProbation, kProtected };
+
+  struct Entry {
+    ObjectID object_id;
+    int64_t size = 0;
+    uint32_t prev = kNilIndex;
+    uint32_t next = kNilIndex;
+    Segment segment = Segment::kPinned;
+    /// Number of times the object was released.
+    int64_t num_accesses = 0;
+  };
+
+  /// Adds the entry to the front of the given segment.
+  void Link(uint32_t index, Segment segment);
+
+  /// Removes the entry from its segment, so that it can't be evicted.
+  void Unlink(uint32_t index);
+
+  /// Whether the object is evictable, for testing.
+  bool IsObjectExists(const ObjectID &object_id) const;
+
+  /// Whether the object is in the protected segment, for testing.
+  bool IsObjectProtected(const ObjectID &object_id) const;
+
+  const IObjectStore &object_store_;
+  const IAllocator &allocator_;
+  /// Entries of all objects in the store.
+  EntryTable<Entry> entries_;
+  IntrusiveList<Entry> probation_{entries_};
+  IntrusiveList<Entry> protected_{entries_};
+  int64_t probation_bytes_ = 0;
+  int64_t protected_bytes_ = 0;
+  const int64_t protected_capacity_;
+  int64_t num_evictions_total_ = 0;
+  int64_t bytes_evicted_total_ = 0;
+
+  FRIEND_TEST(EvictionPoliciesTest, SegmentedLRU);
+};
+
+/// GreedyDual-Size-Frequency eviction policy. Each evictable object has a
+/// priority of L + frequency * cost / size, where L is the priority of the last
+/// evicted object and the cost of an object is the work of fetching or
+/// restoring it again. Objects with the lowest priority are evicted first, so
+/// that large objects have to be used more often than small ones to stay in the
+/// store. Raising L on every eviction ages out objects that were popular in the
+/// past.
+class GreedyDualSizeFrequencyEvictionPolicy : public IEvictionPolicy {
+ public:
+  GreedyDualSizeFrequencyEvictionPolicy(const IObjectStore &object_store,
+                                        const IAllocator &allocator);
+
+  void ObjectCreated(const ObjectID &object_id) override;
+
+  int64_t RequireSpace(int64_t size, std::vector<ObjectID> &objects_to_evict) override;
+
+  void BeginObjectAccess(const ObjectID &object_id) override;
+
+  void EndObjectAccess(const ObjectID &object_id) override;
+
+  int64_t ChooseObjectsToEvict(int64_t num_bytes_required,
+                               std::vector<ObjectID> &objects_to_evict) override;
+
+  void RemoveObject(const ObjectID &object_id) override;
+
+  std::string DebugString() const override;
+
+ private:
+  struct Entry {
+    ObjectID object_id;
+    int64_t size = 0;
+    /// Number of times the object was released.
+    int64_t frequency = 0;
+    double priority = 0;
+    /// Position of the entry in heap_, or kNilIndex if it is pinned.
+    uint32_t heap_index = kNilIndex;
+  };
+
+  /// Adds the entry to the heap with a priority based on its frequency.
+  void Push(uint32_t index);
+
+  /// Removes the entry from the heap, so that it can't be evicted.
+  void Remove(uint32_t index);
+
+  /// Restores the heap property for the entry at the given heap position.
+  void SiftUp(size_t position);
+  void SiftDown(size_t position);
+  void Swap(size_t a, size_t b);
+
+  /// Whether the object is evictable, for testing.
+  bool IsObjectExists(const ObjectID &object_id) const;
+
+  const IObjectStore &object_store_;
+  const IAllocator &allocator_;
+  /// Entries of all objects in the store.
+  EntryTable<Entry> entries_;
+  /// Binary min-heap of the evictable entries, ordered by priority.
+  std::vector<uint32_t> heap_;
+  /// The priority of the last evicted object.
+  double inflation_ = 0;
+  int64_t evictable_bytes_ = 0;
+  int64_t num_evictions_total_ = 0;
+  int64_t bytes_evicted_total_ = 0;
+
+  FRIEND_TEST(EvictionPoliciesTest, GreedyDualSizeFrequency);
+};
+
+/// Creates an eviction policy by name, one of "lru", "slru" (segmented LRU) or
+/// "gdsf" (GreedyDual-Size-Frequency).
+std::unique_ptr<IEvictionPolicy> CreateEvictionPolicy(const std::string &policy,
+                                                      const IObjectStore &object_store,
+                                                      const IAllocator &allocator);
+
 }  // namespace plasma
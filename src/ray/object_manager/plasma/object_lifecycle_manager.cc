@@ -25,8 +25,10 @@ using namespace flatbuf;
 
 ObjectLifecycleManager::ObjectLifecycleManager(
     IAllocator &allocator, ray::DeleteObjectCallback delete_object_callback)
-    : object_store_(std::make_unique<ObjectStore>(allocator)),
-      eviction_policy_(std::make_unique<EvictionPolicy>(*object_store_, allocator)),
+    : allocator_(&allocator),
+      object_store_(std::make_unique<ObjectStore>(allocator)),
+      eviction_policy_(CreateEvictionPolicy(
+          RayConfig::instance().plasma_eviction_policy(), *object_store_, allocator)),
       delete_object_callback_(delete_object_callback),
       earger_deletion_objects_(),
       stats_collector_(std::make_unique<ObjectStatsCollector>()) {}
@@ -271,10 +273,18 @@ int64_t ObjectLifecycleManager::GetNumObjectsUnsealed() const {
   return stats_collector_->GetNumObjectsUnsealed();
 }
 
-void ObjectLifecycleManager::RecordMetrics() const { stats_collector_->RecordMetrics(); }
+void ObjectLifecycleManager::RecordMetrics() const {
+  stats_collector_->RecordMetrics();
+  if (allocator_ != nullptr) {
+    allocator_->RecordMetrics();
+  }
+}
 
 void ObjectLifecycleManager::GetDebugDump(std::stringstream &buffer) const {
-  return stats_collector_->GetDebugDump(buffer);
+  stats_collector_->GetDebugDump(buffer);
+  if (allocator_ != nullptr) {
+    allocator_->GetDebugDump(buffer);
+  }
 }
 
 // For test only.
@@ -283,7 +293,8 @@ ObjectLifecycleManager::ObjectLifecycleManager(
     std::unique_ptr<IEvictionPolicy> eviction_policy,
     ray::DeleteObjectCallback delete_object_callback,
     std::unique_ptr<ObjectStatsCollector> stats_collector)
-    : object_store_(std::move(store)),
+    : allocator_(nullptr),
+      object_store_(std::move(store)),
       eviction_policy_(std::move(eviction_policy)),
       delete_object_callback_(delete_object_callback),
       earger_deletion_objects_(),
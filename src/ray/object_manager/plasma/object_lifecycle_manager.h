@@ -167,6 +167,10 @@ class ObjectLifecycleManager : public IObjectLifecycleManager {
   void EvictObjects(const std::vector<ObjectID> &object_ids);
 
   void DeleteObjectInternal(const ObjectID &object_id);
+
+  /// The allocator backing the object store, used to report allocator stats.
+  /// Null in tests.
+  const IAllocator *allocator_;
   std::unique_ptr<IObjectStore> object_store_;
   std::unique_ptr<IEvictionPolicy> eviction_policy_;
   const ray::DeleteObjectCallback delete_object_callback_;
@@ -0,0 +1,238 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/slab_allocator.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "ray/stats/metric_defs.h"
+#include "ray/util/logging.h"
+
+namespace plasma {
+
+namespace {
+// Slot sizes are multiples of this, so that slots keep the 64-byte alignment
+// of the slabs they are carved from.
+const int64_t kSlotAlignment = 64;
+
+int64_t RoundUpToSlotAlignment(int64_t bytes) {
+  return (bytes + kSlotAlignment - 1) / kSlotAlignment * kSlotAlignment;
+}
+}  // namespace
+
+SlabAllocator::SlabAllocator(IAllocator &allocator,
+                             int64_t slab_size,
+                             int64_t max_slot_size)
+    : allocator_(allocator),
+      kSlabSize(slab_size),
+      kMaxSlotSize(RoundUpToSlotAlignment(max_slot_size)) {
+  RAY_CHECK(kMaxSlotSize > 0) << "Max slot size must be positive.";
+  RAY_CHECK(kSlabSize >= kMaxSlotSize)
+      << "Slab size " << kSlabSize << " must be at least the max slot size "
+      << kMaxSlotSize;
+  // Size classes grow by alternating factors of 1.5 and 4/3 (64, 128, 192,
+  // 256, 384, 512, 768, ...), which bounds the internal fragmentation of a
+  // slot to a third of its size.
+  std::vector<int64_t> slot_sizes = {kSlotAlignment};
+  for (int64_t power = 2 * kSlotAlignment; slot_sizes.back() < kMaxSlotSize;
+       power *= 2) {
+    for (int64_t slot_size : {power, power + power / 2}) {
+      if (slot_size > slot_sizes.back()) {
+        slot_sizes.push_back(std::min(slot_size, kMaxSlotSize));
+      }
+      if (slot_sizes.back() == kMaxSlotSize) {
+        break;
+      }
+    }
+  }
+  RAY_CHECK(slot_sizes.size() <= std::numeric_limits<uint8_t>::max());
+
+  size_classes_.resize(slot_sizes.size());
+  size_class_index_.resize(kMaxSlotSize / kSlotAlignment + 1);
+  size_t index = 0;
+  for (size_t i = 0; i < size_class_index_.size(); i++) {
+    while (slot_sizes[index] < static_cast<int64_t>(i) * kSlotAlignment) {
+      index++;
+    }
+    size_class_index_[i] = static_cast<uint8_t>(index);
+  }
+  for (size_t i = 0; i < slot_sizes.size(); i++) {
+    size_classes_[i].slot_size = slot_sizes[i];
+    size_classes_[i].slots_per_slab = static_cast<uint32_t>(kSlabSize / slot_sizes[i]);
+  }
+}
+
+SlabAllocator::~SlabAllocator() {
+  for (auto &size_class : size_classes_) {
+    while (!size_class.slabs.empty()) {
+      FreeSlab(&size_class, size_class.slabs.begin());
+    }
+  }
+}
+
+absl::optional<Allocation> SlabAllocator::Allocate(size_t bytes) {
+  auto size_class = GetSizeClass(bytes);
+  if (size_class == nullptr) {
+    auto allocation = allocator_.Allocate(bytes);
+    if (!allocation.has_value() && ReleaseEmptySlabs()) {
+      allocation = allocator_.Allocate(bytes);
+    }
+    return allocation;
+  }
+
+  auto &slabs = size_class->slabs;
+  if (slabs.empty() || slabs.front().free_slots.empty()) {
+    if (!AllocateSlab(size_class)) {
+      // Out of memory for a new slab, but there might still be a hole in the
+      // underlying allocator that is big enough for this object.
+      return allocator_.Allocate(bytes);
+    }
+  }
+
+  auto slab = slabs.begin();
+  uint32_t slot_index = slab->free_slots.back();
+  slab->free_slots.pop_back();
+  if (slab->free_slots.empty()) {
+    // Move full slabs behind the ones that still have free slots.
+    slabs.splice(slabs.end(), slabs, slab);
+  }
+
+  const auto &backing = slab->allocation;
+  const ptrdiff_t slot_offset = slot_index * size_class->slot_size;
+  void *address = static_cast<uint8_t *>(backing.address) + slot_offset;
+  live_slots_.emplace(address, SlotInfo{size_class, slab, slot_index});
+  slot_bytes_in_use_ += size_class->slot_size;
+  requested_bytes_in_use_ += bytes;
+  return Allocation(address,
+                    static_cast<int64_t>(bytes),
+                    backing.fd,
+                    backing.offset + slot_offset,
+                    backing.device_num,
+                    backing.mmap_size,
+                    backing.fallback_allocated);
+}
+
+absl::optional<Allocation> SlabAllocator::FallbackAllocate(size_t bytes) {
+  return allocator_.FallbackAllocate(bytes);
+}
+
+void SlabAllocator::Free(Allocation allocation) {
+  RAY_CHECK(allocation.address != nullptr) << "Cannot free the nullptr";
+  auto it = live_slots_.find(allocation.address);
+  if (it == live_slots_.end()) {
+    allocator_.Free(std::move(allocation));
+    return;
+  }
+
+  auto size_class = it->second.size_class;
+  auto slab = it->second.slab;
+  auto &slabs = size_class->slabs;
+  if (slab->free_slots.empty()) {
+    // The slab was full, make it available for allocations again.
+    slabs.splice(slabs.begin(), slabs, slab);
+  }
+  slab->free_slots.push_back(it->second.slot_index);
+  slot_bytes_in_use_ -= size_class->slot_size;
+  requested_bytes_in_use_ -= allocation.size;
+  live_slots_.erase(it);
+
+  // Keep the last slab of a size class around even if it is empty, so that
+  // creating and deleting a single small object doesn't allocate and free a
+  // slab every time.
+  if (slab->free_slots.size() == size_class->slots_per_slab && slabs.size() > 1) {
+    FreeSlab(size_class, slab);
+  }
+}
+
+int64_t SlabAllocator::GetFootprintLimit() const {
+  return allocator_.GetFootprintLimit();
+}
+
+int64_t SlabAllocator::Allocated() const { return allocator_.Allocated(); }
+
+int64_t SlabAllocator::FallbackAllocated() const {
+  return allocator_.FallbackAllocated();
+}
+
+void SlabAllocator::RecordMetrics() const {
+  ray::stats::STATS_object_store_slab_bytes.Record(SlabBytesReserved(), "Reserved");
+  ray::stats::STATS_object_store_slab_bytes.Record(SlabBytesInUse(), "InUse");
+  ray::stats::STATS_object_store_slab_bytes.Record(SlabBytesRequested(), "Requested");
+  // Internal fragmentation is the share of reserved slab memory that is not
+  // holding object data, either because slots are free or rounded up.
+  const double fragmentation =
+      num_slabs_ == 0 ? 0 : 1 - SlabBytesRequested() / (double)SlabBytesReserved();
+  ray::stats::STATS_object_store_slab_fragmentation_ratio.Record(fragmentation);
+}
+
+void SlabAllocator::GetDebugDump(std::stringstream &buffer) const {
+  buffer << "\n";
+  buffer << "- slabs: " << num_slabs_ << "\n";
+  buffer << "- slab bytes reserved: " << SlabBytesReserved() << "\n";
+  buffer << "- slab bytes in use: " << SlabBytesInUse() << "\n";
+  buffer << "- slab bytes requested: " << SlabBytesRequested() << "\n";
+}
+
+SlabAllocator::SizeClass *SlabAllocator::GetSizeClass(size_t bytes) {
+  if (static_cast<int64_t>(bytes) > kMaxSlotSize) {
+    return nullptr;
+  }
+  return &size_classes_[size_class_index_[(bytes + kSlotAlignment - 1) /
+                                          kSlotAlignment]];
+}
+
+bool SlabAllocator::AllocateSlab(SizeClass *size_class) {
+  auto allocation = allocator_.Allocate(kSlabSize);
+  if (!allocation.has_value() && ReleaseEmptySlabs()) {
+    allocation = allocator_.Allocate(kSlabSize);
+  }
+  if (!allocation.has_value()) {
+    return false;
+  }
+  RAY_LOG(DEBUG) << "allocated slab of " << kSlabSize << " bytes for slot size "
+                 << size_class->slot_size << " at " << allocation->address;
+  size_class->slabs.emplace_front(std::move(allocation.value()));
+  auto &free_slots = size_class->slabs.front().free_slots;
+  free_slots.reserve(size_class->slots_per_slab);
+  // Push in reverse so that slots are handed out in address order.
+  for (uint32_t i = size_class->slots_per_slab; i > 0; i--) {
+    free_slots.push_back(i - 1);
+  }
+  num_slabs_++;
+  return true;
+}
+
+void SlabAllocator::FreeSlab(SizeClass *size_class, std::list<Slab>::iterator slab) {
+  RAY_LOG(DEBUG) << "freeing slab for slot size " << size_class->slot_size << " at "
+                 << slab->allocation.address;
+  allocator_.Free(std::move(slab->allocation));
+  size_class->slabs.erase(slab);
+  num_slabs_--;
+}
+
+bool SlabAllocator::ReleaseEmptySlabs() {
+  bool released = false;
+  for (auto &size_class : size_classes_) {
+    auto &slabs = size_class.slabs;
+    // Only the front slab can be empty, see Free().
+    if (!slabs.empty() && slabs.front().free_slots.size() == size_class.slots_per_slab) {
+      FreeSlab(&size_class, slabs.begin());
+      released = true;
+    }
+  }
+  return released;
+}
+
+}  // namespace plasma
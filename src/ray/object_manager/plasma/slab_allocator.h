@@ -0,0 +1,150 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "ray/object_manager/plasma/allocator.h"
+#include "ray/object_manager/plasma/common.h"
+
+namespace plasma {
+
+// SlabAllocator serves small allocations out of fixed size slots that are
+// carved from larger slabs of the underlying allocator. Each size class keeps
+// its own list of slabs with free slots, so allocating and freeing a small
+// object is O(1) and does not touch the dlmalloc arena. Allocations larger
+// than the biggest size class are passed through to the underlying allocator.
+//
+// Slots share the file descriptor and mmap size of the slab they belong to,
+// so clients map them exactly like any other plasma allocation.
+//
+// This class is not thread safe.
+class SlabAllocator : public IAllocator {
+ public:
+  /// \param allocator The underlying allocator that slabs and large objects
+  /// are allocated from. It must outlive this allocator.
+  /// \param slab_size Number of bytes requested from the underlying allocator
+  /// for each slab.
+  /// \param max_slot_size Allocations up to this size are served from slabs.
+  SlabAllocator(IAllocator &allocator, int64_t slab_size, int64_t max_slot_size);
+
+  ~SlabAllocator();
+
+  /// Allocates from a slab if bytes fits in a size class, otherwise from the
+  /// underlying allocator. If no slab can be allocated the request is passed
+  /// through to the underlying allocator as well.
+  ///
+  /// \param bytes Number of bytes.
+  /// \return allocated memory. returns empty if not enough space.
+  absl::optional<Allocation> Allocate(size_t bytes) override;
+
+  /// Fallback allocations are never served from slabs.
+  absl::optional<Allocation> FallbackAllocate(size_t bytes) override;
+
+  /// Frees the memory space pointed to by mem, which must have been returned by
+  /// a previous call to Allocate/FallbackAllocate or it yields undefined behavior.
+  ///
+  /// \param allocation allocation to free.
+  void Free(Allocation allocation) override;
+
+  int64_t GetFootprintLimit() const override;
+
+  /// Bytes allocated from the underlying allocator, including slabs that
+  /// are only partially used.
+  int64_t Allocated() const override;
+
+  int64_t FallbackAllocated() const override;
+
+  void RecordMetrics() const override;
+
+  void GetDebugDump(std::stringstream &buffer) const override;
+
+  /// Bytes of all slabs currently held from the underlying allocator.
+  int64_t SlabBytesReserved() const { return num_slabs_ * kSlabSize; }
+
+  /// Bytes of slots handed out to callers, rounded up to the size class.
+  int64_t SlabBytesInUse() const { return slot_bytes_in_use_; }
+
+  /// Bytes requested by callers for allocations served from slabs.
+  int64_t SlabBytesRequested() const { return requested_bytes_in_use_; }
+
+  /// Number of size classes served from slabs.
+  size_t NumSizeClasses() const { return size_classes_.size(); }
+
+ private:
+  struct Slab {
+    explicit Slab(Allocation allocation) : allocation(std::move(allocation)) {}
+    /// The allocation backing this slab.
+    Allocation allocation;
+    /// Stack of free slot indices.
+    std::vector<uint32_t> free_slots;
+  };
+
+  struct SizeClass {
+    /// Size of each slot in bytes.
+    int64_t slot_size;
+    /// Number of slots in each slab of this class.
+    uint32_t slots_per_slab;
+    /// Slabs of this class. Slabs with free slots are kept in front of full
+    /// ones, so allocations are always served from the front slab.
+    std::list<Slab> slabs;
+  };
+
+  /// Location of a live slot.
+  struct SlotInfo {
+    SizeClass *size_class;
+    std::list<Slab>::iterator slab;
+    uint32_t slot_index;
+  };
+
+  /// Returns the size class serving allocations of the given size, or nullptr
+  /// if bytes should be allocated from the underlying allocator.
+  SizeClass *GetSizeClass(size_t bytes);
+
+  /// Allocates a new slab at the front of the size class. Returns false if
+  /// the underlying allocator is out of space.
+  bool AllocateSlab(SizeClass *size_class);
+
+  /// Returns an empty slab to the underlying allocator.
+  void FreeSlab(SizeClass *size_class, std::list<Slab>::iterator slab);
+
+  /// Returns the empty slabs that are cached by size classes to the underlying
+  /// allocator.
+  ///
+  /// \return Whether any slab was freed.
+  bool ReleaseEmptySlabs();
+
+  IAllocator &allocator_;
+  const int64_t kSlabSize;
+  const int64_t kMaxSlotSize;
+  /// Size classes sorted by slot size.
+  std::vector<SizeClass> size_classes_;
+  /// Maps a slot size rounded up to kSlotAlignment to its size class index.
+  std::vector<uint8_t> size_class_index_;
+  /// Mapping from the address of a live slot to its slab.
+  absl::flat_hash_map<void *, SlotInfo> live_slots_;
+  int64_t num_slabs_ = 0;
+  int64_t slot_bytes_in_use_ = 0;
+  int64_t requested_bytes_in_use_ = 0;
+};
+
+}  // namespace plasma
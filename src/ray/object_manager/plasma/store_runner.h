@@ -7,6 +7,7 @@
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/file_system_monitor.h"
 #include "ray/object_manager/plasma/plasma_allocator.h"
+#include "ray/object_manager/plasma/slab_allocator.h"
 #include "ray/object_manager/plasma/store.h"
 
 namespace plasma {
@@ -44,6 +45,8 @@ class PlasmaStoreRunner {
   std::string fallback_directory_;
   mutable instrumented_io_context main_service_;
   std::unique_ptr<PlasmaAllocator> allocator_;
+  /// Serves small objects from slabs of allocator_. Null if disabled.
+  std::unique_ptr<SlabAllocator> slab_allocator_;
   std::unique_ptr<ray::FileSystemMonitor> fs_monitor_;
   std::unique_ptr<PlasmaStore> store_;
 };
@@ -14,9 +14,14 @@
 
 #include "ray/object_manager/plasma/eviction_policy.h"
 
+#include <random>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/random/random.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "ray/object_manager/plasma/object_store.h"
+#include "ray/util/util.h"
 
 using namespace ray;
 using namespace testing;
@@ -183,6 +188,214 @@ TEST(EvictionPolicyTest, Test) {
     EXPECT_TRUE(policy.IsObjectExists(key1));
   }
 }
+
+struct EvictionPoliciesTest : public ::testing::Test {
+  void SetUp() override {
+    EXPECT_CALL(allocator_, GetFootprintLimit()).WillRepeatedly(Return(100));
+    EXPECT_CALL(allocator_, Allocated()).WillRepeatedly(Invoke([this]() {
+      return allocated_;
+    }));
+    EXPECT_CALL(store_, GetObject(_)).WillRepeatedly(Invoke([this](const ObjectID &id) {
+      return objects_.at(id).get();
+    }));
+  }
+
+  ObjectID AddObject(int64_t size) {
+    ObjectID object_id = ObjectID::FromRandom();
+    auto object = std::make_unique<LocalObject>(Allocation());
+    object->object_info.data_size = size;
+    object->object_info.metadata_size = 0;
+    objects_.emplace(object_id, std::move(object));
+    return object_id;
+  }
+
+  // Creates the object and releases it once, like a client that writes it.
+  void CreateObject(IEvictionPolicy &policy, const ObjectID &object_id) {
+    policy.ObjectCreated(object_id);
+    Access(policy, object_id);
+  }
+
+  void Access(IEvictionPolicy &policy, const ObjectID &object_id) {
+    policy.BeginObjectAccess(object_id);
+    policy.EndObjectAccess(object_id);
+  }
+
+  MockAllocator allocator_;
+  MockObjectStore store_;
+  absl::flat_hash_map<ObjectID, std::unique_ptr<LocalObject>> objects_;
+  int64_t allocated_ = 0;
+};
+
+TEST_F(EvictionPoliciesTest, SegmentedLRU) {
+  SegmentedLRUEvictionPolicy policy(store_, allocator_, /*protected_fraction=*/0.5);
+  ObjectID key1 = AddObject(10);
+  ObjectID key2 = AddObject(10);
+  ObjectID key3 = AddObject(10);
+  ObjectID key4 = AddObject(30);
+  for (const auto &key : {key1, key2, key3, key4}) {
+    CreateObject(policy, key);
+    EXPECT_FALSE(policy.IsObjectProtected(key));
+  }
+
+  // Using key1 again protects it from eviction.
+  Access(policy, key1);
+  EXPECT_TRUE(policy.IsObjectProtected(key1));
+  std::vector<ObjectID> objects_to_evict;
+  EXPECT_EQ(20, policy.ChooseObjectsToEvict(15, objects_to_evict));
+  EXPECT_EQ(objects_to_evict, (std::vector<ObjectID>{key2, key3}));
+  EXPECT_FALSE(policy.IsObjectExists(key2));
+  EXPECT_TRUE(policy.IsObjectExists(key1));
+
+  // The protected segment holds up to 50 bytes, the least recently used
+  // objects are demoted when it overflows.
+  Access(policy, key4);
+  EXPECT_TRUE(policy.IsObjectProtected(key4));
+  ObjectID key5 = AddObject(30);
+  CreateObject(policy, key5);
+  Access(policy, key5);
+  EXPECT_TRUE(policy.IsObjectProtected(key5));
+  EXPECT_FALSE(policy.IsObjectProtected(key1));
+  EXPECT_FALSE(policy.IsObjectProtected(key4));
+
+  // Objects in use can't be evicted.
+  policy.BeginObjectAccess(key5);
+  EXPECT_FALSE(policy.IsObjectExists(key5));
+  objects_to_evict.clear();
+  EXPECT_EQ(40, policy.ChooseObjectsToEvict(100, objects_to_evict));
+  EXPECT_EQ(objects_to_evict, (std::vector<ObjectID>{key1, key4}));
+  policy.EndObjectAccess(key5);
+  EXPECT_TRUE(policy.IsObjectExists(key5));
+
+  policy.RemoveObject(key5);
+  EXPECT_FALSE(policy.IsObjectExists(key5));
+  objects_to_evict.clear();
+  EXPECT_EQ(0, policy.ChooseObjectsToEvict(100, objects_to_evict));
+}
+
+TEST_F(EvictionPoliciesTest, GreedyDualSizeFrequency) {
+  GreedyDualSizeFrequencyEvictionPolicy policy(store_, allocator_);
+  const int64_t kMB = 1024 * 1024;
+  ObjectID small = AddObject(1024);
+  ObjectID cold_large = AddObject(64 * kMB);
+  ObjectID hot_large = AddObject(64 * kMB);
+  for (const auto &key : {small, cold_large, hot_large}) {
+    CreateObject(policy, key);
+  }
+  for (int i = 0; i < 10; i++) {
+    Access(policy, hot_large);
+  }
+
+  // Large objects are evicted before small ones, unless they are used a lot
+  // more often.
+  std::vector<ObjectID> objects_to_evict;
+  EXPECT_EQ(64 * kMB, policy.ChooseObjectsToEvict(1, objects_to_evict));
+  EXPECT_EQ(objects_to_evict, std::vector<ObjectID>{cold_large});
+
+  // Objects in use can't be evicted.
+  policy.BeginObjectAccess(hot_large);
+  EXPECT_FALSE(policy.IsObjectExists(hot_large));
+  objects_to_evict.clear();
+  EXPECT_EQ(1024, policy.ChooseObjectsToEvict(1, objects_to_evict));
+  EXPECT_EQ(objects_to_evict, std::vector<ObjectID>{small});
+  policy.EndObjectAccess(hot_large);
+  EXPECT_TRUE(policy.IsObjectExists(hot_large));
+
+  // Evicting the small object aged the hot object, so that a new small object
+  // is kept over it.
+  ObjectID new_small = AddObject(1024);
+  CreateObject(policy, new_small);
+  objects_to_evict.clear();
+  EXPECT_EQ(64 * kMB, policy.ChooseObjectsToEvict(1, objects_to_evict));
+  EXPECT_EQ(objects_to_evict, std::vector<ObjectID>{hot_large});
+
+  policy.RemoveObject(new_small);
+  EXPECT_FALSE(policy.IsObjectExists(new_small));
+  objects_to_evict.clear();
+  EXPECT_EQ(0, policy.ChooseObjectsToEvict(1, objects_to_evict));
+}
+
+TEST_F(EvictionPoliciesTest, CreateEvictionPolicy) {
+  EXPECT_NE(dynamic_cast<EvictionPolicy *>(
+                CreateEvictionPolicy("lru", store_, allocator_).get()),
+            nullptr);
+  EXPECT_NE(dynamic_cast<SegmentedLRUEvictionPolicy *>(
+                CreateEvictionPolicy("slru", store_, allocator_).get()),
+            nullptr);
+  EXPECT_NE(dynamic_cast<GreedyDualSizeFrequencyEvictionPolicy *>(
+                CreateEvictionPolicy("gdsf", store_, allocator_).get()),
+            nullptr);
+}
+
+// Performance benchmark that replays the same trace of object accesses against
+// each eviction policy, and reports the hit ratio and the number of bytes that
+// have to be fetched or restored again after they were evicted. Disabled by
+// default, run it with --gtest_also_run_disabled_tests.
+TEST_F(EvictionPoliciesTest, DISABLED_TraceReplayPerf) {
+  const int64_t kMB = 1024 * 1024;
+  const int64_t capacity = 2 * 1024 * kMB;
+  const int num_objects = 2000;
+  const int num_accesses = 100 * 1000;
+  EXPECT_CALL(allocator_, GetFootprintLimit()).WillRepeatedly(Return(capacity));
+
+  // Most objects are small, but a few large objects make up most of the bytes.
+  // Popularity follows a Zipf distribution, and every so often a scan reads a
+  // batch of objects that are not used again.
+  std::mt19937_64 gen(42);
+  std::vector<ObjectID> working_set;
+  for (int i = 0; i < num_objects; i++) {
+    int64_t size = absl::Bernoulli(gen, 0.2)
+                       ? absl::Uniform<int64_t>(gen, 16 * kMB, 64 * kMB)
+                       : absl::Uniform<int64_t>(gen, 64 * 1024, kMB);
+    working_set.push_back(AddObject(size));
+  }
+  std::vector<ObjectID> trace;
+  for (int i = 0; i < num_accesses; i++) {
+    if (i % 1000 == 999) {
+      for (int j = 0; j < 50; j++) {
+        trace.push_back(AddObject(16 * kMB));
+      }
+    }
+    trace.push_back(working_set[absl::Zipf<int>(gen, num_objects - 1, 1.1)]);
+  }
+
+  for (const std::string name : {"lru", "slru", "gdsf"}) {
+    auto policy = CreateEvictionPolicy(name, store_, allocator_);
+    absl::flat_hash_set<ObjectID> resident;
+    absl::flat_hash_set<ObjectID> seen;
+    allocated_ = 0;
+    int64_t hits = 0;
+    int64_t bytes_refetched = 0;
+    int64_t start_ms = current_time_ms();
+    for (const auto &object_id : trace) {
+      if (resident.contains(object_id)) {
+        hits++;
+        Access(*policy, object_id);
+        continue;
+      }
+      const int64_t size = objects_[object_id]->GetObjectSize();
+      if (!seen.insert(object_id).second) {
+        bytes_refetched += size;
+      }
+      while (allocated_ + size > capacity) {
+        std::vector<ObjectID> objects_to_evict;
+        policy->RequireSpace(size, objects_to_evict);
+        ASSERT_FALSE(objects_to_evict.empty());
+        for (const auto &evicted : objects_to_evict) {
+          resident.erase(evicted);
+          allocated_ -= objects_[evicted]->GetObjectSize();
+          policy->RemoveObject(evicted);
+        }
+      }
+      resident.insert(object_id);
+      allocated_ += size;
+      CreateObject(*policy, object_id);
+    }
+    int64_t duration_ms = std::max<int64_t>(current_time_ms() - start_ms, 1);
+    RAY_LOG(INFO) << name << ": hit ratio " << hits / (double)trace.size()
+                  << ", re-fetched " << bytes_refetched / kMB << " MB, replayed "
+                  << trace.size() << " accesses in " << duration_ms << " ms.";
+  }
+}
 }  // namespace plasma
 
 int main(int argc, char **argv) {
@@ -0,0 +1,137 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/mman.h>
+
+#include <cstring>
+#include <filesystem>
+
+#include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
+#include "ray/object_manager/plasma/malloc.h"
+#include "ray/object_manager/plasma/plasma_allocator.h"
+#include "ray/util/util.h"
+
+using namespace std::filesystem;
+
+namespace plasma {
+namespace {
+const int64_t kMB = 1024 * 1024;
+const int64_t kHugePageSize = 2 * kMB;
+
+std::string CreateTestDir() {
+  path directory = std::filesystem::temp_directory_path() / GenerateUUIDV4();
+  create_directories(directory);
+  return directory.string();
+}
+
+// Returns the sum of all words in the buffer, reading it sequentially.
+uint64_t SumWords(const void *buffer, int64_t size) {
+  const uint64_t *words = static_cast<const uint64_t *>(buffer);
+  uint64_t sum = 0;
+  for (int64_t i = 0; i < size / static_cast<int64_t>(sizeof(uint64_t)); i++) {
+    sum += words[i];
+  }
+  return sum;
+}
+
+// Reads the buffer a few times and returns the bandwidth in MB/s.
+int64_t MeasureReadBandwidth(const void *buffer, int64_t size) {
+  const int num_passes = 10;
+  // Fault in all pages before timing.
+  volatile uint64_t sum = SumWords(buffer, size);
+  int64_t start_ms = current_time_ms();
+  for (int i = 0; i < num_passes; i++) {
+    sum = sum + SumWords(buffer, size);
+  }
+  int64_t duration_ms = std::max<int64_t>(current_time_ms() - start_ms, 1);
+  return num_passes * size / kMB * 1000 / duration_ms;
+}
+};  // namespace
+
+class HugePageArenaTest : public ::testing::Test {
+ public:
+  // PlasmaAllocator can only be created once per process, so all tests share
+  // the same arena. The machine running the test might not have any huge pages
+  // reserved, in which case this exercises the fallback to regular pages.
+  static void SetUpTestSuite() {
+    RayConfig::instance().initialize(
+        R"({"plasma_huge_page_arena": true, "plasma_numa_nodes": "0"})");
+    plasma_allocator_ = new PlasmaAllocator(CreateTestDir(),
+                                            CreateTestDir(),
+                                            /* hugepage_enabled */ false,
+                                            256 * kMB);
+  }
+
+ protected:
+  static PlasmaAllocator *plasma_allocator_;
+};
+
+PlasmaAllocator *HugePageArenaTest::plasma_allocator_ = nullptr;
+
+TEST_F(HugePageArenaTest, ArenaIsMappedInWholeHugePages) {
+  auto allocation = plasma_allocator_->Allocate(kMB);
+  ASSERT_TRUE(allocation.has_value());
+  EXPECT_EQ(allocation->mmap_size % kHugePageSize, 0);
+  EXPECT_GE(allocation->mmap_size, plasma_allocator_->GetFootprintLimit());
+  std::memset(allocation->address, 42, kMB);
+
+  // Map the arena the way clients do, see ClientMmapTableEntry.
+  const size_t length = allocation->mmap_size - kMmapRegionsGap;
+  void *pointer = mmap(
+      NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, allocation->fd.first, 0);
+  ASSERT_NE(pointer, MAP_FAILED);
+  const uint8_t *client_address = static_cast<uint8_t *>(pointer) + allocation->offset;
+  EXPECT_EQ(client_address[0], 42);
+  EXPECT_EQ(client_address[kMB - 1], 42);
+  EXPECT_EQ(munmap(pointer, length), 0);
+
+  plasma_allocator_->Free(std::move(allocation.value()));
+}
+
+// Performance benchmark for reading a large object sequentially from the plasma
+// arena, compared to a buffer that is backed by regular pages. Disabled by
+// default, run it with --gtest_also_run_disabled_tests.
+TEST_F(HugePageArenaTest, DISABLED_SequentialReadBandwidthPerf) {
+  const int64_t object_size = 128 * kMB;
+  auto allocation = plasma_allocator_->Allocate(object_size);
+  ASSERT_TRUE(allocation.has_value());
+  std::memset(allocation->address, 1, object_size);
+
+  void *regular_pages = mmap(NULL,
+                             object_size,
+                             PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS,
+                             -1,
+                             0);
+  ASSERT_NE(regular_pages, MAP_FAILED);
+  madvise(regular_pages, object_size, MADV_NOHUGEPAGE);
+  std::memset(regular_pages, 1, object_size);
+
+  RAY_LOG(INFO) << "Regular pages: sequential read bandwidth "
+                << MeasureReadBandwidth(regular_pages, object_size) << " MB/s.";
+  RAY_LOG(INFO) << "Plasma arena with plasma_huge_page_arena: sequential read "
+                << "bandwidth " << MeasureReadBandwidth(allocation->address, object_size)
+                << " MB/s.";
+
+  munmap(regular_pages, object_size);
+  plasma_allocator_->Free(std::move(allocation.value()));
+}
+
+}  // namespace plasma
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
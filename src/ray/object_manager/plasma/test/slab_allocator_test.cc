@@ -0,0 +1,241 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/slab_allocator.h"
+
+#include <filesystem>
+
+#include "absl/random/random.h"
+#include "gtest/gtest.h"
+#include "ray/object_manager/plasma/object_lifecycle_manager.h"
+#include "ray/object_manager/plasma/plasma_allocator.h"
+#include "ray/util/util.h"
+
+using namespace std::filesystem;
+
+namespace plasma {
+namespace {
+const int64_t kKB = 1024;
+const int64_t kMB = 1024 * 1024;
+const int64_t kSlabSize = kMB;
+const int64_t kMaxSlotSize = 64 * kKB;
+
+std::string CreateTestDir() {
+  path directory = std::filesystem::temp_directory_path() / GenerateUUIDV4();
+  create_directories(directory);
+  return directory.string();
+}
+};  // namespace
+
+class SlabAllocatorTest : public ::testing::Test {
+ public:
+  // PlasmaAllocator can only be created once per process, so all tests share
+  // the same dlmalloc arena.
+  static void SetUpTestSuite() {
+    plasma_allocator_ = new PlasmaAllocator(CreateTestDir(),
+                                            CreateTestDir(),
+                                            /* hugepage_enabled */ false,
+                                            256 * kMB);
+  }
+
+  void SetUp() override {
+    ASSERT_EQ(plasma_allocator_->Allocated(), 0);
+    allocator_ = std::make_unique<SlabAllocator>(
+        *plasma_allocator_, kSlabSize, kMaxSlotSize);
+  }
+
+  void TearDown() override {
+    allocator_.reset();
+    ASSERT_EQ(plasma_allocator_->Allocated(), 0);
+  }
+
+ protected:
+  static PlasmaAllocator *plasma_allocator_;
+  std::unique_ptr<SlabAllocator> allocator_;
+};
+
+PlasmaAllocator *SlabAllocatorTest::plasma_allocator_ = nullptr;
+
+TEST_F(SlabAllocatorTest, SizeClasses) {
+  // 64, then two classes per power of two up to 64 KiB.
+  EXPECT_EQ(allocator_->NumSizeClasses(), 20);
+
+  std::vector<Allocation> allocations;
+  for (int64_t size : std::vector<int64_t>{1, 64, 65, 100, 1000, 4097, kMaxSlotSize}) {
+    auto allocation = allocator_->Allocate(size);
+    ASSERT_TRUE(allocation.has_value());
+    EXPECT_EQ(allocation->size, size);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(allocation->address) % 64, 0);
+    EXPECT_FALSE(allocation->fallback_allocated);
+    allocations.push_back(std::move(allocation.value()));
+  }
+  // 64 + 64 + 128 + 128 + 1024 + 6144 + 65536.
+  EXPECT_EQ(allocator_->SlabBytesInUse(), 73088);
+  EXPECT_EQ(allocator_->SlabBytesRequested(),
+            1 + 64 + 65 + 100 + 1000 + 4097 + kMaxSlotSize);
+  // 1 and 64 share a size class, as do 65 and 100.
+  EXPECT_EQ(allocator_->SlabBytesReserved(), 5 * kSlabSize);
+  EXPECT_EQ(plasma_allocator_->Allocated(), 5 * kSlabSize);
+
+  for (auto &allocation : allocations) {
+    allocator_->Free(std::move(allocation));
+  }
+  EXPECT_EQ(allocator_->SlabBytesInUse(), 0);
+  EXPECT_EQ(allocator_->SlabBytesRequested(), 0);
+  // The last slab of each size class is cached.
+  EXPECT_EQ(allocator_->SlabBytesReserved(), 5 * kSlabSize);
+}
+
+TEST_F(SlabAllocatorTest, SlotsShareSlabMapping) {
+  auto first = allocator_->Allocate(kKB);
+  auto second = allocator_->Allocate(kKB);
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(first->fd, second->fd);
+  EXPECT_EQ(first->mmap_size, second->mmap_size);
+  EXPECT_EQ(second->offset - first->offset, kKB);
+  EXPECT_EQ(static_cast<uint8_t *>(second->address) -
+                static_cast<uint8_t *>(first->address),
+            kKB);
+
+  // A freed slot is handed out again.
+  void *address = first->address;
+  allocator_->Free(std::move(first.value()));
+  auto third = allocator_->Allocate(kKB - 1);
+  ASSERT_TRUE(third.has_value());
+  EXPECT_EQ(third->address, address);
+
+  allocator_->Free(std::move(second.value()));
+  allocator_->Free(std::move(third.value()));
+}
+
+TEST_F(SlabAllocatorTest, LargeObjectsPassThrough) {
+  auto allocation = allocator_->Allocate(kMaxSlotSize + 1);
+  ASSERT_TRUE(allocation.has_value());
+  EXPECT_EQ(allocator_->SlabBytesReserved(), 0);
+  EXPECT_EQ(allocator_->Allocated(), kMaxSlotSize + 1);
+  allocator_->Free(std::move(allocation.value()));
+  EXPECT_EQ(allocator_->Allocated(), 0);
+
+  auto fallback_allocation = allocator_->FallbackAllocate(kKB);
+  ASSERT_TRUE(fallback_allocation.has_value());
+  EXPECT_EQ(allocator_->SlabBytesReserved(), 0);
+  allocator_->Free(std::move(fallback_allocation.value()));
+}
+
+TEST_F(SlabAllocatorTest, EmptySlabsAreReleased) {
+  const int64_t slot_size = 16 * kKB;
+  const int64_t slots_per_slab = kSlabSize / slot_size;
+  std::vector<Allocation> allocations;
+  for (int64_t i = 0; i < 3 * slots_per_slab; i++) {
+    auto allocation = allocator_->Allocate(slot_size);
+    ASSERT_TRUE(allocation.has_value());
+    allocations.push_back(std::move(allocation.value()));
+  }
+  EXPECT_EQ(allocator_->SlabBytesReserved(), 3 * kSlabSize);
+
+  // Free slots from all slabs so that none of them is empty.
+  std::vector<Allocation> remaining;
+  for (size_t i = 0; i < allocations.size(); i++) {
+    if (i % slots_per_slab == 0) {
+      remaining.push_back(std::move(allocations[i]));
+    } else {
+      allocator_->Free(std::move(allocations[i]));
+    }
+  }
+  EXPECT_EQ(allocator_->SlabBytesReserved(), 3 * kSlabSize);
+  EXPECT_EQ(allocator_->SlabBytesInUse(), 3 * slot_size);
+
+  // Slabs are freed once they become empty, except for the last one.
+  for (auto &allocation : remaining) {
+    allocator_->Free(std::move(allocation));
+  }
+  EXPECT_EQ(allocator_->SlabBytesReserved(), kSlabSize);
+  EXPECT_EQ(allocator_->SlabBytesInUse(), 0);
+}
+
+TEST_F(SlabAllocatorTest, CachedSlabsReleasedForLargeObjects) {
+  // Leave an empty cached slab in a couple of size classes.
+  for (int64_t size : {kKB, 4 * kKB, 16 * kKB}) {
+    auto allocation = allocator_->Allocate(size);
+    ASSERT_TRUE(allocation.has_value());
+    allocator_->Free(std::move(allocation.value()));
+  }
+  EXPECT_EQ(allocator_->SlabBytesReserved(), 3 * kSlabSize);
+
+  // The arena can only fit the large object once the cached slabs are freed.
+  auto large =
+      allocator_->Allocate(plasma_allocator_->GetFootprintLimit() - 2 * kSlabSize);
+  ASSERT_TRUE(large.has_value());
+  EXPECT_EQ(allocator_->SlabBytesReserved(), 0);
+  allocator_->Free(std::move(large.value()));
+}
+
+// Performance benchmark for creating, sealing and deleting many small objects
+// through the object lifecycle manager, with and without the slab allocator.
+// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST_F(SlabAllocatorTest, DISABLED_CreateSealDeletePerf) {
+  const int64_t num_objects = 200 * 1000;
+  const size_t max_live_objects = 2000;
+  std::vector<int64_t> sizes;
+  absl::BitGen gen;
+  for (int64_t i = 0; i < num_objects; i++) {
+    sizes.push_back(absl::Uniform<int64_t>(gen, kKB, kMaxSlotSize));
+  }
+
+  auto run = [&](IAllocator &allocator, const std::string &name) {
+    ObjectLifecycleManager manager(allocator, [](const ObjectID &) {});
+    std::vector<ObjectID> live_objects;
+    absl::BitGen delete_gen;
+    int64_t start_ms = current_time_ms();
+    for (int64_t i = 0; i < num_objects; i++) {
+      ray::ObjectInfo info;
+      info.object_id = ObjectID::FromRandom();
+      info.data_size = sizes[i];
+      auto result = manager.CreateObject(
+          info, flatbuf::ObjectSource::CreatedByWorker, /*fallback_allocator=*/false);
+      RAY_CHECK(result.second == flatbuf::PlasmaError::OK);
+      RAY_CHECK(manager.SealObject(info.object_id) != nullptr);
+      live_objects.push_back(info.object_id);
+      // Delete objects in random order to fragment the arena.
+      if (live_objects.size() == max_live_objects) {
+        size_t index = absl::Uniform<size_t>(delete_gen, 0, live_objects.size());
+        std::swap(live_objects[index], live_objects.back());
+        RAY_CHECK(manager.DeleteObject(live_objects.back()) ==
+                  flatbuf::PlasmaError::OK);
+        live_objects.pop_back();
+      }
+    }
+    for (const auto &object_id : live_objects) {
+      RAY_CHECK(manager.DeleteObject(object_id) == flatbuf::PlasmaError::OK);
+    }
+    int64_t duration_ms = std::max<int64_t>(current_time_ms() - start_ms, 1);
+    RAY_LOG(INFO) << name << ": created, sealed and deleted " << num_objects
+                  << " objects in " << duration_ms << " ms ("
+                  << num_objects * 1000 / duration_ms << " objects/s).";
+  };
+
+  run(*plasma_allocator_, "dlmalloc");
+  run(*allocator_, "slab allocator");
+  std::stringstream debug_dump;
+  allocator_->GetDebugDump(debug_dump);
+  RAY_LOG(INFO) << "Slab allocator stats:" << debug_dump.str();
+}
+
+}  // namespace plasma
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -457,7 +457,7 @@ void PullManager::TryToMakeObjectLocal(const ObjectID &object_id) {
   }
 
   // Try to pull the object from a remote node. If the object is spilled on the local
-  // disk of the remote node, it will be restored by PushManager prior to pushing.
+  // disk of the remote node, it will be pushed straight from the spill file.
   bool did_pull = PullFromRandomLocation(object_id);
   if (did_pull) {
     UpdateRetryTimer(request, object_id);
@@ -514,7 +514,7 @@ bool PullManager::PullFromRandomLocation(const ObjectID &object_id) {
   auto &spilled_node_id = it->second.spilled_node_id;
 
   if (node_vector.empty()) {
-    // Pull from remote node, it will be restored prior to push.
+    // Pull from remote node, it will be pushed from its spill file.
     if (!spilled_node_id.IsNil() && spilled_node_id != self_node_id_) {
       RAY_LOG(DEBUG) << "Sending pull request from " << self_node_id_
                      << " to spilled location at " << spilled_node_id << " of object "
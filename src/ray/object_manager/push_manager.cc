@@ -20,29 +20,94 @@
 
 namespace ray {
 
+namespace {
+/// Chunks whose latency exceeds this multiple of the latency without queueing
+/// delay signal congestion.
+const double kCongestedLatencyRatio = 2.0;
+/// Queueing delays below this don't signal congestion, so that the windows of
+/// destinations with very low latencies don't collapse due to jitter.
+const double kMinCongestedDelaySeconds = 0.01;
+/// The interval over which the throughput of each destination is measured.
+const double kThroughputIntervalSeconds = 1.0;
+/// The window of a destination that no chunks have been pushed to yet.
+const double kInitialWindow = 4;
+}  // namespace
+
 void PushManager::StartPush(const NodeID &dest_id,
                             const ObjectID &obj_id,
                             int64_t num_chunks,
+                            int64_t chunk_size,
                             std::function<void(int64_t)> send_chunk_fn) {
   auto push_id = std::make_pair(dest_id, obj_id);
   RAY_CHECK(num_chunks > 0);
-  if (push_info_.contains(push_id)) {
+  auto it = push_info_.find(push_id);
+  if (it != push_info_.end() && it->second->relay) {
+    // The chunks are sent as they are received, and the object is not local until
+    // all of them have been.
+    RAY_LOG(DEBUG) << "Object " << push_id.second << " is being relayed to "
+                   << push_id.first << ", not pushing it again.";
+    return;
+  } else if (it != push_info_.end()) {
     RAY_LOG(DEBUG) << "Duplicate push request " << push_id.first << ", " << push_id.second
                    << ", resending all the chunks.";
-    chunks_remaining_ += push_info_[push_id]->ResendAllChunks(send_chunk_fn);
+    chunks_remaining_ += it->second->ResendAllChunks(send_chunk_fn);
   } else {
     chunks_remaining_ += num_chunks;
-    push_info_[push_id].reset(new PushState(num_chunks, send_chunk_fn));
+    push_info_[push_id].reset(new PushState(num_chunks, chunk_size, send_chunk_fn));
   }
+  AddPeerIfNeeded(dest_id);
   ScheduleRemainingPushes();
 }
 
+void PushManager::RelayChunk(const NodeID &dest_id,
+                             const ObjectID &obj_id,
+                             int64_t chunk_size,
+                             std::function<void()> send_chunk_fn) {
+  auto push_id = std::make_pair(dest_id, obj_id);
+  auto &info = push_info_[push_id];
+  if (info == nullptr) {
+    info.reset(new PushState(/*num_chunks=*/0, chunk_size, nullptr));
+    info->relay = true;
+  } else if (!info->relay) {
+    RAY_LOG(DEBUG) << "Object " << push_id.second << " is being pushed to "
+                   << push_id.first << ", not relaying its chunk.";
+    return;
+  }
+  info->AddRelayChunk(std::move(send_chunk_fn));
+  chunks_remaining_ += 1;
+  AddPeerIfNeeded(dest_id);
+  ScheduleRemainingPushes();
+}
+
+void PushManager::AddPeerIfNeeded(const NodeID &dest_id) {
+  if (!peers_.contains(dest_id)) {
+    const double window =
+        congestion_control_ ? std::min<double>(kInitialWindow, max_chunks_in_flight_)
+                            : max_chunks_in_flight_;
+    peers_.emplace(dest_id, PeerState(window, get_time_seconds_()));
+  }
+}
+
 void PushManager::OnChunkComplete(const NodeID &dest_id, const ObjectID &obj_id) {
   auto push_id = std::make_pair(dest_id, obj_id);
   chunks_in_flight_ -= 1;
   chunks_remaining_ -= 1;
-  push_info_[push_id]->OnChunkComplete();
-  if (push_info_[push_id]->AllChunksComplete()) {
+  auto it = push_info_.find(push_id);
+  if (it == push_info_.end()) {
+    // The push was cancelled because the destination was removed.
+    ScheduleRemainingPushes();
+    return;
+  }
+  auto &info = it->second;
+  info->OnChunkComplete();
+  auto &peer = peers_.at(dest_id);
+  peer.num_chunks_inflight--;
+  if (!info->chunk_send_times.empty()) {
+    UpdatePeerState(
+        peer, info->chunk_send_times.front(), info->chunk_size, get_time_seconds_());
+    info->chunk_send_times.pop_front();
+  }
+  if (info->AllChunksComplete()) {
     push_info_.erase(push_id);
     RAY_LOG(DEBUG) << "Push for " << push_id.first << ", " << push_id.second
                    << " completed, remaining: " << NumPushesInFlight();
@@ -50,6 +115,69 @@ void PushManager::OnChunkComplete(const NodeID &dest_id, const ObjectID &obj_id)
   ScheduleRemainingPushes();
 }
 
+void PushManager::HandleNodeRemoved(const NodeID &node_id) {
+  for (auto it = push_info_.begin(); it != push_info_.end();) {
+    if (it->first.first == node_id) {
+      // The chunks in flight are still counted until they complete, the ones that
+      // were not sent yet never will be.
+      chunks_remaining_ -= it->second->num_chunks_to_send;
+      push_info_.erase(it++);
+    } else {
+      it++;
+    }
+  }
+  if (peers_.erase(node_id) > 0) {
+    // Reset the gauges of the node, so that it doesn't keep exporting its last values.
+    const auto peer_node_id = node_id.Hex();
+    ray::stats::STATS_push_manager_peer_window_chunks.Record(0, peer_node_id);
+    ray::stats::STATS_push_manager_peer_throughput_bytes.Record(0, peer_node_id);
+  }
+}
+
+void PushManager::UpdatePeerState(PeerState &peer,
+                                  double send_time,
+                                  int64_t chunk_size,
+                                  double now) const {
+  peer.throughput_interval_bytes += chunk_size;
+  if (now - peer.throughput_interval_start >= kThroughputIntervalSeconds) {
+    peer.throughput =
+        peer.throughput_interval_bytes / (now - peer.throughput_interval_start);
+    peer.throughput_interval_start = now;
+    peer.throughput_interval_bytes = 0;
+  }
+
+  if (!congestion_control_) {
+    return;
+  }
+  // Chunks of different objects have different sizes, so compare latencies
+  // relative to the chunk size.
+  const double latency = now - send_time;
+  const double bytes = std::max<int64_t>(chunk_size, 1);
+  peer.min_seconds_per_byte = std::min(peer.min_seconds_per_byte, latency / bytes);
+  const double uncongested_latency = peer.min_seconds_per_byte * bytes;
+  const bool congested =
+      latency > std::max(uncongested_latency * kCongestedLatencyRatio,
+                         uncongested_latency + kMinCongestedDelaySeconds);
+  if (!congested) {
+    const double increase = peer.slow_start ? 1 : 1 / peer.window;
+    peer.window = std::min<double>(peer.window + increase, max_chunks_in_flight_);
+  } else if (send_time >= peer.last_decrease_time) {
+    // Only decrease once per round trip, chunks sent before the last decrease
+    // were still sent with the old window.
+    peer.window = std::max(peer.window / 2, 1.0);
+    peer.slow_start = false;
+    peer.last_decrease_time = now;
+  }
+}
+
+bool PushManager::CanSendChunk(const NodeID &dest_id) const {
+  if (!congestion_control_) {
+    return true;
+  }
+  const auto &peer = peers_.at(dest_id);
+  return peer.num_chunks_inflight < static_cast<int64_t>(peer.window);
+}
+
 void PushManager::ScheduleRemainingPushes() {
   bool keep_looping = true;
   // Loop over all active pushes for approximate round-robin prioritization.
@@ -62,8 +190,10 @@ void PushManager::ScheduleRemainingPushes() {
     while (it != push_info_.end() && chunks_in_flight_ < max_chunks_in_flight_) {
       auto push_id = it->first;
       auto &info = it->second;
-      if (info->SendOneChunk()) {
+      if (CanSendChunk(push_id.first) && info->SendOneChunk()) {
         chunks_in_flight_ += 1;
+        peers_.at(push_id.first).num_chunks_inflight += 1;
+        info->chunk_send_times.push_back(get_time_seconds_());
         keep_looping = true;
         RAY_LOG(DEBUG) << "Sending chunk " << info->next_chunk_id << " of "
                        << info->num_chunks << " for push " << push_id.first << ", "
@@ -76,10 +206,32 @@ void PushManager::ScheduleRemainingPushes() {
   }
 }
 
+int64_t PushManager::NumChunksInFlight(const NodeID &dest_id) const {
+  auto it = peers_.find(dest_id);
+  return it == peers_.end() ? 0 : it->second.num_chunks_inflight;
+}
+
+double PushManager::GetWindow(const NodeID &dest_id) const {
+  auto it = peers_.find(dest_id);
+  return it == peers_.end() ? max_chunks_in_flight_ : it->second.window;
+}
+
+double PushManager::GetThroughput(const NodeID &dest_id) const {
+  auto it = peers_.find(dest_id);
+  return it == peers_.end() ? 0 : it->second.throughput;
+}
+
 void PushManager::RecordMetrics() const {
   ray::stats::STATS_push_manager_in_flight_pushes.Record(NumPushesInFlight());
   ray::stats::STATS_push_manager_chunks.Record(NumChunksInFlight(), "InFlight");
   ray::stats::STATS_push_manager_chunks.Record(NumChunksRemaining(), "Remaining");
+  for (const auto &entry : peers_) {
+    const auto peer_node_id = entry.first.Hex();
+    ray::stats::STATS_push_manager_peer_window_chunks.Record(entry.second.window,
+                                                             peer_node_id);
+    ray::stats::STATS_push_manager_peer_throughput_bytes.Record(entry.second.throughput,
+                                                                peer_node_id);
+  }
 }
 
 std::string PushManager::DebugString() const {
@@ -89,6 +241,8 @@ std::string PushManager::DebugString() const {
   result << "\n- num chunks in flight: " << NumChunksInFlight();
   result << "\n- num chunks remaining: " << NumChunksRemaining();
   result << "\n- max chunks allowed: " << max_chunks_in_flight_;
+  result << "\n- congestion control: " << (congestion_control_ ? "on" : "off");
+  result << "\n- num destinations: " << peers_.size();
   return result.str();
 }
 
@@ -15,10 +15,13 @@
 #pragma once
 
 #include <algorithm>
+#include <deque>
+#include <limits>
 #include <memory>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/time/clock.h"
 #include "ray/common/id.h"
 #include "ray/common/ray_config.h"
 #include "ray/common/status.h"
@@ -26,14 +29,33 @@
 namespace ray {
 
 /// Manages rate limiting and deduplication of outbound object pushes.
+///
+/// With congestion control enabled, the chunks in flight to each destination are
+/// also limited by a per-destination window. The window is managed AIMD-style
+/// based on the latency of completed chunks: it grows by one chunk per window of
+/// chunks that complete without queueing delay, and is halved once per round trip
+/// when chunks take much longer than the lowest latency seen for that destination.
+/// Like TCP slow start, the window starts small and doubles every round trip until
+/// the first sign of congestion. This keeps slow destinations from taking up the
+/// whole in-flight budget, while fast destinations can still use as much of it as
+/// they keep up with.
 class PushManager {
  public:
   /// Create a push manager.
   ///
   /// \param max_chunks_in_flight Max number of chunks allowed to be in flight
   ///                             from this PushManager (this raylet).
-  PushManager(int64_t max_chunks_in_flight)
-      : max_chunks_in_flight_(max_chunks_in_flight) {
+  /// \param congestion_control Whether to limit the chunks in flight to each
+  ///                           destination by a congestion window.
+  /// \param get_time_seconds Returns the current time in seconds, used to measure
+  ///                         the latency of chunks.
+  PushManager(int64_t max_chunks_in_flight,
+              bool congestion_control = false,
+              std::function<double()> get_time_seconds =
+                  []() { return absl::GetCurrentTimeNanos() / 1e9; })
+      : max_chunks_in_flight_(max_chunks_in_flight),
+        congestion_control_(congestion_control),
+        get_time_seconds_(std::move(get_time_seconds)) {
     RAY_CHECK(max_chunks_in_flight_ > 0) << max_chunks_in_flight_;
   };
 
@@ -44,18 +66,42 @@ class PushManager {
   /// \param dest_id The node to send to.
   /// \param obj_id The object to send.
   /// \param num_chunks The total number of chunks to send.
+  /// \param chunk_size The size of each chunk in bytes, used for metrics only.
   /// \param send_chunk_fn This function will be called with args 0...{num_chunks-1}.
   ///                      The caller promises to call PushManager::OnChunkComplete()
   ///                      once a call to send_chunk_fn finishes.
   void StartPush(const NodeID &dest_id,
                  const ObjectID &obj_id,
                  int64_t num_chunks,
+                 int64_t chunk_size,
                  std::function<void(int64_t)> send_chunk_fn);
 
+  /// Relay a chunk of an object that is being received to a destination, subject to
+  /// the same limits as StartPush. The chunks of a relayed object are added to its
+  /// push one by one as they are received, and sent in the order they were added.
+  /// If the whole object is already being pushed to the destination, the chunk is
+  /// dropped.
+  ///
+  /// \param dest_id The node to send to.
+  /// \param obj_id The object to send.
+  /// \param chunk_size The size of the chunk in bytes, used for metrics only.
+  /// \param send_chunk_fn This function will be called once to send the chunk. The
+  ///                      caller promises to call PushManager::OnChunkComplete()
+  ///                      once the call finishes.
+  void RelayChunk(const NodeID &dest_id,
+                  const ObjectID &obj_id,
+                  int64_t chunk_size,
+                  std::function<void()> send_chunk_fn);
+
   /// Called every time a chunk completes to trigger additional sends.
   /// TODO(ekl) maybe we should cancel the entire push on error.
   void OnChunkComplete(const NodeID &dest_id, const ObjectID &obj_id);
 
+  /// Cancel the pushes to a node that was removed from the cluster, and forget its
+  /// window and throughput. Chunks that are still in flight to the node are only
+  /// counted until they complete.
+  void HandleNodeRemoved(const NodeID &node_id);
+
   /// Return the number of chunks currently in flight. For testing only.
   int64_t NumChunksInFlight() const { return chunks_in_flight_; };
 
@@ -65,6 +111,26 @@ class PushManager {
   /// Return the number of pushes currently in flight. For testing only.
   int64_t NumPushesInFlight() const { return push_info_.size(); };
 
+  /// Return whether an object is being pushed to a destination.
+  bool IsPushing(const NodeID &dest_id, const ObjectID &obj_id) const {
+    return push_info_.contains(std::make_pair(dest_id, obj_id));
+  }
+
+  /// Return the number of chunks currently in flight to a destination. For testing
+  /// only.
+  int64_t NumChunksInFlight(const NodeID &dest_id) const;
+
+  /// Return the number of destinations that the window and throughput are tracked
+  /// for. For testing only.
+  int64_t NumPeers() const { return peers_.size(); }
+
+  /// Return the congestion window of a destination in chunks. For testing only.
+  double GetWindow(const NodeID &dest_id) const;
+
+  /// Return the throughput of pushes to a destination in bytes per second, over
+  /// the last measurement interval. For testing only.
+  double GetThroughput(const NodeID &dest_id) const;
+
   /// Record the internal metrics.
   void RecordMetrics() const;
 
@@ -74,8 +140,11 @@ class PushManager {
   FRIEND_TEST(TestPushManager, TestPushState);
   /// Tracks the state of an active object push to another node.
   struct PushState {
-    /// total number of chunks of this object.
-    const int64_t num_chunks;
+    /// total number of chunks of this object, or of the chunks added so far if the
+    /// object is relayed.
+    int64_t num_chunks;
+    /// The size of each chunk in bytes.
+    const int64_t chunk_size;
     /// The function to send chunks with.
     std::function<void(int64_t)> chunk_send_fn;
     /// The index of the next chunk to send.
@@ -84,9 +153,19 @@ class PushManager {
     int64_t num_chunks_inflight;
     /// The number of chunks remaining to send.
     int64_t num_chunks_to_send;
+    /// The send time of each chunk pending completion, in the order they were
+    /// sent. Chunks of a push are assumed to complete roughly in order.
+    std::deque<double> chunk_send_times;
+    /// Whether the chunks are relayed as they are received, see RelayChunk.
+    bool relay = false;
+    /// The functions to send the relayed chunks that weren't sent yet with.
+    std::deque<std::function<void()>> relay_send_fns;
 
-    PushState(int64_t num_chunks, std::function<void(int64_t)> chunk_send_fn)
+    PushState(int64_t num_chunks,
+              int64_t chunk_size,
+              std::function<void(int64_t)> chunk_send_fn)
         : num_chunks(num_chunks),
+          chunk_size(chunk_size),
           chunk_send_fn(chunk_send_fn),
           next_chunk_id(0),
           num_chunks_inflight(0),
@@ -108,12 +187,25 @@ class PushManager {
       }
       num_chunks_to_send--;
       num_chunks_inflight++;
+      if (relay) {
+        auto send_fn = std::move(relay_send_fns.front());
+        relay_send_fns.pop_front();
+        send_fn();
+        return true;
+      }
       // Send the next chunk for this push.
       chunk_send_fn(next_chunk_id);
       next_chunk_id = (next_chunk_id + 1) % num_chunks;
       return true;
     }
 
+    /// Add a received chunk to a relayed push.
+    void AddRelayChunk(std::function<void()> send_fn) {
+      relay_send_fns.push_back(std::move(send_fn));
+      num_chunks++;
+      num_chunks_to_send++;
+    }
+
     /// Notify that a chunk is successfully sent.
     void OnChunkComplete() { --num_chunks_inflight; }
 
@@ -123,15 +215,57 @@ class PushManager {
     }
   };
 
+  /// Tracks the congestion window and throughput of pushes to a destination.
+  struct PeerState {
+    explicit PeerState(double window, double now)
+        : window(window), throughput_interval_start(now) {}
+    /// Max number of chunks allowed to be in flight to this destination.
+    double window;
+    /// Whether the window is still growing exponentially, i.e. no congestion has
+    /// been seen yet.
+    bool slow_start = true;
+    /// The number of chunks pending completion.
+    int64_t num_chunks_inflight = 0;
+    /// The lowest latency per byte seen, i.e. without queueing delay.
+    double min_seconds_per_byte = std::numeric_limits<double>::infinity();
+    /// The time the window was last decreased. Chunks sent before that don't
+    /// decrease it again.
+    double last_decrease_time = -std::numeric_limits<double>::infinity();
+    /// The start of the current throughput measurement interval.
+    double throughput_interval_start;
+    /// Bytes completed in the current throughput measurement interval.
+    int64_t throughput_interval_bytes = 0;
+    /// Bytes per second over the last measurement interval.
+    double throughput = 0;
+  };
+
   /// Called on completion events to trigger additional pushes.
   void ScheduleRemainingPushes();
 
+  /// Start tracking the window and throughput of a destination, if not yet.
+  void AddPeerIfNeeded(const NodeID &dest_id);
+
+  /// Whether another chunk can be sent to the destination under its window.
+  bool CanSendChunk(const NodeID &dest_id) const;
+
+  /// Update the window and throughput of a destination on chunk completion.
+  void UpdatePeerState(PeerState &peer,
+                       double send_time,
+                       int64_t chunk_size,
+                       double now) const;
+
   /// Pair of (destination, object_id).
   typedef std::pair<NodeID, ObjectID> PushID;
 
   /// Max number of chunks in flight allowed.
   const int64_t max_chunks_in_flight_;
 
+  /// Whether to limit the chunks in flight to each destination.
+  const bool congestion_control_;
+
+  /// Returns the current time in seconds.
+  const std::function<double()> get_time_seconds_;
+
   /// Running count of chunks in flight, used to limit progress of in_flight_pushes_.
   int64_t chunks_in_flight_ = 0;
 
@@ -140,6 +274,9 @@ class PushManager {
 
   /// Tracks all pushes with chunk transfers in flight.
   absl::flat_hash_map<PushID, std::unique_ptr<PushState>> push_info_;
+
+  /// Tracks the window and throughput of all destinations pushed to.
+  absl::flat_hash_map<NodeID, PeerState> peers_;
 };
 
 }  // namespace ray
@@ -0,0 +1,81 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/spill_compression.h"
+
+#include <zlib.h>
+
+#include "ray/util/logging.h"
+
+namespace ray {
+
+absl::optional<SpillCodec> ParseSpillCodec(const std::string &name) {
+  if (name.empty() || name == "none") {
+    return SpillCodec::kNone;
+  } else if (name == "zlib") {
+    return SpillCodec::kZlib;
+  }
+  return absl::nullopt;
+}
+
+bool CompressBlock(SpillCodec codec,
+                   const char *input,
+                   size_t size,
+                   std::string *output) {
+  switch (codec) {
+  case SpillCodec::kNone:
+    return false;
+  case SpillCodec::kZlib: {
+    uLongf compressed_size = compressBound(size);
+    output->resize(compressed_size);
+    // Spilling is bound by disk bandwidth, but compressing must still keep up
+    // with it, so use the fastest level.
+    if (compress2(reinterpret_cast<Bytef *>(&(*output)[0]),
+                  &compressed_size,
+                  reinterpret_cast<const Bytef *>(input),
+                  size,
+                  Z_BEST_SPEED) != Z_OK ||
+        compressed_size >= size) {
+      return false;
+    }
+    output->resize(compressed_size);
+    return true;
+  }
+  }
+  RAY_LOG(FATAL) << "Unknown spill codec " << static_cast<uint64_t>(codec);
+  return false;
+}
+
+bool DecompressBlock(SpillCodec codec,
+                     const char *input,
+                     size_t input_size,
+                     char *output,
+                     size_t output_size) {
+  switch (codec) {
+  case SpillCodec::kNone:
+    return false;
+  case SpillCodec::kZlib: {
+    uLongf decompressed_size = output_size;
+    return uncompress(reinterpret_cast<Bytef *>(output),
+                      &decompressed_size,
+                      reinterpret_cast<const Bytef *>(input),
+                      input_size) == Z_OK &&
+           decompressed_size == output_size;
+  }
+  }
+  // The codec was read from a corrupted file.
+  return false;
+}
+
+}  // namespace ray
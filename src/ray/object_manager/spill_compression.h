@@ -0,0 +1,59 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+
+#include "absl/types/optional.h"
+
+namespace ray {
+
+/// Codecs that the data payload of spilled objects can be compressed with. The
+/// values are written to spill files, so they must not change.
+enum class SpillCodec : uint64_t {
+  kNone = 0,
+  kZlib = 1,
+};
+
+/// Set in the address size field of spilled objects whose data payload is
+/// compressed, to mark that they have an extended header. See
+/// SpilledObjectReader::ParseObjectHeader for the layout.
+constexpr uint64_t kSpilledObjectCompressedFlag = 1ULL << 63;
+
+/// Parse a codec name from the object_spilling_compression config.
+///
+/// \return The codec, or an empty optional if the name is unknown. An empty name
+///         means no compression.
+absl::optional<SpillCodec> ParseSpillCodec(const std::string &name);
+
+/// Compress a block of data.
+///
+/// \param[out] output The compressed block.
+/// \return False if the block could not be compressed to fewer bytes, in which case
+///         it should be stored as is.
+bool CompressBlock(SpillCodec codec, const char *input, size_t size, std::string *output);
+
+/// Decompress a block of data that was compressed by CompressBlock.
+///
+/// \param output Buffer to decompress into. It must be exactly as large as the
+///               uncompressed block.
+/// \return False if the block is corrupted.
+bool DecompressBlock(SpillCodec codec,
+                     const char *input,
+                     size_t input_size,
+                     char *output,
+                     size_t output_size);
+
+}  // namespace ray
@@ -14,9 +14,18 @@
 
 #include "ray/object_manager/spilled_object_reader.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <fstream>
 #include <regex>
 
+#include "ray/common/ray_config.h"
 #include "ray/util/logging.h"
 
 namespace ray {
@@ -24,6 +33,29 @@ namespace {
 const size_t UINT64_size = sizeof(uint64_t);
 }
 
+class SpilledObjectReader::File {
+ public:
+  explicit File(const std::string &file_path) {
+#ifndef _WIN32
+    fd_ = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+  }
+
+  ~File() {
+#ifndef _WIN32
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+#endif
+  }
+
+  /// The file descriptor, or -1 if the file couldn't be opened.
+  int fd() const { return fd_; }
+
+ private:
+  int fd_ = -1;
+};
+
 /* static */ absl::optional<SpilledObjectReader>
 SpilledObjectReader::CreateSpilledObjectReader(const std::string &object_url) {
   std::string file_path;
@@ -41,6 +73,7 @@ SpilledObjectReader::CreateSpilledObjectReader(const std::string &object_url) {
   uint64_t metadata_offset = 0;
   uint64_t metadata_size = 0;
   rpc::Address owner_address;
+  SpilledObjectCompression compression;
 
   std::ifstream is(file_path, std::ios::binary);
   if (!is || !SpilledObjectReader::ParseObjectHeader(is,
@@ -49,7 +82,8 @@ SpilledObjectReader::CreateSpilledObjectReader(const std::string &object_url) {
                                                      data_size,
                                                      metadata_offset,
                                                      metadata_size,
-                                                     owner_address)) {
+                                                     owner_address,
+                                                     &compression)) {
     RAY_LOG(WARNING) << "Failed to parse object header for spilled object " << object_url;
     return absl::optional<SpilledObjectReader>();
   }
@@ -61,7 +95,8 @@ SpilledObjectReader::CreateSpilledObjectReader(const std::string &object_url) {
                           data_size,
                           metadata_offset,
                           metadata_size,
-                          std::move(owner_address)));
+                          std::move(owner_address),
+                          std::move(compression)));
 }
 
 uint64_t SpilledObjectReader::GetDataSize() const { return data_size_; }
@@ -78,14 +113,26 @@ SpilledObjectReader::SpilledObjectReader(std::string file_path,
                                          uint64_t data_size,
                                          uint64_t metadata_offset,
                                          uint64_t metadata_size,
-                                         rpc::Address owner_address)
+                                         rpc::Address owner_address,
+                                         SpilledObjectCompression compression)
     : file_path_(std::move(file_path)),
       object_size_(object_size),
       data_offset_(data_offset),
       data_size_(data_size),
       metadata_offset_(metadata_offset),
       metadata_size_(metadata_size),
-      owner_address_(std::move(owner_address)) {}
+      owner_address_(std::move(owner_address)),
+      compression_(std::move(compression)),
+      file_(std::make_shared<File>(file_path_)) {
+#ifdef __linux__
+  if (file_->fd() >= 0) {
+    posix_fadvise(file_->fd(),
+                  metadata_offset_,
+                  GetObjectEndOffset() - metadata_offset_,
+                  POSIX_FADV_SEQUENTIAL);
+  }
+#endif
+}
 
 /* static */ bool SpilledObjectReader::ParseObjectURL(const std::string &object_url,
                                                       std::string &file_path,
@@ -123,7 +170,8 @@ bool SpilledObjectReader::ParseObjectHeader(std::istream &is,
                                             uint64_t &data_size,
                                             uint64_t &metadata_offset,
                                             uint64_t &metadata_size,
-                                            rpc::Address &owner_address) {
+                                            rpc::Address &owner_address,
+                                            SpilledObjectCompression *compression) {
   if (!is.seekg(object_offset)) {
     return false;
   }
@@ -134,14 +182,49 @@ bool SpilledObjectReader::ParseObjectHeader(std::istream &is,
     return false;
   }
 
+  uint64_t header_size = UINT64_size * 3;
+  SpillCodec codec = SpillCodec::kNone;
+  uint64_t block_size = 0;
+  std::vector<uint64_t> block_sizes;
+  if (address_size & kSpilledObjectCompressedFlag) {
+    address_size &= ~kSpilledObjectCompressedFlag;
+    uint64_t codec_value = 0;
+    if (compression == nullptr || !ReadUINT64(is, codec_value) ||
+        !ReadUINT64(is, block_size) || block_size == 0) {
+      return false;
+    }
+    codec = static_cast<SpillCodec>(codec_value);
+    uint64_t num_blocks = (data_size + block_size - 1) / block_size;
+    for (uint64_t i = 0; i < num_blocks; i++) {
+      uint64_t compressed_block_size = 0;
+      if (!ReadUINT64(is, compressed_block_size)) {
+        return false;
+      }
+      block_sizes.push_back(compressed_block_size);
+    }
+    header_size += UINT64_size * (2 + num_blocks);
+  }
+
   std::string address_str(address_size, '\0');
   if (!is.read(&address_str[0], address_size) ||
       !owner_address.ParseFromString(address_str)) {
     return false;
   }
 
-  metadata_offset = object_offset + UINT64_size * 3 + address_size;
+  metadata_offset = object_offset + header_size + address_size;
   data_offset = metadata_offset + metadata_size;
+  if (compression != nullptr) {
+    compression->codec = codec;
+    compression->block_size = block_size;
+    compression->block_offsets.clear();
+    if (codec != SpillCodec::kNone) {
+      compression->block_offsets.push_back(data_offset);
+      for (auto compressed_block_size : block_sizes) {
+        compression->block_offsets.push_back(compression->block_offsets.back() +
+                                             compressed_block_size);
+      }
+    }
+  }
   return true;
 }
 
@@ -169,14 +252,111 @@ uint64_t SpilledObjectReader::ToUINT64(const std::string &s) {
 bool SpilledObjectReader::ReadFromDataSection(uint64_t offset,
                                               uint64_t size,
                                               char *output) const {
-  std::ifstream is(file_path_, std::ios::binary);
-  return is.seekg(data_offset_ + offset) && is.read(output, size);
+  if (compression_.codec != SpillCodec::kNone) {
+    return ReadFromCompressedDataSection(offset, size, output);
+  }
+  return ReadFromFile(data_offset_ + offset, size, output);
+}
+
+bool SpilledObjectReader::ReadFromCompressedDataSection(uint64_t offset,
+                                                        uint64_t size,
+                                                        char *output) const {
+  if (offset + size > data_size_) {
+    return false;
+  }
+  std::string compressed_block;
+  std::string block;
+  const uint64_t end = offset + size;
+  for (uint64_t i = offset / compression_.block_size; offset < end; i++) {
+    const uint64_t block_start = i * compression_.block_size;
+    const uint64_t block_size =
+        std::min(compression_.block_size, data_size_ - block_start);
+    const uint64_t compressed_block_size =
+        compression_.block_offsets[i + 1] - compression_.block_offsets[i];
+    compressed_block.resize(compressed_block_size);
+    if (!ReadFromFile(
+            compression_.block_offsets[i], compressed_block_size, &compressed_block[0])) {
+      return false;
+    }
+    const uint64_t num_bytes = std::min(end, block_start + block_size) - offset;
+    if (compressed_block_size == block_size) {
+      // The block didn't shrink, so it was stored as is.
+      std::memcpy(output, compressed_block.data() + (offset - block_start), num_bytes);
+    } else if (num_bytes == block_size) {
+      if (!DecompressBlock(compression_.codec,
+                           compressed_block.data(),
+                           compressed_block_size,
+                           output,
+                           block_size)) {
+        return false;
+      }
+    } else {
+      block.resize(block_size);
+      if (!DecompressBlock(compression_.codec,
+                           compressed_block.data(),
+                           compressed_block_size,
+                           &block[0],
+                           block_size)) {
+        return false;
+      }
+      std::memcpy(output, block.data() + (offset - block_start), num_bytes);
+    }
+    output += num_bytes;
+    offset += num_bytes;
+  }
+  return true;
 }
 
 bool SpilledObjectReader::ReadFromMetadataSection(uint64_t offset,
                                                   uint64_t size,
                                                   char *output) const {
+  return ReadFromFile(metadata_offset_ + offset, size, output);
+}
+
+bool SpilledObjectReader::ReadFromFile(uint64_t file_offset,
+                                       uint64_t size,
+                                       char *output) const {
+#ifdef _WIN32
   std::ifstream is(file_path_, std::ios::binary);
-  return is.seekg(metadata_offset_ + offset) && is.read(output, size);
+  return is.seekg(file_offset) && is.read(output, size);
+#else
+  const int fd = file_->fd();
+  if (fd < 0) {
+    return false;
+  }
+  uint64_t bytes_read = 0;
+  while (bytes_read < size) {
+    ssize_t result =
+        pread(fd, output + bytes_read, size - bytes_read, file_offset + bytes_read);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      // An error, or the file was truncated.
+      return false;
+    }
+    bytes_read += result;
+  }
+#ifdef __linux__
+  const uint64_t readahead_bytes =
+      RayConfig::instance().object_manager_spilled_object_readahead_bytes();
+  const uint64_t end_offset = file_offset + size;
+  const uint64_t object_end_offset = GetObjectEndOffset();
+  if (readahead_bytes > 0 && end_offset < object_end_offset) {
+    posix_fadvise(fd,
+                  end_offset,
+                  std::min(readahead_bytes, object_end_offset - end_offset),
+                  POSIX_FADV_WILLNEED);
+  }
+#endif
+  return true;
+#endif
+}
+
+uint64_t SpilledObjectReader::GetObjectEndOffset() const {
+  if (compression_.codec != SpillCodec::kNone) {
+    return compression_.block_offsets.back();
+  }
+  return data_offset_ + data_size_;
 }
 }  // namespace ray
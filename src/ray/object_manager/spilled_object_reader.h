@@ -16,14 +16,32 @@
 
 #include <gtest/gtest_prod.h>
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "ray/object_manager/object_reader.h"
+#include "ray/object_manager/spill_compression.h"
 #include "src/ray/protobuf/common.pb.h"
 
 namespace ray {
-/// Reader for a local object spilled in the object_url.
+/// How the data payload of a spilled object is stored.
+struct SpilledObjectCompression {
+  SpillCodec codec = SpillCodec::kNone;
+  /// The number of uncompressed bytes in each block, except the last one.
+  uint64_t block_size = 0;
+  /// The offset of each block in the file, followed by the end of the last block.
+  /// Blocks that are as large as their uncompressed size are stored as is.
+  std::vector<uint64_t> block_offsets;
+};
+
+/// Reader for a local object spilled in the object_url. Compressed data payloads
+/// are decompressed transparently.
+///
+/// The file is opened once and read with pread, hinting the OS to read ahead of
+/// each read, so that spilled objects can be pushed to other nodes chunk by chunk
+/// without restoring them into plasma.
 /// This class is thread safe.
 class SpilledObjectReader : public IObjectReader {
  public:
@@ -52,7 +70,8 @@ class SpilledObjectReader : public IObjectReader {
                       uint64_t data_size,
                       uint64_t metadata_offset,
                       uint64_t metadata_size,
-                      rpc::Address owner_address);
+                      rpc::Address owner_address,
+                      SpilledObjectCompression compression = {});
 
   /// Parse the object url in the form of {path}?offset={offset}&size={size}.
   /// Return false if parsing failed.
@@ -79,6 +98,20 @@ class SpilledObjectReader : public IObjectReader {
   ///    --- start of another object ---
   ///      ...
   ///
+  /// If the data payload is compressed, the address size has the
+  /// kSpilledObjectCompressedFlag bit set, and the header is extended to:
+  ///      address_size | flag (8 bytes),
+  ///      metadata_size       (8 bytes),
+  ///      data_size           (8 bytes, uncompressed),
+  ///      codec               (8 bytes),
+  ///      block_size          (8 bytes, uncompressed),
+  ///      block_sizes         (8 bytes for each block, compressed),
+  ///      serialized_address  (address_size bytes),
+  ///      metadata_payload    (metadata_size bytes),
+  ///      data_blocks         (sum of block_sizes bytes)
+  /// The data is split into blocks of block_size bytes that are compressed
+  /// separately, so that ranges of it can be read without decompressing all of it.
+  ///
   /// \param[in] is input stream to read from.
   /// \param[in] object_offset offset of the object stored in the file.
   /// \param[out] data_offset data payload offset in the file.
@@ -86,6 +119,8 @@ class SpilledObjectReader : public IObjectReader {
   /// \param[out] metadata_offset metadata payload offset in the file.
   /// \param[out] metadata_size size of the metadata payload.
   /// \param[out] owner_address owner address.
+  /// \param[out] compression how the data payload is compressed. If null,
+  /// parsing fails for compressed objects.
   /// \return bool.
   static bool ParseObjectHeader(std::istream &is,
                                 uint64_t object_offset,
@@ -93,7 +128,8 @@ class SpilledObjectReader : public IObjectReader {
                                 uint64_t &data_size,
                                 uint64_t &metadata_offset,
                                 uint64_t &metadata_size,
-                                rpc::Address &owner_address);
+                                rpc::Address &owner_address,
+                                SpilledObjectCompression *compression = nullptr);
 
   /// Read 8 bytes from inputstream and deserialize it as a little-endian
   /// uint64_t. Return false if reach end of stream early.
@@ -102,11 +138,27 @@ class SpilledObjectReader : public IObjectReader {
   /// Deserialize 8 bytes string as a little-endian uint64_t.
   static uint64_t ToUINT64(const std::string &s);
 
+  /// Read a range of a compressed data payload, decompressing the blocks it
+  /// overlaps.
+  bool ReadFromCompressedDataSection(uint64_t offset, uint64_t size, char *output) const;
+
+  /// Read a range of the file, and hint the OS to read ahead the part of the object
+  /// that follows it, since chunks are usually read in order.
+  bool ReadFromFile(uint64_t file_offset, uint64_t size, char *output) const;
+
+  /// The offset in the file of the end of the object.
+  uint64_t GetObjectEndOffset() const;
+
+  /// An open file descriptor, closed when the last copy of the reader is destroyed.
+  class File;
+
  private:
   FRIEND_TEST(SpilledObjectReaderTest, ParseObjectURL);
+  FRIEND_TEST(SpilledObjectReaderTest, ReadAfterFileDeleted);
   FRIEND_TEST(SpilledObjectReaderTest, ToUINT64);
   FRIEND_TEST(SpilledObjectReaderTest, ReadUINT64);
   FRIEND_TEST(SpilledObjectReaderTest, ParseObjectHeader);
+  FRIEND_TEST(SpilledObjectReaderTest, ReadCompressedDataSection);
   FRIEND_TEST(SpilledObjectReaderTest, Getters);
   FRIEND_TEST(ChunkObjectReaderTest, GetNumChunks);
 
@@ -117,6 +169,8 @@ class SpilledObjectReader : public IObjectReader {
   const uint64_t metadata_offset_;
   const uint64_t metadata_size_;
   const rpc::Address owner_address_;
+  const SpilledObjectCompression compression_;
+  const std::shared_ptr<File> file_;
 };
 
 }  // namespace ray
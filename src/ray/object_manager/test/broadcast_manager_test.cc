@@ -0,0 +1,354 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/broadcast_manager.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "gtest/gtest.h"
+#include "ray/object_manager/object_buffer_pool.h"
+
+namespace ray {
+
+TEST(BroadcastManagerTest, TestDisabled) {
+  BroadcastManager broadcast_manager(0);
+  auto obj_id = ObjectID::FromRandom();
+  for (int i = 0; i < 10; i++) {
+    broadcast_manager.AddReceiver(obj_id, NodeID::FromRandom());
+  }
+  ASSERT_EQ(broadcast_manager.NumReceivers(obj_id), 0);
+  ASSERT_TRUE(broadcast_manager.ChooseRelay(obj_id, NodeID::FromRandom()).IsNil());
+}
+
+TEST(BroadcastManagerTest, TestChooseRelay) {
+  BroadcastManager broadcast_manager(2);
+  auto obj_id = ObjectID::FromRandom();
+  auto node_a = NodeID::FromRandom();
+  auto node_b = NodeID::FromRandom();
+
+  // Below the fanout, pulls are served by this node.
+  ASSERT_TRUE(broadcast_manager.ChooseRelay(obj_id, NodeID::FromRandom()).IsNil());
+  broadcast_manager.AddReceiver(obj_id, node_a);
+  broadcast_manager.AddReceiver(obj_id, node_a);
+  ASSERT_EQ(broadcast_manager.NumReceivers(obj_id), 1);
+  ASSERT_TRUE(broadcast_manager.ChooseRelay(obj_id, NodeID::FromRandom()).IsNil());
+
+  // At the fanout, pulls are forwarded round-robin to the receivers.
+  broadcast_manager.AddReceiver(obj_id, node_b);
+  ASSERT_EQ(broadcast_manager.ChooseRelay(obj_id, NodeID::FromRandom()), node_a);
+  ASSERT_EQ(broadcast_manager.ChooseRelay(obj_id, NodeID::FromRandom()), node_b);
+  ASSERT_EQ(broadcast_manager.ChooseRelay(obj_id, NodeID::FromRandom()), node_a);
+  ASSERT_EQ(broadcast_manager.NumPullsForwarded(), 3);
+  // Retried pulls from receivers are not forwarded to themselves.
+  ASSERT_TRUE(broadcast_manager.ChooseRelay(obj_id, node_b).IsNil());
+  // Other objects are not affected.
+  ASSERT_TRUE(
+      broadcast_manager.ChooseRelay(ObjectID::FromRandom(), NodeID::FromRandom())
+          .IsNil());
+
+  broadcast_manager.RemoveReceiver(obj_id, node_a);
+  ASSERT_TRUE(broadcast_manager.ChooseRelay(obj_id, NodeID::FromRandom()).IsNil());
+  broadcast_manager.RemoveReceiver(obj_id, node_b);
+  ASSERT_EQ(broadcast_manager.NumReceivers(obj_id), 0);
+
+  broadcast_manager.AddReceiver(obj_id, node_a);
+  broadcast_manager.AddReceiver(obj_id, node_b);
+  broadcast_manager.RemoveReceivers(obj_id);
+  ASSERT_EQ(broadcast_manager.NumReceivers(obj_id), 0);
+}
+
+/// A plasma client that stores objects in local memory, and checks the contents
+/// of objects when they are sealed.
+class FakePlasmaClient : public plasma::PlasmaClientInterface {
+ public:
+  explicit FakePlasmaClient(std::string expected_data)
+      : expected_data_(std::move(expected_data)) {}
+
+  Status Release(const ObjectID &object_id) override { return Status::OK(); }
+
+  Status Disconnect() override { return Status::OK(); }
+
+  Status Get(const std::vector<ObjectID> &object_ids,
+             int64_t timeout_ms,
+             std::vector<plasma::ObjectBuffer> *object_buffers,
+             bool is_from_worker) override {
+    return Status::NotImplemented("Get");
+  }
+
+  Status Seal(const ObjectID &object_id) override {
+    RAY_CHECK(std::string(reinterpret_cast<const char *>(buffer_->Data()),
+                          buffer_->Size()) == expected_data_);
+    sealed_ = true;
+    return Status::OK();
+  }
+
+  Status Abort(const ObjectID &object_id) override { return Status::OK(); }
+
+  Status CreateAndSpillIfNeeded(const ObjectID &object_id,
+                                const rpc::Address &owner_address,
+                                int64_t data_size,
+                                const uint8_t *metadata,
+                                int64_t metadata_size,
+                                std::shared_ptr<Buffer> *data,
+                                plasma::flatbuf::ObjectSource source,
+                                int device_num) override {
+    buffer_ = std::make_shared<LocalMemoryBuffer>(data_size + metadata_size);
+    *data = buffer_;
+    return Status::OK();
+  }
+
+  Status Delete(const std::vector<ObjectID> &object_ids) override {
+    return Status::OK();
+  }
+
+  bool Sealed() const { return sealed_; }
+
+ private:
+  const std::string expected_data_;
+  std::shared_ptr<Buffer> buffer_;
+  bool sealed_ = false;
+};
+
+/// Simulates broadcasting an object from one node to many nodes that all pull it
+/// at once. Each node has a BroadcastManager and an ObjectBufferPool, wired
+/// together the way the ObjectManager wires them: pull requests are forwarded
+/// to relays chosen by the BroadcastManager, and chunks are relayed to the
+/// destinations returned by the ObjectBufferPool as they are written.
+///
+/// Time advances in rounds. Each node can send one chunk per round, round-robin
+/// over the nodes it is sending chunks to, and chunks arrive at the end of the
+/// round. Pull requests arrive immediately.
+class BroadcastSimulation {
+ public:
+  static const uint64_t kChunkSize = 64;
+
+  BroadcastSimulation(int num_nodes, int num_chunks, int64_t max_fanout)
+      : num_chunks_(num_chunks), object_id_(ObjectID::FromRandom()) {
+    for (int i = 0; i < num_chunks * static_cast<int>(kChunkSize); i++) {
+      object_data_.push_back('a' + i % 26);
+    }
+    for (int i = 0; i < num_nodes; i++) {
+      auto node = std::make_unique<Node>(max_fanout, object_data_);
+      node_ids_.push_back(node->node_id);
+      nodes_.emplace(node->node_id, std::move(node));
+    }
+  }
+
+  /// Run the broadcast until all nodes have sealed the object.
+  ///
+  /// \return The number of rounds it took.
+  int Run() {
+    // The first node has the object, all other nodes pull it from there.
+    auto &source = *nodes_[node_ids_[0]];
+    source.has_object = true;
+    for (size_t i = 1; i < node_ids_.size(); i++) {
+      HandlePull(source, node_ids_[i]);
+    }
+    int rounds = 0;
+    while (NumNodesWithObject() < node_ids_.size()) {
+      RAY_CHECK(rounds < 100000) << "The broadcast is stuck.";
+      rounds++;
+      std::vector<std::pair<NodeID, Transfer>> arrivals;
+      for (const auto &node_id : node_ids_) {
+        auto &node = *nodes_[node_id];
+        if (node.destinations.empty()) {
+          continue;
+        }
+        // Send the next chunk to the next destination, round-robin.
+        const NodeID destination = node.destinations.front();
+        node.destinations.pop_front();
+        auto &chunks = node.outgoing[destination];
+        arrivals.emplace_back(destination, std::move(chunks.front()));
+        chunks.pop_front();
+        node.num_chunks_sent++;
+        if (!chunks.empty()) {
+          node.destinations.push_back(destination);
+        } else {
+          if (arrivals.back().second.pushed) {
+            node.broadcast_manager.RemoveReceiver(object_id_, destination);
+          }
+          node.outgoing.erase(destination);
+        }
+      }
+      for (auto &arrival : arrivals) {
+        ReceiveChunk(*nodes_[arrival.first], std::move(arrival.second));
+      }
+    }
+    return rounds;
+  }
+
+  /// Return the number of chunks sent by each node, the first node first.
+  std::vector<int64_t> NumChunksSent() const {
+    std::vector<int64_t> num_chunks_sent;
+    for (const auto &node_id : node_ids_) {
+      num_chunks_sent.push_back(nodes_.at(node_id)->num_chunks_sent);
+    }
+    return num_chunks_sent;
+  }
+
+ private:
+  /// A chunk on its way to a node.
+  struct Transfer {
+    uint64_t chunk_index;
+    std::string data;
+    /// Whether the chunk is part of a push of the whole object, rather than
+    /// relayed.
+    bool pushed;
+  };
+
+  struct Node {
+    Node(int64_t max_fanout, const std::string &object_data)
+        : node_id(NodeID::FromRandom()),
+          broadcast_manager(max_fanout),
+          plasma_client(std::make_shared<FakePlasmaClient>(object_data)),
+          buffer_pool(plasma_client, kChunkSize, kChunkSize) {}
+
+    NodeID node_id;
+    BroadcastManager broadcast_manager;
+    std::shared_ptr<FakePlasmaClient> plasma_client;
+    ObjectBufferPool buffer_pool;
+    /// Whether the object is sealed on this node.
+    bool has_object = false;
+    /// The chunks this node is sending to each destination.
+    absl::flat_hash_map<NodeID, std::deque<Transfer>> outgoing;
+    /// The destinations with chunks to send, in round-robin order.
+    std::deque<NodeID> destinations;
+    int64_t num_chunks_sent = 0;
+  };
+
+  void Send(Node &node, const NodeID &node_id, Transfer transfer) {
+    auto &chunks = node.outgoing[node_id];
+    if (chunks.empty()) {
+      node.destinations.push_back(node_id);
+    }
+    chunks.push_back(std::move(transfer));
+  }
+
+  size_t NumNodesWithObject() const {
+    size_t num_nodes = 0;
+    for (const auto &entry : nodes_) {
+      num_nodes += entry.second->has_object;
+    }
+    return num_nodes;
+  }
+
+  /// See ObjectManager::PushOrRelay.
+  void HandlePull(Node &node, const NodeID &requester_id) {
+    const NodeID relay_id = node.broadcast_manager.ChooseRelay(object_id_, requester_id);
+    if (!relay_id.IsNil()) {
+      HandlePull(*nodes_[relay_id], requester_id);
+    } else if (node.has_object) {
+      Push(node, requester_id);
+    } else {
+      // See ObjectManager::RelayObject.
+      std::vector<rpc::PushRequest> written_chunks;
+      node.buffer_pool.AddRelayDestination(object_id_, requester_id, &written_chunks);
+      node.broadcast_manager.AddReceiver(object_id_, requester_id);
+      for (const auto &chunk : written_chunks) {
+        Send(node, requester_id, {chunk.chunk_index(), chunk.data(), /*pushed=*/false});
+      }
+    }
+  }
+
+  void Push(Node &node, const NodeID &node_id) {
+    node.broadcast_manager.AddReceiver(object_id_, node_id);
+    for (int i = 0; i < num_chunks_; i++) {
+      Send(node,
+           node_id,
+           {static_cast<uint64_t>(i),
+            object_data_.substr(i * kChunkSize, kChunkSize),
+            /*pushed=*/true});
+    }
+  }
+
+  /// See ObjectManager::ReceiveObjectChunk and ObjectManager::HandleObjectAdded.
+  void ReceiveChunk(Node &node, Transfer transfer) {
+    std::vector<NodeID> relay_destinations;
+    if (node.buffer_pool
+            .CreateChunk(
+                object_id_, rpc::Address(), object_data_.size(), 0, transfer.chunk_index)
+            .ok()) {
+      node.buffer_pool.WriteChunk(object_id_,
+                                  object_data_.size(),
+                                  0,
+                                  transfer.chunk_index,
+                                  transfer.data,
+                                  &relay_destinations);
+    }
+    for (const auto &relay_id : relay_destinations) {
+      Send(node, relay_id, {transfer.chunk_index, transfer.data, /*pushed=*/false});
+    }
+    if (!node.has_object && node.plasma_client->Sealed()) {
+      node.has_object = true;
+      node.broadcast_manager.RemoveReceivers(object_id_);
+      for (const auto &node_id :
+           node.buffer_pool.TakePendingRelayDestinations(object_id_)) {
+        Push(node, node_id);
+      }
+    }
+  }
+
+  const int num_chunks_;
+  const ObjectID object_id_;
+  std::string object_data_;
+  std::vector<NodeID> node_ids_;
+  absl::flat_hash_map<NodeID, std::unique_ptr<Node>> nodes_;
+};
+
+TEST(BroadcastManagerTest, TestBroadcastSimulation) {
+  const int num_nodes = 64;
+  const int num_chunks = 16;
+  const int64_t max_fanout = 2;
+
+  BroadcastSimulation direct(num_nodes, num_chunks, /*max_fanout=*/0);
+  const int direct_rounds = direct.Run();
+  const auto direct_chunks_sent = direct.NumChunksSent();
+
+  BroadcastSimulation relayed(num_nodes, num_chunks, max_fanout);
+  const int relayed_rounds = relayed.Run();
+  const auto relayed_chunks_sent = relayed.NumChunksSent();
+
+  RAY_LOG(INFO) << "Broadcast of " << num_chunks << " chunks to " << num_nodes - 1
+                << " nodes: " << direct_rounds << " rounds without relaying, "
+                << relayed_rounds << " rounds with a relay tree of fanout "
+                << max_fanout << ".";
+  RAY_LOG(INFO) << "Chunks sent by the source: " << direct_chunks_sent[0]
+                << " without relaying, " << relayed_chunks_sent[0]
+                << " with a relay tree.";
+
+  // Without relaying, the source sends the object to every node.
+  ASSERT_EQ(direct_chunks_sent[0], (num_nodes - 1) * num_chunks);
+  ASSERT_EQ(direct_rounds, (num_nodes - 1) * num_chunks);
+  // With relaying, each node sends the object at most `max_fanout` times. The
+  // broadcast takes about max_fanout * num_chunks rounds for the first level of
+  // the tree, plus a few rounds for each of the log(num_nodes) levels below it.
+  int64_t total_chunks_sent = 0;
+  for (int64_t num_chunks_sent : relayed_chunks_sent) {
+    ASSERT_LE(num_chunks_sent, max_fanout * num_chunks);
+    total_chunks_sent += num_chunks_sent;
+  }
+  ASSERT_EQ(total_chunks_sent, (num_nodes - 1) * num_chunks);
+  ASSERT_LT(relayed_rounds, 2 * max_fanout * num_chunks);
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -71,7 +71,7 @@ class ObjectBufferPoolTest : public ::testing::Test {
   ObjectBufferPoolTest()
       : chunk_size_(1000),
         mock_plasma_client_(std::make_shared<MockPlasmaClient>()),
-        object_buffer_pool_(mock_plasma_client_, chunk_size_),
+        object_buffer_pool_(mock_plasma_client_, chunk_size_, chunk_size_),
         mock_data_(chunk_size_, 'x') {}
 
   void AssertNoLeaks() {
@@ -163,6 +163,89 @@ TEST_F(ObjectBufferPoolTest, TestSizeMismatch) {
   object_buffer_pool_.WriteChunk(obj_id, data_size_2, 0, 0, mock_data_);
 }
 
+TEST_F(ObjectBufferPoolTest, TestRelayDestinations) {
+  auto obj_id = ObjectID::FromRandom();
+  auto node_a = NodeID::FromRandom();
+  auto node_b = NodeID::FromRandom();
+  rpc::Address owner_address;
+  owner_address.set_ip_address("1.2.3.4");
+  const uint64_t data_size = 3 * chunk_size_;
+  std::vector<rpc::PushRequest> written_chunks;
+  std::vector<NodeID> relay_destinations;
+
+  // A destination added before the buffer is created gets all chunks as they
+  // are written, and only once if it is added again.
+  object_buffer_pool_.AddRelayDestination(obj_id, node_a, &written_chunks);
+  object_buffer_pool_.AddRelayDestination(obj_id, node_a, &written_chunks);
+  ASSERT_TRUE(written_chunks.empty());
+  ASSERT_TRUE(
+      object_buffer_pool_.CreateChunk(obj_id, owner_address, data_size, 0, 0).ok());
+  object_buffer_pool_.WriteChunk(
+      obj_id, data_size, 0, 0, mock_data_, &relay_destinations);
+  ASSERT_EQ(relay_destinations, std::vector<NodeID>({node_a}));
+
+  // A destination added later gets the chunks written so far returned.
+  object_buffer_pool_.AddRelayDestination(obj_id, node_b, &written_chunks);
+  ASSERT_EQ(written_chunks.size(), 1);
+  ASSERT_EQ(written_chunks[0].object_id(), obj_id.Binary());
+  ASSERT_EQ(written_chunks[0].owner_address().ip_address(), "1.2.3.4");
+  ASSERT_EQ(written_chunks[0].data_size(), data_size);
+  ASSERT_EQ(written_chunks[0].chunk_index(), 0);
+  ASSERT_EQ(written_chunks[0].data(), mock_data_);
+
+  // A destination that is added again gets the chunks written so far again, but
+  // later chunks are relayed to it only once.
+  written_chunks.clear();
+  object_buffer_pool_.AddRelayDestination(obj_id, node_b, &written_chunks);
+  ASSERT_EQ(written_chunks.size(), 1);
+  for (int i = 1; i < 3; i++) {
+    ASSERT_TRUE(
+        object_buffer_pool_.CreateChunk(obj_id, owner_address, data_size, 0, i).ok());
+    if (i == 2) {
+      EXPECT_CALL(*mock_plasma_client_, Seal(obj_id));
+      EXPECT_CALL(*mock_plasma_client_, Release(obj_id));
+    }
+    object_buffer_pool_.WriteChunk(
+        obj_id, data_size, 0, i, mock_data_, &relay_destinations);
+    ASSERT_EQ(relay_destinations, std::vector<NodeID>({node_a, node_b}));
+  }
+
+  // Destinations added after the object was sealed are left pending.
+  ASSERT_TRUE(object_buffer_pool_.TakePendingRelayDestinations(obj_id).empty());
+  written_chunks.clear();
+  object_buffer_pool_.AddRelayDestination(obj_id, node_a, &written_chunks);
+  ASSERT_TRUE(written_chunks.empty());
+  ASSERT_EQ(object_buffer_pool_.TakePendingRelayDestinations(obj_id),
+            std::vector<NodeID>({node_a}));
+  ASSERT_TRUE(object_buffer_pool_.TakePendingRelayDestinations(obj_id).empty());
+
+  // Aborting the object drops its pending destinations.
+  object_buffer_pool_.AddRelayDestination(obj_id, node_a, &written_chunks);
+  object_buffer_pool_.AbortCreate(obj_id);
+  ASSERT_TRUE(object_buffer_pool_.TakePendingRelayDestinations(obj_id).empty());
+  AssertNoLeaks();
+}
+
+TEST(ObjectBufferPoolChunkSizeTest, TestAdaptiveChunkSize) {
+  ObjectBufferPool pool(std::make_shared<MockPlasmaClient>(),
+                        /*chunk_size=*/8000,
+                        /*min_chunk_size=*/1000);
+  // Small objects are split into chunks of the min size.
+  ASSERT_EQ(pool.GetChunkSize(0), 1000);
+  ASSERT_EQ(pool.GetChunkSize(500), 1000);
+  ASSERT_EQ(pool.GetNumChunks(500), 1);
+  ASSERT_EQ(pool.GetChunkSize(3000), 1000);
+  ASSERT_EQ(pool.GetNumChunks(3000), 3);
+  // Medium objects are split into a few chunks, rounded up to the min size.
+  ASSERT_EQ(pool.GetChunkSize(20000), 3000);
+  ASSERT_EQ(pool.GetNumChunks(20000), 7);
+  ASSERT_EQ(pool.GetBufferLength(0, 20000), 3000);
+  ASSERT_EQ(pool.GetBufferLength(6, 20000), 2000);
+  // Large objects are split into chunks of the max size.
+  ASSERT_EQ(pool.GetChunkSize(1000000), 8000);
+  ASSERT_EQ(pool.GetNumChunks(1000000), 125);
+}
+
 }  // namespace ray
 
 int main(int argc, char **argv) {
@@ -14,6 +14,8 @@
 
 #include "ray/object_manager/push_manager.h"
 
+#include <queue>
+
 #include "gtest/gtest.h"
 #include "ray/common/test_util.h"
 
@@ -25,7 +27,7 @@ TEST(TestPushManager, TestSingleTransfer) {
   auto node_id = NodeID::FromRandom();
   auto obj_id = ObjectID::FromRandom();
   PushManager pm(5);
-  pm.StartPush(node_id, obj_id, 10, [&](int64_t chunk_id) { results[chunk_id] = 1; });
+  pm.StartPush(node_id, obj_id, 10, 1, [&](int64_t chunk_id) { results[chunk_id] = 1; });
   ASSERT_EQ(pm.NumChunksInFlight(), 5);
   ASSERT_EQ(pm.NumChunksRemaining(), 10);
   ASSERT_EQ(pm.NumPushesInFlight(), 1);
@@ -45,7 +47,7 @@ TEST(TestPushManager, TestPushState) {
   {
     std::vector<int64_t> sent_chunks;
     PushManager::PushState state{
-        2, [&](int64_t chunk_id) { sent_chunks.push_back(chunk_id); }};
+        2, 1, [&](int64_t chunk_id) { sent_chunks.push_back(chunk_id); }};
     ASSERT_EQ(state.num_chunks, 2);
     ASSERT_EQ(state.next_chunk_id, 0);
     ASSERT_EQ(state.num_chunks_inflight, 0);
@@ -81,7 +83,7 @@ TEST(TestPushManager, TestPushState) {
   {
     std::vector<int64_t> sent_chunks;
     PushManager::PushState state{
-        3, [&](int64_t chunk_id) { sent_chunks.push_back(chunk_id); }};
+        3, 1, [&](int64_t chunk_id) { sent_chunks.push_back(chunk_id); }};
     ASSERT_TRUE(state.SendOneChunk());
     ASSERT_FALSE(state.AllChunksComplete());
     ASSERT_EQ(state.num_chunks, 3);
@@ -129,12 +131,12 @@ TEST(TestPushManager, TestRetryDuplicates) {
   PushManager pm(5);
 
   // First push request.
-  pm.StartPush(node_id, obj_id, 10, [&](int64_t chunk_id) { results[chunk_id] = 1; });
+  pm.StartPush(node_id, obj_id, 10, 1, [&](int64_t chunk_id) { results[chunk_id] = 1; });
   ASSERT_EQ(pm.NumChunksInFlight(), 5);
   ASSERT_EQ(pm.NumChunksRemaining(), 10);
   ASSERT_EQ(pm.NumPushesInFlight(), 1);
   // Second push request will resent the full chunks.
-  pm.StartPush(node_id, obj_id, 10, [&](int64_t chunk_id) { results[chunk_id] = 2; });
+  pm.StartPush(node_id, obj_id, 10, 1, [&](int64_t chunk_id) { results[chunk_id] = 2; });
   ASSERT_EQ(pm.NumChunksInFlight(), 5);
   ASSERT_EQ(pm.NumChunksRemaining(), 15);
   ASSERT_EQ(pm.NumPushesInFlight(), 1);
@@ -170,11 +172,11 @@ TEST(TestPushManager, TestMultipleTransfers) {
   int num_active1 = 0;
   int num_active2 = 0;
   PushManager pm(5);
-  pm.StartPush(node1, obj_id, 10, [&](int64_t chunk_id) {
+  pm.StartPush(node1, obj_id, 10, 1, [&](int64_t chunk_id) {
     results1[chunk_id] = 1;
     num_active1++;
   });
-  pm.StartPush(node2, obj_id, 10, [&](int64_t chunk_id) {
+  pm.StartPush(node2, obj_id, 10, 1, [&](int64_t chunk_id) {
     results2[chunk_id] = 2;
     num_active2++;
   });
@@ -201,6 +203,293 @@ TEST(TestPushManager, TestMultipleTransfers) {
   }
 }
 
+TEST(TestPushManager, TestCongestionWindow) {
+  auto node_id = NodeID::FromRandom();
+  auto obj_id = ObjectID::FromRandom();
+  const int64_t chunk_size = 1024;
+  double now = 0;
+  int num_sent = 0;
+  PushManager pm(8, /*congestion_control=*/true, [&]() { return now; });
+  pm.StartPush(node_id, obj_id, 1000, chunk_size, [&](int64_t chunk_id) { num_sent++; });
+  ASSERT_EQ(pm.GetWindow(node_id), 4);
+  ASSERT_EQ(pm.NumChunksInFlight(node_id), 4);
+
+  // In slow start, the window grows by one chunk per chunk without queueing
+  // delay, up to the max chunks in flight.
+  now = 0.1;
+  for (int i = 0; i < 4; i++) {
+    pm.OnChunkComplete(node_id, obj_id);
+  }
+  ASSERT_EQ(pm.GetWindow(node_id), 8);
+  ASSERT_EQ(pm.NumChunksInFlight(node_id), 8);
+  ASSERT_EQ(num_sent, 12);
+
+  // A slow chunk halves the window, but chunks that were in flight at the same
+  // time don't decrease it again.
+  now = 1;
+  pm.OnChunkComplete(node_id, obj_id);
+  ASSERT_EQ(pm.GetWindow(node_id), 4);
+  ASSERT_EQ(pm.NumChunksInFlight(node_id), 7);
+  for (int i = 0; i < 7; i++) {
+    pm.OnChunkComplete(node_id, obj_id);
+  }
+  ASSERT_EQ(pm.GetWindow(node_id), 4);
+  ASSERT_EQ(pm.NumChunksInFlight(node_id), 4);
+  ASSERT_EQ(num_sent, 16);
+
+  // Slow chunks sent after the decrease do.
+  now = 2;
+  for (int i = 0; i < 4; i++) {
+    pm.OnChunkComplete(node_id, obj_id);
+  }
+  ASSERT_EQ(pm.GetWindow(node_id), 2);
+  ASSERT_EQ(pm.NumChunksInFlight(node_id), 2);
+  ASSERT_EQ(num_sent, 18);
+
+  // After slow start, the window grows by one chunk per window of chunks without
+  // queueing delay.
+  now = 2.1;
+  for (int i = 0; i < 2; i++) {
+    pm.OnChunkComplete(node_id, obj_id);
+  }
+  EXPECT_DOUBLE_EQ(pm.GetWindow(node_id), 2.5 + 1 / 2.5);
+  ASSERT_EQ(pm.NumChunksInFlight(node_id), 2);
+  ASSERT_EQ(pm.NumChunksInFlight(), 2);
+  ASSERT_EQ(num_sent, 20);
+
+  // Throughput is measured over intervals of a second. 8 chunks completed
+  // between 1s and 2s.
+  ASSERT_EQ(pm.GetThroughput(node_id), 8 * chunk_size);
+}
+
+TEST(TestPushManager, TestRelayChunks) {
+  auto node_id = NodeID::FromRandom();
+  auto obj_id = ObjectID::FromRandom();
+  std::vector<int> sent_chunks;
+  PushManager pm(2);
+  // Relayed chunks are sent in the order they are received, within the limit of
+  // chunks in flight.
+  for (int i = 0; i < 3; i++) {
+    pm.RelayChunk(node_id, obj_id, 1, [&, i]() { sent_chunks.push_back(i); });
+  }
+  ASSERT_EQ(sent_chunks, std::vector<int>({0, 1}));
+  ASSERT_EQ(pm.NumChunksInFlight(), 2);
+  ASSERT_EQ(pm.NumChunksRemaining(), 3);
+
+  // The whole object isn't pushed while it is being relayed.
+  pm.StartPush(node_id, obj_id, 3, 1, [&](int64_t chunk_id) { FAIL(); });
+  ASSERT_EQ(pm.NumChunksRemaining(), 3);
+
+  pm.OnChunkComplete(node_id, obj_id);
+  ASSERT_EQ(sent_chunks, std::vector<int>({0, 1, 2}));
+  pm.OnChunkComplete(node_id, obj_id);
+  pm.OnChunkComplete(node_id, obj_id);
+  ASSERT_FALSE(pm.IsPushing(node_id, obj_id));
+  ASSERT_EQ(pm.NumChunksRemaining(), 0);
+
+  // Chunks of an object that is being pushed as a whole are not relayed.
+  int num_pushed = 0;
+  pm.StartPush(node_id, obj_id, 1, 1, [&](int64_t chunk_id) { num_pushed++; });
+  pm.RelayChunk(node_id, obj_id, 1, [&]() { FAIL(); });
+  ASSERT_EQ(num_pushed, 1);
+  ASSERT_EQ(pm.NumChunksRemaining(), 1);
+  pm.OnChunkComplete(node_id, obj_id);
+  ASSERT_EQ(pm.NumPushesInFlight(), 0);
+}
+
+TEST(TestPushManager, TestHandleNodeRemoved) {
+  auto node1 = NodeID::FromRandom();
+  auto node2 = NodeID::FromRandom();
+  auto obj_id = ObjectID::FromRandom();
+  int num_sent = 0;
+  PushManager pm(8);
+  pm.StartPush(node1, obj_id, 10, 1, [&](int64_t chunk_id) { num_sent++; });
+  pm.StartPush(node2, obj_id, 10, 1, [&](int64_t chunk_id) { num_sent++; });
+  ASSERT_EQ(pm.NumPeers(), 2);
+  ASSERT_EQ(pm.NumChunksInFlight(), 8);
+  ASSERT_EQ(pm.NumChunksRemaining(), 20);
+
+  // The chunks of node1 that were not sent yet are dropped, and the ones in flight are
+  // counted until they complete.
+  const int64_t node1_in_flight = pm.NumChunksInFlight(node1);
+  pm.HandleNodeRemoved(node1);
+  ASSERT_EQ(pm.NumPeers(), 1);
+  ASSERT_EQ(pm.NumPushesInFlight(), 1);
+  ASSERT_EQ(pm.NumChunksInFlight(), 8);
+  ASSERT_EQ(pm.NumChunksRemaining(), 10 + node1_in_flight);
+  ASSERT_EQ(pm.NumChunksInFlight(node1), 0);
+  for (int i = 0; i < node1_in_flight; i++) {
+    pm.OnChunkComplete(node1, obj_id);
+  }
+  ASSERT_EQ(pm.NumChunksRemaining(), 10);
+
+  // The freed capacity goes to node2.
+  for (int i = 0; i < 10; i++) {
+    pm.OnChunkComplete(node2, obj_id);
+  }
+  ASSERT_EQ(pm.NumChunksInFlight(), 0);
+  ASSERT_EQ(pm.NumChunksRemaining(), 0);
+  ASSERT_EQ(pm.NumPushesInFlight(), 0);
+  ASSERT_EQ(num_sent, 10 + node1_in_flight);
+}
+
+TEST(TestPushManager, TestNoCongestionControl) {
+  auto node_id = NodeID::FromRandom();
+  auto obj_id = ObjectID::FromRandom();
+  double now = 0;
+  PushManager pm(8, /*congestion_control=*/false, [&]() { return now; });
+  pm.StartPush(node_id, obj_id, 1000, 1024, [&](int64_t chunk_id) {});
+  for (int i = 0; i < 16; i++) {
+    now += 1 + i;
+    pm.OnChunkComplete(node_id, obj_id);
+  }
+  ASSERT_EQ(pm.GetWindow(node_id), 8);
+  ASSERT_EQ(pm.NumChunksInFlight(node_id), 8);
+}
+
+/// Simulates pushing an object to each of a set of destinations. Each destination
+/// receives chunks over a number of parallel lanes, one chunk at a time per lane
+/// with a fixed transfer time, so chunks queue up at destinations that can't keep
+/// up with the chunks in flight to them.
+class PushSimulation {
+ public:
+  struct Peer {
+    NodeID node_id;
+    ObjectID object_id;
+    int64_t num_chunks;
+    double transfer_time;
+    /// The time each lane is busy until.
+    std::vector<double> lanes;
+    int64_t num_chunks_completed = 0;
+    /// Max chunks in flight to this destination while pushes to other
+    /// destinations were still in progress.
+    int64_t max_chunks_in_flight = 0;
+    double finish_time = 0;
+  };
+
+  PushSimulation(int64_t max_chunks_in_flight, bool congestion_control)
+      : push_manager_(max_chunks_in_flight, congestion_control, [this]() {
+          return now_;
+        }) {}
+
+  void AddPeer(int64_t num_chunks, double transfer_time, int num_lanes) {
+    Peer peer;
+    peer.node_id = NodeID::FromRandom();
+    peer.object_id = ObjectID::FromRandom();
+    peer.num_chunks = num_chunks;
+    peer.transfer_time = transfer_time;
+    peer.lanes.resize(num_lanes, 0);
+    peers_.push_back(peer);
+  }
+
+  void Run() {
+    num_pushes_in_progress_ = peers_.size();
+    for (size_t i = 0; i < peers_.size(); i++) {
+      push_manager_.StartPush(peers_[i].node_id,
+                              peers_[i].object_id,
+                              peers_[i].num_chunks,
+                              kChunkSize,
+                              [this, i](int64_t chunk_id) { SendChunk(i); });
+    }
+    while (!events_.empty()) {
+      auto event = events_.top();
+      events_.pop();
+      now_ = event.first;
+      auto &peer = peers_[event.second];
+      if (++peer.num_chunks_completed == peer.num_chunks) {
+        peer.finish_time = now_;
+        num_pushes_in_progress_--;
+      }
+      push_manager_.OnChunkComplete(peer.node_id, peer.object_id);
+    }
+  }
+
+  const std::vector<Peer> &Peers() const { return peers_; }
+
+  const PushManager &GetPushManager() const { return push_manager_; }
+
+  static constexpr int64_t kChunkSize = 1024 * 1024;
+
+ private:
+  void SendChunk(size_t peer_index) {
+    auto &peer = peers_[peer_index];
+    auto lane = std::min_element(peer.lanes.begin(), peer.lanes.end());
+    *lane = std::max(*lane, now_ + kPropagationDelay) + peer.transfer_time;
+    events_.emplace(*lane, peer_index);
+    if (num_pushes_in_progress_ > 1) {
+      peer.max_chunks_in_flight = std::max(
+          peer.max_chunks_in_flight, push_manager_.NumChunksInFlight(peer.node_id) + 1);
+    }
+  }
+
+  static constexpr double kPropagationDelay = 0.005;
+  double now_ = 0;
+  PushManager push_manager_;
+  std::vector<Peer> peers_;
+  size_t num_pushes_in_progress_ = 0;
+  /// Chunk completion events of (time, peer index).
+  std::priority_queue<std::pair<double, size_t>,
+                      std::vector<std::pair<double, size_t>>,
+                      std::greater<std::pair<double, size_t>>>
+      events_;
+};
+
+TEST(TestPushManager, TestHeterogeneousPeersSimulation) {
+  const int64_t max_chunks_in_flight = 16;
+  const int64_t num_chunks = 200;
+  std::vector<double> fast_finish_times;
+  std::vector<int64_t> slow_max_chunks_in_flight;
+  for (bool congestion_control : {false, true}) {
+    PushSimulation simulation(max_chunks_in_flight, congestion_control);
+    // Three fast destinations that can receive 200 chunks/s each, and a slow one
+    // that can receive 5 chunks/s.
+    for (int i = 0; i < 3; i++) {
+      simulation.AddPeer(num_chunks, /*transfer_time=*/0.02, /*num_lanes=*/4);
+    }
+    simulation.AddPeer(num_chunks, /*transfer_time=*/0.2, /*num_lanes=*/1);
+    simulation.Run();
+
+    const auto &peers = simulation.Peers();
+    const auto &push_manager = simulation.GetPushManager();
+    double fast_finish_time = 0;
+    for (const auto &peer : peers) {
+      ASSERT_EQ(peer.num_chunks_completed, num_chunks);
+      RAY_LOG(INFO) << "Window " << push_manager.GetWindow(peer.node_id)
+                    << ", throughput "
+                    << push_manager.GetThroughput(peer.node_id) /
+                           PushSimulation::kChunkSize
+                    << " chunks/s, finished after " << peer.finish_time << "s.";
+    }
+    for (int i = 0; i < 3; i++) {
+      fast_finish_time = std::max(fast_finish_time, peers[i].finish_time);
+    }
+    fast_finish_times.push_back(fast_finish_time);
+    slow_max_chunks_in_flight.push_back(peers[3].max_chunks_in_flight);
+    RAY_LOG(INFO) << "Congestion control " << (congestion_control ? "on" : "off")
+                  << ": fast destinations finished after " << fast_finish_time
+                  << "s, the slow destination had up to "
+                  << peers[3].max_chunks_in_flight
+                  << " chunks in flight while they were in progress.";
+
+    if (congestion_control) {
+      // The window of each destination adapts to what it can receive.
+      for (int i = 0; i < 3; i++) {
+        ASSERT_GT(push_manager.GetWindow(peers[i].node_id),
+                  push_manager.GetWindow(peers[3].node_id));
+      }
+      const double slow_throughput =
+          push_manager.GetThroughput(peers[3].node_id) / PushSimulation::kChunkSize;
+      ASSERT_GT(slow_throughput, 4);
+      ASSERT_LT(slow_throughput, 6);
+    }
+  }
+  // The slow destination doesn't hog the in-flight budget, so the fast ones
+  // finish sooner.
+  ASSERT_LT(slow_max_chunks_in_flight[1], slow_max_chunks_in_flight[0]);
+  ASSERT_LE(slow_max_chunks_in_flight[1], max_chunks_in_flight / 2);
+  ASSERT_LT(fast_finish_times[1], fast_finish_times[0]);
+}
+
 }  // namespace ray
 
 int main(int argc, char **argv) {
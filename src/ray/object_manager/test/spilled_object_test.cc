@@ -14,6 +14,7 @@
 
 #include <boost/endian/conversion.hpp>
 #include <fstream>
+#include <random>
 
 #include "absl/strings/str_format.h"
 #include "gtest/gtest.h"
@@ -292,6 +293,119 @@ TEST(SpilledObjectReaderTest, CreateSpilledObjectReader) {
   ASSERT_FALSE(SpilledObjectReader::CreateSpilledObjectReader(object_url1).has_value());
 }
 
+TEST(SpilledObjectReaderTest, ReadCompressedDataSection) {
+  const uint64_t block_size = 1024;
+  // A compressible block, an incompressible block that is stored as is, and a
+  // partial compressible block.
+  std::string data(block_size, 'a');
+  std::mt19937 gen(0);
+  for (uint64_t i = 0; i < block_size; i++) {
+    data.push_back(static_cast<char>(gen()));
+  }
+  data.append(100, 'b');
+  std::string metadata("metadata");
+  rpc::Address owner_address;
+  owner_address.set_ip_address("127.0.0.1");
+  std::string address_str;
+  owner_address.SerializeToString(&address_str);
+
+  std::vector<std::string> blocks;
+  for (uint64_t offset = 0; offset < data.size(); offset += block_size) {
+    auto block = data.substr(offset, block_size);
+    std::string compressed;
+    if (CompressBlock(SpillCodec::kZlib, block.data(), block.size(), &compressed)) {
+      blocks.push_back(compressed);
+    } else {
+      blocks.push_back(block);
+    }
+  }
+  ASSERT_LT(blocks[0].size(), block_size);
+  ASSERT_EQ(blocks[1].size(), block_size);
+
+  std::string str;
+  auto append_uint64 = [&str](uint64_t value) {
+    value = boost::endian::native_to_little(value);
+    str.append((char *)(&value), 8);
+  };
+  append_uint64(address_str.size() | kSpilledObjectCompressedFlag);
+  append_uint64(metadata.size());
+  append_uint64(data.size());
+  append_uint64(static_cast<uint64_t>(SpillCodec::kZlib));
+  append_uint64(block_size);
+  for (const auto &block : blocks) {
+    append_uint64(block.size());
+  }
+  str.append(address_str);
+  str.append(metadata);
+  for (const auto &block : blocks) {
+    str.append(block);
+  }
+  std::string tmp_file = ray::JoinPaths(
+      ray::GetUserTempDir(), "spilled_object_test" + ObjectID::FromRandom().Hex());
+  std::ofstream f(tmp_file, std::ios::binary);
+  RAY_CHECK(f.write(str.c_str(), str.size()));
+  f.close();
+
+  auto reader = SpilledObjectReader::CreateSpilledObjectReader(
+      absl::StrFormat("%s?offset=0&size=%d", tmp_file, str.size()));
+  ASSERT_TRUE(reader.has_value());
+  ASSERT_EQ(reader->GetDataSize(), data.size());
+  ASSERT_EQ(reader->GetMetadataSize(), metadata.size());
+  ASSERT_EQ(reader->GetOwnerAddress().ip_address(), "127.0.0.1");
+  std::string actual_metadata(metadata.size(), '\0');
+  ASSERT_TRUE(
+      reader->ReadFromMetadataSection(0, metadata.size(), &actual_metadata[0]));
+  ASSERT_EQ(actual_metadata, metadata);
+
+  // Read ranges that start and end inside, and span, each kind of block.
+  for (uint64_t offset : {0, 1, 1000, 1024, 1500, 2048, 2100}) {
+    for (uint64_t size : {0, 1, 24, 1024, 1200}) {
+      if (offset + size > data.size()) {
+        continue;
+      }
+      std::string output(size, '\0');
+      ASSERT_TRUE(reader->ReadFromDataSection(offset, size, &output[0]));
+      ASSERT_EQ(output, data.substr(offset, size)) << offset << " " << size;
+    }
+  }
+  std::string output(1, '\0');
+  ASSERT_FALSE(reader->ReadFromDataSection(data.size(), 1, &output[0]));
+
+  // The legacy parser, without compression support, rejects it.
+  std::ifstream is(tmp_file, std::ios::binary);
+  uint64_t data_offset, data_size, metadata_offset, metadata_size;
+  rpc::Address address;
+  ASSERT_FALSE(SpilledObjectReader::ParseObjectHeader(
+      is, 0, data_offset, data_size, metadata_offset, metadata_size, address));
+}
+
+TEST(SpilledObjectReaderTest, ReadAfterFileDeleted) {
+  std::string data(1024 * 1024, 'd');
+  auto object_url = CreateSpilledObjectReaderOnTmp(
+      10 /* object_offset */, data, "metadata", ray::rpc::Address());
+  auto reader = SpilledObjectReader::CreateSpilledObjectReader(object_url);
+  ASSERT_TRUE(reader.has_value());
+  // Copies of the reader share the open file, so chunks can still be read after
+  // the spilled object is deleted.
+  auto copy = std::make_shared<SpilledObjectReader>(std::move(reader.value()));
+  reader.reset();
+  std::string file_path;
+  uint64_t object_offset = 0;
+  uint64_t object_size = 0;
+  ASSERT_TRUE(SpilledObjectReader::ParseObjectURL(
+      object_url, file_path, object_offset, object_size));
+  ASSERT_TRUE(std::remove(file_path.c_str()) == 0);
+
+  ChunkObjectReader chunk_reader(copy, 100 * 1024);
+  std::string output;
+  for (uint64_t i = 0; i < chunk_reader.GetNumChunks(); i++) {
+    auto chunk = chunk_reader.GetChunk(i);
+    ASSERT_TRUE(chunk.has_value());
+    output.append(chunk.value());
+  }
+  ASSERT_EQ(output, data + "metadata");
+}
+
 template <class T>
 std::shared_ptr<T> CreateObjectReader(std::string &data,
                                       std::string &metadata,
@@ -411,6 +525,45 @@ TYPED_TEST(ObjectReaderTest, GetChunk) {
   }
 }
 
+TEST(ChunkObjectReaderTest, GetChunkView) {
+  std::string data("alotofdata");
+  std::string metadata("metadata");
+  rpc::Address owner_address;
+
+  // Spilled objects can only be read by copying.
+  ChunkObjectReader spilled_reader(
+      CreateObjectReader<SpilledObjectReader>(data, metadata, owner_address),
+      3 /* chunk_size */);
+  ASSERT_FALSE(spilled_reader.GetChunkView(0).has_value());
+
+  // So can objects whose metadata doesn't follow the data.
+  ChunkObjectReader separate_reader(
+      CreateObjectReader<MemoryObjectReader>(data, metadata, owner_address),
+      3 /* chunk_size */);
+  ASSERT_FALSE(separate_reader.GetChunkView(0).has_value());
+
+  // Plasma objects store the metadata right after the data.
+  std::string object = data + metadata;
+  plasma::ObjectBuffer object_buffer;
+  auto buffer =
+      std::make_shared<SharedMemoryBuffer>((uint8_t *)object.data(), object.size());
+  object_buffer.data = SharedMemoryBuffer::Slice(buffer, 0, data.size());
+  object_buffer.metadata =
+      SharedMemoryBuffer::Slice(buffer, data.size(), metadata.size());
+  auto memory_reader =
+      std::make_shared<MemoryObjectReader>(std::move(object_buffer), owner_address);
+  for (uint64_t chunk_size : {1, 2, 3, 5, 100}) {
+    ChunkObjectReader reader(memory_reader, chunk_size);
+    for (uint64_t i = 0; i < reader.GetNumChunks(); i++) {
+      auto chunk_view = reader.GetChunkView(i);
+      ASSERT_TRUE(chunk_view.has_value());
+      // The view references the object without copying it.
+      ASSERT_EQ(object.data() + i * chunk_size, chunk_view->data());
+      ASSERT_EQ(reader.GetChunk(i).value(), std::string(chunk_view.value()));
+    }
+  }
+}
+
 TEST(StringAllocationTest, TestNoCopyWhenStringMoved) {
   // Since protobuf always allocate string on heap,
   // move assign a string field doesn't copy the data.
@@ -0,0 +1,143 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <grpcpp/impl/codegen/proto_utils.h>
+
+#include <ctime>
+
+#include "gtest/gtest.h"
+#include "ray/rpc/object_manager/zero_copy_push_request.h"
+#include "ray/util/logging.h"
+#include "ray/util/util.h"
+
+namespace ray {
+namespace rpc {
+namespace {
+const uint64_t kMB = 1024 * 1024;
+
+PushRequest CreatePushRequestHeader(uint64_t chunk_index) {
+  PushRequest header;
+  header.set_push_id(std::string(16, 'p'));
+  header.set_object_id(std::string(28, 'o'));
+  header.mutable_owner_address()->set_raylet_id(std::string(28, 'r'));
+  header.mutable_owner_address()->set_ip_address("127.0.0.1");
+  header.mutable_owner_address()->set_port(1234);
+  header.set_node_id(std::string(28, 'n'));
+  header.set_data_size(1024 * kMB);
+  header.set_metadata_size(4);
+  header.set_chunk_index(chunk_index);
+  return header;
+}
+
+// Returns the contents of the byte buffer as a single string.
+std::string Flatten(const grpc::ByteBuffer &buffer) {
+  std::vector<grpc::Slice> slices;
+  RAY_CHECK(buffer.Dump(&slices).ok());
+  std::string result;
+  for (const auto &slice : slices) {
+    result.append(reinterpret_cast<const char *>(slice.begin()), slice.size());
+  }
+  return result;
+}
+}  // namespace
+
+TEST(ZeroCopyPushRequestTest, SerializesAsPushRequest) {
+  for (uint64_t data_size : std::vector<uint64_t>{0, 1, 127, 128, 5 * kMB}) {
+    auto data = std::make_shared<std::string>(data_size, 'd');
+    ZeroCopyPushRequest request;
+    request.header = CreatePushRequestHeader(3);
+    request.data = *data;
+    request.data_holder = data;
+
+    grpc::ByteBuffer buffer;
+    bool own_buffer = false;
+    ASSERT_TRUE(grpc::SerializationTraits<ZeroCopyPushRequest>::Serialize(
+                    request, &buffer, &own_buffer)
+                    .ok());
+    ASSERT_TRUE(own_buffer);
+    request.data_holder.reset();
+    // The byte buffer keeps the data alive.
+    ASSERT_EQ(data.use_count(), 2);
+
+    // The data is referenced by the byte buffer instead of copied.
+    std::vector<grpc::Slice> slices;
+    ASSERT_TRUE(buffer.Dump(&slices).ok());
+    ASSERT_EQ(slices.size(), 2);
+    ASSERT_EQ(reinterpret_cast<const char *>(slices[1].begin()), data->data());
+    slices.clear();
+
+    // The receiver parses it as a regular push request.
+    PushRequest parsed;
+    ASSERT_TRUE(parsed.ParseFromString(Flatten(buffer)));
+    PushRequest expected = CreatePushRequestHeader(3);
+    expected.set_data(*data);
+    ASSERT_EQ(parsed.SerializeAsString(), expected.SerializeAsString());
+
+    buffer.Clear();
+    ASSERT_EQ(data.use_count(), 1);
+  }
+}
+
+// Performance benchmark for serializing the chunks of a large object into gRPC
+// byte buffers, by copying each chunk into the request and by referencing it.
+// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST(ZeroCopyPushRequestTest, DISABLED_SerializeChunksPerf) {
+  const uint64_t object_size = 1024 * kMB;
+  const uint64_t chunk_size = 5 * kMB;
+  auto object = std::make_shared<std::string>(object_size, 'd');
+
+  auto run = [&](const std::string &name, bool zero_copy) {
+    int64_t start_ms = current_time_ms();
+    std::clock_t start_cpu = std::clock();
+    uint64_t num_bytes = 0;
+    for (uint64_t offset = 0; offset < object_size; offset += chunk_size) {
+      grpc::ByteBuffer buffer;
+      bool own_buffer;
+      absl::string_view chunk(object->data() + offset, chunk_size);
+      if (zero_copy) {
+        ZeroCopyPushRequest request;
+        request.header = CreatePushRequestHeader(offset / chunk_size);
+        request.data = chunk;
+        request.data_holder = object;
+        RAY_CHECK(grpc::SerializationTraits<ZeroCopyPushRequest>::Serialize(
+                      request, &buffer, &own_buffer)
+                      .ok());
+      } else {
+        PushRequest request = CreatePushRequestHeader(offset / chunk_size);
+        request.set_data(std::string(chunk));
+        RAY_CHECK(grpc::SerializationTraits<PushRequest>::Serialize(
+                      request, &buffer, &own_buffer)
+                      .ok());
+      }
+      num_bytes += buffer.Length();
+    }
+    int64_t duration_ms = std::max<int64_t>(current_time_ms() - start_ms, 1);
+    double cpu_ms = 1000.0 * (std::clock() - start_cpu) / CLOCKS_PER_SEC;
+    RAY_LOG(INFO) << name << ": serialized " << num_bytes / kMB << " MB in "
+                  << duration_ms << " ms (" << num_bytes / kMB * 1000 / duration_ms
+                  << " MB/s), " << cpu_ms * 1024 * kMB / num_bytes
+                  << " ms of CPU per GB.";
+  };
+
+  run("Copy", /*zero_copy=*/false);
+  run("Zero copy", /*zero_copy=*/true);
+}
+
+}  // namespace rpc
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
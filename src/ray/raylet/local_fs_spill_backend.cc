@@ -0,0 +1,477 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/local_fs_spill_backend.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <cstring>
+#include <filesystem>
+
+#include "absl/strings/str_cat.h"
+#include "nlohmann/json.hpp"
+#include "ray/common/file_system_monitor.h"
+#include "ray/common/ray_config.h"
+#include "ray/object_manager/spilled_object_reader.h"
+#include "ray/util/logging.h"
+#include "ray/util/util.h"
+
+extern "C" {
+#include "ray/thirdparty/aligned_alloc.h"
+}
+
+using json = nlohmann::json;
+
+namespace ray {
+
+namespace raylet {
+
+namespace {
+
+/// The subdirectory of each spill directory that objects are spilled to. Keep
+/// in sync with DEFAULT_OBJECT_PREFIX in ray_constants.py.
+const char kSpillDirName[] = "ray_spilled_objects";
+
+/// The size of the buffer that small objects and headers are fused in before they
+/// are written.
+const size_t kWriteBufferSize = 8 * 1024 * 1024;
+
+/// Buffers and file offsets written with O_DIRECT must be aligned to this.
+const size_t kDirectIOAlignment = 4096;
+
+/// Serialize a uint64_t as 8 little-endian bytes, to be read back by
+/// SpilledObjectReader::ToUINT64.
+void WriteUINT64(uint64_t value, char *output) {
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    output[i] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+}
+
+#ifndef _WIN32
+/// Appends bytes to a new file. Small writes are fused in an aligned buffer. With
+/// direct IO, all bytes go through the buffer, so that every write to the file is
+/// aligned, and the file is truncated to its real size when it is closed.
+class SpillFileWriter {
+ public:
+  explicit SpillFileWriter(bool use_direct_io) : use_direct_io_(use_direct_io) {}
+
+  ~SpillFileWriter() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+    if (buffer_ != nullptr) {
+      aligned_free(buffer_);
+    }
+  }
+
+  Status Open(const std::string &path) {
+    int flags = O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC;
+#ifdef O_DIRECT
+    if (use_direct_io_) {
+      fd_ = open(path.c_str(), flags | O_DIRECT, 0644);
+      if (fd_ < 0 && errno == EINVAL) {
+        // The filesystem doesn't support direct IO, e.g., tmpfs.
+        RAY_LOG_EVERY_MS(WARNING, 60 * 1000)
+            << "Direct IO is not supported for " << path
+            << ", spilling objects through the page cache instead.";
+        use_direct_io_ = false;
+      }
+    }
+#else
+    use_direct_io_ = false;
+#endif
+    if (fd_ < 0) {
+      fd_ = open(path.c_str(), flags, 0644);
+    }
+    if (fd_ < 0) {
+      return Status::IOError(
+          absl::StrCat("Failed to open ", path, ": ", std::strerror(errno)));
+    }
+    buffer_ = static_cast<char *>(aligned_malloc(kWriteBufferSize, kDirectIOAlignment));
+    RAY_CHECK(buffer_ != nullptr);
+    return Status::OK();
+  }
+
+  Status Append(const char *data, size_t size) {
+    if (!use_direct_io_ && size >= kWriteBufferSize / 2) {
+      // Write large objects straight from plasma.
+      RAY_RETURN_NOT_OK(FlushBuffer(/*final=*/true));
+      RAY_RETURN_NOT_OK(WriteAll(data, size));
+      return Status::OK();
+    }
+    while (size > 0) {
+      size_t n = std::min(size, kWriteBufferSize - buffer_size_);
+      std::memcpy(buffer_ + buffer_size_, data, n);
+      buffer_size_ += n;
+      data += n;
+      size -= n;
+      if (buffer_size_ == kWriteBufferSize) {
+        RAY_RETURN_NOT_OK(FlushBuffer(/*final=*/false));
+      }
+    }
+    return Status::OK();
+  }
+
+  /// Flush the remaining bytes and close the file.
+  Status Close() {
+    RAY_RETURN_NOT_OK(FlushBuffer(/*final=*/true));
+    if (use_direct_io_ && ftruncate(fd_, size_) != 0) {
+      return Status::IOError(
+          absl::StrCat("Failed to truncate spill file: ", std::strerror(errno)));
+    }
+    int fd = fd_;
+    fd_ = -1;
+    if (close(fd) != 0) {
+      return Status::IOError(
+          absl::StrCat("Failed to close spill file: ", std::strerror(errno)));
+    }
+    return Status::OK();
+  }
+
+  /// The number of bytes appended so far.
+  uint64_t Size() const { return size_ + buffer_size_; }
+
+ private:
+  /// Write out the buffer. With direct IO, only whole blocks are written unless
+  /// this is the final flush, in which case the last block is padded with zeros.
+  Status FlushBuffer(bool final) {
+    size_t num_bytes = buffer_size_;
+    if (use_direct_io_) {
+      if (final) {
+        num_bytes = (num_bytes + kDirectIOAlignment - 1) / kDirectIOAlignment *
+                    kDirectIOAlignment;
+        std::memset(buffer_ + buffer_size_, 0, num_bytes - buffer_size_);
+      } else {
+        num_bytes = num_bytes / kDirectIOAlignment * kDirectIOAlignment;
+      }
+    }
+    if (num_bytes == 0) {
+      return Status::OK();
+    }
+    RAY_RETURN_NOT_OK(WriteAll(buffer_, num_bytes));
+    if (num_bytes >= buffer_size_) {
+      // Don't count the padding.
+      size_ -= num_bytes - buffer_size_;
+      buffer_size_ = 0;
+    } else {
+      std::memmove(buffer_, buffer_ + num_bytes, buffer_size_ - num_bytes);
+      buffer_size_ -= num_bytes;
+    }
+    return Status::OK();
+  }
+
+  Status WriteAll(const char *data, size_t size) {
+    while (size > 0) {
+      ssize_t n = pwrite(fd_, data, size, size_);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return Status::IOError(
+            absl::StrCat("Failed to write spill file: ", std::strerror(errno)));
+      }
+      data += n;
+      size -= n;
+      size_ += n;
+    }
+    return Status::OK();
+  }
+
+  bool use_direct_io_;
+  int fd_ = -1;
+  char *buffer_ = nullptr;
+  size_t buffer_size_ = 0;
+  /// The number of bytes written to the file.
+  uint64_t size_ = 0;
+};
+#endif
+
+}  // namespace
+
+std::unique_ptr<LocalFsSpillBackend> LocalFsSpillBackend::Create(
+    const std::string &spilling_config,
+    const std::string &store_socket_name,
+    int num_threads) {
+#ifdef _WIN32
+  return nullptr;
+#else
+  if (!RayConfig::instance().object_spilling_native_fs() || spilling_config.empty()) {
+    return nullptr;
+  }
+  try {
+    if (json::parse(spilling_config).at("type") != "filesystem") {
+      // Other storages, such as S3, are spilled to by IO workers.
+      return nullptr;
+    }
+  } catch (json::exception &ex) {
+    RAY_LOG(ERROR) << "Failed to parse spilling config, spilling objects with IO "
+                      "workers instead. Error message: "
+                   << ex.what();
+    return nullptr;
+  }
+  auto directory_paths = ParseSpillingPaths(spilling_config);
+  if (directory_paths.empty()) {
+    return nullptr;
+  }
+  auto codec = ParseSpillCodec(RayConfig::instance().object_spilling_compression());
+  if (!codec) {
+    RAY_LOG(ERROR) << "Unknown object spilling compression "
+                   << RayConfig::instance().object_spilling_compression()
+                   << ", spilling objects uncompressed.";
+    codec = SpillCodec::kNone;
+  }
+  auto store_client = std::make_shared<plasma::PlasmaClient>();
+  RAY_CHECK_OK(store_client->Connect(store_socket_name.c_str(), "", 0, 300));
+  return std::make_unique<LocalFsSpillBackend>(
+      directory_paths,
+      std::move(store_client),
+      num_threads,
+      RayConfig::instance().object_spilling_direct_io(),
+      *codec,
+      RayConfig::instance().object_spilling_compression_block_size());
+#endif
+}
+
+LocalFsSpillBackend::LocalFsSpillBackend(
+    const std::vector<std::string> &directory_paths,
+    std::shared_ptr<plasma::PlasmaClientInterface> store_client,
+    int num_threads,
+    bool use_direct_io,
+    SpillCodec codec,
+    uint64_t compression_block_size)
+    : store_client_(std::move(store_client)),
+      use_direct_io_(use_direct_io),
+      codec_(codec),
+      compression_block_size_(compression_block_size),
+      spill_pool_(num_threads),
+      restore_pool_(num_threads) {
+  RAY_CHECK(!directory_paths.empty());
+  RAY_CHECK(compression_block_size_ > 0);
+  for (const auto &path : directory_paths) {
+    auto directory_path = std::filesystem::path(path) / kSpillDirName;
+    std::error_code ec;
+    std::filesystem::create_directories(directory_path, ec);
+    RAY_CHECK(!ec) << "Failed to create spill directory " << directory_path << ": "
+                   << ec.message();
+    directory_paths_.push_back(directory_path.string());
+  }
+  RAY_LOG(INFO) << "Spilling objects to the local filesystem with " << num_threads
+                << " threads" << (use_direct_io_ ? " and direct IO." : ".");
+}
+
+LocalFsSpillBackend::~LocalFsSpillBackend() {
+  spill_pool_.join();
+  restore_pool_.join();
+}
+
+void LocalFsSpillBackend::SpillObjects(std::vector<ObjectToSpill> objects,
+                                       SpillCallback callback) {
+  const auto &directory_path =
+      directory_paths_[next_directory_index_++ % directory_paths_.size()];
+  // Use the same file names as IO workers.
+  std::string uuid = GenerateUUIDV4();
+  uuid.erase(std::remove(uuid.begin(), uuid.end(), '-'), uuid.end());
+  auto path = (std::filesystem::path(directory_path) /
+               absl::StrCat(uuid, "-multi-", objects.size()))
+                  .string();
+  boost::asio::post(spill_pool_,
+                    [this,
+                     path = std::move(path),
+                     objects = std::move(objects),
+                     callback = std::move(callback)]() {
+                      std::vector<std::string> object_urls;
+                      auto status = WriteSpillFile(path, objects, &object_urls);
+                      if (!status.ok()) {
+                        std::error_code ec;
+                        std::filesystem::remove(path, ec);
+                        object_urls.clear();
+                      }
+                      callback(status, std::move(object_urls));
+                    });
+}
+
+Status LocalFsSpillBackend::WriteSpillFile(const std::string &path,
+                                           const std::vector<ObjectToSpill> &objects,
+                                           std::vector<std::string> *object_urls) {
+#ifdef _WIN32
+  return Status::NotImplemented("Spilling objects natively is not supported on Windows");
+#else
+  SpillFileWriter writer(use_direct_io_);
+  RAY_RETURN_NOT_OK(writer.Open(path));
+  for (const auto &object : objects) {
+    const uint64_t offset = writer.Size();
+    const uint64_t metadata_size = object.metadata ? object.metadata->Size() : 0;
+    const uint64_t data_size = object.data ? object.data->Size() : 0;
+    const char *data =
+        data_size > 0 ? reinterpret_cast<const char *>(object.data->Data()) : nullptr;
+    std::vector<std::string> blocks;
+    const bool compressed = data_size > 0 && CompressObjectData(*object.data, &blocks);
+    uint64_t address_size = object.owner_address.size();
+    if (compressed) {
+      address_size |= kSpilledObjectCompressedFlag;
+    }
+    std::string header(3 * sizeof(uint64_t), '\0');
+    WriteUINT64(address_size, &header[0]);
+    WriteUINT64(metadata_size, &header[sizeof(uint64_t)]);
+    WriteUINT64(data_size, &header[2 * sizeof(uint64_t)]);
+    if (compressed) {
+      header.resize((5 + blocks.size()) * sizeof(uint64_t));
+      char *field = &header[3 * sizeof(uint64_t)];
+      WriteUINT64(static_cast<uint64_t>(codec_), field);
+      WriteUINT64(compression_block_size_, field + sizeof(uint64_t));
+      field += 2 * sizeof(uint64_t);
+      for (size_t i = 0; i < blocks.size(); i++) {
+        WriteUINT64(blocks[i].empty() ? BlockSize(data_size, i) : blocks[i].size(),
+                    field + i * sizeof(uint64_t));
+      }
+    }
+    RAY_RETURN_NOT_OK(writer.Append(header.data(), header.size()));
+    RAY_RETURN_NOT_OK(
+        writer.Append(object.owner_address.data(), object.owner_address.size()));
+    if (metadata_size > 0) {
+      RAY_RETURN_NOT_OK(writer.Append(
+          reinterpret_cast<const char *>(object.metadata->Data()), metadata_size));
+    }
+    if (compressed) {
+      for (size_t i = 0; i < blocks.size(); i++) {
+        if (blocks[i].empty()) {
+          RAY_RETURN_NOT_OK(writer.Append(data + i * compression_block_size_,
+                                          BlockSize(data_size, i)));
+        } else {
+          RAY_RETURN_NOT_OK(writer.Append(blocks[i].data(), blocks[i].size()));
+        }
+      }
+    } else if (data_size > 0) {
+      RAY_RETURN_NOT_OK(writer.Append(data, data_size));
+    }
+    object_urls->push_back(
+        absl::StrCat(path, "?offset=", offset, "&size=", writer.Size() - offset));
+  }
+  return writer.Close();
+#endif
+}
+
+bool LocalFsSpillBackend::CompressObjectData(const Buffer &data,
+                                             std::vector<std::string> *blocks) const {
+  if (codec_ == SpillCodec::kNone) {
+    return false;
+  }
+  const uint64_t data_size = data.Size();
+  const char *input = reinterpret_cast<const char *>(data.Data());
+  const uint64_t num_blocks =
+      (data_size + compression_block_size_ - 1) / compression_block_size_;
+  blocks->resize(num_blocks);
+  // The extended header stores the codec, the block size and the size of each
+  // block.
+  uint64_t compressed_size = (2 + num_blocks) * sizeof(uint64_t);
+  for (uint64_t i = 0; i < num_blocks; i++) {
+    const uint64_t block_size = BlockSize(data_size, i);
+    if (CompressBlock(
+            codec_, input + i * compression_block_size_, block_size, &(*blocks)[i])) {
+      compressed_size += (*blocks)[i].size();
+    } else {
+      (*blocks)[i].clear();
+      compressed_size += block_size;
+    }
+  }
+  if (compressed_size >= data_size) {
+    blocks->clear();
+    return false;
+  }
+  return true;
+}
+
+void LocalFsSpillBackend::RestoreSpilledObject(const ObjectID &object_id,
+                                               const std::string &object_url,
+                                               RestoreCallback callback) {
+  boost::asio::post(
+      restore_pool_,
+      [this, object_id, object_url, callback = std::move(callback)]() {
+        int64_t bytes_restored = 0;
+        auto status = RestoreObject(object_id, object_url, &bytes_restored);
+        callback(status, bytes_restored);
+      });
+}
+
+Status LocalFsSpillBackend::RestoreObject(const ObjectID &object_id,
+                                          const std::string &object_url,
+                                          int64_t *bytes_restored) {
+  auto reader = SpilledObjectReader::CreateSpilledObjectReader(object_url);
+  if (!reader) {
+    return Status::IOError(absl::StrCat("Failed to read spilled object ", object_url));
+  }
+  std::string metadata(reader->GetMetadataSize(), '\0');
+  if (!reader->ReadFromMetadataSection(0, metadata.size(), metadata.data())) {
+    return Status::IOError(
+        absl::StrCat("Failed to read metadata of spilled object ", object_url));
+  }
+  std::shared_ptr<Buffer> data;
+  auto status = store_client_->CreateAndSpillIfNeeded(
+      object_id,
+      reader->GetOwnerAddress(),
+      static_cast<int64_t>(reader->GetDataSize()),
+      reinterpret_cast<const uint8_t *>(metadata.data()),
+      static_cast<int64_t>(metadata.size()),
+      &data,
+      plasma::flatbuf::ObjectSource::RestoredFromStorage);
+  if (status.IsObjectExists()) {
+    return Status::OK();
+  }
+  RAY_RETURN_NOT_OK(status);
+  if (!reader->ReadFromDataSection(
+          0, reader->GetDataSize(), reinterpret_cast<char *>(data->Data()))) {
+    RAY_CHECK_OK(store_client_->Release(object_id));
+    RAY_CHECK_OK(store_client_->Abort(object_id));
+    return Status::IOError(
+        absl::StrCat("Failed to read data of spilled object ", object_url));
+  }
+  RAY_RETURN_NOT_OK(store_client_->Seal(object_id));
+  RAY_RETURN_NOT_OK(store_client_->Release(object_id));
+  *bytes_restored = reader->GetDataSize();
+  return Status::OK();
+}
+
+void LocalFsSpillBackend::DeleteSpilledObjects(std::vector<std::string> object_urls,
+                                               DeleteCallback callback) {
+  boost::asio::post(
+      restore_pool_,
+      [object_urls = std::move(object_urls), callback = std::move(callback)]() {
+        Status status;
+        for (const auto &object_url : object_urls) {
+          auto parsed_url = ParseURL(object_url);
+          auto it = parsed_url->find("url");
+          if (it == parsed_url->end()) {
+            status = Status::Invalid(absl::StrCat("Invalid spilled URL ", object_url));
+            continue;
+          }
+          std::error_code ec;
+          std::filesystem::remove(it->second, ec);
+          if (ec) {
+            status = Status::IOError(
+                absl::StrCat("Failed to delete ", it->second, ": ", ec.message()));
+          }
+        }
+        callback(status);
+      });
+}
+
+}  // namespace raylet
+
+}  // namespace ray
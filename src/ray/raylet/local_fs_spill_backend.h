@@ -0,0 +1,167 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <boost/asio/thread_pool.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ray/common/buffer.h"
+#include "ray/common/id.h"
+#include "ray/common/status.h"
+#include "ray/object_manager/plasma/client.h"
+#include "ray/object_manager/spill_compression.h"
+
+namespace ray {
+
+namespace raylet {
+
+/// Spills objects to and restores them from the local filesystem inside the
+/// raylet, instead of sending them through Python IO workers.
+///
+/// Objects are fused into files with the same layout as the Python
+/// FileSystemStorage, so that they can be read back with SpilledObjectReader:
+///     address_size        (8 bytes),
+///     metadata_size       (8 bytes),
+///     data_size           (8 bytes),
+///     serialized_address  (address_size bytes),
+///     metadata_payload    (metadata_size bytes),
+///     data_payload        (data_size bytes)
+/// and each object is identified by a URL of the form
+/// {path}?offset={offset}&size={size}.
+///
+/// If a codec is given, the data payload of each object is compressed in blocks,
+/// using the extended header described in SpilledObjectReader::ParseObjectHeader.
+/// Objects that don't shrink are written in the layout above. Files with
+/// compressed objects can't be read by IO workers.
+///
+/// Spills, restores and deletes run on thread pools. Callbacks are called from
+/// these threads, so callers should post them back to their own event loop.
+/// Restores run on a separate pool from spills, since restoring an object can
+/// block until other objects have been spilled to make room for it.
+///
+/// The methods of this class should be called from a single thread.
+class LocalFsSpillBackend {
+ public:
+  /// An object to spill. The buffers must stay valid until the spill callback
+  /// is called.
+  struct ObjectToSpill {
+    ObjectID object_id;
+    /// The serialized rpc::Address of the object's owner.
+    std::string owner_address;
+    std::shared_ptr<Buffer> metadata;
+    std::shared_ptr<Buffer> data;
+  };
+
+  using SpillCallback =
+      std::function<void(const Status &status, std::vector<std::string> object_urls)>;
+  using RestoreCallback =
+      std::function<void(const Status &status, int64_t bytes_restored)>;
+  using DeleteCallback = std::function<void(const Status &status)>;
+
+  /// Create a backend if the spilling config uses the local filesystem and native
+  /// spilling is enabled by `object_spilling_native_fs`.
+  ///
+  /// \param spilling_config The JSON object spilling config.
+  /// \param store_socket_name The socket of the plasma store to restore objects to.
+  /// \param num_threads The number of threads to spill with, and to restore with.
+  /// \return The backend, or nullptr if objects should be spilled by IO workers.
+  static std::unique_ptr<LocalFsSpillBackend> Create(const std::string &spilling_config,
+                                                     const std::string &store_socket_name,
+                                                     int num_threads);
+
+  /// \param directory_paths The directories to spill to, round-robin. A
+  ///                        subdirectory is created in each of them.
+  /// \param store_client The plasma client to restore objects with. It should not
+  ///                     be shared with the raylet's event loop, since restoring an
+  ///                     object may block until there is room for it.
+  /// \param num_threads The number of threads to spill with, and to restore with.
+  /// \param use_direct_io Whether to write spill files with O_DIRECT, bypassing
+  ///                      the page cache.
+  /// \param codec The codec to compress data payloads with.
+  /// \param compression_block_size The number of bytes compressed together.
+  LocalFsSpillBackend(const std::vector<std::string> &directory_paths,
+                      std::shared_ptr<plasma::PlasmaClientInterface> store_client,
+                      int num_threads,
+                      bool use_direct_io,
+                      SpillCodec codec = SpillCodec::kNone,
+                      uint64_t compression_block_size = 1024 * 1024);
+
+  ~LocalFsSpillBackend();
+
+  /// Write objects to a new file. On success, the callback gets the URL of each
+  /// object, in order. On failure, no object is spilled.
+  void SpillObjects(std::vector<ObjectToSpill> objects, SpillCallback callback);
+
+  /// Read a spilled object straight into a new plasma buffer and seal it. Restoring
+  /// an object that is already in plasma succeeds without reading it.
+  void RestoreSpilledObject(const ObjectID &object_id,
+                            const std::string &object_url,
+                            RestoreCallback callback);
+
+  /// Delete the files that the given objects were spilled to. Files that don't
+  /// exist are skipped.
+  void DeleteSpilledObjects(std::vector<std::string> object_urls,
+                            DeleteCallback callback);
+
+ private:
+  /// Write the objects to the file at `path` and fill in their URLs.
+  Status WriteSpillFile(const std::string &path,
+                        const std::vector<ObjectToSpill> &objects,
+                        std::vector<std::string> *object_urls);
+
+  /// Compress the data payload of an object into blocks. A block that doesn't
+  /// shrink is left empty, to be written uncompressed.
+  ///
+  /// \return False if the object doesn't shrink, so it shouldn't be compressed.
+  bool CompressObjectData(const Buffer &data, std::vector<std::string> *blocks) const;
+
+  /// The uncompressed size of a block of a data payload of `data_size` bytes.
+  uint64_t BlockSize(uint64_t data_size, uint64_t block_index) const {
+    return std::min(compression_block_size_,
+                    data_size - block_index * compression_block_size_);
+  }
+
+  Status RestoreObject(const ObjectID &object_id,
+                       const std::string &object_url,
+                       int64_t *bytes_restored);
+
+  /// The directories to spill to.
+  std::vector<std::string> directory_paths_;
+
+  /// The index of the next directory to spill to.
+  size_t next_directory_index_ = 0;
+
+  std::shared_ptr<plasma::PlasmaClientInterface> store_client_;
+
+  const bool use_direct_io_;
+
+  const SpillCodec codec_;
+
+  const uint64_t compression_block_size_;
+
+  /// Threads that write spill files.
+  boost::asio::thread_pool spill_pool_;
+
+  /// Threads that restore objects and delete spill files.
+  boost::asio::thread_pool restore_pool_;
+};
+
+}  // namespace raylet
+
+}  // namespace ray
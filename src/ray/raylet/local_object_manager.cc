@@ -300,79 +300,144 @@ void LocalObjectManager::SpillObjectsInternal(
     absl::MutexLock lock(&mutex_);
     num_active_workers_ += 1;
   }
-  io_worker_pool_.PopSpillWorker(
-      [this, objects_to_spill, callback](std::shared_ptr<WorkerInterface> io_worker) {
-        rpc::SpillObjectsRequest request;
-        std::vector<ObjectID> requested_objects_to_spill;
-        for (const auto &object_id : objects_to_spill) {
-          auto it = objects_pending_spill_.find(object_id);
-          RAY_CHECK(it != objects_pending_spill_.end());
-          auto freed_it = local_objects_.find(object_id);
-          // If the object hasn't already been freed, spill it.
-          if (freed_it == local_objects_.end() || freed_it->second.is_freed) {
-            num_bytes_pending_spill_ -= it->second->GetSize();
-            objects_pending_spill_.erase(it);
-          } else {
-            auto ref = request.add_object_refs_to_spill();
-            ref->set_object_id(object_id.Binary());
-            ref->mutable_owner_address()->CopyFrom(freed_it->second.owner_address);
-            RAY_LOG(DEBUG) << "Sending spill request for object " << object_id;
-            requested_objects_to_spill.push_back(object_id);
+  if (fs_spill_backend_) {
+    SpillObjectsToLocalFs(objects_to_spill, callback);
+  } else {
+    io_worker_pool_.PopSpillWorker(
+        [this, objects_to_spill, callback](std::shared_ptr<WorkerInterface> io_worker) {
+          rpc::SpillObjectsRequest request;
+          std::vector<ObjectID> requested_objects_to_spill;
+          for (const auto &object_id : objects_to_spill) {
+            auto it = objects_pending_spill_.find(object_id);
+            RAY_CHECK(it != objects_pending_spill_.end());
+            auto freed_it = local_objects_.find(object_id);
+            // If the object hasn't already been freed, spill it.
+            if (freed_it == local_objects_.end() || freed_it->second.is_freed) {
+              num_bytes_pending_spill_ -= it->second->GetSize();
+              objects_pending_spill_.erase(it);
+            } else {
+              auto ref = request.add_object_refs_to_spill();
+              ref->set_object_id(object_id.Binary());
+              ref->mutable_owner_address()->CopyFrom(freed_it->second.owner_address);
+              RAY_LOG(DEBUG) << "Sending spill request for object " << object_id;
+              requested_objects_to_spill.push_back(object_id);
+            }
           }
-        }
 
-        if (request.object_refs_to_spill_size() == 0) {
-          {
-            absl::MutexLock lock(&mutex_);
-            num_active_workers_ -= 1;
+          if (request.object_refs_to_spill_size() == 0) {
+            {
+              absl::MutexLock lock(&mutex_);
+              num_active_workers_ -= 1;
+            }
+            io_worker_pool_.PushSpillWorker(io_worker);
+            callback(Status::OK());
+            return;
           }
-          io_worker_pool_.PushSpillWorker(io_worker);
-          callback(Status::OK());
-          return;
-        }
 
-        io_worker->rpc_client()->SpillObjects(
-            request,
-            [this, requested_objects_to_spill, callback, io_worker](
-                const ray::Status &status, const rpc::SpillObjectsReply &r) {
+          io_worker->rpc_client()->SpillObjects(
+              request,
+              [this, requested_objects_to_spill, callback, io_worker](
+                  const ray::Status &status, const rpc::SpillObjectsReply &r) {
+                {
+                  absl::MutexLock lock(&mutex_);
+                  num_active_workers_ -= 1;
+                }
+                io_worker_pool_.PushSpillWorker(io_worker);
+                OnSpillObjectsReply(requested_objects_to_spill, status, r, callback);
+              });
+        });
+  }
+
+  // Deleting spilled objects can fall behind when there is a lot
+  // of concurrent spilling and object frees. Clear the queue here
+  // if needed.
+  if (spilled_object_pending_delete_.size() >= free_objects_batch_size_) {
+    ProcessSpilledObjectsDeleteQueue(free_objects_batch_size_);
+  }
+}
+
+void LocalObjectManager::SpillObjectsToLocalFs(
+    const std::vector<ObjectID> &objects_to_spill,
+    std::function<void(const ray::Status &)> callback) {
+  std::vector<LocalFsSpillBackend::ObjectToSpill> objects;
+  std::vector<ObjectID> requested_objects_to_spill;
+  for (const auto &object_id : objects_to_spill) {
+    auto it = objects_pending_spill_.find(object_id);
+    RAY_CHECK(it != objects_pending_spill_.end());
+    auto freed_it = local_objects_.find(object_id);
+    // If the object hasn't already been freed, spill it.
+    if (freed_it == local_objects_.end() || freed_it->second.is_freed) {
+      num_bytes_pending_spill_ -= it->second->GetSize();
+      objects_pending_spill_.erase(it);
+    } else {
+      objects.push_back({object_id,
+                         freed_it->second.owner_address.SerializeAsString(),
+                         it->second->GetMetadata(),
+                         it->second->GetData()});
+      requested_objects_to_spill.push_back(object_id);
+    }
+  }
+
+  if (objects.empty()) {
+    {
+      absl::MutexLock lock(&mutex_);
+      num_active_workers_ -= 1;
+    }
+    callback(Status::OK());
+    return;
+  }
+
+  fs_spill_backend_->SpillObjects(
+      std::move(objects),
+      [this, requested_objects_to_spill, callback](const ray::Status &status,
+                                                   std::vector<std::string> object_urls) {
+        io_service_.post(
+            [this,
+             requested_objects_to_spill,
+             callback,
+             status,
+             object_urls = std::move(object_urls)]() {
               {
                 absl::MutexLock lock(&mutex_);
                 num_active_workers_ -= 1;
               }
-              io_worker_pool_.PushSpillWorker(io_worker);
-              size_t num_objects_spilled = status.ok() ? r.spilled_objects_url_size() : 0;
-              // Object spilling is always done in the order of the request.
-              // For example, if an object succeeded, it'll guarentee that all objects
-              // before this will succeed.
-              RAY_CHECK(num_objects_spilled <= requested_objects_to_spill.size());
-              for (size_t i = num_objects_spilled; i != requested_objects_to_spill.size();
-                   ++i) {
-                const auto &object_id = requested_objects_to_spill[i];
-                auto it = objects_pending_spill_.find(object_id);
-                RAY_CHECK(it != objects_pending_spill_.end());
-                pinned_objects_size_ += it->second->GetSize();
-                num_bytes_pending_spill_ -= it->second->GetSize();
-                pinned_objects_.emplace(object_id, std::move(it->second));
-                objects_pending_spill_.erase(it);
-              }
-
-              if (!status.ok()) {
-                RAY_LOG(ERROR) << "Failed to send object spilling request: "
-                               << status.ToString();
-              } else {
-                OnObjectSpilled(requested_objects_to_spill, r);
-              }
-              if (callback) {
-                callback(status);
+              rpc::SpillObjectsReply reply;
+              for (const auto &object_url : object_urls) {
+                reply.add_spilled_objects_url(object_url);
               }
-            });
+              OnSpillObjectsReply(requested_objects_to_spill, status, reply, callback);
+            },
+            "LocalObjectManager.SpillObjectsToLocalFs");
       });
+}
 
-  // Deleting spilled objects can fall behind when there is a lot
-  // of concurrent spilling and object frees. Clear the queue here
-  // if needed.
-  if (spilled_object_pending_delete_.size() >= free_objects_batch_size_) {
-    ProcessSpilledObjectsDeleteQueue(free_objects_batch_size_);
+void LocalObjectManager::OnSpillObjectsReply(
+    const std::vector<ObjectID> &requested_objects_to_spill,
+    const ray::Status &status,
+    const rpc::SpillObjectsReply &reply,
+    std::function<void(const ray::Status &)> callback) {
+  size_t num_objects_spilled = status.ok() ? reply.spilled_objects_url_size() : 0;
+  // Object spilling is always done in the order of the request.
+  // For example, if an object succeeded, it'll guarentee that all objects
+  // before this will succeed.
+  RAY_CHECK(num_objects_spilled <= requested_objects_to_spill.size());
+  for (size_t i = num_objects_spilled; i != requested_objects_to_spill.size(); ++i) {
+    const auto &object_id = requested_objects_to_spill[i];
+    auto it = objects_pending_spill_.find(object_id);
+    RAY_CHECK(it != objects_pending_spill_.end());
+    pinned_objects_size_ += it->second->GetSize();
+    num_bytes_pending_spill_ -= it->second->GetSize();
+    pinned_objects_.emplace(object_id, std::move(it->second));
+    objects_pending_spill_.erase(it);
+  }
+
+  if (!status.ok()) {
+    RAY_LOG(ERROR) << "Failed to spill objects: " << status.ToString();
+  } else {
+    OnObjectSpilled(requested_objects_to_spill, reply);
+  }
+  if (callback) {
+    callback(status);
   }
 }
 
@@ -409,6 +474,9 @@ void LocalObjectManager::OnObjectSpilled(const std::vector<ObjectID> &object_ids
 
     // Update the internal spill metrics
     spilled_bytes_total_ += object_size;
+    const auto size_it = parsed_url->find("size");
+    spilled_bytes_on_disk_total_ +=
+        size_it != parsed_url->end() ? std::stoll(size_it->second) : object_size;
     spilled_bytes_current_ += object_size;
     spilled_objects_total_++;
 
@@ -458,6 +526,28 @@ void LocalObjectManager::AsyncRestoreSpilledObject(
   RAY_CHECK(objects_pending_restore_.emplace(object_id).second)
       << "Object dedupe wasn't done properly. Please report if you see this issue.";
   num_bytes_pending_restore_ += object_size;
+  if (fs_spill_backend_) {
+    auto start_time = absl::GetCurrentTimeNanos();
+    fs_spill_backend_->RestoreSpilledObject(
+        object_id,
+        object_url,
+        [this, start_time, object_id, object_size, callback](const ray::Status &status,
+                                                             int64_t bytes_restored) {
+          io_service_.post(
+              [this,
+               start_time,
+               object_id,
+               object_size,
+               callback,
+               status,
+               bytes_restored]() {
+                OnObjectRestored(
+                    object_id, object_size, start_time, status, bytes_restored, callback);
+              },
+              "LocalObjectManager.RestoreSpilledObjectFromLocalFs");
+        });
+    return;
+  }
   io_worker_pool_.PopRestoreWorker([this, object_id, object_size, object_url, callback](
                                        std::shared_ptr<WorkerInterface> io_worker) {
     auto start_time = absl::GetCurrentTimeNanos();
@@ -470,40 +560,52 @@ void LocalObjectManager::AsyncRestoreSpilledObject(
         [this, start_time, object_id, object_size, callback, io_worker](
             const ray::Status &status, const rpc::RestoreSpilledObjectsReply &r) {
           io_worker_pool_.PushRestoreWorker(io_worker);
-          num_bytes_pending_restore_ -= object_size;
-          objects_pending_restore_.erase(object_id);
-          if (!status.ok()) {
-            RAY_LOG(ERROR) << "Failed to send restore spilled object request: "
-                           << status.ToString();
-          } else {
-            auto now = absl::GetCurrentTimeNanos();
-            auto restored_bytes = r.bytes_restored_total();
-            RAY_LOG(DEBUG) << "Restored " << restored_bytes << " in "
-                           << (now - start_time) / 1e6 << "ms. Object id:" << object_id;
-            restored_bytes_total_ += restored_bytes;
-            restored_objects_total_ += 1;
-            // Adjust throughput timing to account for concurrent restore operations.
-            restore_time_total_s_ +=
-                (now - std::max(start_time, last_restore_finish_ns_)) / 1e9;
-            if (now - last_restore_log_ns_ > 1e9) {
-              last_restore_log_ns_ = now;
-              RAY_LOG(INFO) << "Restored "
-                            << static_cast<int>(restored_bytes_total_ / (1024 * 1024))
-                            << " MiB, " << restored_objects_total_
-                            << " objects, read throughput "
-                            << static_cast<int>(restored_bytes_total_ / (1024 * 1024) /
-                                                restore_time_total_s_)
-                            << " MiB/s";
-            }
-            last_restore_finish_ns_ = now;
-          }
-          if (callback) {
-            callback(status);
-          }
+          OnObjectRestored(object_id,
+                           object_size,
+                           start_time,
+                           status,
+                           r.bytes_restored_total(),
+                           callback);
         });
   });
 }
 
+void LocalObjectManager::OnObjectRestored(
+    const ObjectID &object_id,
+    int64_t object_size,
+    int64_t start_time,
+    const ray::Status &status,
+    int64_t bytes_restored,
+    std::function<void(const ray::Status &)> callback) {
+  num_bytes_pending_restore_ -= object_size;
+  objects_pending_restore_.erase(object_id);
+  if (!status.ok()) {
+    RAY_LOG(ERROR) << "Failed to restore spilled object " << object_id << ": "
+                   << status.ToString();
+  } else {
+    auto now = absl::GetCurrentTimeNanos();
+    RAY_LOG(DEBUG) << "Restored " << bytes_restored << " in "
+                   << (now - start_time) / 1e6 << "ms. Object id:" << object_id;
+    restored_bytes_total_ += bytes_restored;
+    restored_objects_total_ += 1;
+    // Adjust throughput timing to account for concurrent restore operations.
+    restore_time_total_s_ += (now - std::max(start_time, last_restore_finish_ns_)) / 1e9;
+    if (now - last_restore_log_ns_ > 1e9) {
+      last_restore_log_ns_ = now;
+      RAY_LOG(INFO) << "Restored "
+                    << static_cast<int>(restored_bytes_total_ / (1024 * 1024)) << " MiB, "
+                    << restored_objects_total_ << " objects, read throughput "
+                    << static_cast<int>(restored_bytes_total_ / (1024 * 1024) /
+                                        restore_time_total_s_)
+                    << " MiB/s";
+    }
+    last_restore_finish_ns_ = now;
+  }
+  if (callback) {
+    callback(status);
+  }
+}
+
 void LocalObjectManager::ProcessSpilledObjectsDeleteQueue(uint32_t max_batch_size) {
   std::vector<std::string> object_urls_to_delete;
   // Process upto batch size of objects to delete.
@@ -562,6 +664,17 @@ void LocalObjectManager::ProcessSpilledObjectsDeleteQueue(uint32_t max_batch_siz
 
 void LocalObjectManager::DeleteSpilledObjects(std::vector<std::string> urls_to_delete,
                                               int64_t num_retries) {
+  if (fs_spill_backend_) {
+    fs_spill_backend_->DeleteSpilledObjects(
+        std::move(urls_to_delete), [this](const ray::Status &status) {
+          if (!status.ok()) {
+            // Files that failed to be deleted locally are not retried.
+            num_failed_deletion_requests_ += 1;
+            RAY_LOG(ERROR) << "Failed to delete spilled objects: " << status.ToString();
+          }
+        });
+    return;
+  }
   io_worker_pool_.PopDeleteWorker(
       [this, urls_to_delete, num_retries](std::shared_ptr<WorkerInterface> io_worker) {
         RAY_LOG(DEBUG) << "Sending delete spilled object request. Length: "
@@ -602,6 +715,19 @@ void LocalObjectManager::FillObjectSpillingStats(rpc::GetNodeStatsReply *reply)
   stats->set_restored_bytes_total(restored_bytes_total_);
   stats->set_restored_objects_total(restored_objects_total_);
   stats->set_object_store_bytes_primary_copy(pinned_objects_size_);
+  stats->set_spilled_bytes_on_disk_total(spilled_bytes_on_disk_total_);
+  if (spilled_bytes_on_disk_total_ > 0) {
+    stats->set_spill_compression_ratio(1.0 * spilled_bytes_total_ /
+                                       spilled_bytes_on_disk_total_);
+  }
+  if (spill_time_total_s_ > 0) {
+    stats->set_spill_throughput_mib_s(spilled_bytes_total_ / (1024.0 * 1024.0) /
+                                      spill_time_total_s_);
+  }
+  if (restore_time_total_s_ > 0) {
+    stats->set_restore_throughput_mib_s(restored_bytes_total_ / (1024.0 * 1024.0) /
+                                        restore_time_total_s_);
+  }
 }
 
 void LocalObjectManager::RecordMetrics() const {
@@ -24,6 +24,7 @@
 #include "ray/object_manager/common.h"
 #include "ray/object_manager/object_directory.h"
 #include "ray/pubsub/subscriber.h"
+#include "ray/raylet/local_fs_spill_backend.h"
 #include "ray/raylet/worker_pool.h"
 #include "ray/rpc/worker/core_worker_client_pool.h"
 #include "ray/util/util.h"
@@ -56,7 +57,8 @@ class LocalObjectManager {
       std::function<void(const std::vector<ObjectID> &)> on_objects_freed,
       std::function<bool(const ray::ObjectID &)> is_plasma_object_spillable,
       pubsub::SubscriberInterface *core_worker_subscriber,
-      IObjectDirectory *object_directory)
+      IObjectDirectory *object_directory,
+      std::unique_ptr<LocalFsSpillBackend> fs_spill_backend = nullptr)
       : self_node_id_(node_id),
         self_node_address_(self_node_address),
         self_node_port_(self_node_port),
@@ -75,7 +77,8 @@ class LocalObjectManager {
         max_fused_object_count_(max_fused_object_count),
         next_spill_error_log_bytes_(RayConfig::instance().verbose_spill_logs()),
         core_worker_subscriber_(core_worker_subscriber),
-        object_directory_(object_directory) {}
+        object_directory_(object_directory),
+        fs_spill_backend_(std::move(fs_spill_backend)) {}
 
   /// Pin objects.
   ///
@@ -209,6 +212,26 @@ class LocalObjectManager {
   void SpillObjectsInternal(const std::vector<ObjectID> &objects_ids,
                             std::function<void(const ray::Status &)> callback);
 
+  /// Spill objects with the local filesystem backend instead of an IO worker.
+  void SpillObjectsToLocalFs(const std::vector<ObjectID> &objects_to_spill,
+                             std::function<void(const ray::Status &)> callback);
+
+  /// Handle the result of spilling objects, by an IO worker or the local
+  /// filesystem backend. Objects that weren't spilled are pinned again.
+  void OnSpillObjectsReply(const std::vector<ObjectID> &requested_objects_to_spill,
+                           const ray::Status &status,
+                           const rpc::SpillObjectsReply &reply,
+                           std::function<void(const ray::Status &)> callback);
+
+  /// Handle the result of restoring an object, by an IO worker or the local
+  /// filesystem backend.
+  void OnObjectRestored(const ObjectID &object_id,
+                        int64_t object_size,
+                        int64_t start_time,
+                        const ray::Status &status,
+                        int64_t bytes_restored,
+                        std::function<void(const ray::Status &)> callback);
+
   /// Release an object that has been freed by its owner.
   void ReleaseFreedObject(const ObjectID &object_id);
 
@@ -347,6 +370,10 @@ class LocalObjectManager {
   /// The object directory interface to access object information.
   IObjectDirectory *object_directory_;
 
+  /// Spills and restores objects inside the raylet if the external storage is the
+  /// local filesystem. If null, objects are spilled by IO workers.
+  std::unique_ptr<LocalFsSpillBackend> fs_spill_backend_;
+
   ///
   /// Stats
   ///
@@ -363,6 +390,11 @@ class LocalObjectManager {
   /// The total number of bytes spilled.
   int64_t spilled_bytes_total_ = 0;
 
+  /// The total number of bytes that spilled objects take in external storage,
+  /// including their headers. Less than spilled_bytes_total_ if objects are
+  /// compressed.
+  int64_t spilled_bytes_on_disk_total_ = 0;
+
   /// The total number of objects spilled.
   int64_t spilled_objects_total_ = 0;
 
@@ -248,6 +248,8 @@ int main(int argc, char *argv[]) {
             std::min(std::max(2, num_cpus / 4), 8);
         object_manager_config.object_chunk_size =
             RayConfig::instance().object_manager_default_chunk_size();
+        object_manager_config.min_object_chunk_size =
+            RayConfig::instance().object_manager_min_chunk_size();
 
         RAY_LOG(DEBUG) << "Starting object manager with configuration: \n"
                        << "rpc_service_threads_number = "
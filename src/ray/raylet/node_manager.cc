@@ -273,7 +273,10 @@ NodeManager::NodeManager(instrumented_io_context &io_service,
             return object_manager_.IsPlasmaObjectSpillable(object_id);
           },
           /*core_worker_subscriber_=*/core_worker_subscriber_.get(),
-          object_directory_.get()),
+          object_directory_.get(),
+          LocalFsSpillBackend::Create(RayConfig::instance().object_spilling_config(),
+                                      config.store_socket_name,
+                                      config.max_io_workers)),
       high_plasma_storage_usage_(RayConfig::instance().high_plasma_storage_usage()),
       local_gc_run_time_ns_(absl::GetCurrentTimeNanos()),
       local_gc_throttler_(RayConfig::instance().local_gc_min_interval_s() * 1e9),
@@ -316,7 +319,24 @@ NodeManager::NodeManager(instrumented_io_context &io_service,
         }
       },
       /*get_pull_manager_at_capacity*/
-      [this]() { return object_manager_.PullManagerHasPullsQueued(); });
+      [this]() { return object_manager_.PullManagerHasPullsQueued(); },
+      /*get_object_locations*/
+      [this](const ObjectID &object_id,
+             std::vector<scheduling::NodeID> *node_ids,
+             int64_t *object_size) {
+        // The locations are known for the task arguments that this node is pulling.
+        std::unordered_set<NodeID> locations;
+        size_t size = 0;
+        if (!object_directory_->GetSubscribedObjectLocations(
+                object_id, &locations, &size)) {
+          return false;
+        }
+        for (const auto &node_id : locations) {
+          node_ids->emplace_back(node_id.Binary());
+        }
+        *object_size = static_cast<int64_t>(size);
+        return true;
+      });
 
   auto get_node_info_func = [this](const NodeID &node_id) {
     return gcs_client_->Nodes().Get(node_id);
@@ -1069,6 +1089,8 @@ void NodeManager::NodeRemoved(const NodeID &node_id) {
   // Notify the object directory that the node has been removed so that it
   // can remove it from any cached locations.
   object_directory_->HandleNodeRemoved(node_id);
+  // Stop pushing objects to the node.
+  object_manager_.HandleNodeRemoved(node_id);
 
   // Clean up workers that were owned by processes that were on the failed
   // node.
@@ -2565,6 +2587,9 @@ rpc::ObjectStoreStats AccumulateStoreStats(
                                         cur_store.spilled_bytes_total());
     store_stats.set_spilled_objects_total(store_stats.spilled_objects_total() +
                                           cur_store.spilled_objects_total());
+    store_stats.set_spilled_bytes_on_disk_total(
+        store_stats.spilled_bytes_on_disk_total() +
+        cur_store.spilled_bytes_on_disk_total());
     store_stats.set_restored_bytes_total(store_stats.restored_bytes_total() +
                                          cur_store.restored_bytes_total());
     store_stats.set_restored_objects_total(store_stats.restored_objects_total() +
@@ -2587,6 +2612,21 @@ rpc::ObjectStoreStats AccumulateStoreStats(
       store_stats.set_object_pulls_queued(true);
     }
   }
+  // Derive the ratios from the cluster-wide totals.
+  if (store_stats.spilled_bytes_on_disk_total() > 0) {
+    store_stats.set_spill_compression_ratio(1.0 * store_stats.spilled_bytes_total() /
+                                            store_stats.spilled_bytes_on_disk_total());
+  }
+  if (store_stats.spill_time_total_s() > 0) {
+    store_stats.set_spill_throughput_mib_s(store_stats.spilled_bytes_total() /
+                                           (1024.0 * 1024.0) /
+                                           store_stats.spill_time_total_s());
+  }
+  if (store_stats.restore_time_total_s() > 0) {
+    store_stats.set_restore_throughput_mib_s(store_stats.restored_bytes_total() /
+                                             (1024.0 * 1024.0) /
+                                             store_stats.restore_time_total_s());
+  }
   return store_stats;
 }
 
@@ -20,10 +20,6 @@
 namespace ray {
 using namespace ::ray::scheduling;
 
-bool IsPredefinedResource(scheduling::ResourceID resource) {
-  return resource.ToInt() >= 0 && resource.ToInt() < PredefinedResourcesEnum_MAX;
-}
-
 /// Convert a map of resources to a ResourceRequest data structure.
 ResourceRequest ResourceMapToResourceRequest(
     const absl::flat_hash_map<std::string, double> &resource_map,
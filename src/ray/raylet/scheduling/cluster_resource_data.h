@@ -14,8 +14,10 @@
 
 #pragma once
 
+#include <array>
 #include <boost/range/adaptor/map.hpp>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <vector>
 
@@ -30,17 +32,98 @@ namespace ray {
 
 using scheduling::ResourceID;
 
-bool IsPredefinedResource(scheduling::ResourceID resource_id);
+/// Whether the resource is one of PredefinedResourcesEnum.
+inline bool IsPredefinedResource(scheduling::ResourceID resource_id) {
+  return resource_id.ToInt() >= 0 && resource_id.ToInt() < PredefinedResourcesEnum_MAX;
+}
 
 /// Represents a set of resources.
 /// NOTE: negative values are valid in this set, while 0 is not. This means if any
 /// resource value is changed to 0, the resource will be removed.
+/// The predefined resources are stored in a fixed array indexed by
+/// PredefinedResourcesEnum, where 0 means that the resource is absent. Only custom
+/// resources go to a hash map. So comparing two sets, e.g. to check whether a node can
+/// run a task, is a branch-free loop over the array that the compiler vectorizes, plus
+/// a hash lookup per custom resource.
 /// TODO(hchen): This class should be independent with tasks. We should move out the
 /// "requires_object_store_memory_" field, and rename this class to ResourceSet.
 class ResourceRequest {
+  using PredefinedResources = std::array<FixedPoint, PredefinedResourcesEnum_MAX>;
+  using CustomResources = absl::flat_hash_map<ResourceID, FixedPoint>;
+
  public:
-  using ResourceIdIterator =
-      boost::select_first_range<absl::flat_hash_map<ResourceID, FixedPoint>>;
+  /// A range of the IDs of the resources in a ResourceRequest. The predefined resources
+  /// come first, in the order of PredefinedResourcesEnum, followed by the custom
+  /// resources.
+  class ResourceIdIterator {
+   public:
+    class const_iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = ResourceID;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const ResourceID *;
+      using reference = const ResourceID &;
+
+      const_iterator(const ResourceRequest *request,
+                     size_t predefined_index,
+                     CustomResources::const_iterator custom_it)
+          : request_(request),
+            predefined_index_(request->NextPredefinedIndex(predefined_index)),
+            custom_it_(custom_it) {}
+
+      reference operator*() const {
+        if (predefined_index_ < PredefinedResourcesEnum_MAX) {
+          return PredefinedResourceIds()[predefined_index_];
+        }
+        return custom_it_->first;
+      }
+
+      pointer operator->() const { return &**this; }
+
+      const_iterator &operator++() {
+        if (predefined_index_ < PredefinedResourcesEnum_MAX) {
+          predefined_index_ = request_->NextPredefinedIndex(predefined_index_ + 1);
+        } else {
+          ++custom_it_;
+        }
+        return *this;
+      }
+
+      const_iterator operator++(int) {
+        auto it = *this;
+        ++*this;
+        return it;
+      }
+
+      bool operator==(const const_iterator &other) const {
+        return predefined_index_ == other.predefined_index_ &&
+               custom_it_ == other.custom_it_;
+      }
+
+      bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+     private:
+      const ResourceRequest *request_;
+      size_t predefined_index_;
+      CustomResources::const_iterator custom_it_;
+    };
+    using iterator = const_iterator;
+
+    explicit ResourceIdIterator(const ResourceRequest *request) : request_(request) {}
+
+    const_iterator begin() const {
+      return const_iterator(request_, 0, request_->custom_resources_.begin());
+    }
+
+    const_iterator end() const {
+      return const_iterator(
+          request_, PredefinedResourcesEnum_MAX, request_->custom_resources_.end());
+    }
+
+   private:
+    const ResourceRequest *request_;
+  };
 
   /// Construct an empty ResourceRequest.
   ResourceRequest() : ResourceRequest({}, false) {}
@@ -53,9 +136,7 @@ class ResourceRequest {
                   bool requires_object_store_memory)
       : requires_object_store_memory_(requires_object_store_memory) {
     for (auto entry : resource_map) {
-      if (entry.second != 0) {
-        resources_[entry.first] = entry.second;
-      }
+      Set(entry.first, entry.second);
     }
   }
 
@@ -66,8 +147,11 @@ class ResourceRequest {
   /// Get the value of a particular resource.
   /// If the resource doesn't exist, return 0.
   FixedPoint Get(ResourceID resource_id) const {
-    auto it = resources_.find(resource_id);
-    if (it == resources_.end()) {
+    if (IsPredefinedResource(resource_id)) {
+      return predefined_resources_[resource_id.ToInt()];
+    }
+    auto it = custom_resources_.find(resource_id);
+    if (it == custom_resources_.end()) {
       return FixedPoint(0);
     } else {
       return it->second;
@@ -77,25 +161,40 @@ class ResourceRequest {
   /// Set a resource to the given value.
   /// NOTE: if the new value is 0, the resource will be removed.
   ResourceRequest &Set(ResourceID resource_id, FixedPoint value) {
-    if (value == 0) {
-      resources_.erase(resource_id);
+    if (IsPredefinedResource(resource_id)) {
+      predefined_resources_[resource_id.ToInt()] = value;
+    } else if (value == 0) {
+      custom_resources_.erase(resource_id);
     } else {
-      resources_[resource_id] = value;
+      custom_resources_[resource_id] = value;
     }
     return *this;
   }
 
   /// Check whether a particular resource exist.
-  bool Has(ResourceID resource_id) const { return resources_.contains(resource_id); }
+  bool Has(ResourceID resource_id) const {
+    if (IsPredefinedResource(resource_id)) {
+      return predefined_resources_[resource_id.ToInt()] != 0;
+    }
+    return custom_resources_.contains(resource_id);
+  }
 
   /// Clear the whole set.
-  void Clear() { resources_.clear(); }
+  void Clear() {
+    predefined_resources_.fill(FixedPoint(0));
+    custom_resources_.clear();
+  }
 
   /// Remove the negative values in this set.
   void RemoveNegative() {
-    for (auto it = resources_.begin(); it != resources_.end();) {
+    for (auto &value : predefined_resources_) {
+      if (value < 0) {
+        value = FixedPoint(0);
+      }
+    }
+    for (auto it = custom_resources_.begin(); it != custom_resources_.end();) {
       if (it->second < 0) {
-        resources_.erase(it++);
+        custom_resources_.erase(it++);
       } else {
         it++;
       }
@@ -103,19 +202,25 @@ class ResourceRequest {
   }
 
   /// Return the number of resources in this set.
-  size_t Size() const { return resources_.size(); }
+  size_t Size() const {
+    size_t size = custom_resources_.size();
+    for (auto &value : predefined_resources_) {
+      size += value != 0;
+    }
+    return size;
+  }
 
   /// Return true if this set is empty.
-  bool IsEmpty() const { return resources_.empty(); }
+  bool IsEmpty() const { return Size() == 0; }
 
-  /// Return a boost::range object that can be used as an iterator of the resource IDs.
-  ResourceIdIterator ResourceIds() const { return boost::adaptors::keys(resources_); }
+  /// Return a range object that can be used as an iterator of the resource IDs.
+  ResourceIdIterator ResourceIds() const { return ResourceIdIterator(this); }
 
   /// Return a map from the resource ids to the values.
   absl::flat_hash_map<ResourceID, FixedPoint> ToMap() const {
     absl::flat_hash_map<ResourceID, FixedPoint> res;
-    for (auto entry : resources_) {
-      res.emplace(entry.first, entry.second);
+    for (auto &resource_id : ResourceIds()) {
+      res.emplace(resource_id, Get(resource_id));
     }
     return res;
   }
@@ -123,8 +228,8 @@ class ResourceRequest {
   /// Return a map from resource names (string) to values (double).
   absl::flat_hash_map<std::string, double> ToResourceMap() const {
     absl::flat_hash_map<std::string, double> resource_map;
-    for (auto entry : resources_) {
-      resource_map.emplace(entry.first.Binary(), entry.second.Double());
+    for (auto &resource_id : ResourceIds()) {
+      resource_map.emplace(resource_id.Binary(), Get(resource_id).Double());
     }
     return resource_map;
   }
@@ -142,37 +247,44 @@ class ResourceRequest {
   }
 
   ResourceRequest &operator+=(const ResourceRequest &other) {
-    for (auto &entry : other.resources_) {
-      auto it = resources_.find(entry.first);
-      if (it != resources_.end()) {
+    for (size_t i = 0; i < PredefinedResourcesEnum_MAX; i++) {
+      predefined_resources_[i] += other.predefined_resources_[i];
+    }
+    for (auto &entry : other.custom_resources_) {
+      auto it = custom_resources_.find(entry.first);
+      if (it != custom_resources_.end()) {
         it->second += entry.second;
         if (it->second == 0) {
-          resources_.erase(it);
+          custom_resources_.erase(it);
         }
       } else {
-        resources_.emplace(entry.first, entry.second);
+        custom_resources_.emplace(entry.first, entry.second);
       }
     }
     return *this;
   }
 
   ResourceRequest &operator-=(const ResourceRequest &other) {
-    for (auto &entry : other.resources_) {
-      auto it = resources_.find(entry.first);
-      if (it != resources_.end()) {
+    for (size_t i = 0; i < PredefinedResourcesEnum_MAX; i++) {
+      predefined_resources_[i] -= other.predefined_resources_[i];
+    }
+    for (auto &entry : other.custom_resources_) {
+      auto it = custom_resources_.find(entry.first);
+      if (it != custom_resources_.end()) {
         it->second -= entry.second;
         if (it->second == 0) {
-          resources_.erase(it);
+          custom_resources_.erase(it);
         }
       } else {
-        resources_.emplace(entry.first, -entry.second);
+        custom_resources_.emplace(entry.first, -entry.second);
       }
     }
     return *this;
   }
 
   bool operator==(const ResourceRequest &other) const {
-    return this->resources_ == other.resources_;
+    return this->predefined_resources_ == other.predefined_resources_ &&
+           this->custom_resources_ == other.custom_resources_;
   }
 
   bool operator!=(const ResourceRequest &other) const { return !(*this == other); }
@@ -181,21 +293,30 @@ class ResourceRequest {
   /// If A <= B, it means for each resource, its value in A is less than or equqal to that
   /// in B.
   bool operator<=(const ResourceRequest &other) const {
-    // Check all resources that exist in this.
-    for (auto &entry : resources_) {
+    // Absent predefined resources are 0 in both sets, so they can be compared
+    // unconditionally. Don't return early, so that the loop has no branches.
+    bool result = true;
+    for (size_t i = 0; i < PredefinedResourcesEnum_MAX; i++) {
+      result &= predefined_resources_[i] <= other.predefined_resources_[i];
+    }
+    if (!result) {
+      return false;
+    }
+    // Check all custom resources that exist in this.
+    for (auto &entry : custom_resources_) {
       auto &this_value = entry.second;
       auto other_value = FixedPoint(0);
-      auto it = other.resources_.find(entry.first);
-      if (it != other.resources_.end()) {
+      auto it = other.custom_resources_.find(entry.first);
+      if (it != other.custom_resources_.end()) {
         other_value = it->second;
       }
       if (this_value > other_value) {
         return false;
       }
     }
-    // Check all resources that exist in other, but not in this.
-    for (auto &entry : other.resources_) {
-      if (!resources_.contains(entry.first)) {
+    // Check all custom resources that exist in other, but not in this.
+    for (auto &entry : other.custom_resources_) {
+      if (!custom_resources_.contains(entry.first)) {
         if (entry.second < 0) {
           return false;
         }
@@ -226,8 +347,27 @@ class ResourceRequest {
   }
 
  private:
-  /// Map from the resource IDs to the resource values.
-  absl::flat_hash_map<ResourceID, FixedPoint> resources_;
+  /// The IDs of the predefined resources, indexed by PredefinedResourcesEnum.
+  static const std::array<ResourceID, PredefinedResourcesEnum_MAX>
+      &PredefinedResourceIds() {
+    static const std::array<ResourceID, PredefinedResourcesEnum_MAX> ids = {
+        ResourceID(CPU), ResourceID(MEM), ResourceID(GPU), ResourceID(OBJECT_STORE_MEM)};
+    return ids;
+  }
+
+  /// Return the first index starting from `index` whose predefined resource exists, or
+  /// PredefinedResourcesEnum_MAX if there is none.
+  size_t NextPredefinedIndex(size_t index) const {
+    while (index < PredefinedResourcesEnum_MAX && predefined_resources_[index] == 0) {
+      index++;
+    }
+    return index;
+  }
+
+  /// The values of the predefined resources, indexed by PredefinedResourcesEnum.
+  PredefinedResources predefined_resources_;
+  /// Map from the custom resource IDs to the resource values.
+  CustomResources custom_resources_;
   /// Whether this task requires object store memory.
   /// TODO(swang): This should be a quantity instead of a flag.
   bool requires_object_store_memory_ = false;
@@ -46,6 +46,7 @@ void ClusterResourceManager::AddOrUpdateNode(scheduling::NodeID node_id,
                                              const NodeResources &node_resources) {
   RAY_LOG(DEBUG) << "Update node info, node_id: " << node_id.ToInt()
                  << ", node_resources: " << node_resources.DebugString();
+  node_score_index_.MarkNodeChanged(node_id);
   auto it = nodes_.find(node_id);
   if (it == nodes_.end()) {
     // This node is new, so add it to the map.
@@ -86,6 +87,7 @@ bool ClusterResourceManager::RemoveNode(scheduling::NodeID node_id) {
     return false;
   } else {
     nodes_.erase(it);
+    node_score_index_.MarkNodeChanged(node_id);
     return true;
   }
 }
@@ -117,6 +119,7 @@ void ClusterResourceManager::UpdateResourceCapacity(scheduling::NodeID node_id,
     NodeResources node_resources;
     it = nodes_.emplace(node_id, node_resources).first;
   }
+  node_score_index_.MarkNodeChanged(node_id);
 
   auto local_view = it->second.GetMutableLocalView();
   FixedPoint resource_total_fp(resource_total);
@@ -141,6 +144,7 @@ bool ClusterResourceManager::DeleteResources(
   if (it == nodes_.end()) {
     return false;
   }
+  node_score_index_.MarkNodeChanged(node_id);
 
   auto local_view = it->second.GetMutableLocalView();
   for (const auto &resource_id : resource_ids) {
@@ -168,6 +172,7 @@ bool ClusterResourceManager::SubtractNodeAvailableResources(
     return false;
   }
 
+  node_score_index_.MarkNodeChanged(node_id);
   NodeResources *resources = it->second.GetMutableLocalView();
 
   resources->available -= resource_request;
@@ -206,6 +211,7 @@ bool ClusterResourceManager::AddNodeAvailableResources(
     return false;
   }
 
+  node_score_index_.MarkNodeChanged(node_id);
   auto node_resources = it->second.GetMutableLocalView();
   for (auto &resource_id : resource_request.ResourceIds()) {
     if (node_resources->total.Has(resource_id)) {
@@ -235,6 +241,7 @@ bool ClusterResourceManager::UpdateNodeAvailableResourcesIfExist(
   auto resources =
       ResourceMapToResourceRequest(MapFromProtobuf(resource_data.resources_available()),
                                    /*requires_object_store_memory=*/false);
+  node_score_index_.MarkNodeChanged(node_id);
   auto node_resources = iter->second.GetMutableLocalView();
   // Note, by iterating over "total", we only update existing resources.
   // Do not iterating over "available", because some resources may have been removed
@@ -249,6 +256,7 @@ bool ClusterResourceManager::UpdateNodeNormalTaskResources(
     scheduling::NodeID node_id, const rpc::ResourcesData &resource_data) {
   auto iter = nodes_.find(node_id);
   if (iter != nodes_.end()) {
+    node_score_index_.MarkNodeChanged(node_id);
     auto node_resources = iter->second.GetMutableLocalView();
     if (resource_data.resources_normal_task_changed() &&
         resource_data.resources_normal_task_timestamp() >
@@ -281,4 +289,6 @@ BundleLocationIndex &ClusterResourceManager::GetBundleLocationIndex() {
   return bundle_location_index_;
 }
 
+NodeScoreIndex &ClusterResourceManager::GetNodeScoreIndex() { return node_score_index_; }
+
 }  // namespace ray
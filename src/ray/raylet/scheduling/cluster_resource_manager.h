@@ -26,6 +26,7 @@
 #include "ray/raylet/scheduling/cluster_resource_data.h"
 #include "ray/raylet/scheduling/fixed_point.h"
 #include "ray/raylet/scheduling/local_resource_manager.h"
+#include "ray/raylet/scheduling/node_score_index.h"
 #include "ray/util/logging.h"
 #include "src/ray/protobuf/gcs.pb.h"
 
@@ -37,6 +38,7 @@ class SchedulingPolicyTest;
 }  // namespace raylet
 namespace raylet_scheduling_policy {
 class HybridSchedulingPolicyTest;
+class LocalityAwareSchedulingPolicyTest;
 }
 namespace gcs {
 class GcsActorSchedulerTest;
@@ -135,6 +137,10 @@ class ClusterResourceManager {
 
   BundleLocationIndex &GetBundleLocationIndex();
 
+  /// Get the index of the nodes sorted by their score in the hybrid scheduling policy.
+  /// It is kept up to date with every change that this class makes to the nodes.
+  NodeScoreIndex &GetNodeScoreIndex();
+
  private:
   friend class ClusterResourceScheduler;
   friend class gcs::GcsActorSchedulerTest;
@@ -160,6 +166,8 @@ class ClusterResourceManager {
 
   BundleLocationIndex bundle_location_index_;
 
+  NodeScoreIndex node_score_index_;
+
   friend class ClusterResourceSchedulerTest;
   friend struct ClusterResourceManagerTest;
   friend class raylet::ClusterTaskManagerTest;
@@ -188,6 +196,7 @@ class ClusterResourceManager {
 
   friend class raylet::SchedulingPolicyTest;
   friend class raylet_scheduling_policy::HybridSchedulingPolicyTest;
+  friend class raylet_scheduling_policy::LocalityAwareSchedulingPolicyTest;
 };
 
 }  // end namespace ray
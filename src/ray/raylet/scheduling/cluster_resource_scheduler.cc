@@ -14,7 +14,9 @@
 
 #include "ray/raylet/scheduling/cluster_resource_scheduler.h"
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
+#include <cmath>
 
 #include "ray/common/grpc_util.h"
 #include "ray/common/ray_config.h"
@@ -41,8 +43,12 @@ ClusterResourceScheduler::ClusterResourceScheduler(
     const absl::flat_hash_map<std::string, double> &local_node_resources,
     std::function<bool(scheduling::NodeID)> is_node_available_fn,
     std::function<int64_t(void)> get_used_object_store_memory,
-    std::function<bool(void)> get_pull_manager_at_capacity)
-    : local_node_id_(local_node_id), is_node_available_fn_(is_node_available_fn) {
+    std::function<bool(void)> get_pull_manager_at_capacity,
+    std::function<bool(const ObjectID &, std::vector<scheduling::NodeID> *, int64_t *)>
+        get_object_locations)
+    : local_node_id_(local_node_id),
+      is_node_available_fn_(is_node_available_fn),
+      get_object_locations_(get_object_locations) {
   NodeResources node_resources =
       ResourceMapToNodeResources(local_node_resources, local_node_resources);
   Init(node_resources, get_used_object_store_memory, get_pull_manager_at_capacity);
@@ -248,6 +254,68 @@ bool ClusterResourceScheduler::IsSchedulableOnNode(
   return IsSchedulable(resource_request, node_id);
 }
 
+int64_t ClusterResourceScheduler::GetNumSchedulableCopiesOnNode(
+    scheduling::NodeID node_id,
+    const absl::flat_hash_map<std::string, double> &shape,
+    int64_t max_copies) {
+  auto resource_request =
+      ResourceMapToResourceRequest(shape, /*requires_object_store_memory=*/false);
+  if (!IsSchedulable(resource_request, node_id)) {
+    return 0;
+  }
+  const auto &available =
+      cluster_resource_manager_->GetNodeResources(node_id).available;
+  int64_t num_copies = max_copies;
+  for (auto resource_id : resource_request.ResourceIds()) {
+    // Divide the values in resource units, since dividing the doubles can round the
+    // quotient down, e.g. 0.3 / 0.1 < 3.
+    int64_t demand = std::llround(resource_request.Get(resource_id).Double() *
+                                  RESOURCE_UNIT_SCALING);
+    int64_t supply =
+        std::llround(available.Get(resource_id).Double() * RESOURCE_UNIT_SCALING);
+    if (demand > 0) {
+      num_copies = std::min(num_copies, supply / demand);
+    }
+  }
+  return num_copies;
+}
+
+std::unique_ptr<LocalityAwareSchedulingContext>
+ClusterResourceScheduler::GetArgumentLocality(const TaskSpecification &task_spec) const {
+  // Only the default strategy of normal tasks takes locality into account. Explicit
+  // strategies have higher priority, and actors outlive their creation arguments.
+  const auto strategy_case =
+      task_spec.GetMessage().scheduling_strategy().scheduling_strategy_case();
+  if (get_object_locations_ == nullptr ||
+      RayConfig::instance().scheduler_locality_weight() <= 0 ||
+      task_spec.IsActorCreationTask() ||
+      (strategy_case != rpc::SchedulingStrategy::kDefaultSchedulingStrategy &&
+       strategy_case != rpc::SchedulingStrategy::SCHEDULING_STRATEGY_NOT_SET)) {
+    return nullptr;
+  }
+  // Number of object bytes (from the arguments) that a given node has local.
+  absl::flat_hash_map<scheduling::NodeID, int64_t> bytes_local_table;
+  int64_t total_bytes = 0;
+  std::vector<scheduling::NodeID> node_ids;
+  for (const ObjectID &object_id : task_spec.GetDependencyIds()) {
+    int64_t object_size = 0;
+    node_ids.clear();
+    if (!get_object_locations_(object_id, &node_ids, &object_size) ||
+        object_size <= 0) {
+      continue;
+    }
+    total_bytes += object_size;
+    for (const auto &node_id : node_ids) {
+      bytes_local_table[node_id] += object_size;
+    }
+  }
+  if (bytes_local_table.empty()) {
+    return nullptr;
+  }
+  return std::make_unique<LocalityAwareSchedulingContext>(std::move(bytes_local_table),
+                                                          total_bytes);
+}
+
 scheduling::NodeID ClusterResourceScheduler::GetBestSchedulableNode(
     const TaskSpecification &task_spec,
     const std::string &preferred_node_id,
@@ -264,17 +332,36 @@ scheduling::NodeID ClusterResourceScheduler::GetBestSchedulableNode(
     return local_node_id_;
   }
 
-  // This argument is used to set violation, which is an unsupported feature now.
-  int64_t _unused;
-  scheduling::NodeID best_node =
-      GetBestSchedulableNode(task_spec.GetRequiredPlacementResources().GetResourceMap(),
-                             task_spec.GetMessage().scheduling_strategy(),
-                             requires_object_store_memory,
-                             task_spec.IsActorCreationTask(),
-                             exclude_local_node,
-                             preferred_node_id,
-                             &_unused,
-                             is_infeasible);
+  scheduling::NodeID best_node;
+  auto locality_context = GetArgumentLocality(task_spec);
+  if (locality_context != nullptr) {
+    // Weigh the bytes of the arguments that each node has local against the
+    // utilization of the nodes, instead of only the utilization as the hybrid
+    // policy does.
+    ResourceRequest resource_request = ResourceMapToResourceRequest(
+        task_spec.GetRequiredPlacementResources().GetResourceMap(),
+        requires_object_store_memory);
+    best_node = scheduling_policy_->Schedule(
+        resource_request,
+        SchedulingOptions::LocalityAware(
+            /*avoid_local_node*/ exclude_local_node,
+            /*require_node_available*/ exclude_local_node,
+            preferred_node_id,
+            std::move(locality_context)));
+    *is_infeasible = best_node.IsNil();
+  } else {
+    // This argument is used to set violation, which is an unsupported feature now.
+    int64_t _unused;
+    best_node =
+        GetBestSchedulableNode(task_spec.GetRequiredPlacementResources().GetResourceMap(),
+                               task_spec.GetMessage().scheduling_strategy(),
+                               requires_object_store_memory,
+                               task_spec.IsActorCreationTask(),
+                               exclude_local_node,
+                               preferred_node_id,
+                               &_unused,
+                               is_infeasible);
+  }
 
   // There is no other available nodes.
   if (!best_node.IsNil() &&
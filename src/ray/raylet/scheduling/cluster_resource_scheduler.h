@@ -60,7 +60,10 @@ class ClusterResourceScheduler {
       const absl::flat_hash_map<std::string, double> &local_node_resources,
       std::function<bool(scheduling::NodeID)> is_node_available_fn,
       std::function<int64_t(void)> get_used_object_store_memory = nullptr,
-      std::function<bool(void)> get_pull_manager_at_capacity = nullptr);
+      std::function<bool(void)> get_pull_manager_at_capacity = nullptr,
+      std::function<bool(const ObjectID &object_id,
+                         std::vector<scheduling::NodeID> *node_ids,
+                         int64_t *object_size)> get_object_locations = nullptr);
 
   /// Schedule the specified resources to the cluster nodes.
   ///
@@ -119,6 +122,19 @@ class ClusterResourceScheduler {
                            const absl::flat_hash_map<std::string, double> &shape,
                            bool requires_object_store_memory);
 
+  /// Get the number of copies of a task request that fit in the available resources
+  /// of a given node at the same time.
+  ///
+  /// \param node_id The ID of the node.
+  /// \param shape The resource demand's shape of one copy.
+  /// \param max_copies The maximum number of copies to return.
+  /// \return The number of copies, at most max_copies, or 0 if even one copy is not
+  /// schedulable on the node.
+  int64_t GetNumSchedulableCopiesOnNode(
+      scheduling::NodeID node_id,
+      const absl::flat_hash_map<std::string, double> &shape,
+      int64_t max_copies);
+
   LocalResourceManager &GetLocalResourceManager() { return *local_resource_manager_; }
   ClusterResourceManager &GetClusterResourceManager() {
     return *cluster_resource_manager_;
@@ -194,6 +210,14 @@ class ClusterResourceScheduler {
       int64_t *violations,
       bool *is_infeasible);
 
+  /// Get the argument bytes of a task that each node has local, from the known
+  /// locations of its arguments.
+  ///
+  /// \return Null if locality aware scheduling is disabled or no node has any argument
+  /// of the task local.
+  std::unique_ptr<raylet_scheduling_policy::LocalityAwareSchedulingContext>
+  GetArgumentLocality(const TaskSpecification &task_spec) const;
+
   /// Judging whether it affinity with placement group bundle
   bool IsAffinityWithBundleSchedule(const rpc::SchedulingStrategy &scheduling_strategy);
   /// Identifier of local node.
@@ -211,6 +235,10 @@ class ClusterResourceScheduler {
       bundle_scheduling_policy_;
   /// Whether there is a raylet on the local node.
   bool is_local_node_with_raylet_ = true;
+  /// Callback to get the nodes that have a copy of an object and the size of the
+  /// object. It returns false if the locations of the object are unknown.
+  std::function<bool(const ObjectID &, std::vector<scheduling::NodeID> *, int64_t *)>
+      get_object_locations_;
 
   friend class ClusterResourceSchedulerTest;
   FRIEND_TEST(ClusterResourceSchedulerTest, PopulatePredefinedResources);
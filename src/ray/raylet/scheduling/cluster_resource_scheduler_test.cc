@@ -21,6 +21,7 @@
 #include "gtest/gtest.h"
 #include "ray/common/ray_config.h"
 #include "ray/common/task/scheduling_resources.h"
+#include "ray/common/task/task_spec.h"
 #include "ray/raylet/scheduling/scheduling_ids.h"
 #include "mock/ray/gcs/gcs_client/gcs_client.h"
 #ifdef UNORDERED_VS_ABSL_MAPS_EVALUATION
@@ -1601,6 +1602,26 @@ TEST_F(ClusterResourceSchedulerTest, TestForceSpillback) {
             node_ids[51]);
 }
 
+TEST_F(ClusterResourceSchedulerTest, GetNumSchedulableCopiesOnNodeTest) {
+  ClusterResourceScheduler resource_scheduler(
+      scheduling::NodeID("local"), {{"CPU", 3}, {"custom", 8}}, is_node_available_fn_);
+  auto local = scheduling::NodeID("local");
+  // The fractional resources are counted exactly.
+  ASSERT_EQ(resource_scheduler.GetNumSchedulableCopiesOnNode(local, {{"CPU", 0.1}}, 100),
+            30);
+  ASSERT_EQ(resource_scheduler.GetNumSchedulableCopiesOnNode(
+                local, {{"CPU", 1}, {"custom", 4}}, 100),
+            2);
+  ASSERT_EQ(resource_scheduler.GetNumSchedulableCopiesOnNode(local, {{"CPU", 1}}, 2), 2);
+  ASSERT_EQ(resource_scheduler.GetNumSchedulableCopiesOnNode(local, {{"CPU", 4}}, 100),
+            0);
+  ASSERT_EQ(resource_scheduler.GetNumSchedulableCopiesOnNode(local, {{"GPU", 1}}, 100),
+            0);
+  ASSERT_EQ(resource_scheduler.GetNumSchedulableCopiesOnNode(
+                scheduling::NodeID("remote"), {{"CPU", 1}}, 100),
+            0);
+}
+
 TEST_F(ClusterResourceSchedulerTest, CustomResourceInstanceTest) {
   SetUnitInstanceResourceIds({ResourceID("FPGA")});
   ClusterResourceScheduler resource_scheduler(
@@ -1720,6 +1741,72 @@ TEST_F(ClusterResourceSchedulerTest, AffinityWithBundleScheduleTest) {
   test_schedule({{"CPU", 2}}, bundle_1, scheduling::NodeID::Nil());
 }
 
+// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST_F(ClusterResourceSchedulerTest, DISABLED_BenchmarkGetBestSchedulableNode) {
+  // Each node has the predefined resources, and some nodes also have a custom
+  // resource. Most requests only need predefined resources. Time how long it takes to
+  // pick a node for each request, without allocating the resources, so that every
+  // request sees the same cluster.
+  const int num_requests = 1000;
+  std::vector<TaskSpecification> requests;
+  for (int i = 0; i < num_requests; i++) {
+    rpc::TaskSpec spec;
+    spec.mutable_scheduling_strategy()->mutable_default_scheduling_strategy();
+    auto &request = *spec.mutable_required_resources();
+    request["CPU"] = 1 + rand() % 4;
+    request["memory"] = 1 + rand() % 8;
+    if (i % 10 == 0) {
+      request["GPU"] = 1;
+    }
+    if (i % 20 == 0) {
+      request["custom1"] = 1;
+    }
+    requests.push_back(TaskSpecification(std::move(spec)));
+  }
+
+  for (int num_nodes : {100, 1000, 2000}) {
+    ClusterResourceScheduler resource_scheduler(
+        scheduling::NodeID(0),
+        CreateNodeResources({{ResourceID::CPU(), 0}}),
+        [](scheduling::NodeID) { return true; });
+    for (int i = 1; i <= num_nodes; i++) {
+      absl::flat_hash_map<std::string, double> total(
+          {{"CPU", 16}, {"memory", 64}, {"object_store_memory", 32}});
+      if (i % 4 == 0) {
+        total["GPU"] = 4;
+      }
+      if (i % 8 == 0) {
+        total["custom1"] = 2;
+      }
+      auto available = total;
+      available["CPU"] = rand() % 17;
+      available["memory"] = rand() % 65;
+      resource_scheduler.GetClusterResourceManager().AddOrUpdateNode(
+          scheduling::NodeID(i), ResourceMapToNodeResources(total, available));
+    }
+
+    bool is_infeasible;
+    int num_scheduled = 0;
+    auto start = absl::Now();
+    for (const auto &request : requests) {
+      auto node_id = resource_scheduler.GetBestSchedulableNode(
+          request,
+          /*preferred_node_id*/ std::string(),
+          /*exclude_local_node*/ false,
+          /*requires_object_store_memory*/ false,
+          &is_infeasible);
+      num_scheduled += !node_id.IsNil();
+    }
+    auto elapsed = absl::Now() - start;
+    ASSERT_GT(num_scheduled, 0);
+    RAY_LOG(INFO) << num_nodes << " nodes: " << num_requests
+                  << " calls to GetBestSchedulableNode took "
+                  << absl::ToDoubleMilliseconds(elapsed) << "ms, "
+                  << absl::ToDoubleMicroseconds(elapsed) / num_requests
+                  << "us per call";
+  }
+}
+
 }  // namespace ray
 
 int main(int argc, char **argv) {
@@ -18,6 +18,7 @@
 
 #include <boost/range/join.hpp>
 
+#include "ray/common/ray_config.h"
 #include "ray/stats/metric_defs.h"
 #include "ray/util/logging.h"
 
@@ -189,8 +190,10 @@ void ClusterTaskManager::ScheduleAndDispatchTasks() {
       }
 
       NodeID node_id = NodeID::FromBinary(scheduling_node_id.Binary());
-      ScheduleOnNode(node_id, work);
-      work_it = work_queue.erase(work_it);
+      auto batch_end = GetBatchEnd(work_queue, work_it, scheduling_node_id);
+      ScheduleOnNode(node_id,
+                     std::vector<std::shared_ptr<internal::Work>>(work_it, batch_end));
+      work_it = work_queue.erase(work_it, batch_end);
     }
 
     if (is_infeasible) {
@@ -412,45 +415,96 @@ std::string ClusterTaskManager::DebugStr() const {
   return internal_stats_.ComputeAndReportDebugStr();
 }
 
-void ClusterTaskManager::ScheduleOnNode(const NodeID &spillback_to,
-                                        const std::shared_ptr<internal::Work> &work) {
-  if (spillback_to == self_node_id_ && local_task_manager_) {
-    local_task_manager_->QueueAndScheduleTask(work);
-    return;
+std::deque<std::shared_ptr<internal::Work>>::iterator ClusterTaskManager::GetBatchEnd(
+    std::deque<std::shared_ptr<internal::Work>> &work_queue,
+    std::deque<std::shared_ptr<internal::Work>>::iterator work_it,
+    scheduling::NodeID node_id) {
+  auto batch_end = std::next(work_it);
+  if (!RayConfig::instance().scheduler_batch_placement_enabled()) {
+    return batch_end;
   }
 
-  auto send_reply_callback = work->callback;
-
-  if (work->grant_or_reject) {
-    work->reply->set_rejected(true);
-    send_reply_callback();
-    return;
+  // Only batch the tasks that the default policy places by their resources alone. A
+  // spread task, for example, should still go to a different node each time.
+  const auto &task_spec = (*work_it)->task.GetTaskSpecification();
+  const auto strategy_case =
+      task_spec.GetMessage().scheduling_strategy().scheduling_strategy_case();
+  if ((strategy_case != rpc::SchedulingStrategy::kDefaultSchedulingStrategy &&
+       strategy_case != rpc::SchedulingStrategy::SCHEDULING_STRATEGY_NOT_SET) ||
+      task_spec.IsActorCreationTask() ||
+      task_spec.GetRequiredResources().GetResourceMap().empty()) {
+    return batch_end;
   }
 
-  internal_stats_.TaskSpilled();
+  auto get_preferred_node_id = [this](const internal::Work &work) {
+    return work.PrioritizeLocalNode() ? self_node_id_.Binary()
+                                      : work.task.GetPreferredNodeID();
+  };
+  const auto preferred_node_id = get_preferred_node_id(**work_it);
+  // The node has room for `num_copies` tasks of this class. Tasks placed on a remote
+  // node take its resources right away, so the node would keep being picked until it
+  // is full unless another node scores better.
+  const int64_t num_copies = cluster_resource_scheduler_->GetNumSchedulableCopiesOnNode(
+      node_id,
+      task_spec.GetRequiredResources().GetResourceMap(),
+      std::distance(work_it, work_queue.end()));
+  for (int64_t i = 1; i < num_copies; i++, batch_end++) {
+    // Tasks that prefer another node, e.g. where their arguments are, are placed
+    // separately.
+    if (get_preferred_node_id(**batch_end) != preferred_node_id) {
+      break;
+    }
+  }
+  return batch_end;
+}
 
-  const auto &task = work->task;
-  const auto &task_spec = task.GetTaskSpecification();
-  RAY_LOG(DEBUG) << "Spilling task " << task_spec.TaskId() << " to node " << spillback_to;
+void ClusterTaskManager::ScheduleOnNode(
+    const NodeID &spillback_to,
+    const std::vector<std::shared_ptr<internal::Work>> &works) {
+  if (spillback_to == self_node_id_ && local_task_manager_) {
+    for (const auto &work : works) {
+      local_task_manager_->QueueAndScheduleTask(work);
+    }
+    return;
+  }
 
-  if (!cluster_resource_scheduler_->AllocateRemoteTaskResources(
-          scheduling::NodeID(spillback_to.Binary()),
-          task_spec.GetRequiredResources().GetResourceMap())) {
-    RAY_LOG(DEBUG) << "Tried to allocate resources for request " << task_spec.TaskId()
-                   << " on a remote node that are no longer available";
+  std::vector<std::shared_ptr<internal::Work>> works_to_spill;
+  for (const auto &work : works) {
+    if (work->grant_or_reject) {
+      work->reply->set_rejected(true);
+      work->callback();
+    } else {
+      internal_stats_.TaskSpilled();
+      RAY_LOG(DEBUG) << "Spilling task " << work->task.GetTaskSpecification().TaskId()
+                     << " to node " << spillback_to;
+      works_to_spill.push_back(work);
+    }
+  }
+  if (works_to_spill.empty()) {
+    return;
   }
 
   auto node_info_ptr = get_node_info_(spillback_to);
   RAY_CHECK(node_info_ptr)
       << "Spilling back to a node manager, but no GCS info found for node "
       << spillback_to;
-  auto reply = work->reply;
-  reply->mutable_retry_at_raylet_address()->set_ip_address(
-      node_info_ptr->node_manager_address());
-  reply->mutable_retry_at_raylet_address()->set_port(node_info_ptr->node_manager_port());
-  reply->mutable_retry_at_raylet_address()->set_raylet_id(spillback_to.Binary());
+  for (const auto &work : works_to_spill) {
+    const auto &task_spec = work->task.GetTaskSpecification();
+    if (!cluster_resource_scheduler_->AllocateRemoteTaskResources(
+            scheduling::NodeID(spillback_to.Binary()),
+            task_spec.GetRequiredResources().GetResourceMap())) {
+      RAY_LOG(DEBUG) << "Tried to allocate resources for request " << task_spec.TaskId()
+                     << " on a remote node that are no longer available";
+    }
 
-  send_reply_callback();
+    auto reply = work->reply;
+    reply->mutable_retry_at_raylet_address()->set_ip_address(
+        node_info_ptr->node_manager_address());
+    reply->mutable_retry_at_raylet_address()->set_port(
+        node_info_ptr->node_manager_port());
+    reply->mutable_retry_at_raylet_address()->set_raylet_id(spillback_to.Binary());
+    work->callback();
+  }
 }
 
 std::shared_ptr<ClusterResourceScheduler>
@@ -156,9 +156,22 @@ class ClusterTaskManager : public ClusterTaskManagerInterface {
  private:
   void TryScheduleInfeasibleTask();
 
-  // Schedule the task onto a node (which could be either remote or local).
+  /// Get the end of the batch of works, starting at `work_it`, to place on the node
+  /// that was picked for the first one. Without batch placement, the batch is only
+  /// the first work.
+  ///
+  /// \param work_queue: The queue of works of one scheduling class.
+  /// \param work_it: The first work of the batch.
+  /// \param node_id: The node that was picked for the first work.
+  /// \return The end of the batch, which is never after the end of `work_queue`.
+  std::deque<std::shared_ptr<internal::Work>>::iterator GetBatchEnd(
+      std::deque<std::shared_ptr<internal::Work>> &work_queue,
+      std::deque<std::shared_ptr<internal::Work>>::iterator work_it,
+      scheduling::NodeID node_id);
+
+  // Schedule the tasks onto a node (which could be either remote or local).
   void ScheduleOnNode(const NodeID &node_to_schedule,
-                      const std::shared_ptr<internal::Work> &work);
+                      const std::vector<std::shared_ptr<internal::Work>> &works);
 
   /// Recompute the debug stats.
   /// It is needed because updating the debug state is expensive for cluster_task_manager.
@@ -301,6 +301,8 @@ class ClusterTaskManagerTest : public ::testing::Test {
         .WillByDefault(::testing::Return(&node_info));
   }
 
+  void TearDown() { RayConfig::instance().initialize(""); }
+
   RayObject *MakeDummyArg() {
     std::vector<uint8_t> data;
     data.resize(default_arg_size_);
@@ -2423,6 +2425,97 @@ TEST_F(ClusterTaskManagerTest, DispatchTimerAfterRequestTest) {
   AssertNoLeaks();
 }
 
+TEST_F(ClusterTaskManagerTestWithoutCPUsAtHead, BatchPlacementTest) {
+  RayConfig::instance().scheduler_batch_placement_enabled() = true;
+  std::vector<rpc::RequestWorkerLeaseReply> replies(10);
+  int num_callbacks = 0;
+  auto callback = [&num_callbacks](Status, std::function<void()>, std::function<void()>) {
+    num_callbacks++;
+  };
+  for (auto &reply : replies) {
+    RayTask task = CreateTask({{ray::kCPU_ResourceLabel, 1}});
+    task_manager_.QueueAndScheduleTask(task, false, false, &reply, callback);
+  }
+  // No node has CPUs yet.
+  ASSERT_EQ(num_callbacks, 0);
+  ASSERT_EQ(task_manager_.GetInfeasibleQueueSize(), 10);
+
+  auto node_id_1 = NodeID::FromRandom();
+  auto node_id_2 = NodeID::FromRandom();
+  AddNode(node_id_1, 4);
+  AddNode(node_id_2, 4);
+  task_manager_.ScheduleAndDispatchTasks();
+  ASSERT_EQ(num_callbacks, 10);
+
+  // Each node is filled by one batch of 4 tasks.
+  const auto &first_node_id = replies[0].retry_at_raylet_address().raylet_id();
+  const auto &second_node_id = replies[4].retry_at_raylet_address().raylet_id();
+  ASSERT_NE(first_node_id, second_node_id);
+  for (int i = 0; i < 8; i++) {
+    ASSERT_EQ(replies[i].retry_at_raylet_address().raylet_id(),
+              i < 4 ? first_node_id : second_node_id);
+  }
+  for (const auto &node_id : {node_id_1, node_id_2}) {
+    ASSERT_EQ(scheduler_->GetClusterResourceManager()
+                  .GetNodeResources(scheduling::NodeID(node_id.Binary()))
+                  .available.Get(scheduling::ResourceID::CPU()),
+              0);
+  }
+  // The remaining tasks are still feasible, so they are spilled one at a time to
+  // wait on a full node.
+  for (int i = 8; i < 10; i++) {
+    ASSERT_FALSE(replies[i].retry_at_raylet_address().raylet_id().empty());
+  }
+  AssertNoLeaks();
+}
+
+/// Benchmark placing a burst of tasks of one scheduling class that were queued while
+/// no node could run them, with and without batch placement. Disabled by default, run
+/// it with --gtest_also_run_disabled_tests.
+TEST_F(ClusterTaskManagerTestWithoutCPUsAtHead, DISABLED_BenchmarkBurstScheduling) {
+  const int num_nodes = 200;
+  const int num_tasks = 100000;
+  // The scheduler checks whether each node it looks at is alive, so expect the calls
+  // to avoid a warning for each of them.
+  static rpc::GcsNodeInfo node_info;
+  EXPECT_CALL(*gcs_client_->mock_node_accessor, Get(_, _))
+      .WillRepeatedly(::testing::Return(&node_info));
+  for (bool batch_placement_enabled : {false, true}) {
+    RayConfig::instance().scheduler_batch_placement_enabled() = batch_placement_enabled;
+    std::vector<rpc::RequestWorkerLeaseReply> replies(num_tasks);
+    int num_callbacks = 0;
+    auto callback = [&num_callbacks](
+                        Status, std::function<void()>, std::function<void()>) {
+      num_callbacks++;
+    };
+    for (auto &reply : replies) {
+      RayTask task = CreateTask({{ray::kCPU_ResourceLabel, 1}});
+      task_manager_.QueueAndScheduleTask(task, false, false, &reply, callback);
+    }
+    ASSERT_EQ(task_manager_.GetInfeasibleQueueSize(), num_tasks);
+
+    std::vector<NodeID> node_ids;
+    for (int i = 0; i < num_nodes; i++) {
+      node_ids.push_back(NodeID::FromRandom());
+      AddNode(node_ids.back(), num_tasks / num_nodes);
+    }
+    auto start = absl::Now();
+    task_manager_.ScheduleAndDispatchTasks();
+    auto elapsed = absl::Now() - start;
+    ASSERT_EQ(num_callbacks, num_tasks);
+    RAY_LOG(INFO) << num_tasks << " tasks on " << num_nodes << " nodes with batch "
+                  << "placement " << (batch_placement_enabled ? "enabled" : "disabled")
+                  << ": placed in " << absl::ToDoubleMilliseconds(elapsed) << "ms, "
+                  << num_tasks / absl::ToDoubleSeconds(elapsed) << " tasks/s";
+
+    for (const auto &node_id : node_ids) {
+      scheduler_->GetClusterResourceManager().RemoveNode(
+          scheduling::NodeID(node_id.Binary()));
+    }
+  }
+  AssertNoLeaks();
+}
+
 // Regression test for https://github.com/ray-project/ray/issues/16935:
 // When a task requires 1 CPU and is infeasible because head node has 0 CPU,
 // make sure the task's resource demand is reported.
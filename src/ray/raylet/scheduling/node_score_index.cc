@@ -0,0 +1,76 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/scheduling/node_score_index.h"
+
+namespace ray {
+
+float NodeScoreIndex::ComputeNodeScore(const NodeResources &node_resources,
+                                       float spread_threshold) {
+  float critical_resource_utilization =
+      node_resources.CalculateCriticalResourceUtilization();
+  if (critical_resource_utilization < spread_threshold) {
+    critical_resource_utilization = 0;
+  }
+  return critical_resource_utilization;
+}
+
+void NodeScoreIndex::MarkNodeChanged(scheduling::NodeID node_id) {
+  if (!all_nodes_changed_) {
+    changed_nodes_.insert(node_id);
+  }
+}
+
+void NodeScoreIndex::MarkAllNodesChanged() {
+  all_nodes_changed_ = true;
+  changed_nodes_.clear();
+}
+
+const std::set<NodeScoreIndex::Entry> &NodeScoreIndex::GetSortedNodes(
+    const absl::flat_hash_map<scheduling::NodeID, Node> &nodes, float spread_threshold) {
+  if (spread_threshold != spread_threshold_) {
+    MarkAllNodesChanged();
+    spread_threshold_ = spread_threshold;
+  }
+
+  if (all_nodes_changed_) {
+    sorted_nodes_.clear();
+    node_scores_.clear();
+    for (const auto &entry : nodes) {
+      float score = ComputeNodeScore(entry.second.GetLocalView(), spread_threshold_);
+      sorted_nodes_.emplace(score, entry.first);
+      node_scores_.emplace(entry.first, score);
+    }
+    all_nodes_changed_ = false;
+    return sorted_nodes_;
+  }
+
+  for (const auto &node_id : changed_nodes_) {
+    auto score_it = node_scores_.find(node_id);
+    if (score_it != node_scores_.end()) {
+      sorted_nodes_.erase({score_it->second, node_id});
+      node_scores_.erase(score_it);
+    }
+    auto node_it = nodes.find(node_id);
+    if (node_it != nodes.end()) {
+      float score = ComputeNodeScore(node_it->second.GetLocalView(), spread_threshold_);
+      sorted_nodes_.emplace(score, node_id);
+      node_scores_.emplace(node_id, score);
+    }
+  }
+  changed_nodes_.clear();
+  return sorted_nodes_;
+}
+
+}  // namespace ray
@@ -0,0 +1,75 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <set>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "ray/raylet/scheduling/cluster_resource_data.h"
+
+namespace ray {
+
+/// Keeps the nodes of the cluster sorted by the score that the hybrid scheduling
+/// policy ranks them by: the critical resource utilization of the node, truncated to
+/// 0 below the spread threshold, with ties broken by node ID. So the policy can walk
+/// the nodes from the best one and stop after its top k candidates, instead of
+/// scoring and sorting every node for every task.
+///
+/// The index is updated lazily. The owner of the nodes marks a node as changed when
+/// it adds or removes the node or modifies its local view, and only the changed nodes
+/// are re-scored the next time the index is read.
+/// This class is not thread safe.
+class NodeScoreIndex {
+ public:
+  /// A node ID together with its score.
+  using Entry = std::pair<float, scheduling::NodeID>;
+
+  /// Compute the score of a node. The lower the score, the more preferable the node.
+  static float ComputeNodeScore(const NodeResources &node_resources,
+                                float spread_threshold);
+
+  /// Record that a node was added or removed, or that its local view may have changed.
+  void MarkNodeChanged(scheduling::NodeID node_id);
+
+  /// Re-score every node the next time the index is read, e.g. because the nodes
+  /// were replaced without marking them.
+  void MarkAllNodesChanged();
+
+  /// Return the nodes sorted by score.
+  ///
+  /// \param nodes All nodes of the cluster. These must be the nodes that the index
+  /// was marked for.
+  /// \param spread_threshold The spread threshold to compute the scores with. If it
+  /// differs from that of the last call, every node is re-scored.
+  const std::set<Entry> &GetSortedNodes(
+      const absl::flat_hash_map<scheduling::NodeID, Node> &nodes,
+      float spread_threshold);
+
+ private:
+  /// The nodes sorted by score.
+  std::set<Entry> sorted_nodes_;
+  /// Map from the ID of each indexed node to its score.
+  absl::flat_hash_map<scheduling::NodeID, float> node_scores_;
+  /// The nodes to re-score the next time the index is read.
+  absl::flat_hash_set<scheduling::NodeID> changed_nodes_;
+  /// Whether to re-score every node the next time the index is read.
+  bool all_nodes_changed_ = true;
+  /// The spread threshold that the scores were computed with.
+  float spread_threshold_ = 0;
+};
+
+}  // namespace ray
@@ -32,6 +32,8 @@ scheduling::NodeID CompositeSchedulingPolicy::Schedule(
     return random_policy_.Schedule(resource_request, options);
   case SchedulingType::HYBRID:
     return hybrid_policy_.Schedule(resource_request, options);
+  case SchedulingType::LOCALITY_AWARE:
+    return locality_aware_policy_.Schedule(resource_request, options);
   case SchedulingType::NODE_AFFINITY:
     return node_affinity_policy_.Schedule(resource_request, options);
   case SchedulingType::AFFINITY_WITH_BUNDLE:
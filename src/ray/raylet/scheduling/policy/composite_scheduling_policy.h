@@ -20,6 +20,7 @@
 #include "ray/raylet/scheduling/policy/affinity_with_bundle_scheduling_policy.h"
 #include "ray/raylet/scheduling/policy/bundle_scheduling_policy.h"
 #include "ray/raylet/scheduling/policy/hybrid_scheduling_policy.h"
+#include "ray/raylet/scheduling/policy/locality_aware_scheduling_policy.h"
 #include "ray/raylet/scheduling/policy/node_affinity_scheduling_policy.h"
 #include "ray/raylet/scheduling/policy/random_scheduling_policy.h"
 #include "ray/raylet/scheduling/policy/spread_scheduling_policy.h"
@@ -34,8 +35,14 @@ class CompositeSchedulingPolicy : public ISchedulingPolicy {
   CompositeSchedulingPolicy(scheduling::NodeID local_node_id,
                             ClusterResourceManager &cluster_resource_manager,
                             std::function<bool(scheduling::NodeID)> is_node_available)
-      : hybrid_policy_(
-            local_node_id, cluster_resource_manager.GetResourceView(), is_node_available),
+      : hybrid_policy_(local_node_id,
+                       cluster_resource_manager.GetResourceView(),
+                       is_node_available,
+                       &cluster_resource_manager.GetNodeScoreIndex()),
+        locality_aware_policy_(local_node_id,
+                               cluster_resource_manager.GetResourceView(),
+                               is_node_available,
+                               &cluster_resource_manager.GetNodeScoreIndex()),
         random_policy_(
             local_node_id, cluster_resource_manager.GetResourceView(), is_node_available),
         spread_policy_(
@@ -52,6 +59,7 @@ class CompositeSchedulingPolicy : public ISchedulingPolicy {
 
  private:
   HybridSchedulingPolicy hybrid_policy_;
+  LocalityAwareSchedulingPolicy locality_aware_policy_;
   RandomSchedulingPolicy random_policy_;
   SpreadSchedulingPolicy spread_policy_;
   NodeAffinitySchedulingPolicy node_affinity_policy_;
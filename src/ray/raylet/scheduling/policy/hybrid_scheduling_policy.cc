@@ -44,22 +44,12 @@ bool HybridSchedulingPolicy::IsNodeFeasible(
   return node_resources.IsFeasible(resource_request);
 }
 
-namespace {
-float ComputeNodeScoreImpl(const NodeResources &node_resources, float spread_threshold) {
-  float critical_resource_utilization =
-      node_resources.CalculateCriticalResourceUtilization();
-  if (critical_resource_utilization < spread_threshold) {
-    critical_resource_utilization = 0;
-  }
-  return critical_resource_utilization;
-}
-}  // namespace
-
 float HybridSchedulingPolicy::ComputeNodeScore(const scheduling::NodeID &node_id,
                                                float spread_threshold) const {
   const auto local_it = nodes_.find(node_id);
   RAY_CHECK(local_it != nodes_.end());
-  return ComputeNodeScoreImpl(local_it->second.GetLocalView(), spread_threshold);
+  return NodeScoreIndex::ComputeNodeScore(local_it->second.GetLocalView(),
+                                          spread_threshold);
 }
 
 scheduling::NodeID HybridSchedulingPolicy::GetBestNode(
@@ -120,45 +110,65 @@ scheduling::NodeID HybridSchedulingPolicy::ScheduleImpl(
       preferred_node_id = new_id;
     }
   }
-  for (const auto &pair : nodes_) {
-    const auto &node_id = pair.first;
-    const auto &node_resources = pair.second.GetLocalView();
-    if (force_spillback && node_id == preferred_node_id) {
-      continue;
+  auto preferred_it = nodes_.find(preferred_node_id);
+  if (!force_spillback && preferred_it != nodes_.end()) {
+    const auto &node_resources = preferred_it->second.GetLocalView();
+    preferred_node_is_feasible = IsNodeFeasible(
+        preferred_node_id, node_filter, node_resources, resource_request);
+    // It's okay if the local node's pull manager is at
+    // capacity because we will eventually spill the task
+    // back from the waiting queue if its args cannot be
+    // pulled.
+    preferred_node_is_available =
+        preferred_node_is_feasible &&
+        node_resources.IsAvailable(resource_request,
+                                   /*ignore_pull_manager_at_capacity*/ true);
+  }
+
+  size_t num_candidate_nodes =
+      std::max<int32_t>(schedule_top_k_absolute,
+                        static_cast<int32_t>(nodes_.size() * scheduler_top_k_fraction));
+
+  NodeScoreIndex *node_score_index = node_score_index_;
+  if (node_score_index == nullptr) {
+    node_score_index = &own_node_score_index_;
+    node_score_index->MarkAllNodesChanged();
+  }
+  // Visit the nodes from the lowest score, so that the first candidates found are the
+  // top ones. Only the top num_candidate_nodes candidates can be picked, so stop once
+  // that many available nodes are found.
+  const size_t max_candidate_nodes = std::max<size_t>(num_candidate_nodes, 1);
+  for (const auto &entry : node_score_index->GetSortedNodes(nodes_, spread_threshold)) {
+    if (available_nodes.size() >= max_candidate_nodes) {
+      break;
     }
-    if (IsNodeFeasible(node_id, node_filter, node_resources, resource_request)) {
-      bool ignore_pull_manager_at_capacity = false;
-      if (node_id == preferred_node_id) {
-        // It's okay if the local node's pull manager is at
-        // capacity because we will eventually spill the task
-        // back from the waiting queue if its args cannot be
-        // pulled.
-        ignore_pull_manager_at_capacity = true;
-        preferred_node_is_feasible = true;
+    const auto &node_score = entry.first;
+    const auto &node_id = entry.second;
+    bool is_available = false;
+    if (node_id == preferred_node_id) {
+      if (!preferred_node_is_feasible) {
+        continue;
       }
-      bool is_available =
-          node_resources.IsAvailable(resource_request, ignore_pull_manager_at_capacity);
-      if (node_id == preferred_node_id && is_available) {
-        preferred_node_is_available = true;
+      is_available = preferred_node_is_available;
+    } else {
+      const auto &node_resources = nodes_.find(node_id)->second.GetLocalView();
+      if (!IsNodeFeasible(node_id, node_filter, node_resources, resource_request)) {
+        continue;
       }
-      float node_score = ComputeNodeScoreImpl(node_resources, spread_threshold);
+      is_available = node_resources.IsAvailable(resource_request);
       RAY_LOG(DEBUG) << "Node " << node_id.ToInt() << " is "
                      << (is_available ? "available" : "not available") << " for request "
                      << resource_request.DebugString()
                      << " with critical resource utilization " << node_score
                      << " based on local view " << node_resources.DebugString();
-      if (is_available) {
-        available_nodes.push_back({node_id, node_score});
-      } else {
-        feasible_and_unavailable_nodes.push_back({node_id, node_score});
-      }
+    }
+    if (is_available) {
+      available_nodes.push_back({node_id, node_score});
+    } else if (feasible_and_unavailable_nodes.size() < max_candidate_nodes) {
+      feasible_and_unavailable_nodes.push_back({node_id, node_score});
     }
   }
 
-  size_t num_candidate_nodes =
-      std::max<int32_t>(schedule_top_k_absolute,
-                        static_cast<int32_t>(nodes_.size() * scheduler_top_k_fraction));
-
   if (!available_nodes.empty()) {
     bool prioritize_preferred_node = !force_spillback && preferred_node_is_available;
     // First prioritize available nodes.
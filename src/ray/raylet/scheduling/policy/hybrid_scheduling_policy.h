@@ -21,6 +21,7 @@
 
 #include "absl/random/bit_gen_ref.h"
 #include "absl/random/random.h"
+#include "ray/raylet/scheduling/node_score_index.h"
 #include "ray/raylet/scheduling/policy/scheduling_policy.h"
 
 namespace ray {
@@ -47,14 +48,21 @@ namespace raylet_scheduling_policy {
 ///   * Break ties in available/feasible by critical resource utilization.
 ///   * Critical resource utilization below a threshold should be truncated to 0.
 ///
+/// The nodes are visited in the order of a NodeScoreIndex, so only the nodes up to the
+/// top k available ones are checked for each request.
 class HybridSchedulingPolicy : public ISchedulingPolicy {
  public:
+  /// \param node_score_index The index of `nodes`, which is kept up to date by the owner
+  /// of the nodes. If it is null, the policy uses its own index and re-scores every
+  /// node for each request, since it can't know which nodes changed.
   HybridSchedulingPolicy(scheduling::NodeID local_node_id,
                          const absl::flat_hash_map<scheduling::NodeID, Node> &nodes,
-                         std::function<bool(scheduling::NodeID)> is_node_alive)
+                         std::function<bool(scheduling::NodeID)> is_node_alive,
+                         NodeScoreIndex *node_score_index = nullptr)
       : local_node_id_(local_node_id),
         nodes_(nodes),
         is_node_alive_(is_node_alive),
+        node_score_index_(node_score_index),
         bitgen_(),
         bitgenref_(bitgen_) {}
 
@@ -130,6 +138,10 @@ class HybridSchedulingPolicy : public ISchedulingPolicy {
   const absl::flat_hash_map<scheduling::NodeID, Node> &nodes_;
   /// Function Checks if node is alive.
   std::function<bool(scheduling::NodeID)> is_node_alive_;
+  /// The index of the nodes sorted by score, if the owner of the nodes keeps one.
+  NodeScoreIndex *node_score_index_;
+  /// The index used if the owner of the nodes doesn't keep one.
+  NodeScoreIndex own_node_score_index_;
   /// Random number generator to choose a random node out of the top K.
   mutable absl::BitGen bitgen_;
   /// Using BitGenRef to simplify testing.
@@ -154,6 +154,84 @@ TEST_F(HybridSchedulingPolicyTest, GetBestNodePrioritizePreferredNode) {
   }
 }
 
+TEST_F(HybridSchedulingPolicyTest, NodeScoreIndexTracksChanges) {
+  // The index must give the same order as scoring and sorting every node, after any
+  // change that ClusterResourceManager makes to the nodes.
+  for (int i = 0; i < 50; i++) {
+    nodes.emplace(scheduling::NodeID(i), CreateNodeResources(8, 8, 16, 16, 0, 0));
+  }
+  auto cluster_resource_manager = MockClusterResourceManager(nodes);
+  auto &index = cluster_resource_manager.GetNodeScoreIndex();
+  const float spread_threshold = 0.5;
+  auto expect_sorted_nodes = [&]() {
+    std::set<NodeScoreIndex::Entry> expected;
+    for (const auto &entry : cluster_resource_manager.GetResourceView()) {
+      expected.emplace(
+          NodeScoreIndex::ComputeNodeScore(entry.second.GetLocalView(), spread_threshold),
+          entry.first);
+    }
+    ASSERT_EQ(index.GetSortedNodes(cluster_resource_manager.GetResourceView(),
+                                   spread_threshold),
+              expected);
+  };
+  expect_sorted_nodes();
+
+  auto req = ResourceMapToResourceRequest({{"CPU", 1}, {"memory", 2}}, false);
+  for (int i = 0; i < 500; i++) {
+    auto node_id = scheduling::NodeID(rand() % 60);
+    switch (rand() % 4) {
+    case 0:
+      cluster_resource_manager.SubtractNodeAvailableResources(node_id, req);
+      break;
+    case 1:
+      cluster_resource_manager.AddNodeAvailableResources(node_id, req);
+      break;
+    case 2:
+      cluster_resource_manager.UpdateResourceCapacity(
+          node_id, ResourceID::CPU(), rand() % 16);
+      break;
+    default:
+      cluster_resource_manager.RemoveNode(node_id);
+    }
+    if (i % 10 == 0) {
+      expect_sorted_nodes();
+    }
+  }
+  expect_sorted_nodes();
+  // A different spread threshold re-scores every node.
+  for (const auto &entry :
+       index.GetSortedNodes(cluster_resource_manager.GetResourceView(), 1.1)) {
+    ASSERT_EQ(entry.first, 0);
+  }
+}
+
+// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST_F(HybridSchedulingPolicyTest, DISABLED_BenchmarkScheduleWithNodeScoreIndex) {
+  // Schedule tasks one by one on a cluster of 5000 empty nodes, and subtract the
+  // resources of each task from the chosen node like the cluster task manager does.
+  const int num_nodes = 5000;
+  const int num_tasks = 20000;
+  for (int i = 0; i < num_nodes; i++) {
+    nodes.emplace(scheduling::NodeID(i), CreateNodeResources(16, 16, 64, 64, 0, 0));
+  }
+  auto cluster_resource_manager = MockClusterResourceManager(nodes);
+  CompositeSchedulingPolicy policy(
+      local_node, cluster_resource_manager, [](auto) { return true; });
+  auto req = ResourceMapToResourceRequest({{"CPU", 1}, {"memory", 1}}, false);
+  std::vector<double> latencies_us;
+  for (int i = 0; i < num_tasks; i++) {
+    auto start = absl::Now();
+    auto node_id = policy.Schedule(req, HybridOptions(0.5, false, false));
+    latencies_us.push_back(absl::ToDoubleMicroseconds(absl::Now() - start));
+    ASSERT_FALSE(node_id.IsNil());
+    cluster_resource_manager.SubtractNodeAvailableResources(node_id, req);
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  RAY_LOG(INFO) << num_tasks << " tasks on " << num_nodes
+                << " nodes: scheduling latency p50 " << latencies_us[num_tasks / 2]
+                << "us p99 " << latencies_us[num_tasks * 99 / 100] << "us";
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
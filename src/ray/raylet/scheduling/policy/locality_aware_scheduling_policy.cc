@@ -0,0 +1,221 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/scheduling/policy/locality_aware_scheduling_policy.h"
+
+#include <algorithm>
+
+namespace ray {
+
+namespace raylet_scheduling_policy {
+
+bool LocalityAwareSchedulingPolicy::IsNodeFeasible(
+    const scheduling::NodeID &node_id,
+    const NodeResources &node_resources,
+    const ResourceRequest &resource_request,
+    bool avoid_gpu_nodes) const {
+  if (!is_node_alive_(node_id)) {
+    return false;
+  }
+  if (avoid_gpu_nodes && node_resources.total.Has(ResourceID::GPU())) {
+    return false;
+  }
+  return node_resources.IsFeasible(resource_request);
+}
+
+scheduling::NodeID LocalityAwareSchedulingPolicy::GetBestNode(
+    std::vector<Candidate> &candidates,
+    size_t num_candidate_nodes,
+    scheduling::NodeID preferred_node_id) const {
+  RAY_CHECK(!candidates.empty());
+  // Sort by score and break ties by node ID, so that ties are always broken in the
+  // same order.
+  std::sort(candidates.begin(),
+            candidates.end(),
+            [](const Candidate &a, const Candidate &b) {
+              if (a.score != b.score) {
+                return a.score < b.score;
+              }
+              return a.node_id < b.node_id;
+            });
+  const float best_score = candidates.front().score;
+  for (const auto &candidate : candidates) {
+    if (candidate.score > best_score) {
+      break;
+    }
+    if (candidate.node_id == preferred_node_id) {
+      return preferred_node_id;
+    }
+  }
+  // Only pick among the top candidates that tie with the best one, since the others
+  // have fewer arguments local or a higher utilization.
+  size_t num_ties = 0;
+  while (num_ties < std::min(num_candidate_nodes, candidates.size()) &&
+         candidates[num_ties].score == best_score) {
+    num_ties++;
+  }
+  size_t node_index = absl::Uniform<size_t>(bitgenref_, 0u, num_ties);
+  return candidates[node_index].node_id;
+}
+
+scheduling::NodeID LocalityAwareSchedulingPolicy::ScheduleImpl(
+    const ResourceRequest &resource_request,
+    const SchedulingOptions &options,
+    const LocalityAwareSchedulingContext &context,
+    bool avoid_gpu_nodes,
+    bool require_node_available) {
+  scheduling::NodeID preferred_node_id = local_node_id_;
+  if (!options.preferred_node_id.empty()) {
+    auto new_id = scheduling::NodeID(options.preferred_node_id);
+    if (nodes_.contains(new_id)) {
+      preferred_node_id = new_id;
+    }
+  }
+  const float locality_weight = std::clamp(options.locality_weight, 0.0f, 1.0f);
+  const size_t num_candidate_nodes = std::max<size_t>(
+      std::max<int32_t>(
+          options.schedule_top_k_absolute,
+          static_cast<int32_t>(nodes_.size() * options.scheduler_top_k_fraction)),
+      1);
+
+  // Nodes that are feasible and currently have available resources.
+  std::vector<Candidate> available_nodes;
+  // Nodes that are feasible but currently do not have available resources.
+  std::vector<Candidate> feasible_and_unavailable_nodes;
+  // Score a node and add it to the candidates. Return whether it is available.
+  auto consider_node = [&](scheduling::NodeID node_id, int64_t bytes_local) {
+    if (options.avoid_local_node && node_id == preferred_node_id) {
+      return false;
+    }
+    auto it = nodes_.find(node_id);
+    if (it == nodes_.end()) {
+      return false;
+    }
+    const auto &node_resources = it->second.GetLocalView();
+    if (!IsNodeFeasible(node_id, node_resources, resource_request, avoid_gpu_nodes)) {
+      return false;
+    }
+    float remote_fraction = 1;
+    if (context.total_bytes_ > 0) {
+      remote_fraction =
+          1 - std::min<float>(1, static_cast<float>(bytes_local) / context.total_bytes_);
+    }
+    Candidate candidate;
+    candidate.node_id = node_id;
+    const float utilization_score =
+        NodeScoreIndex::ComputeNodeScore(node_resources, options.spread_threshold);
+    candidate.score =
+        (1 - locality_weight) * utilization_score + locality_weight * remote_fraction;
+    // It's okay if the preferred node's pull manager is at capacity because we will
+    // eventually spill the task back from the waiting queue if its args cannot be
+    // pulled.
+    bool is_available = node_resources.IsAvailable(
+        resource_request,
+        /*ignore_pull_manager_at_capacity*/ node_id == preferred_node_id);
+    if (is_available) {
+      available_nodes.push_back(candidate);
+    } else {
+      feasible_and_unavailable_nodes.push_back(candidate);
+    }
+    return is_available;
+  };
+
+  // The nodes that hold arguments differ in how many bytes they have local, so score
+  // each of them.
+  for (const auto &entry : context.bytes_local_table_) {
+    consider_node(entry.first, entry.second);
+  }
+  // The preferred node wins ties, so score it even if it holds no arguments.
+  if (!context.bytes_local_table_.contains(preferred_node_id)) {
+    consider_node(preferred_node_id, 0);
+  }
+  // All other nodes have no argument local, so the first available ones in the order
+  // of the index have the lowest scores among them. Only the top num_candidate_nodes
+  // of them can be picked.
+  NodeScoreIndex *node_score_index = node_score_index_;
+  if (node_score_index == nullptr) {
+    node_score_index = &own_node_score_index_;
+    node_score_index->MarkAllNodesChanged();
+  }
+  size_t num_available_without_arguments = 0;
+  size_t num_unavailable_without_arguments = 0;
+  for (const auto &entry :
+       node_score_index->GetSortedNodes(nodes_, options.spread_threshold)) {
+    if (num_available_without_arguments >= num_candidate_nodes) {
+      break;
+    }
+    const auto &node_id = entry.second;
+    if (node_id == preferred_node_id || context.bytes_local_table_.contains(node_id)) {
+      continue;
+    }
+    if (num_unavailable_without_arguments >= num_candidate_nodes) {
+      // Only look for available nodes from now on.
+      const auto &node_resources = nodes_.find(node_id)->second.GetLocalView();
+      if (!node_resources.IsAvailable(resource_request)) {
+        continue;
+      }
+    }
+    const size_t num_unavailable_nodes = feasible_and_unavailable_nodes.size();
+    if (consider_node(node_id, 0)) {
+      num_available_without_arguments++;
+    } else if (feasible_and_unavailable_nodes.size() > num_unavailable_nodes) {
+      num_unavailable_without_arguments++;
+    }
+  }
+
+  if (!available_nodes.empty()) {
+    return GetBestNode(available_nodes, num_candidate_nodes, preferred_node_id);
+  } else if (!feasible_and_unavailable_nodes.empty() && !require_node_available) {
+    return GetBestNode(
+        feasible_and_unavailable_nodes, num_candidate_nodes, preferred_node_id);
+  } else {
+    return scheduling::NodeID::Nil();
+  }
+}
+
+scheduling::NodeID LocalityAwareSchedulingPolicy::Schedule(
+    const ResourceRequest &resource_request, SchedulingOptions options) {
+  RAY_CHECK(options.scheduling_type == SchedulingType::LOCALITY_AWARE)
+      << "LocalityAwarePolicy policy requires type = LOCALITY_AWARE";
+  const auto *context = dynamic_cast<const LocalityAwareSchedulingContext *>(
+      options.scheduling_context.get());
+  RAY_CHECK(context != nullptr);
+  if (!options.avoid_gpu_nodes || resource_request.Has(ResourceID::GPU())) {
+    return ScheduleImpl(resource_request,
+                        options,
+                        *context,
+                        /*avoid_gpu_nodes*/ false,
+                        options.require_node_available);
+  }
+
+  // Try schedule on non-GPU nodes.
+  auto best_node_id = ScheduleImpl(resource_request,
+                                   options,
+                                   *context,
+                                   /*avoid_gpu_nodes*/ true,
+                                   /*require_node_available*/ true);
+  if (!best_node_id.IsNil()) {
+    return best_node_id;
+  }
+
+  // If we cannot find any available node from non-gpu nodes, fallback to all nodes.
+  return ScheduleImpl(resource_request,
+                      options,
+                      *context,
+                      /*avoid_gpu_nodes*/ false,
+                      options.require_node_available);
+}
+
+}  // namespace raylet_scheduling_policy
+}  // namespace ray
@@ -0,0 +1,111 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "absl/random/bit_gen_ref.h"
+#include "absl/random/random.h"
+#include "ray/raylet/scheduling/node_score_index.h"
+#include "ray/raylet/scheduling/policy/scheduling_policy.h"
+
+namespace ray {
+namespace raylet_scheduling_policy {
+
+/// Policy that weighs the resource utilization of a node against the bytes of the
+/// task's arguments that the node would have to fetch. A node's score is
+///
+///   (1 - locality_weight) * utilization score + locality_weight * remote fraction
+///
+/// where the utilization score is the one of the hybrid policy and the remote fraction
+/// is the fraction of the argument bytes (from the LocalityAwareSchedulingContext) that
+/// the node doesn't have local. Like the hybrid policy, available nodes are always
+/// preferred over feasible ones, the preferred node is picked if no node has a lower
+/// score, and otherwise a node is picked randomly among the top k nodes. Only the top
+/// k nodes that tie with the lowest score are picked from, so that a node with more
+/// arguments local is not traded for a random one.
+///
+/// Only the nodes that hold arguments need to be scored one by one. All other nodes have
+/// the same remote fraction, so the best k of them are the first ones in the order of
+/// the NodeScoreIndex.
+class LocalityAwareSchedulingPolicy : public ISchedulingPolicy {
+ public:
+  /// \param node_score_index The index of `nodes`, which is kept up to date by the owner
+  /// of the nodes. If it is null, the policy uses its own index and re-scores every
+  /// node for each request.
+  LocalityAwareSchedulingPolicy(
+      scheduling::NodeID local_node_id,
+      const absl::flat_hash_map<scheduling::NodeID, Node> &nodes,
+      std::function<bool(scheduling::NodeID)> is_node_alive,
+      NodeScoreIndex *node_score_index = nullptr)
+      : local_node_id_(local_node_id),
+        nodes_(nodes),
+        is_node_alive_(is_node_alive),
+        node_score_index_(node_score_index),
+        bitgen_(),
+        bitgenref_(bitgen_) {}
+
+  scheduling::NodeID Schedule(const ResourceRequest &resource_request,
+                              SchedulingOptions options) override;
+
+ private:
+  /// A scored node that the request can be scheduled on.
+  struct Candidate {
+    scheduling::NodeID node_id = scheduling::NodeID::Nil();
+    float score = 0;
+  };
+
+  /// Return true if the node is alive, its total resources satisfy the request and,
+  /// if avoid_gpu_nodes is set, it has no GPU.
+  bool IsNodeFeasible(const scheduling::NodeID &node_id,
+                      const NodeResources &node_resources,
+                      const ResourceRequest &resource_request,
+                      bool avoid_gpu_nodes) const;
+
+  /// Pick a node among the top num_candidate_nodes candidates. The preferred node is
+  /// picked if it is a candidate and no candidate has a lower score. Otherwise a node
+  /// is picked randomly among the top candidates that tie with the lowest score.
+  scheduling::NodeID GetBestNode(std::vector<Candidate> &candidates,
+                                 size_t num_candidate_nodes,
+                                 scheduling::NodeID preferred_node_id) const;
+
+  /// \param avoid_gpu_nodes: Only schedule on nodes that have no GPU.
+  /// \param require_node_available: Only schedule on nodes that have the resources
+  /// of the request available.
+  /// \return Nil if no node can be picked, otherwise the ID of the best node.
+  scheduling::NodeID ScheduleImpl(const ResourceRequest &resource_request,
+                                  const SchedulingOptions &options,
+                                  const LocalityAwareSchedulingContext &context,
+                                  bool avoid_gpu_nodes,
+                                  bool require_node_available);
+
+  /// Identifier of local node.
+  const scheduling::NodeID local_node_id_;
+  /// List of nodes in the clusters and their resources organized as a map.
+  /// The key of the map is the node ID.
+  const absl::flat_hash_map<scheduling::NodeID, Node> &nodes_;
+  /// Function Checks if node is alive.
+  std::function<bool(scheduling::NodeID)> is_node_alive_;
+  /// The index of the nodes sorted by score, if the owner of the nodes keeps one.
+  NodeScoreIndex *node_score_index_;
+  /// The index used if the owner of the nodes doesn't keep one.
+  NodeScoreIndex own_node_score_index_;
+  /// Random number generator to choose a random node out of the top K.
+  mutable absl::BitGen bitgen_;
+  /// Using BitGenRef to simplify testing.
+  mutable absl::BitGenRef bitgenref_;
+};
+}  // namespace raylet_scheduling_policy
+}  // namespace ray
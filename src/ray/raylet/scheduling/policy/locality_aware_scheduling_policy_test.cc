@@ -0,0 +1,233 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/scheduling/policy/locality_aware_scheduling_policy.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "gtest/gtest.h"
+#include "ray/raylet/scheduling/policy/composite_scheduling_policy.h"
+
+namespace ray {
+
+namespace raylet_scheduling_policy {
+
+class LocalityAwareSchedulingPolicyTest : public ::testing::Test {
+ public:
+  scheduling::NodeID local_node = scheduling::NodeID(0);
+  scheduling::NodeID n1 = scheduling::NodeID(1);
+  scheduling::NodeID n2 = scheduling::NodeID(2);
+  scheduling::NodeID n3 = scheduling::NodeID(3);
+  ClusterResourceManager cluster_resource_manager;
+
+  void AddNode(ClusterResourceManager &manager,
+               scheduling::NodeID node_id,
+               double total_cpu,
+               double available_cpu) {
+    manager.AddOrUpdateNode(node_id,
+                            ResourceMapToNodeResources({{"CPU", total_cpu}},
+                                                       {{"CPU", available_cpu}}));
+  }
+
+  void AddNode(scheduling::NodeID node_id, double total_cpu, double available_cpu) {
+    AddNode(cluster_resource_manager, node_id, total_cpu, available_cpu);
+  }
+
+  SchedulingOptions LocalityAwareOptions(
+      absl::flat_hash_map<scheduling::NodeID, int64_t> bytes_local_table,
+      int64_t total_bytes,
+      float locality_weight,
+      bool avoid_local_node = false,
+      bool require_node_available = false) {
+    auto options = SchedulingOptions::LocalityAware(
+        avoid_local_node,
+        require_node_available,
+        /*preferred_node_id*/ "",
+        std::make_unique<LocalityAwareSchedulingContext>(std::move(bytes_local_table),
+                                                         total_bytes));
+    options.locality_weight = locality_weight;
+    return options;
+  }
+
+  scheduling::NodeID Schedule(const SchedulingOptions &options) {
+    LocalityAwareSchedulingPolicy policy(
+        local_node,
+        cluster_resource_manager.GetResourceView(),
+        [](auto) { return true; },
+        &cluster_resource_manager.GetNodeScoreIndex());
+    return policy.Schedule(ResourceMapToResourceRequest({{"CPU", 1}}, false), options);
+  }
+
+  /// Run the reduce stage of a shuffle in a simulated cluster, and return the number
+  /// of argument bytes that had to be transferred to the nodes that the reduce tasks
+  /// were scheduled on.
+  int64_t SimulateShuffle(bool locality_aware, int num_nodes, int num_reducers);
+};
+
+TEST_F(LocalityAwareSchedulingPolicyTest, PreferNodeWithMostArgumentBytes) {
+  AddNode(local_node, 8, 0);
+  AddNode(n1, 8, 8);
+  AddNode(n2, 8, 8);
+  AddNode(n3, 8, 8);
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{n1, 100}, {n2, 900}}, 1000, 0.5)), n2);
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{n1, 600}, {n2, 400}}, 1000, 0.5)), n1);
+}
+
+TEST_F(LocalityAwareSchedulingPolicyTest, WeighLocalityAgainstUtilization) {
+  AddNode(local_node, 8, 0);
+  // n1 has a small part of the arguments but is busy.
+  AddNode(n1, 8, 1);
+  AddNode(n2, 8, 8);
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{n1, 100}}, 1000, 0.5)), n2);
+  // Locality wins if it has all the weight.
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{n1, 100}}, 1000, 1)), n1);
+  // If n1 has all the arguments, locality wins at the default weight.
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{n1, 1000}}, 1000, 0.5)), n1);
+}
+
+TEST_F(LocalityAwareSchedulingPolicyTest, PreferAvailableNodes) {
+  AddNode(local_node, 8, 0);
+  AddNode(n1, 8, 0);
+  AddNode(n2, 8, 8);
+  // n1 has all the arguments but no CPU available.
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{n1, 1000}}, 1000, 1)), n2);
+  // If no node is available, pick the feasible node with the arguments.
+  AddNode(n2, 8, 0);
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{n1, 1000}}, 1000, 1)), n1);
+  ASSERT_TRUE(Schedule(LocalityAwareOptions({{n1, 1000}},
+                                            1000,
+                                            1,
+                                            /*avoid_local_node*/ false,
+                                            /*require_node_available*/ true))
+                  .IsNil());
+}
+
+TEST_F(LocalityAwareSchedulingPolicyTest, PreferLocalNode) {
+  AddNode(local_node, 8, 8);
+  AddNode(n1, 8, 8);
+  // Break ties in favor of the local node.
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{n1, 500}, {local_node, 500}}, 1000, 0.5)),
+            local_node);
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{n1, 500}}, 1000, 0)), local_node);
+  // Unless the local node is avoided.
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{local_node, 1000}},
+                                          1000,
+                                          0.5,
+                                          /*avoid_local_node*/ true)),
+            n1);
+}
+
+TEST_F(LocalityAwareSchedulingPolicyTest, SkipNodesWithoutArguments) {
+  AddNode(local_node, 8, 0);
+  AddNode(n1, 8, 8);
+  AddNode(n2, 8, 8);
+  AddNode(n3, 8, 8);
+  // No node has any argument, so pick the best node by utilization and node ID, since
+  // the top k is 1 for this cluster size.
+  ASSERT_EQ(Schedule(LocalityAwareOptions({{scheduling::NodeID(100), 1000}}, 1000, 0.5)),
+            n1);
+}
+
+TEST_F(LocalityAwareSchedulingPolicyTest, PickRandomlyAmongTiedTopKNodes) {
+  AddNode(local_node, 8, 0);
+  AddNode(n1, 8, 8);
+  AddNode(n2, 8, 8);
+  AddNode(n3, 8, 8);
+  // No node has any argument, so n1, n2 and n3 tie.
+  absl::flat_hash_set<scheduling::NodeID> picked_nodes;
+  for (int i = 0; i < 100; i++) {
+    auto options = LocalityAwareOptions({{scheduling::NodeID(100), 1000}}, 1000, 0.5);
+    options.schedule_top_k_absolute = 3;
+    auto node_id = Schedule(options);
+    ASSERT_TRUE(node_id == n1 || node_id == n2 || node_id == n3);
+    picked_nodes.insert(node_id);
+  }
+  ASSERT_GT(picked_nodes.size(), 1);
+
+  // A node with more arguments local doesn't tie with the others.
+  for (int i = 0; i < 100; i++) {
+    auto options = LocalityAwareOptions({{n2, 100}}, 1000, 0.5);
+    options.schedule_top_k_absolute = 3;
+    ASSERT_EQ(Schedule(options), n2);
+  }
+}
+
+int64_t LocalityAwareSchedulingPolicyTest::SimulateShuffle(bool locality_aware,
+                                                           int num_nodes,
+                                                           int num_reducers) {
+  const int64_t kMB = 1024 * 1024;
+  ClusterResourceManager manager;
+  // The driver's node is busy, so every reduce task is spilled to another node.
+  AddNode(manager, local_node, 8, 0);
+  for (int i = 1; i <= num_nodes; i++) {
+    AddNode(manager, scheduling::NodeID(i), 8, 8);
+  }
+  CompositeSchedulingPolicy policy(local_node, manager, [](auto) { return true; });
+  const auto resource_request = ResourceMapToResourceRequest({{"CPU", 1}}, false);
+
+  int64_t bytes_transferred = 0;
+  for (int reducer = 0; reducer < num_reducers; reducer++) {
+    // There is one map task per node, and each reduce task reads one partition of
+    // every map output. The inputs are partially co-partitioned with the reduce keys,
+    // so the partition from one of the mappers is much larger than the others.
+    absl::flat_hash_map<scheduling::NodeID, int64_t> bytes_local_table;
+    int64_t total_bytes = 0;
+    for (int mapper = 1; mapper <= num_nodes; mapper++) {
+      int64_t partition_size = (reducer % num_nodes + 1 == mapper) ? 256 * kMB : 8 * kMB;
+      bytes_local_table[scheduling::NodeID(mapper)] += partition_size;
+      total_bytes += partition_size;
+    }
+
+    scheduling::NodeID node_id;
+    if (locality_aware) {
+      auto options = SchedulingOptions::LocalityAware(
+          /*avoid_local_node*/ false,
+          /*require_node_available*/ false,
+          /*preferred_node_id*/ "",
+          std::make_unique<LocalityAwareSchedulingContext>(bytes_local_table,
+                                                           total_bytes));
+      options.locality_weight = 0.5;
+      node_id = policy.Schedule(resource_request, options);
+    } else {
+      node_id = policy.Schedule(resource_request,
+                                SchedulingOptions::Hybrid(
+                                    /*avoid_local_node*/ false,
+                                    /*require_node_available*/ false));
+    }
+    RAY_CHECK(!node_id.IsNil());
+    RAY_CHECK(manager.SubtractNodeAvailableResources(node_id, resource_request));
+    bytes_transferred += total_bytes - bytes_local_table[node_id];
+  }
+  return bytes_transferred;
+}
+
+/// Benchmark the bytes that the reduce stage of a shuffle transfers, when the tasks are
+/// placed by the hybrid policy and by the locality aware policy. Disabled by default,
+/// run it with --gtest_also_run_disabled_tests.
+TEST_F(LocalityAwareSchedulingPolicyTest, DISABLED_BenchmarkShuffleBytesTransferred) {
+  const int num_nodes = 16;
+  const int num_reducers = 64;
+  const int64_t hybrid_bytes =
+      SimulateShuffle(/*locality_aware*/ false, num_nodes, num_reducers);
+  const int64_t locality_aware_bytes =
+      SimulateShuffle(/*locality_aware*/ true, num_nodes, num_reducers);
+  RAY_LOG(INFO) << num_reducers << " reduce tasks on " << num_nodes
+                << " nodes transferred " << hybrid_bytes / (1024 * 1024)
+                << "MB with the hybrid policy and "
+                << locality_aware_bytes / (1024 * 1024)
+                << "MB with the locality aware policy";
+  ASSERT_LT(locality_aware_bytes, hybrid_bytes);
+}
+
+}  // namespace raylet_scheduling_policy
+}  // namespace ray
@@ -19,6 +19,7 @@
 #include "ray/common/bundle_spec.h"
 #include "ray/common/id.h"
 #include "ray/common/placement_group.h"
+#include "ray/raylet/scheduling/scheduling_ids.h"
 
 namespace ray {
 namespace raylet_scheduling_policy {
@@ -48,5 +49,18 @@ struct AffinityWithBundleSchedulingContext : public SchedulingContext {
   BundleID affinity_bundle_id_;
 };
 
+struct LocalityAwareSchedulingContext : public SchedulingContext {
+ public:
+  LocalityAwareSchedulingContext(
+      absl::flat_hash_map<scheduling::NodeID, int64_t> bytes_local_table,
+      int64_t total_bytes)
+      : bytes_local_table_(std::move(bytes_local_table)), total_bytes_(total_bytes) {}
+
+  /// Number of argument bytes that a given node has local.
+  absl::flat_hash_map<scheduling::NodeID, int64_t> bytes_local_table_;
+  /// Total size of the arguments whose locations are known.
+  int64_t total_bytes_;
+};
+
 }  // namespace raylet_scheduling_policy
 }  // namespace ray
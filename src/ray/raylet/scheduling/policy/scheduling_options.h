@@ -36,7 +36,8 @@ enum class SchedulingType {
   BUNDLE_SPREAD = 5,
   BUNDLE_STRICT_PACK = 6,
   BUNDLE_STRICT_SPREAD = 7,
-  AFFINITY_WITH_BUNDLE = 8
+  AFFINITY_WITH_BUNDLE = 8,
+  LOCALITY_AWARE = 9
 };
 
 // Options that controls the scheduling behavior.
@@ -72,6 +73,21 @@ struct SchedulingOptions {
                              preferred_node_id);
   }
 
+  // construct option for locality aware scheduling policy.
+  static SchedulingOptions LocalityAware(
+      bool avoid_local_node,
+      bool require_node_available,
+      const std::string &preferred_node_id,
+      std::unique_ptr<LocalityAwareSchedulingContext> scheduling_context) {
+    SchedulingOptions scheduling_options =
+        Hybrid(avoid_local_node, require_node_available, preferred_node_id);
+    scheduling_options.scheduling_type = SchedulingType::LOCALITY_AWARE;
+    scheduling_options.scheduling_context = std::move(scheduling_context);
+    scheduling_options.locality_weight =
+        RayConfig::instance().scheduler_locality_weight();
+    return scheduling_options;
+  }
+
   static SchedulingOptions NodeAffinity(bool avoid_local_node,
                                         bool require_node_available,
                                         std::string node_id,
@@ -170,6 +186,9 @@ struct SchedulingOptions {
   std::string preferred_node_id;
   int32_t schedule_top_k_absolute;
   float scheduler_top_k_fraction;
+  // The weight of argument locality against resource utilization, between 0 and 1.
+  // This is only used for the locality aware scheduling policy.
+  float locality_weight = 0;
 
  private:
   SchedulingOptions(
@@ -152,6 +152,41 @@ TEST_F(ResourceRequestTest, TestOperators) {
   ASSERT_EQ(r1.ToMap(), expected);
 }
 
+TEST_F(ResourceRequestTest, TestPredefinedAndCustomResources) {
+  auto cpu_id = ResourceID::CPU();
+  auto mem_id = ResourceID::Memory();
+  auto gpu_id = ResourceID::GPU();
+  auto custom_id1 = ResourceID("custom1");
+  ResourceRequest r1({{custom_id1, 1}, {gpu_id, 2}, {cpu_id, 3}});
+
+  // Predefined resources are iterated first, in the order of PredefinedResourcesEnum.
+  std::vector<ResourceID> resource_ids;
+  for (auto &resource_id : r1.ResourceIds()) {
+    resource_ids.push_back(resource_id);
+  }
+  ASSERT_EQ(resource_ids, std::vector<ResourceID>({cpu_id, gpu_id, custom_id1}));
+  ASSERT_EQ(r1.ResourceIds().begin()->Binary(), kCPU_ResourceLabel);
+  ASSERT_EQ(r1.Size(), 3);
+
+  // A predefined resource that drops to 0 is removed.
+  r1 -= ResourceRequest({{cpu_id, 3}, {mem_id, 1}});
+  ASSERT_FALSE(r1.Has(cpu_id));
+  ASSERT_TRUE(r1.Has(mem_id));
+  ASSERT_EQ(r1.Get(mem_id), -1);
+  ASSERT_EQ(r1.Size(), 3);
+  ASSERT_EQ(r1, ResourceRequest({{mem_id, -1}, {gpu_id, 2}, {custom_id1, 1}}));
+
+  // Missing predefined resources count as 0 on both sides of a comparison.
+  ASSERT_TRUE(r1 <= ResourceRequest({{gpu_id, 2}, {custom_id1, 1}}));
+  ASSERT_FALSE(ResourceRequest({{gpu_id, 2}, {custom_id1, 1}}) <= r1);
+  r1.RemoveNegative();
+  ASSERT_FALSE(r1.Has(mem_id));
+  ASSERT_EQ(r1.Size(), 2);
+  r1.Clear();
+  ASSERT_TRUE(r1.IsEmpty());
+  ASSERT_EQ(r1.ResourceIds().begin(), r1.ResourceIds().end());
+}
+
 class TaskResourceInstancesTest : public ::testing::Test {};
 
 TEST_F(TaskResourceInstancesTest, TestBasic) {
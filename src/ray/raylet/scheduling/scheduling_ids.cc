@@ -16,68 +16,145 @@
 
 namespace ray {
 
+namespace {
+/// The number of slots of the first index of a map.
+constexpr size_t kInitialIndexCapacity = 16;
+}  // namespace
+
+StringIdMap::Index::Index(size_t capacity)
+    : capacity(capacity),
+      by_string_id(new std::atomic<const Entry *>[capacity]),
+      by_id(new std::atomic<const Entry *>[capacity]) {
+  for (size_t i = 0; i < capacity; i++) {
+    by_string_id[i].store(nullptr, std::memory_order_relaxed);
+    by_id[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+StringIdMap::StringIdMap() {
+  indexes_.emplace_back(new Index(kInitialIndexCapacity));
+  index_.store(indexes_.back().get(), std::memory_order_release);
+}
+
+size_t StringIdMap::HashId(int64_t id) {
+  // The IDs of the predefined resources and of the test maps are small integers, so
+  // spread them over the table.
+  uint64_t hash = static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ULL;
+  return hash ^ (hash >> 32);
+}
+
+const StringIdMap::Entry *StringIdMap::Find(const std::string &string_id) const {
+  const Index *index = index_.load(std::memory_order_acquire);
+  const size_t mask = index->capacity - 1;
+  const size_t hash = hasher_(string_id);
+  // The index is never more than half full, so the probing ends at an empty slot.
+  for (size_t i = hash & mask; true; i = (i + 1) & mask) {
+    const Entry *entry = index->by_string_id[i].load(std::memory_order_acquire);
+    if (entry == nullptr) {
+      return nullptr;
+    }
+    if (entry->string_hash == hash && entry->string_id == string_id) {
+      return entry;
+    }
+  }
+}
+
+const StringIdMap::Entry *StringIdMap::Find(int64_t id) const {
+  const Index *index = index_.load(std::memory_order_acquire);
+  const size_t mask = index->capacity - 1;
+  for (size_t i = HashId(id) & mask; true; i = (i + 1) & mask) {
+    const Entry *entry = index->by_id[i].load(std::memory_order_acquire);
+    if (entry == nullptr || entry->id == id) {
+      return entry;
+    }
+  }
+}
+
+void StringIdMap::AddToIndex(const Entry &entry, Index &index) {
+  const size_t mask = index.capacity - 1;
+  size_t i = entry.string_hash & mask;
+  while (index.by_string_id[i].load(std::memory_order_relaxed) != nullptr) {
+    i = (i + 1) & mask;
+  }
+  index.by_string_id[i].store(&entry, std::memory_order_release);
+  i = HashId(entry.id) & mask;
+  while (index.by_id[i].load(std::memory_order_relaxed) != nullptr) {
+    i = (i + 1) & mask;
+  }
+  index.by_id[i].store(&entry, std::memory_order_release);
+}
+
+void StringIdMap::Add(const std::string &string_id, int64_t id) {
+  Index *index = indexes_.back().get();
+  if (2 * (entries_.size() + 1) > index->capacity) {
+    // Fill a new index before publishing it, so that lookups always see all entries
+    // that were added before.
+    indexes_.emplace_back(new Index(2 * index->capacity));
+    index = indexes_.back().get();
+    for (const auto &entry : entries_) {
+      AddToIndex(entry, *index);
+    }
+    index_.store(index, std::memory_order_release);
+  }
+  entries_.push_back(Entry{string_id, id, hasher_(string_id)});
+  AddToIndex(entries_.back(), *index);
+  count_.fetch_add(1, std::memory_order_relaxed);
+}
+
 int64_t StringIdMap::Get(const std::string &string_id) const {
-  absl::ReaderMutexLock lock(&mutex_);
-  auto it = string_to_int_.find(string_id);
-  if (it == string_to_int_.end()) {
+  const Entry *entry = Find(string_id);
+  if (entry == nullptr) {
     return -1;
   } else {
-    return it->second;
+    return entry->id;
   }
 };
 
 std::string StringIdMap::Get(uint64_t id) const {
-  absl::ReaderMutexLock lock(&mutex_);
-  std::string id_string;
-  auto it = int_to_string_.find(id);
-  if (it == int_to_string_.end()) {
-    id_string = "-1";
+  const Entry *entry = Find(static_cast<int64_t>(id));
+  if (entry == nullptr) {
+    return "-1";
   } else {
-    id_string = it->second;
+    return entry->string_id;
   }
-  return id_string;
 };
 
 int64_t StringIdMap::Insert(const std::string &string_id, uint8_t max_id) {
-  absl::WriterMutexLock lock(&mutex_);
-  auto sit = string_to_int_.find(string_id);
-  if (sit == string_to_int_.end()) {
-    int64_t id = hasher_(string_id);
-    if (max_id != 0) {
-      id = id % MAX_ID_TEST;
+  if (const Entry *entry = Find(string_id)) {
+    return entry->id;
+  }
+  absl::MutexLock lock(&mutex_);
+  // Another thread may have inserted the string ID since the lookup above.
+  if (const Entry *entry = Find(string_id)) {
+    return entry->id;
+  }
+  int64_t id = hasher_(string_id);
+  if (max_id != 0) {
+    id = id % MAX_ID_TEST;
+  }
+  for (size_t i = 0; true; i++) {
+    if (Find(id) == nullptr) {
+      /// No hash collision, so associate string_id with id.
+      Add(string_id, id);
+      break;
     }
-    for (size_t i = 0; true; i++) {
-      auto it = int_to_string_.find(id);
-      if (it == int_to_string_.end()) {
-        /// No hash collision, so associate string_id with id.
-        string_to_int_.emplace(string_id, id);
-        int_to_string_.emplace(id, string_id);
-        break;
-      }
-      id = hasher_(string_id + std::to_string(i));
-      if (max_id != 0) {
-        id = id % max_id;
-      }
+    id = hasher_(string_id + std::to_string(i));
+    if (max_id != 0) {
+      id = id % max_id;
     }
-    return id;
-  } else {
-    return sit->second;
   }
+  return id;
 };
 
 StringIdMap &StringIdMap::InsertOrDie(const std::string &string_id, int64_t value) {
-  absl::WriterMutexLock lock(&mutex_);
-  RAY_CHECK(string_to_int_.emplace(string_id, value).second)
-      << string_id << " or " << value << " already exist!";
-  RAY_CHECK(int_to_string_.emplace(value, string_id).second)
+  absl::MutexLock lock(&mutex_);
+  RAY_CHECK(Find(string_id) == nullptr && Find(value) == nullptr)
       << string_id << " or " << value << " already exist!";
+  Add(string_id, value);
   return *this;
 }
 
-int64_t StringIdMap::Count() {
-  absl::ReaderMutexLock lock(&mutex_);
-  return string_to_int_.size();
-}
+int64_t StringIdMap::Count() { return count_.load(std::memory_order_relaxed); }
 
 namespace scheduling {
 
@@ -14,9 +14,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <boost/algorithm/string.hpp>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -46,14 +50,15 @@ const std::string kMemory_ResourceLabel = "memory";
 const std::string kBundle_ResourceLabel = "bundle";
 
 /// Class to map string IDs to unique integer IDs and back.
+///
+/// Lookups never take a lock. The mappings are appended to a list that never
+/// shrinks, and are indexed by two hash tables, from the string ID and from the
+/// integer ID. Only inserting a new string ID takes the mutex. When an index gets
+/// half full, it is replaced by a copy of twice the size. The old index is kept
+/// until the map is destroyed, because a concurrent lookup may still read it.
 class StringIdMap {
-  absl::flat_hash_map<std::string, int64_t> string_to_int_;
-  absl::flat_hash_map<int64_t, std::string> int_to_string_;
-  std::hash<std::string> hasher_;
-  mutable absl::Mutex mutex_;
-
  public:
-  StringIdMap(){};
+  StringIdMap();
   ~StringIdMap(){};
 
   /// Get integer ID associated with an existing string ID.
@@ -85,6 +90,48 @@ class StringIdMap {
 
   /// Get number of identifiers.
   int64_t Count();
+
+ private:
+  /// A mapping between a string ID and an integer ID.
+  struct Entry {
+    std::string string_id;
+    int64_t id;
+    size_t string_hash;
+  };
+
+  /// Open addressing hash tables of the entries, with linear probing. A slot is
+  /// either null or points to an entry, and is never changed once it is set.
+  struct Index {
+    explicit Index(size_t capacity);
+    /// The number of slots of each table, which is a power of two.
+    const size_t capacity;
+    std::unique_ptr<std::atomic<const Entry *>[]> by_string_id;
+    std::unique_ptr<std::atomic<const Entry *>[]> by_id;
+  };
+
+  static size_t HashId(int64_t id);
+
+  const Entry *Find(const std::string &string_id) const;
+
+  const Entry *Find(int64_t id) const;
+
+  /// Add a mapping that doesn't exist yet, and grow the index if needed.
+  void Add(const std::string &string_id, int64_t id) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Insert an entry into the slots of an index.
+  static void AddToIndex(const Entry &entry, Index &index);
+
+  std::hash<std::string> hasher_;
+  /// The current index, which contains all entries.
+  std::atomic<const Index *> index_;
+  std::atomic<int64_t> count_{0};
+  /// Serializes inserts.
+  absl::Mutex mutex_;
+  /// All entries, in insertion order. A deque never moves its elements when it
+  /// grows, so the indexes can point to them.
+  std::deque<Entry> entries_ GUARDED_BY(mutex_);
+  /// The current index and all indexes that it replaced.
+  std::vector<std::unique_ptr<Index>> indexes_ GUARDED_BY(mutex_);
 };
 
 enum class SchedulingIDTag { Node, Resource };
@@ -14,6 +14,9 @@
 
 #include "ray/raylet/scheduling/scheduling_ids.h"
 
+#include <thread>
+
+#include "absl/time/clock.h"
 #include "gtest/gtest.h"
 
 namespace ray {
@@ -65,4 +68,73 @@ TEST_F(SchedulingIDsTest, UnitInstanceResourceTest) {
   ASSERT_FALSE(ResourceID::Memory().IsUnitInstanceResource());
   ASSERT_FALSE(ResourceID("custom2").IsUnitInstanceResource());
 }
+
+TEST_F(SchedulingIDsTest, ConcurrentInsertTest) {
+  StringIdMap ids;
+  const int num_threads = 16;
+  const int num_names = 2000;
+  // Every thread inserts the same names in a different order while the others read
+  // them, so the index grows under concurrent lookups.
+  std::vector<std::vector<int64_t>> ids_by_thread(num_threads,
+                                                  std::vector<int64_t>(num_names));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ids, &ids_by_thread, t]() {
+      for (int i = 0; i < num_names; i++) {
+        int name = (i * 7 + t * 131) % num_names;
+        int64_t id = ids.Insert("name" + std::to_string(name));
+        ASSERT_EQ(ids.Get("name" + std::to_string(name)), id);
+        ASSERT_EQ(ids.Get(id), "name" + std::to_string(name));
+        ids_by_thread[t][name] = id;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(ids.Count(), num_names);
+  for (int t = 1; t < num_threads; t++) {
+    ASSERT_EQ(ids_by_thread[t], ids_by_thread[0]);
+  }
+}
+
+/// Benchmark converting resource maps to resource IDs and back from many threads at
+/// once, as the raylet, GCS and core worker threads do for protobuf resource maps.
+/// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST_F(SchedulingIDsTest, DISABLED_BenchmarkConcurrentResourceMapConversion) {
+  const std::vector<std::string> resource_map = {kCPU_ResourceLabel,
+                                                 kGPU_ResourceLabel,
+                                                 kMemory_ResourceLabel,
+                                                 kObjectStoreMemory_ResourceLabel,
+                                                 "node:127.0.0.1",
+                                                 "accelerator_type:V100",
+                                                 "custom1",
+                                                 "custom2"};
+  const int num_threads = 16;
+  const int num_conversions = 100000;
+  std::vector<std::thread> threads;
+  std::atomic<int64_t> checksum{0};
+  auto start = absl::Now();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&]() {
+      int64_t sum = 0;
+      for (int i = 0; i < num_conversions; i++) {
+        for (const auto &name : resource_map) {
+          ResourceID resource_id(name);
+          sum += resource_id.ToInt() + resource_id.Binary().size();
+        }
+      }
+      checksum += sum;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = absl::Now() - start;
+  const int64_t num_lookups = 2 * num_threads * num_conversions * resource_map.size();
+  RAY_LOG(INFO) << num_threads << " threads converted " << num_threads * num_conversions
+                << " resource maps in " << absl::ToDoubleMilliseconds(elapsed) << "ms, "
+                << num_lookups / absl::ToDoubleSeconds(elapsed) << " lookups/s, checksum "
+                << checksum;
+}
 }  // namespace ray
@@ -0,0 +1,403 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/local_fs_spill_backend.h"
+
+#include <filesystem>
+#include <future>
+#include <random>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "gtest/gtest.h"
+#include "ray/object_manager/spilled_object_reader.h"
+#include "ray/util/util.h"
+
+namespace ray {
+
+namespace raylet {
+
+namespace {
+const uint64_t kMB = 1024 * 1024;
+}  // namespace
+
+/// A plasma client that stores objects in local memory.
+class FakePlasmaClient : public plasma::PlasmaClientInterface {
+ public:
+  struct Object {
+    std::shared_ptr<Buffer> data;
+    std::string metadata;
+    rpc::Address owner_address;
+    bool sealed = false;
+  };
+
+  Status Release(const ObjectID &object_id) override { return Status::OK(); }
+
+  Status Disconnect() override { return Status::OK(); }
+
+  Status Get(const std::vector<ObjectID> &object_ids,
+             int64_t timeout_ms,
+             std::vector<plasma::ObjectBuffer> *object_buffers,
+             bool is_from_worker) override {
+    return Status::NotImplemented("Get");
+  }
+
+  Status Seal(const ObjectID &object_id) override {
+    absl::MutexLock lock(&mutex_);
+    objects_[object_id].sealed = true;
+    return Status::OK();
+  }
+
+  Status Abort(const ObjectID &object_id) override {
+    absl::MutexLock lock(&mutex_);
+    objects_.erase(object_id);
+    return Status::OK();
+  }
+
+  Status CreateAndSpillIfNeeded(const ObjectID &object_id,
+                                const rpc::Address &owner_address,
+                                int64_t data_size,
+                                const uint8_t *metadata,
+                                int64_t metadata_size,
+                                std::shared_ptr<Buffer> *data,
+                                plasma::flatbuf::ObjectSource source,
+                                int device_num) override {
+    absl::MutexLock lock(&mutex_);
+    if (objects_.contains(object_id)) {
+      return Status::ObjectExists("exists");
+    }
+    auto &object = objects_[object_id];
+    object.data = std::make_shared<LocalMemoryBuffer>(data_size);
+    object.metadata =
+        std::string(reinterpret_cast<const char *>(metadata), metadata_size);
+    object.owner_address = owner_address;
+    *data = object.data;
+    return Status::OK();
+  }
+
+  Status Delete(const std::vector<ObjectID> &object_ids) override {
+    absl::MutexLock lock(&mutex_);
+    for (const auto &object_id : object_ids) {
+      objects_.erase(object_id);
+    }
+    return Status::OK();
+  }
+
+  Object GetObject(const ObjectID &object_id) {
+    absl::MutexLock lock(&mutex_);
+    return objects_.at(object_id);
+  }
+
+ private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<ObjectID, Object> objects_ GUARDED_BY(mutex_);
+};
+
+class LocalFsSpillBackendTest : public ::testing::TestWithParam<bool> {
+ public:
+  LocalFsSpillBackendTest()
+      : directory_(std::filesystem::temp_directory_path() / GenerateUUIDV4()),
+        store_client_(std::make_shared<FakePlasmaClient>()) {}
+
+  void SetUp() override {
+    backend_ = std::make_unique<LocalFsSpillBackend>(
+        std::vector<std::string>{directory_.string()},
+        store_client_,
+        /*num_threads=*/4,
+        /*use_direct_io=*/GetParam());
+  }
+
+  void TearDown() override {
+    backend_.reset();
+    std::filesystem::remove_all(directory_);
+  }
+
+  static std::shared_ptr<Buffer> MakeBuffer(const std::string &contents) {
+    if (contents.empty()) {
+      return nullptr;
+    }
+    return std::make_shared<LocalMemoryBuffer>(
+        reinterpret_cast<uint8_t *>(const_cast<char *>(contents.data())),
+        contents.size(),
+        /*copy_data=*/true);
+  }
+
+  static rpc::Address MakeOwnerAddress() {
+    rpc::Address owner_address;
+    owner_address.set_raylet_id(NodeID::FromRandom().Binary());
+    owner_address.set_ip_address("127.0.0.1");
+    owner_address.set_port(1234);
+    owner_address.set_worker_id(WorkerID::FromRandom().Binary());
+    return owner_address;
+  }
+
+  std::vector<std::string> Spill(std::vector<LocalFsSpillBackend::ObjectToSpill> objects,
+                                 Status *status) {
+    std::promise<std::pair<Status, std::vector<std::string>>> promise;
+    backend_->SpillObjects(std::move(objects),
+                           [&promise](const Status &status,
+                                      std::vector<std::string> object_urls) {
+                             promise.set_value({status, std::move(object_urls)});
+                           });
+    auto result = promise.get_future().get();
+    *status = result.first;
+    return result.second;
+  }
+
+  Status Restore(const ObjectID &object_id,
+                 const std::string &object_url,
+                 int64_t *bytes_restored) {
+    std::promise<std::pair<Status, int64_t>> promise;
+    backend_->RestoreSpilledObject(
+        object_id, object_url, [&promise](const Status &status, int64_t bytes_restored) {
+          promise.set_value({status, bytes_restored});
+        });
+    auto result = promise.get_future().get();
+    *bytes_restored = result.second;
+    return result.first;
+  }
+
+ protected:
+  std::filesystem::path directory_;
+  std::shared_ptr<FakePlasmaClient> store_client_;
+  std::unique_ptr<LocalFsSpillBackend> backend_;
+};
+
+TEST_P(LocalFsSpillBackendTest, TestSpillAndRestore) {
+  struct TestObject {
+    ObjectID object_id;
+    rpc::Address owner_address;
+    std::string metadata;
+    std::string data;
+  };
+  std::vector<TestObject> test_objects = {
+      {ObjectID::FromRandom(), MakeOwnerAddress(), "meta", "data"},
+      {ObjectID::FromRandom(), MakeOwnerAddress(), "error", ""},
+      {ObjectID::FromRandom(), MakeOwnerAddress(), "", std::string(5 * kMB + 3, 'x')},
+      {ObjectID::FromRandom(), MakeOwnerAddress(), "m", std::string(4097, 'y')},
+  };
+  std::vector<LocalFsSpillBackend::ObjectToSpill> objects;
+  for (const auto &object : test_objects) {
+    objects.push_back({object.object_id,
+                       object.owner_address.SerializeAsString(),
+                       MakeBuffer(object.metadata),
+                       MakeBuffer(object.data)});
+  }
+
+  Status status;
+  auto object_urls = Spill(std::move(objects), &status);
+  ASSERT_TRUE(status.ok()) << status.ToString();
+  ASSERT_EQ(object_urls.size(), test_objects.size());
+
+  // All objects are fused into one file in the spill subdirectory.
+  std::vector<std::filesystem::path> files;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(directory_ / "ray_spilled_objects")) {
+    files.push_back(entry.path());
+  }
+  ASSERT_EQ(files.size(), 1);
+  ASSERT_TRUE(absl::EndsWith(files[0].filename().string(), "-multi-4"));
+  uint64_t total_size = 0;
+  for (const auto &object_url : object_urls) {
+    ASSERT_EQ((*ParseURL(object_url))["url"], files[0].string());
+    total_size += std::stoull((*ParseURL(object_url))["size"]);
+  }
+  ASSERT_EQ(std::filesystem::file_size(files[0]), total_size);
+
+  for (size_t i = 0; i < test_objects.size(); i++) {
+    const auto &expected = test_objects[i];
+
+    // The spilled objects can be read in the existing layout.
+    auto reader = SpilledObjectReader::CreateSpilledObjectReader(object_urls[i]);
+    ASSERT_TRUE(reader.has_value());
+    ASSERT_EQ(reader->GetDataSize(), expected.data.size());
+    ASSERT_EQ(reader->GetMetadataSize(), expected.metadata.size());
+    ASSERT_EQ(reader->GetOwnerAddress().SerializeAsString(),
+              expected.owner_address.SerializeAsString());
+
+    int64_t bytes_restored = 0;
+    ASSERT_TRUE(Restore(expected.object_id, object_urls[i], &bytes_restored).ok());
+    ASSERT_EQ(bytes_restored, expected.data.size());
+    auto restored = store_client_->GetObject(expected.object_id);
+    ASSERT_TRUE(restored.sealed);
+    ASSERT_EQ(restored.metadata, expected.metadata);
+    ASSERT_EQ(std::string(reinterpret_cast<const char *>(restored.data->Data()),
+                          restored.data->Size()),
+              expected.data);
+    ASSERT_EQ(restored.owner_address.SerializeAsString(),
+              expected.owner_address.SerializeAsString());
+
+    // Restoring an object that is already in plasma is a no-op.
+    ASSERT_TRUE(Restore(expected.object_id, object_urls[i], &bytes_restored).ok());
+    ASSERT_EQ(bytes_restored, 0);
+  }
+
+  // Restoring from a file that doesn't exist fails.
+  int64_t bytes_restored = 0;
+  ASSERT_FALSE(Restore(ObjectID::FromRandom(),
+                       (directory_ / "missing?offset=0&size=10").string(),
+                       &bytes_restored)
+                   .ok());
+
+  std::promise<Status> promise;
+  backend_->DeleteSpilledObjects(
+      {object_urls[0]}, [&promise](const Status &status) { promise.set_value(status); });
+  ASSERT_TRUE(promise.get_future().get().ok());
+  ASSERT_FALSE(std::filesystem::exists(files[0]));
+}
+
+TEST_P(LocalFsSpillBackendTest, TestCompressedSpillAndRestore) {
+  const uint64_t block_size = 64 * 1024;
+  backend_ = std::make_unique<LocalFsSpillBackend>(
+      std::vector<std::string>{directory_.string()},
+      store_client_,
+      /*num_threads=*/4,
+      /*use_direct_io=*/GetParam(),
+      SpillCodec::kZlib,
+      block_size);
+
+  std::string compressible;
+  for (uint64_t i = 0; compressible.size() < kMB + 7; i++) {
+    compressible.append(std::to_string(i % 100));
+  }
+  std::string incompressible;
+  std::mt19937 gen(0);
+  for (uint64_t i = 0; i < 4 * block_size; i++) {
+    incompressible.push_back(static_cast<char>(gen()));
+  }
+  std::vector<std::string> datas = {compressible, incompressible, "data", ""};
+  std::vector<ObjectID> object_ids;
+  auto owner_address = MakeOwnerAddress();
+  std::vector<LocalFsSpillBackend::ObjectToSpill> objects;
+  for (const auto &data : datas) {
+    object_ids.push_back(ObjectID::FromRandom());
+    objects.push_back({object_ids.back(),
+                       owner_address.SerializeAsString(),
+                       MakeBuffer("meta"),
+                       MakeBuffer(data)});
+  }
+
+  Status status;
+  auto object_urls = Spill(std::move(objects), &status);
+  ASSERT_TRUE(status.ok()) << status.ToString();
+  ASSERT_EQ(object_urls.size(), datas.size());
+
+  const uint64_t header_size =
+      3 * sizeof(uint64_t) + owner_address.SerializeAsString().size() + 4;
+  std::vector<uint64_t> sizes;
+  for (const auto &object_url : object_urls) {
+    sizes.push_back(std::stoull((*ParseURL(object_url))["size"]));
+  }
+  // Only the compressible object is compressed. The others are stored in the
+  // uncompressed layout, since compressing them doesn't save space.
+  ASSERT_LT(sizes[0], compressible.size() / 2);
+  for (size_t i = 1; i < datas.size(); i++) {
+    ASSERT_EQ(sizes[i], header_size + datas[i].size());
+  }
+
+  for (size_t i = 0; i < datas.size(); i++) {
+    auto reader = SpilledObjectReader::CreateSpilledObjectReader(object_urls[i]);
+    ASSERT_TRUE(reader.has_value());
+    ASSERT_EQ(reader->GetDataSize(), datas[i].size());
+    ASSERT_EQ(reader->GetMetadataSize(), 4);
+
+    int64_t bytes_restored = 0;
+    ASSERT_TRUE(Restore(object_ids[i], object_urls[i], &bytes_restored).ok());
+    ASSERT_EQ(bytes_restored, datas[i].size());
+    auto restored = store_client_->GetObject(object_ids[i]);
+    ASSERT_EQ(restored.metadata, "meta");
+    ASSERT_EQ(std::string(reinterpret_cast<const char *>(restored.data->Data()),
+                          restored.data->Size()),
+              datas[i]);
+  }
+
+  // Ranges of a compressed object can be read, as they are when it is pulled in
+  // chunks.
+  auto reader = SpilledObjectReader::CreateSpilledObjectReader(object_urls[0]);
+  for (uint64_t offset = 0; offset < compressible.size(); offset += block_size / 3) {
+    const uint64_t size = std::min(block_size, compressible.size() - offset);
+    std::string output(size, '\0');
+    ASSERT_TRUE(reader->ReadFromDataSection(offset, size, &output[0]));
+    ASSERT_EQ(output, compressible.substr(offset, size));
+  }
+}
+
+// Performance benchmark for spilling and restoring objects, with and without
+// direct IO. Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST_P(LocalFsSpillBackendTest, DISABLED_SpillRestorePerf) {
+  const uint64_t object_size = 16 * kMB;
+  const int num_objects = 64;
+  const int objects_per_file = 4;
+  std::string data(object_size, 'd');
+  auto data_buffer = MakeBuffer(data);
+  std::vector<ObjectID> object_ids;
+  for (int i = 0; i < num_objects; i++) {
+    object_ids.push_back(ObjectID::FromRandom());
+  }
+  auto owner_address = MakeOwnerAddress().SerializeAsString();
+
+  absl::Mutex mutex;
+  std::vector<std::string> object_urls(num_objects);
+  int64_t start_ms = current_time_ms();
+  {
+    absl::BlockingCounter spills(num_objects / objects_per_file);
+    for (int i = 0; i < num_objects; i += objects_per_file) {
+      std::vector<LocalFsSpillBackend::ObjectToSpill> objects;
+      for (int j = i; j < i + objects_per_file; j++) {
+        objects.push_back({object_ids[j], owner_address, nullptr, data_buffer});
+      }
+      backend_->SpillObjects(
+          std::move(objects),
+          [&, i](const Status &status, std::vector<std::string> urls) {
+            RAY_CHECK_OK(status);
+            absl::MutexLock lock(&mutex);
+            std::copy(urls.begin(), urls.end(), object_urls.begin() + i);
+            spills.DecrementCount();
+          });
+    }
+    spills.Wait();
+  }
+  int64_t spill_ms = std::max<int64_t>(current_time_ms() - start_ms, 1);
+
+  start_ms = current_time_ms();
+  {
+    absl::BlockingCounter restores(num_objects);
+    for (int i = 0; i < num_objects; i++) {
+      backend_->RestoreSpilledObject(
+          object_ids[i], object_urls[i], [&](const Status &status, int64_t) {
+            RAY_CHECK_OK(status);
+            restores.DecrementCount();
+          });
+    }
+    restores.Wait();
+  }
+  int64_t restore_ms = std::max<int64_t>(current_time_ms() - start_ms, 1);
+  auto restored = store_client_->GetObject(object_ids.back());
+  ASSERT_EQ(std::string(reinterpret_cast<const char *>(restored.data->Data()),
+                        restored.data->Size()),
+            data);
+
+  double total_gb = 1.0 * num_objects * object_size / (1024 * kMB);
+  RAY_LOG(INFO) << (GetParam() ? "Direct IO" : "Buffered IO") << ": spilled "
+                << total_gb / spill_ms * 1000 << " GB/s, restored "
+                << total_gb / restore_ms * 1000 << " GB/s.";
+}
+
+INSTANTIATE_TEST_SUITE_P(DirectIO, LocalFsSpillBackendTest, testing::Values(false, true));
+
+}  // namespace raylet
+
+}  // namespace ray
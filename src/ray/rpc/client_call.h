@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <grpcpp/generic/generic_stub.h>
 #include <grpcpp/grpcpp.h>
 
 #include <boost/asio.hpp>
@@ -235,6 +236,63 @@ class ClientCallManager {
       const ClientCallback<Reply> &callback,
       std::string call_name,
       int64_t method_timeout_ms = -1) {
+    return StartCall<Reply>(
+        [&stub, prepare_async_function, &request](grpc::ClientContext *context,
+                                                  grpc::CompletionQueue *cq) {
+          return (stub.*prepare_async_function)(context, request, cq);
+        },
+        callback,
+        std::move(call_name),
+        method_timeout_ms);
+  }
+
+  /// Create a new `ClientCall` through a generic stub and send request. Unlike
+  /// `CreateCall`, the request doesn't have to be a protobuf message, as long as
+  /// there is a `grpc::SerializationTraits` specialization for it.
+  ///
+  /// \tparam Request Type of the request message.
+  /// \tparam Reply Type of the reply message.
+  ///
+  /// \param[in] stub The generic stub.
+  /// \param[in] method The full name of the rpc method, e.g. "/ray.rpc.FooService/Bar".
+  /// \param[in] request The request message.
+  /// \param[in] callback The callback function that handles reply.
+  /// \param[in] call_name The name of the gRPC method call.
+  /// \param[in] method_timeout_ms The timeout of the RPC method in ms.
+  /// -1 means it will use the default timeout configured for the handler.
+  ///
+  /// \return A `ClientCall` representing the request that was just sent.
+  template <class Request, class Reply>
+  std::shared_ptr<ClientCall> CreateGenericCall(
+      grpc::TemplatedGenericStub<Request, Reply> &stub,
+      const std::string &method,
+      const Request &request,
+      const ClientCallback<Reply> &callback,
+      std::string call_name,
+      int64_t method_timeout_ms = -1) {
+    return StartCall<Reply>(
+        [&stub, &method, &request](grpc::ClientContext *context,
+                                   grpc::CompletionQueue *cq) {
+          return stub.PrepareUnaryCall(context, method, request, cq);
+        },
+        callback,
+        std::move(call_name),
+        method_timeout_ms);
+  }
+
+  /// Get the main service of this rpc.
+  instrumented_io_context &GetMainService() { return main_service_; }
+
+ private:
+  /// Create a new `ClientCall` and send the request prepared by `prepare_call`.
+  ///
+  /// \param[in] prepare_call Function that prepares the request with the given
+  /// client context and completion queue, and returns the response reader.
+  template <class Reply, class PrepareCall>
+  std::shared_ptr<ClientCall> StartCall(PrepareCall prepare_call,
+                                        const ClientCallback<Reply> &callback,
+                                        std::string call_name,
+                                        int64_t method_timeout_ms) {
     auto stats_handle = main_service_.stats().RecordStart(call_name);
     if (method_timeout_ms == -1) {
       method_timeout_ms = call_timeout_ms_;
@@ -243,8 +301,8 @@ class ClientCallManager {
         callback, std::move(stats_handle), method_timeout_ms);
     // Send request.
     // Find the next completion queue to wait for response.
-    call->response_reader_ = (stub.*prepare_async_function)(
-        &call->context_, request, cqs_[rr_index_++ % num_threads_].get());
+    call->response_reader_ =
+        prepare_call(&call->context_, cqs_[rr_index_++ % num_threads_].get());
     call->response_reader_->StartCall();
     // Create a new tag object. This object will eventually be deleted in the
     // `ClientCallManager::PollEventsFromCompletionQueue` when reply is received.
@@ -258,10 +316,6 @@ class ClientCallManager {
     return call;
   }
 
-  /// Get the main service of this rpc.
-  instrumented_io_context &GetMainService() { return main_service_; }
-
- private:
   /// This function runs in a background thread. It keeps polling events from the
   /// `CompletionQueue`, and dispatches the event to the callbacks via the `ClientCall`
   /// objects.
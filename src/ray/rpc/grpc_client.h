@@ -153,6 +153,32 @@ class GrpcClient {
     RAY_CHECK(call != nullptr);
   }
 
+  /// Call a method of this service through a generic stub on the same channel.
+  /// This allows sending requests with a custom `grpc::SerializationTraits`,
+  /// e.g. to avoid copying large payloads into a protobuf message.
+  ///
+  /// \tparam Request Type of the request message.
+  /// \tparam Reply Type of the reply message.
+  /// \param[in] method The full name of the rpc method, e.g. "/ray.rpc.FooService/Bar".
+  /// \param[in] request The request message.
+  /// \param[in] callback The callback function that handles reply.
+  /// \param[in] call_name The name of the gRPC method call.
+  /// \param[in] method_timeout_ms The timeout of the RPC method in ms.
+  /// -1 means it will use the default timeout configured for the handler.
+  template <class Request, class Reply>
+  void CallGenericMethod(const std::string &method,
+                         const Request &request,
+                         const ClientCallback<Reply> &callback,
+                         std::string call_name = "UNKNOWN_RPC",
+                         int64_t method_timeout_ms = -1) {
+    // The generic stub only holds a reference to the channel, so it is cheap to
+    // create one per call.
+    grpc::TemplatedGenericStub<Request, Reply> stub(channel_);
+    auto call = client_call_manager_.CreateGenericCall<Request, Reply>(
+        stub, method, request, callback, std::move(call_name), method_timeout_ms);
+    RAY_CHECK(call != nullptr);
+  }
+
   std::shared_ptr<grpc::Channel> Channel() const { return channel_; }
 
  private:
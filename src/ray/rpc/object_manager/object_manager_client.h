@@ -22,6 +22,7 @@
 
 #include "ray/common/status.h"
 #include "ray/rpc/grpc_client.h"
+#include "ray/rpc/object_manager/zero_copy_push_request.h"
 #include "ray/util/logging.h"
 #include "src/ray/protobuf/object_manager.grpc.pb.h"
 #include "src/ray/protobuf/object_manager.pb.h"
@@ -61,6 +62,22 @@ class ObjectManagerClient {
                          grpc_clients_[push_rr_index_++ % num_connections_],
                          /*method_timeout_ms*/ -1, )
 
+  /// Push object to remote object manager without copying the chunk data into
+  /// the request. The server receives it as a regular `PushRequest`.
+  ///
+  /// \param request The request message.
+  /// \param callback The callback function that handles reply from server
+  void Push(const ZeroCopyPushRequest &request,
+            const ClientCallback<PushReply> &callback) {
+    grpc_clients_[push_rr_index_++ % num_connections_]
+        ->CallGenericMethod<ZeroCopyPushRequest, PushReply>(
+            "/ray.rpc.ObjectManagerService/Push",
+            request,
+            callback,
+            "ObjectManagerService.grpc_client.Push",
+            /*method_timeout_ms*/ -1);
+  }
+
   /// Pull object from remote object manager
   ///
   /// \param request The request message
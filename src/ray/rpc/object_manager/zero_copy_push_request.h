@@ -0,0 +1,93 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <grpcpp/grpcpp.h>
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "src/ray/protobuf/object_manager.pb.h"
+
+namespace ray {
+namespace rpc {
+
+/// A `PushRequest` whose chunk data is referenced instead of copied into the
+/// message. It is serialized into the same wire format as a `PushRequest`, with
+/// the chunk data attached to the gRPC byte buffer as a separate slice, so the
+/// receiver handles it like any other push.
+struct ZeroCopyPushRequest {
+  /// The request header. Its `data` field must be empty.
+  PushRequest header;
+  /// The chunk data. It must stay valid for as long as `data_holder` is alive.
+  absl::string_view data;
+  /// Keeps the memory referenced by `data` alive. gRPC holds a copy of it until
+  /// the request has been written to the wire.
+  std::shared_ptr<const void> data_holder;
+};
+
+}  // namespace rpc
+}  // namespace ray
+
+namespace grpc {
+
+template <>
+class SerializationTraits<ray::rpc::ZeroCopyPushRequest, void> {
+ public:
+  static Status Serialize(const ray::rpc::ZeroCopyPushRequest &msg,
+                          ByteBuffer *buffer,
+                          bool *own_buffer) {
+    using google::protobuf::io::CodedOutputStream;
+    using google::protobuf::internal::WireFormatLite;
+    *own_buffer = true;
+    std::string header = msg.header.SerializeAsString();
+    // Append the tag and length of the data field, so that the data slice that
+    // follows is parsed as its value.
+    uint8_t field_prefix[16];
+    uint8_t *end = CodedOutputStream::WriteTagToArray(
+        WireFormatLite::MakeTag(ray::rpc::PushRequest::kDataFieldNumber,
+                                WireFormatLite::WIRETYPE_LENGTH_DELIMITED),
+        field_prefix);
+    end = CodedOutputStream::WriteVarint64ToArray(msg.data.size(), end);
+    header.append(reinterpret_cast<const char *>(field_prefix), end - field_prefix);
+
+    Slice slices[2] = {
+        Slice(header),
+        Slice(const_cast<char *>(msg.data.data()),
+              msg.data.size(),
+              &ReleaseDataHolder,
+              new std::shared_ptr<const void>(msg.data_holder)),
+    };
+    ByteBuffer tmp(slices, 2);
+    buffer->Swap(&tmp);
+    return Status::OK;
+  }
+
+  static Status Deserialize(ByteBuffer *buffer, ray::rpc::ZeroCopyPushRequest *msg) {
+    // Requests are received as a regular `PushRequest`.
+    return Status(StatusCode::UNIMPLEMENTED,
+                  "ZeroCopyPushRequest can only be serialized.");
+  }
+
+ private:
+  static void ReleaseDataHolder(void *data_holder) {
+    delete static_cast<std::shared_ptr<const void> *>(data_holder);
+  }
+};
+
+}  // namespace grpc
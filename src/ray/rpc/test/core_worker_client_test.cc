@@ -0,0 +1,143 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/rpc/worker/core_worker_client.h"
+
+#include "gtest/gtest.h"
+
+namespace ray {
+namespace rpc {
+
+/// A client that records the PushTasks RPCs instead of sending them.
+class TestCoreWorkerClient : public CoreWorkerClient {
+ public:
+  TestCoreWorkerClient(const rpc::Address &address, ClientCallManager &client_call_manager)
+      : CoreWorkerClient(address, client_call_manager) {}
+
+  void PushTasks(const PushTasksRequest &request,
+                 const ClientCallback<PushTasksReply> &callback) override {
+    requests.push_back(request);
+    callbacks.push_back(callback);
+  }
+
+  std::vector<PushTasksRequest> requests;
+  std::vector<ClientCallback<PushTasksReply>> callbacks;
+};
+
+class CoreWorkerClientTest : public ::testing::Test {
+ public:
+  CoreWorkerClientTest() : client_call_manager_(io_service_) {
+    rpc::Address address;
+    address.set_ip_address("127.0.0.1");
+    address.set_port(1);
+    address.set_worker_id(WorkerID::FromRandom().Binary());
+    client_ = std::make_shared<TestCoreWorkerClient>(address, client_call_manager_);
+  }
+
+  /// Push a batch of tasks with sequence numbers [start, start + num_tasks), and
+  /// record the status each of them is replied to with.
+  std::vector<TaskID> PushBatch(int64_t start, int64_t num_tasks) {
+    std::vector<TaskID> task_ids;
+    PushTaskBatch batch;
+    for (int64_t seq_no = start; seq_no < start + num_tasks; seq_no++) {
+      auto request = std::make_unique<PushTaskRequest>();
+      task_ids.push_back(TaskID::FromRandom(JobID::FromInt(0)));
+      request->mutable_task_spec()->set_task_id(task_ids.back().Binary());
+      request->set_sequence_number(seq_no);
+      batch.emplace_back(
+          std::move(request),
+          [this, task_id = task_ids.back()](const Status &status,
+                                            const PushTaskReply &reply) {
+            ASSERT_FALSE(statuses_.contains(task_id));
+            statuses_.emplace(task_id, status);
+          });
+    }
+    client_->PushActorTasks(std::move(batch));
+    return task_ids;
+  }
+
+  ReportActorTaskReplyRequest TaskReply(const TaskID &task_id,
+                                        const Status &status = Status::OK()) {
+    ReportActorTaskReplyRequest request;
+    request.set_task_id(task_id.Binary());
+    if (!status.ok()) {
+      request.set_status_code(status.CodeAsString());
+      request.set_status_message(status.message());
+    }
+    return request;
+  }
+
+ protected:
+  instrumented_io_context io_service_;
+  ClientCallManager client_call_manager_;
+  std::shared_ptr<TestCoreWorkerClient> client_;
+  absl::flat_hash_map<TaskID, Status> statuses_;
+};
+
+TEST_F(CoreWorkerClientTest, TestBatchPartiallyReplied) {
+  auto task_ids = PushBatch(0, 3);
+  ASSERT_EQ(client_->requests.size(), 1);
+  ASSERT_EQ(client_->requests[0].requests_size(), 3);
+  ASSERT_EQ(client_->requests[0].requests(0).client_processed_up_to(), -1);
+
+  // Each task is replied to as soon as its reply is reported, before the batch is.
+  client_->HandleActorTaskReply(TaskReply(task_ids[1]));
+  ASSERT_TRUE(statuses_.at(task_ids[1]).ok());
+  ASSERT_EQ(client_->ClientProcessedUpToSeqno(), 1);
+  client_->HandleActorTaskReply(TaskReply(task_ids[0], Status::Invalid("task failed")));
+  ASSERT_TRUE(statuses_.at(task_ids[0]).IsInvalid());
+  ASSERT_EQ(statuses_.at(task_ids[0]).message(), "task failed");
+  ASSERT_EQ(statuses_.size(), 2);
+
+  // Replies to tasks that were already replied to, or that were never sent, are
+  // ignored.
+  client_->HandleActorTaskReply(TaskReply(task_ids[1]));
+  client_->HandleActorTaskReply(TaskReply(TaskID::FromRandom(JobID::FromInt(0))));
+  ASSERT_EQ(statuses_.size(), 2);
+
+  // The batch RPC fails. Only the task that wasn't replied to yet fails with it.
+  client_->callbacks[0](Status::IOError("connection lost"), PushTasksReply());
+  ASSERT_EQ(statuses_.size(), 3);
+  ASSERT_TRUE(statuses_.at(task_ids[0]).IsInvalid());
+  ASSERT_TRUE(statuses_.at(task_ids[2]).IsIOError());
+  ASSERT_EQ(client_->ClientProcessedUpToSeqno(), 2);
+
+  // A late reply to the failed task is ignored.
+  client_->HandleActorTaskReply(TaskReply(task_ids[2]));
+  ASSERT_TRUE(statuses_.at(task_ids[2]).IsIOError());
+}
+
+TEST_F(CoreWorkerClientTest, TestBatchFailed) {
+  auto task_ids = PushBatch(0, 2);
+  ASSERT_EQ(client_->requests.size(), 1);
+
+  // A successful batch reply doesn't reply to the tasks.
+  client_->callbacks[0](Status::OK(), PushTasksReply());
+  ASSERT_TRUE(statuses_.empty());
+  client_->HandleActorTaskReply(TaskReply(task_ids[0]));
+  client_->HandleActorTaskReply(TaskReply(task_ids[1]));
+  ASSERT_TRUE(statuses_.at(task_ids[0]).ok());
+  ASSERT_TRUE(statuses_.at(task_ids[1]).ok());
+
+  // A failed batch fails all of its tasks.
+  task_ids = PushBatch(2, 2);
+  ASSERT_EQ(client_->requests.size(), 2);
+  ASSERT_EQ(client_->requests[1].requests(0).client_processed_up_to(), 1);
+  client_->callbacks[1](Status::IOError("connection lost"), PushTasksReply());
+  ASSERT_TRUE(statuses_.at(task_ids[0]).IsIOError());
+  ASSERT_TRUE(statuses_.at(task_ids[1]).IsIOError());
+}
+
+}  // namespace rpc
+}  // namespace ray
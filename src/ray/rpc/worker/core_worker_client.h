@@ -28,7 +28,9 @@
 #include <thread>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/hash/hash.h"
+#include "ray/common/id.h"
 #include "ray/common/status.h"
 #include "ray/pubsub/subscriber.h"
 #include "ray/rpc/grpc_client.h"
@@ -54,6 +56,11 @@ const static int64_t RequestSizeInBytes(const PushTaskRequest &request) {
   return size;
 }
 
+/// Actor tasks that are sent to a worker together. A batch of more than one task
+/// is sent in one PushTasks RPC.
+using PushTaskBatch = std::vector<
+    std::pair<std::unique_ptr<PushTaskRequest>, ClientCallback<PushTaskReply>>>;
+
 // Shared between direct actor and task submitters.
 /* class CoreWorkerClientInterface; */
 
@@ -113,9 +120,31 @@ class CoreWorkerClientInterface : public pubsub::SubscriberClientInterface {
                              bool skip_queue,
                              const ClientCallback<PushTaskReply> &callback) {}
 
+  /// Push a batch of actor tasks in one RPC. The tasks are ordered as if they had
+  /// been pushed one by one with PushActorTask. Each callback is called with the
+  /// reply to its own task as soon as that task finishes, see HandleActorTaskReply.
+  ///
+  /// \param[in] batch The requests to send and the callbacks that handle their
+  /// replies, in order.
+  virtual void PushActorTasks(PushTaskBatch batch) {
+    for (auto &[request, callback] : batch) {
+      PushActorTask(std::move(request), /*skip_queue=*/false, callback);
+    }
+  }
+
+  /// Handle the reply to a task that was pushed with PushActorTasks, which the
+  /// worker that executed the task reports to its caller.
+  ///
+  /// \param[in] request The reported reply.
+  virtual void HandleActorTaskReply(const ReportActorTaskReplyRequest &request) {}
+
   /// Similar to PushActorTask, but sets no ordering constraint. This is used to
-  /// push non-actor tasks directly to a worker.
-  virtual void PushNormalTask(std::unique_ptr<PushTaskRequest> request,
+  /// push non-actor tasks directly to a worker. The caller should set the sequence
+  /// number and client_processed_up_to of the request to -1.
+  ///
+  /// The request is not used after this method returns, so the caller may let it
+  /// borrow fields such as the task spec instead of copying them in.
+  virtual void PushNormalTask(const PushTaskRequest &request,
                               const ClientCallback<PushTaskReply> &callback) {}
 
   /// Notify a wait has completed for direct actor call arguments.
@@ -131,6 +160,12 @@ class CoreWorkerClientInterface : public pubsub::SubscriberClientInterface {
   virtual void GetObjectStatus(const GetObjectStatusRequest &request,
                                const ClientCallback<GetObjectStatusReply> &callback) {}
 
+  /// Ask the owner of several objects about their current status. The owner
+  /// replies once the status of at least one of the objects is known.
+  virtual void GetObjectStatuses(
+      const GetObjectStatusesRequest &request,
+      const ClientCallback<GetObjectStatusesReply> &callback) {}
+
   /// Ask the actor's owner to reply when the actor has gone out of scope.
   virtual void WaitForActorOutOfScope(
       const WaitForActorOutOfScopeRequest &request,
@@ -200,6 +235,13 @@ class CoreWorkerClientInterface : public pubsub::SubscriberClientInterface {
       const RayletNotifyGCSRestartRequest &request,
       const ClientCallback<RayletNotifyGCSRestartReply> &callback) {}
 
+  virtual void PushTasks(const PushTasksRequest &request,
+                         const ClientCallback<PushTasksReply> &callback) {}
+
+  virtual void ReportActorTaskReply(
+      const ReportActorTaskReplyRequest &request,
+      const ClientCallback<ReportActorTaskReplyReply> &callback) {}
+
   /// Returns the max acked sequence number, useful for checking on progress.
   virtual int64_t ClientProcessedUpToSeqno() { return -1; }
 
@@ -235,6 +277,12 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
                          /*method_timeout_ms*/ -1,
                          override)
 
+  VOID_RPC_CLIENT_METHOD(CoreWorkerService,
+                         GetObjectStatuses,
+                         grpc_client_,
+                         /*method_timeout_ms*/ -1,
+                         override)
+
   VOID_RPC_CLIENT_METHOD(CoreWorkerService,
                          KillActor,
                          grpc_client_,
@@ -334,6 +382,15 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   VOID_RPC_CLIENT_METHOD(
       CoreWorkerService, Exit, grpc_client_, /*method_timeout_ms*/ -1, override)
 
+  VOID_RPC_CLIENT_METHOD(
+      CoreWorkerService, PushTasks, grpc_client_, /*method_timeout_ms*/ -1, override)
+
+  VOID_RPC_CLIENT_METHOD(CoreWorkerService,
+                         ReportActorTaskReply,
+                         grpc_client_,
+                         /*method_timeout_ms*/ -1,
+                         override)
+
   VOID_RPC_CLIENT_METHOD(CoreWorkerService,
                          AssignObjectOwner,
                          grpc_client_,
@@ -357,22 +414,33 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
       return;
     }
 
+    PushTaskBatch batch;
+    batch.emplace_back(std::move(request),
+                       std::move(const_cast<ClientCallback<PushTaskReply> &>(callback)));
     {
       absl::MutexLock lock(&mutex_);
-      send_queue_.push_back(std::make_pair(
-          std::move(request),
-          std::move(const_cast<ClientCallback<PushTaskReply> &>(callback))));
+      send_queue_.push_back(std::move(batch));
     }
     SendRequests();
   }
 
-  void PushNormalTask(std::unique_ptr<PushTaskRequest> request,
+  void PushActorTasks(PushTaskBatch batch) override {
+    if (batch.empty()) {
+      return;
+    }
+    {
+      absl::MutexLock lock(&mutex_);
+      send_queue_.push_back(std::move(batch));
+    }
+    SendRequests();
+  }
+
+  void PushNormalTask(const PushTaskRequest &request,
                       const ClientCallback<PushTaskReply> &callback) override {
-    request->set_sequence_number(-1);
-    request->set_client_processed_up_to(-1);
+    RAY_CHECK_EQ(request.sequence_number(), -1);
     INVOKE_RPC_CALL(CoreWorkerService,
                     PushTask,
-                    *request,
+                    request,
                     callback,
                     grpc_client_,
                     /*method_timeout_ms*/ -1);
@@ -388,9 +456,14 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
     auto this_ptr = this->shared_from_this();
 
     while (!send_queue_.empty() && rpc_bytes_in_flight_ < kMaxBytesInFlight) {
-      auto pair = std::move(*send_queue_.begin());
+      auto batch = std::move(*send_queue_.begin());
       send_queue_.pop_front();
+      if (batch.size() > 1) {
+        SendBatch(std::move(batch), this_ptr);
+        continue;
+      }
 
+      auto pair = std::move(batch.front());
       auto request = std::move(pair.first);
       int64_t task_size = RequestSizeInBytes(*request);
       int64_t seq_no = request->sequence_number();
@@ -425,6 +498,18 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
     }
   }
 
+  void HandleActorTaskReply(const ReportActorTaskReplyRequest &request) override {
+    Status status;
+    if (!request.status_code().empty()) {
+      status =
+          Status(Status::StringToCode(request.status_code()), request.status_message());
+    }
+    FinishBatchedTask(TaskID::FromBinary(request.task_id()),
+                      request.attempt_number(),
+                      status,
+                      request.reply());
+  }
+
   /// Returns the max acked sequence number, useful for checking on progress.
   int64_t ClientProcessedUpToSeqno() override {
     absl::MutexLock lock(&mutex_);
@@ -432,6 +517,79 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   }
 
  private:
+  /// A task sent in a PushTasks RPC that hasn't been replied to yet.
+  struct PendingTaskReply {
+    uint64_t attempt_number;
+    int64_t seq_no;
+    int64_t task_size;
+    ClientCallback<PushTaskReply> callback;
+  };
+
+  /// Send a batch of more than one task in one PushTasks RPC. The worker replies to
+  /// the RPC once it has queued the tasks, and reports the reply to each task once
+  /// the task finishes. Each task counts as in flight until then.
+  void SendBatch(PushTaskBatch batch, std::shared_ptr<CoreWorkerClient> this_ptr)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    PushTasksRequest batch_request;
+    std::vector<std::pair<TaskID, uint64_t>> tasks;
+    tasks.reserve(batch.size());
+    for (auto &[request, callback] : batch) {
+      const int64_t task_size = RequestSizeInBytes(*request);
+      rpc_bytes_in_flight_ += task_size;
+      request->set_client_processed_up_to(max_finished_seq_no_);
+      const auto task_id = TaskID::FromBinary(request->task_spec().task_id());
+      const uint64_t attempt_number = request->task_spec().attempt_number();
+      tasks.emplace_back(task_id, attempt_number);
+      // Register the callback before sending, since the reply to a task may arrive
+      // before the reply to the batch.
+      pending_task_replies_[task_id] = PendingTaskReply{
+          attempt_number, request->sequence_number(), task_size, std::move(callback)};
+      batch_request.add_requests()->Swap(request.get());
+    }
+
+    auto rpc_callback = [this, this_ptr, tasks = std::move(tasks)](
+                            const Status &status, const rpc::PushTasksReply &reply) {
+      if (status.ok()) {
+        // The worker reports the reply to each task once it finishes.
+        return;
+      }
+      // The worker may not have received the tasks that haven't been replied to.
+      for (const auto &[task_id, attempt_number] : tasks) {
+        FinishBatchedTask(task_id, attempt_number, status, rpc::PushTaskReply());
+      }
+    };
+
+    PushTasks(batch_request, std::move(rpc_callback));
+  }
+
+  /// Call the callback of a task sent in a PushTasks RPC, unless it was already
+  /// called.
+  void FinishBatchedTask(const TaskID &task_id,
+                         uint64_t attempt_number,
+                         const Status &status,
+                         const PushTaskReply &reply) LOCKS_EXCLUDED(mutex_) {
+    ClientCallback<PushTaskReply> callback;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = pending_task_replies_.find(task_id);
+      if (it == pending_task_replies_.end() ||
+          it->second.attempt_number != attempt_number) {
+        RAY_LOG(DEBUG) << "Ignoring reply to task " << task_id << " attempt "
+                       << attempt_number << ", which was already replied to.";
+        return;
+      }
+      if (it->second.seq_no > max_finished_seq_no_) {
+        max_finished_seq_no_ = it->second.seq_no;
+      }
+      rpc_bytes_in_flight_ -= it->second.task_size;
+      RAY_CHECK(rpc_bytes_in_flight_ >= 0);
+      callback = std::move(it->second.callback);
+      pending_task_replies_.erase(it);
+    }
+    SendRequests();
+    callback(status, reply);
+  }
+
   /// Protects against unsafe concurrent access from the callback thread.
   absl::Mutex mutex_;
 
@@ -441,15 +599,18 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   /// The RPC client.
   std::unique_ptr<GrpcClient<CoreWorkerService>> grpc_client_;
 
-  /// Queue of requests to send.
-  std::deque<std::pair<std::unique_ptr<PushTaskRequest>, ClientCallback<PushTaskReply>>>
-      send_queue_ GUARDED_BY(mutex_);
+  /// Queue of requests to send. Each batch is sent in one RPC.
+  std::deque<PushTaskBatch> send_queue_ GUARDED_BY(mutex_);
 
   /// The number of bytes currently in flight.
   int64_t rpc_bytes_in_flight_ GUARDED_BY(mutex_) = 0;
 
   /// The max sequence number we have processed responses for.
   int64_t max_finished_seq_no_ GUARDED_BY(mutex_) = -1;
+
+  /// The tasks sent in PushTasks RPCs that haven't been replied to yet.
+  absl::flat_hash_map<TaskID, PendingTaskReply> pending_task_replies_
+      GUARDED_BY(mutex_);
 };
 
 typedef std::function<std::shared_ptr<CoreWorkerClientInterface>(const rpc::Address &)>
@@ -52,6 +52,22 @@ DEFINE_stats(
     (),
     ray::stats::GAUGE);
 
+/// Size of the specs of finished tasks that owners keep to reconstruct objects.
+DEFINE_stats(task_lineage_bytes,
+             "Bytes of task lineage kept by owners broken per location {InMemory, "
+             "Spilled}.",
+             ("Location"),
+             (),
+             ray::stats::GAUGE);
+
+/// Idle leased workers that were handed to the queued tasks of another
+/// scheduling key instead of being returned to the raylet.
+DEFINE_stats(core_worker_lease_reuses_total,
+             "Number of worker leases reused for a different scheduling key.",
+             (),
+             (),
+             ray::stats::COUNT);
+
 /// Tracks actors by state, including pending, running, and idle actors.
 ///
 /// To avoid metric collection conflicts between components reporting on the same task,
@@ -98,6 +114,18 @@ DEFINE_stats(
     (),
     ray::stats::GAUGE);
 
+/// Object store slab allocator.
+DEFINE_stats(object_store_slab_bytes,
+             "Bytes of plasma slab memory broken per type {Reserved, InUse, Requested}.",
+             ("Type"),
+             (),
+             ray::stats::GAUGE);
+DEFINE_stats(object_store_slab_fragmentation_ratio,
+             "Fraction of reserved plasma slab memory that is not used by object data.",
+             (),
+             (),
+             ray::stats::GAUGE);
+
 /// Placement group metrics from the GCS.
 DEFINE_stats(placement_groups,
              "Number of placement groups broken down by state.",
@@ -147,7 +175,7 @@ DEFINE_stats(grpc_server_req_finished,
 /// Object Manager.
 DEFINE_stats(object_manager_bytes,
              "Number of bytes pushed or received by type {PushedFromLocalPlasma, "
-             "PushedFromLocalDisk, Received}.",
+             "PushedFromLocalDisk, Received, Relayed}.",
              ("Type"),
              (),
              ray::stats::GAUGE);
@@ -209,6 +237,16 @@ DEFINE_stats(push_manager_chunks,
              ("Type"),
              (),
              ray::stats::GAUGE);
+DEFINE_stats(push_manager_peer_window_chunks,
+             "Max number of object chunks allowed in flight to each destination node.",
+             ("PeerNodeId"),
+             (),
+             ray::stats::GAUGE);
+DEFINE_stats(push_manager_peer_throughput_bytes,
+             "Bytes per second of object chunks pushed to each destination node.",
+             ("PeerNodeId"),
+             (),
+             ray::stats::GAUGE);
 
 /// Scheduler
 DEFINE_stats(
@@ -45,6 +45,12 @@ namespace stats {
 /// Tasks stats, broken down by state.
 DECLARE_stats(tasks);
 
+/// Owner lineage stats, broken down by location.
+DECLARE_stats(task_lineage_bytes);
+
+/// Worker leases reused across scheduling keys.
+DECLARE_stats(core_worker_lease_reuses_total);
+
 /// Actor stats, broken down by state.
 DECLARE_stats(actors);
 
@@ -81,6 +87,8 @@ DECLARE_stats(pull_manager_object_request_time_ms);
 /// Push Manager
 DECLARE_stats(push_manager_in_flight_pushes);
 DECLARE_stats(push_manager_chunks);
+DECLARE_stats(push_manager_peer_window_chunks);
+DECLARE_stats(push_manager_peer_throughput_bytes);
 
 /// Scheduler
 DECLARE_stats(scheduler_failed_worker_startup_total);
@@ -107,6 +115,8 @@ DECLARE_stats(gcs_task_manager_task_events_reported);
 
 /// Object Store
 DECLARE_stats(object_store_memory);
+DECLARE_stats(object_store_slab_bytes);
+DECLARE_stats(object_store_slab_fragmentation_ratio);
 
 /// Placement Group
 DECLARE_stats(gcs_placement_group_creation_latency_ms);